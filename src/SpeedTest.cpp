@@ -0,0 +1,606 @@
+/**
+ * @file SpeedTest.cpp
+ * @author Takanori Saiki
+ * @brief 主要な処理のベンチマーク(Google Benchmark)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details make benchmarkでbenchmark.jsonに結果を書き出す。2つの結果はsrc/convert_tools/compare_benchmarks.pyで比較できる。
+ *          細胞数(cells)、密度(density: 1万平方単位あたりの細胞数)、分子の格子の一辺(grid)を変えて計測する。
+ *          設定はconfig.yamlを読まずにここで決める(結果が設定ファイルに左右されないようにするため)。
+ *          1スレッドで動くベンチマークでは、開けるハードウェアカウンタ(PerfCounters)の値も1要素あたりで記録する。
+ */
+
+#include "UserSimulation.hpp"
+#include "core/CellSnapshot.hpp"
+#include "core/ClusterAnalysis.hpp"
+#include "core/MoleculeGrid.hpp"
+#include "utils/PerfCounters.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+namespace {
+    constexpr int32_t MIN_FIELD_LEN = 256; //!< フィールドの一辺の最小値。CellListのグリッドが小さくなりすぎないようにする
+
+    /**
+     * @brief 細胞数と密度からフィールドの大きさを決め、SimulationSettingsを書き換える。
+     * @details フィールドの一辺は2のべき乗にする必要があるので、実際の密度はdensity以下になる。
+     *
+     * @return int32_t フィールドの一辺
+     */
+    int32_t configure(int64_t cellCount, int64_t density, int64_t gridLen)
+    {
+        const double side = std::sqrt((double)cellCount * 1e4 / (double)density);
+        int32_t fieldLen  = MIN_FIELD_LEN;
+        while (fieldLen < side) {
+            fieldLen *= 2;
+        }
+
+        SimulationSettings::USE_CELL_LIST           = true;
+        SimulationSettings::CELL_SEED               = 0;
+        SimulationSettings::SIM_STEP                = 1000;
+        SimulationSettings::OUTPUT_INTERVAL_STEP    = 5;
+        SimulationSettings::CELL_NUM                = cellCount;
+        SimulationSettings::POSITION_UPDATE_METHOD  = PositionUpdateMethod::EULER;
+        SimulationSettings::GRID_SIZE_MAGNIFICATION = 32;
+        SimulationSettings::SEARCH_RADIUS           = 64;
+        SimulationSettings::CELL_LIST_TYPE          = CellListType::UNIFORM;
+        SimulationSettings::CELL_LIST_INCREMENTAL   = false;
+        SimulationSettings::CELL_LIST_PERIODIC      = false;
+        SimulationSettings::ADAPTIVE_BASE_GRID_SIZE = 8;
+        SimulationSettings::ADAPTIVE_BUCKET_CELLS   = 32;
+        SimulationSettings::REMOTE_FORCE_METHOD     = RemoteForceMethod::CUTOFF;
+        SimulationSettings::REMOTE_FORCE_EXP        = ExpMethod::LIBM;
+        SimulationSettings::INTERACTION_MATRIX      = InteractionMatrix::standard(SimulationSettings::REMOTE_FORCE_LAMBDA);
+        SimulationSettings::FIELD_X_LEN             = fieldLen;
+        SimulationSettings::FIELD_Y_LEN             = fieldLen;
+        SimulationSettings::FIELD_Z_LEN             = 0;
+        SimulationSettings::MOLECULE_TYPE_NUM       = 1;
+        SimulationSettings::DEFAULT_MOLECULE_NUMS   = { 3000 };
+        SimulationSettings::MOLECULE_FIELD_X_LEN    = gridLen;
+        SimulationSettings::MOLECULE_FIELD_Y_LEN    = gridLen;
+        SimulationSettings::MOLECULE_FIELD_Z_LEN    = 1;
+        SimulationSettings::OUTPUT_ASYNC            = false;
+        SimulationSettings::ANALYSIS_CLUSTERS       = false;
+        SimulationSettings::OUTPUT_QUEUE_DEPTH      = 1;
+        SimulationSettings::DELTA_TIME              = 0.1;
+        SimulationSettings::MOLECULE_DELTA_TIME     = 0.001;
+
+        return fieldLen;
+    }
+
+    /**
+     * @brief ベンチマークから内部の状態に触るためのSimulation
+     */
+    class BenchSimulation : public UserSimulation
+    {
+      public:
+        using Simulation::addCell;
+        using Simulation::cellList;
+        using Simulation::cells;
+        using Simulation::findAroundCells;
+        using Simulation::getContactGraph;
+        using Simulation::moleculeSpaces;
+        using Simulation::remoteExp;
+        using Simulation::setCellList;
+
+        /**
+         * @brief フィールド全体に一様に細胞を置く。
+         * @param mixedTypes trueなら細胞の種類をWORKERからENEMYまで順に割り当てる
+         */
+        void scatter(int64_t cellCount, bool mixedTypes = false)
+        {
+            const int32_t firstType = (int32_t)CellType::WORKER;
+            const int32_t typeNum   = mixedTypes ? InteractionMatrix::cellTypeNum() - firstType : 1;
+            const double half = SimulationSettings::FIELD_X_LEN / 2.0;
+            std::mt19937_64 engine(0);
+            std::uniform_real_distribution<double> pos(-half, half);
+
+            for (int64_t i = 0; i < cellCount; i++) {
+                const double x = pos(engine);
+                const double y = pos(engine);
+                addCell(std::make_shared<UserCell>((CellType)(firstType + i % typeNum), x, y, 10.0));
+            }
+        }
+
+        /**
+         * @brief 細胞の9割を4つの密集したコロニー(正規分布)に、残りをフィールド全体に置く。
+         */
+        void colonies(int64_t cellCount)
+        {
+            const double half = SimulationSettings::FIELD_X_LEN / 2.0;
+            std::mt19937_64 engine(0);
+            std::uniform_real_distribution<double> pos(-half, half);
+            std::normal_distribution<double> spread(0, half / 32);
+            const double centers[4][2] = { { -half / 2, -half / 2 }, { half / 2, -half / 3 }, { -half / 3, half / 2 }, { half / 3, half / 3 } };
+
+            for (int64_t i = 0; i < cellCount; i++) {
+                double x = pos(engine), y = pos(engine);
+                if (i % 10 != 0) {
+                    x = std::clamp(centers[i % 4][0] + spread(engine), -half, half - 1);
+                    y = std::clamp(centers[i % 4][1] + spread(engine), -half, half - 1);
+                }
+                addCell(std::make_shared<UserCell>(CellType::WORKER, x, y, 10.0));
+            }
+        }
+
+        void buildCellList()
+        {
+            cellList.rebuild(cells);
+        }
+    };
+
+    /**
+     * @brief 設定を書き換えてSimulationを作り、細胞を置く。
+     */
+    std::unique_ptr<BenchSimulation> makeSimulation(int64_t cellCount, int64_t density, int64_t gridLen, bool mixedTypes = false)
+    {
+        configure(cellCount, density, gridLen);
+        Cell::numberOfCellsBorn = 0;
+        Cell::currentStep       = 1;
+
+        // MoleculeSpaceのコンストラクタが標準出力に書くので、その間は止めておく
+        std::cout.setstate(std::ios::failbit);
+        auto sim = std::make_unique<BenchSimulation>();
+        std::cout.clear();
+
+        sim->scatter(cellCount, mixedTypes);
+        sim->buildCellList();
+
+        return sim;
+    }
+
+    /**
+     * @brief 実際の密度(1万平方単位あたりの細胞数)を記録する。
+     */
+    void setDensityCounter(benchmark::State& state, int64_t cellCount)
+    {
+        const double area        = (double)SimulationSettings::FIELD_X_LEN * SimulationSettings::FIELD_Y_LEN;
+        state.counters["density"] = cellCount * 1e4 / area;
+    }
+
+    /**
+     * @brief ベンチマークのループの前後でハードウェアカウンタを読み、1要素あたりの値を記録する。
+     * @details 呼び出したスレッドしか数えないので、1スレッドで動くベンチマークにだけ使う。開けなかったカウンタは記録しない。
+     */
+    class CounterProbe
+    {
+      private:
+        PerfCounters counters;
+        PerfCounters::Values start;
+
+      public:
+        CounterProbe()
+          : start(counters.read())
+        {
+        }
+
+        void finish(benchmark::State& state, int64_t itemsPerIteration)
+        {
+            const PerfCounters::Values end = counters.read();
+            const double items             = (double)state.iterations() * itemsPerIteration;
+            if (items <= 0) {
+                return;
+            }
+
+            auto delta = [&](PerfCounters::Counter c) { return (double)(end[c] - start[c]); };
+            if (counters.isAvailable(PerfCounters::CYCLES)) {
+                state.counters["cycles/item"] = delta(PerfCounters::CYCLES) / items;
+            }
+            if (counters.isAvailable(PerfCounters::CYCLES) && counters.isAvailable(PerfCounters::INSTRUCTIONS) && delta(PerfCounters::CYCLES) > 0) {
+                state.counters["IPC"] = delta(PerfCounters::INSTRUCTIONS) / delta(PerfCounters::CYCLES);
+            }
+            if (counters.isAvailable(PerfCounters::LLC_MISSES)) {
+                state.counters["LLCmiss/item"] = delta(PerfCounters::LLC_MISSES) / items;
+            }
+            if (counters.isAvailable(PerfCounters::BRANCH_MISSES)) {
+                state.counters["brMiss/item"] = delta(PerfCounters::BRANCH_MISSES) / items;
+            }
+        }
+    };
+
+    /**
+     * @brief 細胞数 x 密度の組み合わせ
+     */
+    void cellArgs(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "cells", "density" });
+        for (int64_t cells : { 1000, 10000, 100000 }) {
+            for (int64_t density : { 10, 40 }) {
+                b->Args({ cells, density });
+            }
+        }
+    }
+} // namespace
+
+/**
+ * @brief CellListの構築(rebuild()で全細胞を登録し直す)
+ */
+static void BM_CellListBuild(benchmark::State& state)
+{
+    auto sim = makeSimulation(state.range(0), state.range(1), 16);
+
+    CounterProbe probe;
+    for (auto _ : state) {
+        sim->buildCellList();
+    }
+    probe.finish(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_CellListBuild)->Apply(cellArgs)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief ゆっくり動く細胞でのCellListの更新。incrementalが0なら毎回作り直し、1ならグリッドをまたいだ細胞だけを入れ直す
+ * @details 細胞を動かす時間は計らない。1ステップで細胞は平均0.5動くので、グリッド(一辺32)をまたぐのは数%になる。
+ */
+static void BM_CellListUpdate(benchmark::State& state)
+{
+    auto sim                                  = makeSimulation(state.range(0), 40, 16);
+    SimulationSettings::CELL_LIST_INCREMENTAL = state.range(1) != 0;
+    sim->setCellList();
+
+    std::mt19937_64 engine(0);
+    std::normal_distribution<double> step(0, 0.5);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (auto& cell : sim->cells) {
+            cell->initForce();
+            cell->addForce(step(engine), step(engine));
+            cell->nextStep();
+        }
+        state.ResumeTiming();
+
+        sim->setCellList();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["moved"] = (double)sim->cellList.movedCount() / state.range(0);
+}
+BENCHMARK(BM_CellListUpdate)->ArgNames({ "cells", "incremental" })->ArgsProduct({ { 10000, 100000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 全細胞についてaroundCellListで近傍の細胞を集める
+ */
+static void BM_AroundCellList(benchmark::State& state)
+{
+    auto sim = makeSimulation(state.range(0), state.range(1), 16);
+
+    int64_t neighbours = 0;
+    CounterProbe probe;
+    for (auto _ : state) {
+        neighbours = 0;
+        for (auto& cell : sim->cells) {
+            auto around = sim->cellList.aroundCellList(cell);
+            neighbours += around.size();
+            benchmark::DoNotOptimize(around.data());
+        }
+    }
+    probe.finish(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["neighbours"] = (double)neighbours / state.range(0);
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_AroundCellList)->Apply(cellArgs)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 密集したコロニーでの近傍探索(構築 + 全細胞の近傍)。adaptiveが0ならCellList、1ならVariableRatioCellList
+ */
+static void BM_ClusteredNeighbourSearch(benchmark::State& state)
+{
+    const int64_t cellCount = state.range(0);
+    auto sim                = makeSimulation(0, 10, 16);
+    SimulationSettings::CELL_LIST_TYPE = state.range(1) != 0 ? CellListType::ADAPTIVE : CellListType::UNIFORM;
+    sim->colonies(cellCount);
+
+    int64_t neighbours = 0;
+    for (auto _ : state) {
+        sim->setCellList();
+        neighbours = 0;
+        for (auto& cell : sim->cells) {
+            auto around = sim->findAroundCells(cell);
+            neighbours += around.size();
+            benchmark::DoNotOptimize(around.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cellCount);
+    state.counters["neighbours"] = (double)neighbours / cellCount;
+}
+BENCHMARK(BM_ClusteredNeighbourSearch)->ArgNames({ "cells", "adaptive" })->ArgsProduct({ { 1000, 10000, 100000 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 点の配列から1点への距離の2乗(VecBatch::distancesSquared)。paddedが1ならPaddedVec3<double>の配列
+ */
+template <typename V>
+static void distancesSquared(benchmark::State& state)
+{
+    std::vector<V> points(4096);
+    std::mt19937_64 engine(0);
+    std::uniform_real_distribution<double> dist(0.0, 100.0);
+    for (auto& p : points) {
+        p = Vec3(dist(engine), dist(engine), dist(engine));
+    }
+
+    std::vector<double> dist2(points.size());
+    for (auto _ : state) {
+        VecBatch::distancesSquared(std::span<const V>(points), Vec3(50, 50, 50), std::span(dist2));
+        benchmark::DoNotOptimize(dist2.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+static void BM_VecDistances(benchmark::State& state)
+{
+    if (state.range(0) != 0) {
+        distancesSquared<PaddedVec3<double>>(state);
+    } else {
+        distancesSquared<Vec3>(state);
+    }
+}
+BENCHMARK(BM_VecDistances)->ArgName("padded")->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 全細胞についてcalcCellCellForceを計算する(1スレッド)
+ */
+static void BM_CellCellForce(benchmark::State& state)
+{
+    auto sim = makeSimulation(state.range(0), state.range(1), 16);
+    // UserSimulationではprivateなので、Simulationの仮想関数として呼ぶ
+    const Simulation& base = *sim;
+
+    CounterProbe probe;
+    for (auto _ : state) {
+        for (auto& cell : sim->cells) {
+            Vec3 force = base.calcCellCellForce(cell);
+            benchmark::DoNotOptimize(force);
+        }
+    }
+    probe.finish(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_CellCellForce)->Apply(cellArgs)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief e^(-x)をremote_force.expの各方法で計算する。xは近傍の細胞の距離/λの範囲(0〜search_radius/λ)
+ */
+static void BM_RemoteExp(benchmark::State& state)
+{
+    const double range = 64.0 / 30.0;
+    const FastExp exp((ExpMethod)state.range(0), range);
+
+    std::vector<double> xs(4096);
+    std::mt19937_64 engine(0);
+    std::uniform_real_distribution<double> dist(0.0, range);
+    for (auto& x : xs) {
+        x = dist(engine);
+    }
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (double x : xs) {
+            sum += exp(x);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * xs.size());
+    state.counters["maxRelError"] = exp.maxRelativeError();
+}
+BENCHMARK(BM_RemoteExp)->ArgName("method")->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief remote_force.expの各方法でcalcCellCellForceを計算する(1スレッド、1万細胞)
+ */
+static void BM_CellCellForceExp(benchmark::State& state)
+{
+    auto sim               = makeSimulation(10000, 40, 16);
+    sim->remoteExp         = FastExp((ExpMethod)state.range(0), SimulationSettings::SEARCH_RADIUS / SimulationSettings::REMOTE_FORCE_LAMBDA);
+    const Simulation& base = *sim;
+
+    for (auto _ : state) {
+        for (auto& cell : sim->cells) {
+            Vec3 force = base.calcCellCellForce(cell);
+            benchmark::DoNotOptimize(force);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sim->cells.size());
+}
+BENCHMARK(BM_CellCellForceExp)->ArgName("method")->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 種類の混ざった細胞についてcalcCellCellForceを計算する(1スレッド)
+ * @details 細胞の種類をWORKERからENEMYまで順に割り当て、すべての組が遠隔力と体積排除で作用する表を使う。
+ *          BM_CellCellForce(WORKERだけ)と比べ、種類が混ざっても1細胞あたりの時間が変わらないことを確かめる。
+ */
+static void BM_MixedTypeForce(benchmark::State& state)
+{
+    auto sim               = makeSimulation(state.range(0), state.range(1), 16, true);
+    const Simulation& base = *sim;
+
+    InteractionMatrix matrix;
+    const int32_t typeNum = InteractionMatrix::cellTypeNum();
+    for (int32_t r = 1; r < typeNum; r++) {
+        for (int32_t s = 1; s < typeNum; s++) {
+            InteractionMatrix::Interaction interaction;
+            interaction.remoteCoefficient = (r == s) ? 1.0 : 0.5;
+            interaction.enabled           = true;
+            matrix.set((CellType)r, (CellType)s, interaction);
+        }
+    }
+    SimulationSettings::INTERACTION_MATRIX = matrix;
+
+    CounterProbe probe;
+    for (auto _ : state) {
+        for (auto& cell : sim->cells) {
+            Vec3 force = base.calcCellCellForce(cell);
+            benchmark::DoNotOptimize(force);
+        }
+    }
+    probe.finish(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_MixedTypeForce)->Apply(cellArgs)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 分子の格子の差分計算(拡散の5点ステンシル + 分解)と更新。細胞は置かない
+ */
+static void BM_MoleculeStencil(benchmark::State& state)
+{
+    auto sim    = makeSimulation(0, 10, state.range(0));
+    auto& space = sim->moleculeSpaces[0];
+
+    CounterProbe probe;
+    for (auto _ : state) {
+        space->calcConcentrationDiff();
+        space->nextStep();
+    }
+    probe.finish(state, state.range(0) * state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_MoleculeStencil)->ArgName("grid")->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 細胞から分子の格子への放出。格子を小さくして、ステンシルの時間がほぼ無視できるようにする
+ */
+static void BM_EmissionScatter(benchmark::State& state)
+{
+    auto sim    = makeSimulation(state.range(0), 10, 8);
+    auto& space = sim->moleculeSpaces[0];
+
+    CounterProbe probe;
+    for (auto _ : state) {
+        space->calcConcentrationDiff();
+    }
+    probe.finish(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EmissionScatter)->ArgName("cells")->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 全細胞を1回ずつ分裂させ、娘細胞を登録する
+ * @details 分裂は親の細胞と細胞の配列の管理(IDと添字の表)を書き換えるので、反復ごとに計測を止めてシミュレーションを作り直す。
+ */
+static void BM_Division(benchmark::State& state)
+{
+    const int64_t cellCount = state.range(0);
+    std::unique_ptr<BenchSimulation> sim;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        sim = makeSimulation(cellCount, 10, 16);
+        state.ResumeTiming();
+
+        for (int64_t i = 0; i < cellCount; i++) {
+            sim->addCell(std::make_shared<UserCell>(sim->cells[i]->divide()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cellCount);
+}
+BENCHMARK(BM_Division)->ArgName("cells")->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 細胞のスナップショットをバイナリ形式で書き出す(メモリ上)
+ */
+static void BM_SnapshotOutput(benchmark::State& state)
+{
+    const int64_t cellCount = state.range(0);
+    const bool useFloat32   = state.range(1) != 0;
+    auto sim                = makeSimulation(cellCount, 10, 16);
+
+    CellSnapshot snapshot;
+    snapshot.resize(cellCount);
+    for (int64_t i = 0; i < cellCount; i++) {
+        snapshot.id[i]     = sim->cells[i]->id;
+        snapshot.type[i]   = static_cast<uint8_t>(sim->cells[i]->getCellType());
+        snapshot.x[i]      = sim->cells[i]->getPosition().x;
+        snapshot.y[i]      = sim->cells[i]->getPosition().y;
+        snapshot.radius[i] = sim->cells[i]->getRadius();
+    }
+
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::ostringstream os(std::ios::binary);
+        snapshot.writeBinary(os, useFloat32);
+        bytes = os.tellp();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["fileBytes"] = bytes;
+}
+BENCHMARK(BM_SnapshotOutput)->ArgNames({ "cells", "float32" })->ArgsProduct({ { 1000, 100000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 1ステップ進めたあとの接触から、スナップショットのクラスタを求める
+ */
+static void BM_ClusterLabel(benchmark::State& state)
+{
+    auto sim = makeSimulation(state.range(0), state.range(1), 16);
+    sim->nextStep();
+
+    const ContactGraph& graph = sim->getContactGraph();
+    CellSnapshot snapshot;
+    snapshot.resize(graph.rowCount());
+    for (int32_t i = 0; i < graph.rowCount(); i++) {
+        snapshot.id[i] = sim->cells[i]->id;
+    }
+    snapshot.contactOffset = graph.getOffsets();
+    snapshot.contactId     = graph.getContacts();
+
+    int32_t clusters = 0;
+    for (auto _ : state) {
+        clusters = ClusterAnalysis::label(snapshot).clusterCount;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["clusters"] = clusters;
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_ClusterLabel)->Apply(cellArgs)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief 分子の格子をバイナリ形式で書き出す(圧縮の方法ごと)
+ */
+static void BM_GridOutput(benchmark::State& state)
+{
+    const int64_t gridLen             = state.range(0);
+    const CompressionMode compression = static_cast<CompressionMode>(state.range(1));
+
+    // 拡散が進んだ状態に近い、なめらかな格子を作る
+    MoleculeGrid grid{ (uint32_t)gridLen, (uint32_t)gridLen, 1, {} };
+    grid.values.resize(grid.valueCount());
+    for (size_t i = 0; i < grid.values.size(); i++) {
+        grid.values[i] = std::sin(i * 0.001) * 100.0;
+    }
+
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::ostringstream os(std::ios::binary);
+        grid.writeBinary(os, false, compression, 1e-6);
+        bytes = os.tellp();
+    }
+    state.SetBytesProcessed(state.iterations() * grid.values.size() * sizeof(double));
+    state.counters["ratio"] = (double)(grid.values.size() * sizeof(double)) / bytes;
+}
+BENCHMARK(BM_GridOutput)
+    ->ArgNames({ "grid", "mode" })
+    ->ArgsProduct({ { 64, 512 }, { (int64_t)CompressionMode::NONE, (int64_t)CompressionMode::LOSSLESS, (int64_t)CompressionMode::LOSSY } })
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Simulation::nextStep全体(CellListの構築、力の計算、分子の更新、位置の更新)
+ */
+static void BM_NextStep(benchmark::State& state)
+{
+    auto sim = makeSimulation(state.range(0), state.range(1), 64);
+
+    for (auto _ : state) {
+        sim->nextStep();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    setDensityCounter(state, state.range(0));
+}
+BENCHMARK(BM_NextStep)->Apply(cellArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -21,14 +21,17 @@ class UserCell : public Cell
     double divisionGauge = 0; //!< 細胞の分裂周期のゲージ。divisionTimeを超えたら分裂する。
     double dieGauge      = 0; //!< 細胞の死滅周期のゲージ。dieTimeを超えたら死滅する。
 
-    static std::mt19937 randomEngine;
-    static std::exponential_distribution<> divisionDist;
-    static std::exponential_distribution<> dieDist;
+    static constexpr double DIVISION_RATE = 1.0 / 130.0; //!< 分裂周期の指数分布のパラメータ(平均130)
+    static constexpr double DIE_RATE      = 1.0 / 150.0; //!< 死滅周期の指数分布のパラメータ(平均150)
 
   public:
     UserCell();
     UserCell(CellType _typeID, double x, double y, double radius = 5.0, double vx = 0, double vy = 0);
     UserCell(CellType _typeID, Vec3 pos, double radius = 5.0, Vec3 v = Vec3::zero());
+    UserCell(int32_t _id, CellType _typeID, Vec3 pos, double radius, Vec3 v);
+    explicit UserCell(std::istream& is);
+
+    void writeState(std::ostream& os) const override;
     bool checkWillDivide() const noexcept override;
     bool checkWillDie() const noexcept override;
     void metabolize() noexcept override;
@@ -16,12 +16,15 @@ void UserMoleculeSpace::calcConcentrationDiff() noexcept
     constexpr double hydrolysisCoefficient = 5.4;
 
     // すべての格子について拡散、生成、分解、移流を行う
-    // #pragma omp parallel for
-    for (int32_t x = 1; x <= width; x++) {
-        for (int32_t y = 1; y <= height; y++) {
-            for (int32_t z = 1; z <= depth; z++) {
-                deltaMoleculeSpace[x][y][z] = diffuse(x, y, z);
-                deltaMoleculeSpace[x][y][z] += -hydrolysisCoefficient * moleculeSpace[x][y][z];
+    {
+        ProfileScope scope("diffusion");
+        // #pragma omp parallel for
+        for (int32_t x = 1; x <= width; x++) {
+            for (int32_t y = 1; y <= height; y++) {
+                for (int32_t z = 1; z <= depth; z++) {
+                    // doubleで計算してから格子に入れる
+                    deltaMoleculeSpace[x][y][z] = diffuse(x, y, z) - hydrolysisCoefficient * moleculeSpace[x][y][z];
+                }
             }
         }
     }
@@ -32,6 +35,7 @@ void UserMoleculeSpace::calcConcentrationDiff() noexcept
     const int32_t height = SimulationSettings::FIELD_Y_LEN;
     const int32_t depth  = SimulationSettings::FIELD_Z_LEN;
 
+    ProfileScope scope("emission");
     // #pragma omp parallel for
     for (u_int32_t i = 0; i < cells.size(); i++) {
         std::shared_ptr<UserCell>& cell = cells[i];
@@ -47,6 +51,7 @@ void UserMoleculeSpace::calcConcentrationDiff() noexcept
 
 void UserMoleculeSpace::nextStep() noexcept
 {
+    ProfileScope scope("update");
     // #pragma omp parallel for
     for (int x = 1; x <= width; x++) {
         for (int y = 1; y <= height; y++) {
@@ -50,13 +50,17 @@ void UserSimulation::stepPreprocess() noexcept
         cells[i]->initForce();
     }
 
-    for (int i = 0; i < preCellCount; i++) {
-        if (cells[i]->getCellType() == CellType::DEAD || cells[i]->getCellType() == CellType::NONE) {
-            continue;
+    {
+        ProfileScope scope("metabolism");
+        for (int i = 0; i < preCellCount; i++) {
+            if (cells[i]->getCellType() == CellType::DEAD || cells[i]->getCellType() == CellType::NONE) {
+                continue;
+            }
+            cells[i]->metabolize();
         }
-        cells[i]->metabolize();
     }
 
+    ProfileScope scope("division");
     for (int i = 0; i < preCellCount; i++) {
         if (cells[i]->getCellType() == CellType::DEAD || cells[i]->getCellType() == CellType::NONE) {
             continue;
@@ -65,12 +69,8 @@ void UserSimulation::stepPreprocess() noexcept
         if (cells[i]->checkWillDivide()) {
             auto c = std::make_shared<UserCell>(cells[i]->divide());
 
-            // 分裂した場合は配列に新しいCellを上書き(あるいは追加)する。
-            if (c->arrayIndex >= (int32_t)cells.size()) {
-                cells.push_back(c);
-            } else {
-                cells[c->arrayIndex] = c;
-            }
+            // 分裂した場合は空いている場所に新しいCellを上書き(あるいは追加)する。
+            addCell(c);
         }
     }
 }
@@ -84,46 +84,26 @@ void UserSimulation::stepEndProcess() noexcept
 }
 
 /**
- * @brief 細胞間作用の計算。細胞の種類に応じて計算を行う。
+ * @brief 遠隔力を発生させる細胞。config.yamlのinteractionで、どれかの種類に遠隔力を及ぼす種類(既定ではWORKER)。
+ */
+bool UserSimulation::isRemoteForceSource(const std::shared_ptr<UserCell>& c) const noexcept
+{
+    return SimulationSettings::INTERACTION_MATRIX.isRemoteSource(c->getCellType());
+}
+
+/**
+ * @brief 細胞間作用の計算。細胞の種類の組ごとのパラメータ(config.yamlのinteraction)に従って計算する。
+ * @details 既定の表では、WORKERはWORKERから遠隔力を受け、WORKERとDEADはNONE以外の細胞と体積排除・接着で作用する。
+ *          種類ごとの力の式を変えたい場合は、ここで場合分けする。
  *
  * @param c
  * @return Vec3
  */
 Vec3 UserSimulation::calcCellCellForce(std::shared_ptr<UserCell> c) const noexcept
 {
-    auto aroundCells = cellList.aroundCellList(c);
-    Vec3 force       = Vec3::zero();
-
-    switch (c->getCellType()) {
-        case CellType::WORKER:
-            for (auto i : aroundCells) {
-                if (cells[i]->getCellType() == CellType::WORKER) {
-                    force += Simulation::calcRemoteForce(c, cells[i]);
-                }
-            }
-            force = force.normalize();
-
-            for (auto i : aroundCells) {
-                if (cells[i]->getCellType() != CellType::NONE) {
-                    force += Simulation::calcVolumeExclusion(c, cells[i]);
-                }
-            }
-
-            return force.timesScalar(SimulationSettings::DELTA_TIME);
-
-        case CellType::DEAD:
-            for (auto i : aroundCells) {
-                if (cells[i]->getCellType() != CellType::NONE) {
-                    force += Simulation::calcVolumeExclusion(c, cells[i]);
-                }
-            }
-
-            return force.timesScalar(SimulationSettings::DELTA_TIME);
-
-        case CellType::NONE:
-            return Vec3::zero();
-        default:
-            std::cerr << "CellType is Wrong: " << NAMEOF_ENUM(c->getCellType()) << std::endl;
-            exit(1);
+    if (c->getCellType() == CellType::NONE) {
+        return Vec3::zero();
     }
+
+    return Simulation::calcInteractionForce(c, SimulationSettings::INTERACTION_MATRIX).timesScalar(SimulationSettings::DELTA_TIME);
 }
\ No newline at end of file
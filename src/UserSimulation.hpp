@@ -19,6 +19,7 @@ class UserSimulation : public Simulation
 {
   private:
     Vec3 calcCellCellForce(std::shared_ptr<UserCell> c) const noexcept override;
+    bool isRemoteForceSource(const std::shared_ptr<UserCell>& c) const noexcept override;
     void stepPreprocess() noexcept override;
     void stepEndProcess() noexcept override;
 
@@ -12,9 +12,17 @@
 #include "UserSimulation.hpp"
 #include "core/Simulation.hpp"
 
-int main(void)
+/**
+ * @brief 引数で設定ファイルのパスを指定できる(省略するとsrc/config.yaml)。
+ */
+int main(int argc, char* argv[])
 {
-    bool res = SimulationSettings::init_settings();
+    if (argc > 2) {
+        std::cout << "Usage: " << argv[0] << " [config.yaml]" << std::endl;
+        return -1;
+    }
+
+    bool res = argc == 2 ? SimulationSettings::init_settings(argv[1]) : SimulationSettings::init_settings();
 
     if (!res) {
         std::cout << "Failed to initialize settings." << std::endl;
@@ -24,7 +32,23 @@ int main(void)
     UserSimulation sim;
 
     sim.exportConfig();
-    sim.initCells();
+    if (SimulationSettings::RESTART) {
+        try {
+            sim.loadCheckpoint(SimulationSettings::CHECKPOINT_PATH);
+        } catch (const std::exception& e) {
+            std::cout << "Failed to restore checkpoint: " << e.what() << std::endl;
+            return -1;
+        }
+    } else if (!SimulationSettings::INIT_CELL_FILE.empty()) {
+        try {
+            sim.loadCells(SimulationSettings::INIT_CELL_FILE);
+        } catch (const std::exception& e) {
+            std::cout << "Failed to load initial cells: " << e.what() << std::endl;
+            return -1;
+        }
+    } else {
+        sim.initCells();
+    }
     sim.initDirectories();
 
     int32_t simResult = sim.run();
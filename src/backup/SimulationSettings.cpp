@@ -3,21 +3,37 @@
 /**
  * @brief 設定ファイルからの読み込み
  * @brief 必要に応じてユーザが設定項目を書き足しても良い。
- * @note 設定ファイルのパスはsrc/config.yaml。パースに失敗した場合は例外処理をする。
+ * @note 設定ファイルの既定のパスはsrc/config.yaml。読み込みやパースに失敗した場合はfalseを返す。
  *
+ * @param path 設定ファイルのパス
  * @return true
  * @return false
  */
-bool SimulationSettings::init_settings()
+bool SimulationSettings::init_settings(const std::string& path)
 {
-    std::string path = "src/config.yaml";
-
     try {
         YAML::Node config = YAML::LoadFile(path);
 
         CELL_SEED = config["cell"]["cell_seed"].as<int32_t>();
         CELL_NUM  = config["cell"]["cell_num"].as<int32_t>();
         assert(CELL_NUM >= 0);
+        COMPACTION_THRESHOLD = config["cell"]["compaction_threshold"].as<double>(0.25);
+        assert(0.0 < COMPACTION_THRESHOLD && COMPACTION_THRESHOLD <= 1.0);
+        INIT_CELL_FILE = config["cell"]["init_file"].as<std::string>("");
+
+        std::string cellOrderStr = config["cell"]["order"].as<std::string>("ROW_MAJOR");
+        if (cellOrderStr == "ROW_MAJOR")
+            CELL_ORDER = CellOrder::ROW_MAJOR;
+        else if (cellOrderStr == "MORTON")
+            CELL_ORDER = CellOrder::MORTON;
+        else if (cellOrderStr == "HILBERT")
+            CELL_ORDER = CellOrder::HILBERT;
+        else {
+            std::cerr << "Invalid cell order: " << cellOrderStr << std::endl;
+            return false;
+        }
+        REORDER_INTERVAL = config["cell"]["reorder_interval"].as<int32_t>(0);
+        assert(REORDER_INTERVAL >= 0);
 
         std::string postionUpdateMethodStr = config["cell"]["position_update_method"].as<std::string>();
         if (postionUpdateMethodStr == "AB4")
@@ -70,7 +86,125 @@ bool SimulationSettings::init_settings()
         SEARCH_RADIUS = config["cell_list"]["search_radius"].as<int32_t>();
         assert(SEARCH_RADIUS >= 0);
 
-    } catch (YAML::ParserException& e) {
+        std::string cellListTypeStr = config["cell_list"]["type"].as<std::string>("UNIFORM");
+        if (cellListTypeStr == "UNIFORM")
+            CELL_LIST_TYPE = CellListType::UNIFORM;
+        else if (cellListTypeStr == "ADAPTIVE")
+            CELL_LIST_TYPE = CellListType::ADAPTIVE;
+        else {
+            std::cerr << "Invalid cell_list.type: " << cellListTypeStr << std::endl;
+            return false;
+        }
+        CELL_LIST_INCREMENTAL   = config["cell_list"]["incremental"].as<bool>(false);
+        CELL_LIST_PERIODIC      = config["cell_list"]["periodic"].as<bool>(false);
+        if (CELL_LIST_PERIODIC && CELL_LIST_TYPE == CellListType::ADAPTIVE) {
+            std::cerr << "Invalid cell_list.periodic: ADAPTIVE does not support periodic boundaries" << std::endl;
+            return false;
+        }
+        if (CELL_LIST_PERIODIC && (2 * SEARCH_RADIUS >= FIELD_X_LEN || 2 * SEARCH_RADIUS >= FIELD_Y_LEN || (FIELD_Z_LEN > 0 && 2 * SEARCH_RADIUS >= FIELD_Z_LEN))) {
+            std::cerr << "Invalid cell_list.periodic: search_radius must be less than half of the field length" << std::endl;
+            return false;
+        }
+        ADAPTIVE_BASE_GRID_SIZE = config["cell_list"]["adaptive_base_grid"].as<int32_t>(8);
+        assert(ADAPTIVE_BASE_GRID_SIZE >= 1);
+        ADAPTIVE_BUCKET_CELLS = config["cell_list"]["adaptive_bucket_cells"].as<int32_t>(32);
+        assert(ADAPTIVE_BUCKET_CELLS >= 1);
+
+        std::string outputFormatStr = config["output"]["format"].as<std::string>("TEXT");
+        if (outputFormatStr == "TEXT")
+            OUTPUT_FORMAT = OutputFormat::TEXT;
+        else if (outputFormatStr == "BINARY")
+            OUTPUT_FORMAT = OutputFormat::BINARY;
+        else if (outputFormatStr == "CONTAINER")
+            OUTPUT_FORMAT = OutputFormat::CONTAINER;
+        else {
+            std::cerr << "Invalid output format: " << outputFormatStr << std::endl;
+            return false;
+        }
+        OUTPUT_ENABLED     = config["output"]["enabled"].as<bool>(true);
+        OUTPUT_FLOAT32     = config["output"]["float32"].as<bool>(false);
+        OUTPUT_ASYNC       = config["output"]["async"].as<bool>(true);
+        OUTPUT_QUEUE_DEPTH = config["output"]["async_queue_depth"].as<int32_t>(2);
+        assert(OUTPUT_QUEUE_DEPTH > 0);
+
+        std::string compressionStr = config["output"]["molecule_compression"].as<std::string>("NONE");
+        if (compressionStr == "NONE")
+            MOLECULE_COMPRESSION = CompressionMode::NONE;
+        else if (compressionStr == "LOSSLESS")
+            MOLECULE_COMPRESSION = CompressionMode::LOSSLESS;
+        else if (compressionStr == "LOSSY")
+            MOLECULE_COMPRESSION = CompressionMode::LOSSY;
+        else {
+            std::cerr << "Invalid molecule compression: " << compressionStr << std::endl;
+            return false;
+        }
+        MOLECULE_ERROR_BOUND = config["output"]["molecule_error_bound"].as<double>(1e-6);
+        assert(MOLECULE_COMPRESSION != CompressionMode::LOSSY || MOLECULE_ERROR_BOUND > 0.0);
+
+        CHECKPOINT_INTERVAL = config["checkpoint"]["interval"].as<int32_t>(0);
+        assert(CHECKPOINT_INTERVAL >= 0);
+        CHECKPOINT_PATH = config["checkpoint"]["path"].as<std::string>("./result/checkpoint.mcmc");
+        RESTART         = config["checkpoint"]["restart"].as<bool>(false);
+
+        PROFILE_ENABLED    = config["profile"]["enabled"].as<bool>(false);
+        PROFILE_TRACE_PATH = config["profile"]["trace_path"].as<std::string>("");
+        PROFILE_COUNTERS   = config["profile"]["counters"].as<bool>(false);
+
+        ANALYSIS_CLUSTERS = config["analysis"]["clusters"].as<bool>(false);
+
+        std::string remoteForceMethodStr = config["remote_force"]["method"].as<std::string>("CUTOFF");
+        if (remoteForceMethodStr == "CUTOFF")
+            REMOTE_FORCE_METHOD = RemoteForceMethod::CUTOFF;
+        else if (remoteForceMethodStr == "BARNES_HUT")
+            REMOTE_FORCE_METHOD = RemoteForceMethod::BARNES_HUT;
+        else if (remoteForceMethodStr == "PARTICLE_MESH")
+            REMOTE_FORCE_METHOD = RemoteForceMethod::PARTICLE_MESH;
+        else {
+            std::cerr << "Invalid remote_force.method: " << remoteForceMethodStr << std::endl;
+            return false;
+        }
+        if (CELL_LIST_PERIODIC && REMOTE_FORCE_METHOD != RemoteForceMethod::CUTOFF) {
+            std::cerr << "Invalid cell_list.periodic: remote_force.method " << remoteForceMethodStr << " does not support periodic boundaries (use CUTOFF)" << std::endl;
+            return false;
+        }
+        REMOTE_FORCE_LAMBDA = config["remote_force"]["lambda"].as<double>(30.0);
+        assert(REMOTE_FORCE_LAMBDA > 0.0);
+        BARNES_HUT_THETA = config["remote_force"]["theta"].as<double>(0.5);
+        assert(BARNES_HUT_THETA >= 0.0);
+        REMOTE_FORCE_MAX_DISTANCE = config["remote_force"]["max_distance"].as<double>(0.0);
+        assert(REMOTE_FORCE_MAX_DISTANCE >= 0.0);
+        REMOTE_FORCE_MESH_SPACING = config["remote_force"]["mesh_spacing"].as<double>(4.0);
+        assert(REMOTE_FORCE_MESH_SPACING > 0.0);
+
+        std::string remoteForceExpStr = config["remote_force"]["exp"].as<std::string>("LIBM");
+        if (remoteForceExpStr == "LIBM")
+            REMOTE_FORCE_EXP = ExpMethod::LIBM;
+        else if (remoteForceExpStr == "TABLE")
+            REMOTE_FORCE_EXP = ExpMethod::TABLE;
+        else if (remoteForceExpStr == "POLYNOMIAL")
+            REMOTE_FORCE_EXP = ExpMethod::POLYNOMIAL;
+        else {
+            std::cerr << "Invalid remote_force.exp: " << remoteForceExpStr << std::endl;
+            return false;
+        }
+        REMOTE_FORCE_EXP_TOLERANCE = config["remote_force"]["exp_tolerance"].as<double>(0.0);
+        assert(REMOTE_FORCE_EXP_TOLERANCE >= 0.0);
+
+        if (config["interaction"]) {
+            try {
+                INTERACTION_MATRIX.load(config["interaction"], REMOTE_FORCE_LAMBDA);
+            } catch (std::invalid_argument& e) {
+                std::cerr << "Invalid interaction: " << e.what() << std::endl;
+                return false;
+            }
+        } else {
+            INTERACTION_MATRIX = InteractionMatrix::standard(REMOTE_FORCE_LAMBDA);
+        }
+
+        THREAD_NUM = config["parallel"]["threads"].as<int32_t>(0);
+        assert(THREAD_NUM >= 0);
+
+    } catch (YAML::Exception& e) {
         std::cerr << e.what() << std::endl;
 
         return false;
@@ -86,9 +220,34 @@ void SimulationSettings::printSettings()
     std::cout << "SIM STEP : " << SIM_STEP << std::endl;
     std::cout << "OUTPUT INTERVAL STEP : " << OUTPUT_INTERVAL_STEP << std::endl;
     std::cout << "CELL NUM : " << CELL_NUM << std::endl;
+    std::cout << "COMPACTION THRESHOLD : " << COMPACTION_THRESHOLD << std::endl;
+    std::cout << "INIT CELL FILE : " << INIT_CELL_FILE << std::endl;
+    std::cout << "CELL ORDER : " << NAMEOF_ENUM(CELL_ORDER) << std::endl;
+    std::cout << "REORDER INTERVAL : " << REORDER_INTERVAL << std::endl;
     std::cout << "POSITION UPDATE METHOD : " << NAMEOF_ENUM(POSITION_UPDATE_METHOD) << std::endl;
     std::cout << "GRID SIZE MAGNIFICATION : " << GRID_SIZE_MAGNIFICATION << std::endl;
     std::cout << "SEARCH RADIUS : " << SEARCH_RADIUS << std::endl;
+    std::cout << "CELL LIST TYPE : " << NAMEOF_ENUM(CELL_LIST_TYPE) << std::endl;
+    std::cout << "CELL LIST INCREMENTAL : " << CELL_LIST_INCREMENTAL << std::endl;
+    std::cout << "CELL LIST PERIODIC : " << CELL_LIST_PERIODIC << std::endl;
+    std::cout << "ADAPTIVE BASE GRID SIZE : " << ADAPTIVE_BASE_GRID_SIZE << std::endl;
+    std::cout << "ADAPTIVE BUCKET CELLS : " << ADAPTIVE_BUCKET_CELLS << std::endl;
+    std::cout << "REMOTE FORCE METHOD : " << NAMEOF_ENUM(REMOTE_FORCE_METHOD) << std::endl;
+    std::cout << "REMOTE FORCE LAMBDA : " << REMOTE_FORCE_LAMBDA << std::endl;
+    std::cout << "BARNES HUT THETA : " << BARNES_HUT_THETA << std::endl;
+    std::cout << "REMOTE FORCE MAX DISTANCE : " << REMOTE_FORCE_MAX_DISTANCE << std::endl;
+    std::cout << "REMOTE FORCE MESH SPACING : " << REMOTE_FORCE_MESH_SPACING << std::endl;
+    std::cout << "REMOTE FORCE EXP : " << NAMEOF_ENUM(REMOTE_FORCE_EXP) << std::endl;
+    std::cout << "REMOTE FORCE EXP TOLERANCE : " << REMOTE_FORCE_EXP_TOLERANCE << std::endl;
+    for (int32_t r = 0; r < InteractionMatrix::cellTypeNum(); r++) {
+        for (int32_t s = 0; s < InteractionMatrix::cellTypeNum(); s++) {
+            const auto& interaction = INTERACTION_MATRIX.get((CellType)r, (CellType)s);
+            if (interaction.enabled) {
+                std::cout << "INTERACTION " << NAMEOF_ENUM((CellType)r) << " <- " << NAMEOF_ENUM((CellType)s) << " : remote " << interaction.remoteCoefficient
+                          << ", lambda " << interaction.lambda << ", exclusion " << interaction.exclusionBias << ", adhesion " << interaction.adhesionBias << std::endl;
+            }
+        }
+    }
     std::cout << "FIELD X LEN : " << FIELD_X_LEN << std::endl;
     std::cout << "FIELD Y LEN : " << FIELD_Y_LEN << std::endl;
     std::cout << "FIELD Z LEN : " << FIELD_Z_LEN << std::endl;
@@ -101,6 +260,21 @@ void SimulationSettings::printSettings()
     std::cout << "MOLECULE FIELD X LEN : " << MOLECULE_FIELD_X_LEN << std::endl;
     std::cout << "MOLECULE FIELD Y LEN : " << MOLECULE_FIELD_Y_LEN << std::endl;
     std::cout << "MOLECULE FIELD Z LEN : " << MOLECULE_FIELD_Z_LEN << std::endl;
+    std::cout << "OUTPUT FORMAT : " << NAMEOF_ENUM(OUTPUT_FORMAT) << std::endl;
+    std::cout << "OUTPUT ENABLED : " << OUTPUT_ENABLED << std::endl;
+    std::cout << "OUTPUT FLOAT32 : " << OUTPUT_FLOAT32 << std::endl;
+    std::cout << "OUTPUT ASYNC : " << OUTPUT_ASYNC << std::endl;
+    std::cout << "OUTPUT QUEUE DEPTH : " << OUTPUT_QUEUE_DEPTH << std::endl;
+    std::cout << "MOLECULE COMPRESSION : " << NAMEOF_ENUM(MOLECULE_COMPRESSION) << std::endl;
+    std::cout << "MOLECULE ERROR BOUND : " << MOLECULE_ERROR_BOUND << std::endl;
+    std::cout << "CHECKPOINT INTERVAL : " << CHECKPOINT_INTERVAL << std::endl;
+    std::cout << "CHECKPOINT PATH : " << CHECKPOINT_PATH << std::endl;
+    std::cout << "RESTART : " << RESTART << std::endl;
+    std::cout << "PROFILE ENABLED : " << PROFILE_ENABLED << std::endl;
+    std::cout << "PROFILE TRACE PATH : " << PROFILE_TRACE_PATH << std::endl;
+    std::cout << "PROFILE COUNTERS : " << PROFILE_COUNTERS << std::endl;
+    std::cout << "ANALYSIS CLUSTERS : " << ANALYSIS_CLUSTERS << std::endl;
+    std::cout << "THREAD NUM : " << THREAD_NUM << std::endl;
     std::cout << "DELTA TIME : " << DELTA_TIME << std::endl;
     std::cout << "MOLECULE DELTA TIME : " << MOLECULE_DELTA_TIME << std::endl;
 }
@@ -111,9 +285,26 @@ int32_t SimulationSettings::CELL_SEED                           = 0;
 int32_t SimulationSettings::SIM_STEP                            = 0;
 int32_t SimulationSettings::OUTPUT_INTERVAL_STEP                = 0;
 int32_t SimulationSettings::CELL_NUM                            = 0;
+double SimulationSettings::COMPACTION_THRESHOLD                 = 0.25;
+std::string SimulationSettings::INIT_CELL_FILE                  = "";
+CellOrder SimulationSettings::CELL_ORDER                        = CellOrder::ROW_MAJOR;
+int32_t SimulationSettings::REORDER_INTERVAL                    = 0;
 PositionUpdateMethod SimulationSettings::POSITION_UPDATE_METHOD = PositionUpdateMethod::AB4;
 int32_t SimulationSettings::GRID_SIZE_MAGNIFICATION             = 0;
 int32_t SimulationSettings::SEARCH_RADIUS                       = 0;
+CellListType SimulationSettings::CELL_LIST_TYPE                 = CellListType::UNIFORM;
+bool SimulationSettings::CELL_LIST_INCREMENTAL                  = false;
+bool SimulationSettings::CELL_LIST_PERIODIC                     = false;
+int32_t SimulationSettings::ADAPTIVE_BASE_GRID_SIZE             = 8;
+int32_t SimulationSettings::ADAPTIVE_BUCKET_CELLS               = 32;
+RemoteForceMethod SimulationSettings::REMOTE_FORCE_METHOD       = RemoteForceMethod::CUTOFF;
+double SimulationSettings::REMOTE_FORCE_LAMBDA                  = 30.0;
+double SimulationSettings::BARNES_HUT_THETA                     = 0.5;
+double SimulationSettings::REMOTE_FORCE_MAX_DISTANCE            = 0.0;
+double SimulationSettings::REMOTE_FORCE_MESH_SPACING            = 4.0;
+ExpMethod SimulationSettings::REMOTE_FORCE_EXP                  = ExpMethod::LIBM;
+double SimulationSettings::REMOTE_FORCE_EXP_TOLERANCE           = 0.0;
+InteractionMatrix SimulationSettings::INTERACTION_MATRIX        = InteractionMatrix::standard(30.0);
 int32_t SimulationSettings::FIELD_X_LEN                         = 0;
 int32_t SimulationSettings::FIELD_Y_LEN                         = 0;
 int32_t SimulationSettings::FIELD_Z_LEN                         = 0;
@@ -122,5 +313,20 @@ int32_t SimulationSettings::MOLECULE_TYPE_NUM                   = 0;
 int32_t SimulationSettings::MOLECULE_FIELD_X_LEN                = 0;
 int32_t SimulationSettings::MOLECULE_FIELD_Y_LEN                = 0;
 int32_t SimulationSettings::MOLECULE_FIELD_Z_LEN                = 0;
+OutputFormat SimulationSettings::OUTPUT_FORMAT                  = OutputFormat::BINARY;
+bool SimulationSettings::OUTPUT_ENABLED                         = true;
+bool SimulationSettings::OUTPUT_FLOAT32                         = false;
+bool SimulationSettings::OUTPUT_ASYNC                           = true;
+int32_t SimulationSettings::OUTPUT_QUEUE_DEPTH                  = 2;
+CompressionMode SimulationSettings::MOLECULE_COMPRESSION        = CompressionMode::NONE;
+double SimulationSettings::MOLECULE_ERROR_BOUND                 = 1e-6;
+int32_t SimulationSettings::CHECKPOINT_INTERVAL                 = 0;
+std::string SimulationSettings::CHECKPOINT_PATH                 = "./result/checkpoint.mcmc";
+bool SimulationSettings::RESTART                                = false;
+bool SimulationSettings::PROFILE_ENABLED                        = false;
+std::string SimulationSettings::PROFILE_TRACE_PATH              = "";
+bool SimulationSettings::PROFILE_COUNTERS                       = false;
+bool SimulationSettings::ANALYSIS_CLUSTERS                      = false;
+int32_t SimulationSettings::THREAD_NUM                          = 0;
 double SimulationSettings::DELTA_TIME                           = 0.0;
 double SimulationSettings::MOLECULE_DELTA_TIME                  = 0.0;
@@ -11,7 +11,10 @@
 
 #pragma once
 
+#include "core/InteractionMatrix.hpp"
 #include "thirdparty/nameof.hpp"
+#include "utils/FastMath.hpp"
+#include "utils/FieldCodec.hpp"
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -28,12 +31,39 @@ enum class PositionUpdateMethod
     EULER,
 };
 
+enum class OutputFormat
+{
+    TEXT,      // タブ区切りのテキスト
+    BINARY,    // CellSnapshotのバイナリ形式
+    CONTAINER, // すべての出力を1つのファイル(TimeSeriesFile)にまとめる
+};
+
+enum class CellOrder
+{
+    ROW_MAJOR, // CellListのグリッドの行優先の順
+    MORTON,    // グリッド座標のMorton番号の順
+    HILBERT,   // グリッド座標のHilbert番号の順
+};
+
+enum class CellListType
+{
+    UNIFORM,  // 一辺GRID_SIZE_MAGNIFICATIONの一様なグリッド(CellList)
+    ADAPTIVE, // 細胞の多い領域ほど細かく分けるグリッド(VariableRatioCellList)
+};
+
+enum class RemoteForceMethod
+{
+    CUTOFF,        // CellListでSEARCH_RADIUS内の細胞だけを足す
+    BARNES_HUT,    // Barnes-Hut法の木ですべての細胞を近似して足す
+    PARTICLE_MESH, // 重みを格子に割り振り、核との畳み込みをFFTで求めて勾配を補間する
+};
+
 class SimulationSettings
 {
   public:
     SimulationSettings();
     ~SimulationSettings();
-    static bool init_settings();
+    static bool init_settings(const std::string& path = "src/config.yaml");
     static void printSettings();
 
     // 入力値チェックのため、u_intではなくintを使う
@@ -44,10 +74,28 @@ class SimulationSettings
     static int32_t OUTPUT_INTERVAL_STEP; //!< シミュレーション結果を出力するステップ間隔。
 
     static int32_t CELL_NUM;                            //!< シミュレーションで生成するCell数
+    static double COMPACTION_THRESHOLD;                 //!< 消滅した細胞(NONE)の割合がこの値を超えたら細胞の配列を詰め直す。
+    static std::string INIT_CELL_FILE;                  //!< 空でなければ、細胞の初期状態をこのファイルから読み込む(CELL_NUMは使わない)
+    static CellOrder CELL_ORDER;                        //!< コンパクションと並べ替えのときの細胞の並び順
+    static int32_t REORDER_INTERVAL;                    //!< 細胞の配列をCELL_ORDERの順に並べ替えるステップ間隔。0なら並べ替えない(コンパクションのときだけ並ぶ)
     static PositionUpdateMethod POSITION_UPDATE_METHOD; //!< 細胞位置の更新方法(陽オイラー法やAdams-Bashforth法など)
 
     static int32_t GRID_SIZE_MAGNIFICATION; //!< CellListで使用するグリッドサイズの倍率。最小は1、値は2^nである必要がある。
     static int32_t SEARCH_RADIUS;           //!< この半径内(positionの差)にあるcellを力の計算の対象とする。
+    static CellListType CELL_LIST_TYPE;     //!< 近傍の細胞を探すグリッドの種類
+    static bool CELL_LIST_INCREMENTAL;      //!< UNIFORMのとき、グリッドをまたいだ細胞だけをCellListに入れ直す
+    static bool CELL_LIST_PERIODIC;         //!< 近傍の細胞をフィールドの反対側の端からも探す(周期境界)
+    static int32_t ADAPTIVE_BASE_GRID_SIZE; //!< ADAPTIVEのときの最も細かいグリッドの一辺
+    static int32_t ADAPTIVE_BUCKET_CELLS;   //!< ADAPTIVEのとき、グリッド内の細胞数がこれを超えたら4つに分ける
+
+    static RemoteForceMethod REMOTE_FORCE_METHOD; //!< 遠隔力の計算方法
+    static double REMOTE_FORCE_LAMBDA;            //!< 遠隔力の減衰距離(e^(-d/λ)のλ)
+    static double BARNES_HUT_THETA;               //!< Barnes-Hut法の開き角。小さいほど正確で遅い。0なら近似しない
+    static double REMOTE_FORCE_MAX_DISTANCE;      //!< BARNES_HUTのとき、これより遠い細胞の遠隔力を無視する。0なら無視しない
+    static double REMOTE_FORCE_MESH_SPACING;      //!< PARTICLE_MESHの格子の間隔
+    static ExpMethod REMOTE_FORCE_EXP;            //!< 遠隔力のe^(-d/λ)の計算方法
+    static double REMOTE_FORCE_EXP_TOLERANCE;     //!< REMOTE_FORCE_EXPの相対誤差の上限。超えたら開始しない。0なら確かめない
+    static InteractionMatrix INTERACTION_MATRIX;  //!< 細胞の種類の組ごとの相互作用のパラメータ
 
     static int32_t FIELD_X_LEN; //!< シミュレーションをおこなうフィールドのx方向の辺の長さ。長さは2のn乗とする。
     static int32_t FIELD_Y_LEN; //!< シミュレーションをおこなうフィールドのy方向の辺の長さ。長さは2のn乗とする。
@@ -60,6 +108,27 @@ class SimulationSettings
     static int32_t MOLECULE_FIELD_Y_LEN; //!< 分子のフィールドのy方向の辺の長さ。長さは2のn乗とする。
     static int32_t MOLECULE_FIELD_Z_LEN; //!< 分子のフィールドのz方向の辺の長さ。長さは2のn乗とする。
 
+    static OutputFormat OUTPUT_FORMAT; //!< 細胞の状態の出力形式
+    static bool OUTPUT_ENABLED;        //!< falseなら結果を出力しない(ベンチマーク用)
+    static bool OUTPUT_FLOAT32;        //!< バイナリ出力のとき、実数をfloat32に落として書き出すかどうか
+    static bool OUTPUT_ASYNC;          //!< 結果の書き出しを別スレッドで行うかどうか
+    static int32_t OUTPUT_QUEUE_DEPTH; //!< 書き出し待ちにできる出力の数。これを超えるとシミュレーションが書き出しを待つ
+
+    static CompressionMode MOLECULE_COMPRESSION; //!< バイナリ出力のときの分子の格子の圧縮方法
+    static double MOLECULE_ERROR_BOUND;          //!< MOLECULE_COMPRESSIONがLOSSYのときの誤差の上限
+
+    static int32_t CHECKPOINT_INTERVAL; //!< チェックポイントを書き出すステップ間隔。0なら書き出さない
+    static std::string CHECKPOINT_PATH; //!< チェックポイントの出力先(再開時の読み込み元)
+    static bool RESTART;                //!< trueならCHECKPOINT_PATHから状態を読み込んでシミュレーションを再開する
+
+    static bool PROFILE_ENABLED;           //!< trueなら各処理の時間を計測し、終了時に表を出力する
+    static std::string PROFILE_TRACE_PATH; //!< 空でなければ、計測した区間をChromeのトレース形式でここに書き出す
+    static bool PROFILE_COUNTERS;          //!< trueならハードウェアカウンタ(サイクル数、命令数、LLCミスなど)も処理ごとに集計する
+
+    static bool ANALYSIS_CLUSTERS; //!< trueなら出力のたびに接触でつながった細胞の集団(クラスタ)を求め、./result/clusters.tsvに書き出す
+
+    static int32_t THREAD_NUM; //!< OpenMPのスレッド数。0ならOpenMPの既定値(OMP_NUM_THREADS、なければコア数)
+
     static double DELTA_TIME;          //!< 時間スケール(1が通常時)
     static double MOLECULE_DELTA_TIME; //!< 分子の時間スケール(だいたいDELTA_TIMEより小さい)
 };
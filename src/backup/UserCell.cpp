@@ -1,9 +1,5 @@
 #include "UserCell.hpp"
 
-std::mt19937 UserCell::randomEngine(1231);
-std::exponential_distribution<> UserCell::divisionDist(1.0 / 130.0);
-std::exponential_distribution<> UserCell::dieDist(1.0 / 150.0);
-
 UserCell::UserCell()
   : UserCell(CellType::WORKER, Vec3(0, 0, 0))
 {
@@ -37,8 +33,9 @@ UserCell::UserCell(CellType _typeID, Vec3 pos, double radius, Vec3 v)
   , divisionGauge{ 0 }
   , dieGauge{ 0 }
 {
-    divisionTime = divisionDist(randomEngine);
-    dieTime      = dieDist(randomEngine);
+    // 乱数は(シード値, ID, ステップ, 用途)から決まるので、生成順やスレッドに依存しない
+    divisionTime = randomStream(RandomPurpose::DIVISION_TIME).exponential(DIVISION_RATE);
+    dieTime      = randomStream(RandomPurpose::DIE_TIME).exponential(DIE_RATE);
 }
 
 /**
@@ -105,13 +102,13 @@ int32_t UserCell::die() noexcept
 UserCell UserCell::divide() noexcept
 {
     divisionGauge = 0;
-    divisionTime  = divisionDist(randomEngine);
+    divisionTime  = randomStream(RandomPurpose::DIVISION_TIME).exponential(DIVISION_RATE);
 
     // 体積を二分割したときの半径を求める。
     double halfVolumeRadius = this->radius / std::pow(2, 1.0 / 3.0);
 
     Vec3 pos            = this->getPosition();
-    Vec3 childDirection = Vec3::randomDirection2(); // どの方向に分裂するかを決める。分裂元は逆方向に動く。
+    Vec3 childDirection = Vec3::direction2(randomStream(RandomPurpose::DIVISION_DIRECTION).angle()); // どの方向に分裂するかを決める。分裂元は逆方向に動く。
 
     // Cellのtypeはとりあえず継承する形にする。位置はchildDirection方向に半径の半分だけずらす
     UserCell c(this->typeID, this->getPosition() + childDirection.timesScalar(halfVolumeRadius / 2), halfVolumeRadius);
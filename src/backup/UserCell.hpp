@@ -21,9 +21,8 @@ class UserCell : public Cell
     double divisionGauge = 0; //!< 細胞の分裂周期のゲージ。divisionTimeを超えたら分裂する。
     double dieGauge      = 0; //!< 細胞の死滅周期のゲージ。dieTimeを超えたら死滅する。
 
-    static std::mt19937 randomEngine;
-    static std::exponential_distribution<> divisionDist;
-    static std::exponential_distribution<> dieDist;
+    static constexpr double DIVISION_RATE = 1.0 / 130.0; //!< 分裂周期の指数分布のパラメータ(平均130)
+    static constexpr double DIE_RATE      = 1.0 / 150.0; //!< 死滅周期の指数分布のパラメータ(平均150)
 
   public:
     UserCell();
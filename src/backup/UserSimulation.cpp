@@ -65,12 +65,8 @@ void UserSimulation::stepPreprocess() noexcept
         if (cells[i]->checkWillDivide()) {
             auto c = std::make_shared<UserCell>(cells[i]->divide());
 
-            // 分裂した場合は配列に新しいCellを上書き(あるいは追加)する。
-            if (c->arrayIndex >= (int32_t)cells.size()) {
-                cells.push_back(c);
-            } else {
-                cells[c->arrayIndex] = c;
-            }
+            // 分裂した場合は空いている場所に新しいCellを上書き(あるいは追加)する。
+            addCell(c);
         }
     }
 }
@@ -0,0 +1,66 @@
+"""
+SpeedTest(src/SpeedTest.cpp)が書き出したGoogle BenchmarkのJSONを2つ比べる。
+
+    make benchmark                      # benchmark.json ができる
+    cp benchmark.json base.json
+    (変更を加える)
+    make benchmark
+    python3 src/convert_tools/compare_benchmarks.py base.json benchmark.json
+
+ベンチマークごとに時間の比(new / old)を表示する。比がthreshold(既定1.10)を超えたものがあれば終了コード1を返すので、
+遅くなっていないかの確認に使える。
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """ベンチマーク名 -> 1回あたりの時間(ナノ秒)の辞書を返す。繰り返し実行した場合は平均(aggregate)を使う。"""
+    with open(path) as f:
+        data = json.load(f)
+
+    scale = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    times = {}
+    for bench in data['benchmarks']:
+        if bench.get('run_type') == 'aggregate' and bench.get('aggregate_name') != 'mean':
+            continue
+        name = bench.get('run_name', bench['name'])
+        times[name] = bench['real_time'] * scale[bench.get('time_unit', 'ns')]
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description='compare two SpeedTest results')
+    parser.add_argument('old')
+    parser.add_argument('new')
+    parser.add_argument('--threshold', type=float, default=1.10, help='これを超える比を遅くなったとみなす')
+    args = parser.parse_args()
+
+    old = load(args.old)
+    new = load(args.new)
+
+    width = max(len(name) for name in new) if new else 10
+    print(f'{"benchmark":<{width}} {"old[us]":>12} {"new[us]":>12} {"ratio":>8}')
+
+    regressions = 0
+    for name, time in new.items():
+        if name not in old:
+            print(f'{name:<{width}} {"-":>12} {time / 1e3:>12.2f} {"new":>8}')
+            continue
+        ratio = time / old[name]
+        mark = ''
+        if ratio > args.threshold:
+            mark = ' *'
+            regressions += 1
+        print(f'{name:<{width}} {old[name] / 1e3:>12.2f} {time / 1e3:>12.2f} {ratio:>8.3f}{mark}')
+
+    if regressions > 0:
+        print(f'{regressions} benchmark(s) slower than {args.threshold:.2f}x')
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,8 +3,10 @@ import numpy as np
 import glob
 import math
 from visualize_setting import Setting
+from snapshot_reader import is_snapshot, read_snapshot
+from timeseries_reader import TimeSeries
 
-files = sorted(glob.glob('./result/*'))
+CONTAINER_PATH = './result/timeseries.mcmc'
 
 with open('config.txt', 'r') as f:
     img_w_len = int(f.readline())
@@ -18,30 +20,63 @@ time_delta_sec = time_per_file * 60
 
 scale = IMAGE_LEN/img_w_len
 
-for file in files:
-    img = np.full((IMAGE_LEN, IMAGE_LEN, 3), 255, dtype=np.uint8)
-    cv2.circle(img, (IMAGE_LEN//2, IMAGE_LEN//2), IMAGE_LEN//2, (0, 0, 0))
-    cv2.line(img, (0, IMAGE_LEN//2), (IMAGE_LEN, IMAGE_LEN//2), (0, 0, 0))
-    cv2.line(img, (IMAGE_LEN//2, 0), (IMAGE_LEN//2, IMAGE_LEN), (0, 0, 0))
+
+def snapshot_to_cells(snap):
+    """CellSnapshotを{id: (type, x, y, r, contact ids)}に変換する。"""
+    cell_objs = {}
+    c = snap.columns
+    xs = c['x']*scale+IMAGE_LEN/2
+    ys = c['y']*scale+IMAGE_LEN/2
+    rs = c['radius']*scale
+    for i in range(len(snap)):
+        cell_objs[int(c['id'][i])] = (snap.type_name(c['type'][i]), xs[i], ys[i], rs[i],
+                                      [int(j) for j in snap.contacts(i)])
+    return cell_objs
+
+
+def read_cells(file):
+    """テキスト形式とバイナリ形式(CellSnapshot)のどちらも読み、{id: (type, x, y, r, contact ids)}を返す。"""
+    cell_objs = {}
+
+    if is_snapshot(file):
+        return snapshot_to_cells(read_snapshot(file))
 
     with open(file, 'r') as f:
         cells = f.read().split('\n')
 
     # cell[id, typeID, x, y, z, vx, vy, vz, r, contact num, contact id...]
-
-    cell_objs = []
-
     for cell in cells[1:-1]:
         cell = cell.split('\t')
-        cell_type = cell[1]
         x = float(cell[2])*scale+IMAGE_LEN/2
         y = float(cell[3])*scale+IMAGE_LEN/2
-        z = float(cell[4])*scale+IMAGE_LEN/2
         r = float(cell[8])*scale
-        adhere_cells_str = cell[10]
+        adhere_ids = [int(i) for i in cell[10].split(',') if i not in ('', '_')] if len(cell) > 10 else []
 
-        cell_objs.append((cell_type, x, y, r, adhere_cells_str))
+        cell_objs[int(cell[0])] = (cell[1], x, y, r, adhere_ids)
+
+    return cell_objs
+
+
+def frames():
+    """(出力番号, {id: (type, x, y, r, contact ids)})を出力番号の順に返す。"""
+    if glob.glob(CONTAINER_PATH):
+        with TimeSeries(CONTAINER_PATH) as ts:
+            for step in ts.steps():
+                yield step, snapshot_to_cells(ts.cells(step))
+        return
+
+    for file in sorted(glob.glob('./result/cells_*')):
+        yield int(file.split('_')[-1]), read_cells(file)
+
+
+for step, cell_objs in frames():
+    img = np.full((IMAGE_LEN, IMAGE_LEN, 3), 255, dtype=np.uint8)
+    cv2.circle(img, (IMAGE_LEN//2, IMAGE_LEN//2), IMAGE_LEN//2, (0, 0, 0))
+    cv2.line(img, (0, IMAGE_LEN//2), (IMAGE_LEN, IMAGE_LEN//2), (0, 0, 0))
+    cv2.line(img, (IMAGE_LEN//2, 0), (IMAGE_LEN//2, IMAGE_LEN), (0, 0, 0))
 
+    # cell_obj[typeID, x, y, r, contact id list]
+    for cell_type, x, y, r, _ in cell_objs.values():
         if x < 0 or x > IMAGE_LEN or y < 0 or y > IMAGE_LEN:
             print('out of range')
 
@@ -55,12 +90,10 @@ for file in files:
         cv2.circle(img, (math.floor(x), math.floor(y)),
                    math.floor(r), cell_color, thickness=1)
 
-    for cell_obj in cell_objs:
-        adhere_list = cell_obj[4].split(',')
-        for adhere_id in adhere_list:
-            if adhere_id == '_':
+    for cell_obj in cell_objs.values():
+        for adhere_id in cell_obj[4]:
+            if adhere_id not in cell_objs:
                 continue
-            adhere_id = int(adhere_id)
             adhere_obj = cell_objs[adhere_id]
             x1 = cell_obj[1]
             y1 = cell_obj[2]
@@ -69,9 +102,9 @@ for file in files:
             cv2.line(img, (math.floor(x1), math.floor(y1)),
                      (math.floor(x2), math.floor(y2)), (0, 0, 255), thickness=1)
 
-    cv2.imwrite(f'./image/cells_{file[-5:]}.png', img)
+    cv2.imwrite(f'./image/cells_{step:05d}.png', img)
 
-    print(file)
+    print(step)
 
 
 exit()
@@ -0,0 +1,144 @@
+"""
+MoleculeGrid(src/core/MoleculeGrid.hpp)とFieldCodec(src/utils/FieldCodec.hpp)の形式を読むためのモジュール。
+
+    from field_codec import read_grid
+    grid = read_grid('./molecule_result/0/molecule_0000')   # 境界を含む (x, y, z) の numpy 配列
+
+lz4パッケージ(pip install lz4)があればそれで展開し、なければPythonで展開する(遅い)。
+"""
+
+import struct
+
+import numpy as np
+
+try:
+    import lz4.block as _lz4_block
+except ImportError:
+    _lz4_block = None
+
+GRID_MAGIC = b'MCMCGRID'
+GRID_SUPPORTED_VERSION = 1
+FLAG_FLOAT32 = 1 << 0
+FLAG_COMPRESSED = 1 << 1
+
+MODE_LOSSLESS = 1
+MODE_LOSSY = 2
+
+CODEC_HEADER = struct.Struct('<B3xIdQI')
+BLOCK_ENTRY = struct.Struct('<B3xI')
+
+
+def lz4_decompress(src, size):
+    """LZ4のブロック形式を展開する。"""
+    if _lz4_block is not None:
+        return _lz4_block.decompress(bytes(src), uncompressed_size=size)
+
+    dst = bytearray()
+    ip = 0
+    end = len(src)
+    while ip < end:
+        token = src[ip]
+        ip += 1
+
+        literal_len = token >> 4
+        if literal_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                literal_len += b
+                if b != 255:
+                    break
+        dst += src[ip:ip + literal_len]
+        ip += literal_len
+        if ip >= end:
+            break
+
+        offset = src[ip] | (src[ip + 1] << 8)
+        ip += 2
+        match_len = (token & 15) + 4
+        if (token & 15) == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                match_len += b
+                if b != 255:
+                    break
+
+        start = len(dst) - offset
+        if offset >= match_len:
+            dst += dst[start:start + match_len]
+        else:
+            # 自分自身と重なる一致は周期offsetの繰り返しになる
+            pattern = dst[start:]
+            dst += (pattern * (match_len // offset + 1))[:match_len]
+
+    if len(dst) != size:
+        raise ValueError('lz4 size mismatch')
+    return bytes(dst)
+
+
+def _unshuffle(buf, count, dtype):
+    """FieldCodec::unshuffle と同じ。"""
+    shuffled = np.frombuffer(buf, dtype=np.uint8).reshape(dtype.itemsize, count)
+    return np.ascontiguousarray(shuffled.T).view(dtype).reshape(count)
+
+
+def decode_field(buf, offset=0):
+    """FieldCodec::encode で書き込んだ配列を読み、(float64配列, 次のoffset)を返す。"""
+    mode, block_size, error_bound, count, block_count = CODEC_HEADER.unpack_from(buf, offset)
+    offset += CODEC_HEADER.size
+
+    blocks = []
+    for _ in range(block_count):
+        blocks.append(BLOCK_ENTRY.unpack_from(buf, offset))
+        offset += BLOCK_ENTRY.size
+
+    values = np.empty(count, dtype=np.float64)
+    for b, (block_mode, size) in enumerate(blocks):
+        begin = b * block_size
+        n = min(block_size, count - begin)
+        raw = lz4_decompress(buf[offset:offset + size], n * 8)
+        offset += size
+
+        if block_mode == MODE_LOSSLESS:
+            values[begin:begin + n] = _unshuffle(raw, n, np.dtype('<f8'))
+        elif block_mode == MODE_LOSSY:
+            zz = _unshuffle(raw, n, np.dtype('<u8'))
+            deltas = (zz >> np.uint64(1)).astype(np.int64) ^ -(zz & np.uint64(1)).astype(np.int64)
+            values[begin:begin + n] = np.cumsum(deltas) * (2.0 * error_bound)
+        else:
+            raise ValueError(f'unknown block mode {block_mode}')
+
+    return values, offset
+
+
+def parse_grid(buf, offset=0):
+    """MoleculeGrid::writeBinary で書き込んだ格子を読み、(境界を含む (x, y, z) の配列, 次のoffset)を返す。"""
+    width, height, depth, flags = struct.unpack_from('<IIII', buf, offset)
+    offset += 16
+    shape = (width + 2, height + 2, depth + 2)
+    count = int(np.prod(shape))
+
+    if flags & FLAG_COMPRESSED:
+        values, offset = decode_field(buf, offset)
+    else:
+        dtype = np.dtype('<f4') if flags & FLAG_FLOAT32 else np.dtype('<f8')
+        values = np.frombuffer(buf, dtype=dtype, count=count, offset=offset).astype(np.float64)
+        offset += dtype.itemsize * count
+
+    return values.reshape(shape), offset
+
+
+def read_grid(path):
+    """MoleculeGrid::save で書き込んだファイルを読む。"""
+    with open(path, 'rb') as f:
+        buf = f.read()
+
+    if buf[:8] != GRID_MAGIC:
+        raise ValueError(f'{path} is not a molecule grid')
+    (version,) = struct.unpack_from('<I', buf, 8)
+    if version > GRID_SUPPORTED_VERSION:
+        raise ValueError(f'unsupported molecule grid version {version}')
+
+    grid, _ = parse_grid(buf, 12)
+    return grid
@@ -0,0 +1,142 @@
+"""
+double(SimMain)とfloat(SimMainFloat、make PRECISION=floatと同じ)で状態を保存した場合の結果の差を測るドライバ。
+
+src/config.yamlをもとに、出力をCONTAINER形式(実数はfloat32に落とさない)にした設定ファイルを作り、
+2つのSimMainを同じ設定で実行する。出力したステップごとに次の値を表にする。
+
+- cells: 両方にあるCellの数(IDで対応をとる)と、片方にしかないCellの数
+- max/rms dist: 同じIDのCellの位置の差。フィールドの端をまたいだ場合は近い方の像との差にする
+- molecule rel: 分子の格子の差の最大値 / doubleの格子の絶対値の最大値(分子の種類ごとの最大)
+
+    make precision-check ARGS="--steps 200"
+    python3 src/convert_tools/precision_check.py --double ./SimMain --float ./SimMainFloat --steps 100
+
+--jsonを指定すると表の値を書き出す。--max-distを指定すると、最後のステップの最大の差がそれを超えたときに終了コード1を返す。
+"""
+
+import argparse
+import copy
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+import yaml
+
+from timeseries_reader import TimeSeries
+
+
+def make_config(base, args):
+    config = copy.deepcopy(base)
+    config['simulation']['sim_step'] = args.steps
+    if args.output_interval > 0:
+        config['simulation']['output_interval'] = args.output_interval
+    config['output']['enabled'] = True
+    config['output']['format'] = 'CONTAINER'
+    config['output']['float32'] = False
+    config['output']['molecule_compression'] = 'LOSSLESS'
+    config.setdefault('checkpoint', {})['interval'] = 0
+    config['checkpoint']['restart'] = False
+    config['profile'] = {'enabled': False, 'trace_path': ''}
+    return config
+
+
+def run(simmain, config):
+    """作業ディレクトリでSimMainを実行し、そのディレクトリを返す。"""
+    workdir = tempfile.mkdtemp(prefix='precision_')
+    config_path = os.path.join(workdir, 'config.yaml')
+    with open(config_path, 'w') as f:
+        yaml.safe_dump(config, f, sort_keys=False)
+
+    result = subprocess.run([simmain, config_path], cwd=workdir, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout[-2000:] + result.stderr[-2000:])
+        shutil.rmtree(workdir, ignore_errors=True)
+        raise RuntimeError(f'{simmain} failed')
+    return workdir
+
+
+def nearest_image(diff, length):
+    if length <= 0:
+        return diff
+    return diff - length * np.round(diff / length)
+
+
+def compare_cells(a, b, field_len):
+    ids_a, ids_b = a.columns['id'], b.columns['id']
+    common, ia, ib = np.intersect1d(ids_a, ids_b, return_indices=True)
+    unmatched = len(ids_a) + len(ids_b) - 2 * len(common)
+    if len(common) == 0:
+        return 0, unmatched, 0.0, 0.0
+
+    dist2 = np.zeros(len(common))
+    for axis, length in zip(('x', 'y', 'z'), field_len):
+        d = nearest_image(b.columns[axis][ib].astype(np.float64) - a.columns[axis][ia].astype(np.float64), length)
+        dist2 += d * d
+    dist = np.sqrt(dist2)
+    return len(common), unmatched, float(dist.max()), float(np.sqrt(dist2.mean()))
+
+
+def compare_molecules(ts_a, ts_b, step):
+    worst = 0.0
+    for molecule_type in ts_a.molecule_types():
+        a = ts_a.molecules(step, molecule_type)
+        b = ts_b.molecules(step, molecule_type)
+        scale = np.abs(a).max()
+        if scale > 0:
+            worst = max(worst, float(np.abs(b - a).max() / scale))
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description='trajectory divergence between double and float storage')
+    parser.add_argument('--double', default='./SimMain', help='doubleで保存するSimMain')
+    parser.add_argument('--float', default='./SimMainFloat', help='floatで保存するSimMain')
+    parser.add_argument('--config', default='./src/config.yaml', help='もとにする設定ファイル')
+    parser.add_argument('--steps', type=int, default=100, help='シミュレーションのステップ数')
+    parser.add_argument('--output-interval', type=int, default=0, help='比べるステップの間隔。0なら設定ファイルのまま')
+    parser.add_argument('--max-dist', type=float, default=0.0, help='最後のステップの位置の差の許容値。0なら確かめない')
+    parser.add_argument('--json', help='結果の出力先')
+    args = parser.parse_args()
+
+    with open(args.config) as f:
+        config = make_config(yaml.safe_load(f), args)
+    sim = config['simulation']
+    field_len = (sim['field_x_len'], sim['field_y_len'], sim.get('field_z_len', 0))
+
+    dirs = []
+    try:
+        for simmain in (args.double, args.float):
+            dirs.append(run(os.path.abspath(simmain), config))
+
+        rows = []
+        with TimeSeries(os.path.join(dirs[0], 'result', 'timeseries.mcmc')) as ts_a, \
+                TimeSeries(os.path.join(dirs[1], 'result', 'timeseries.mcmc')) as ts_b:
+            for step in ts_a.steps():
+                common, unmatched, max_dist, rms_dist = compare_cells(ts_a.cells(step), ts_b.cells(step), field_len)
+                rows.append({'step': step, 'cells': common, 'unmatched': unmatched, 'max_dist': max_dist, 'rms_dist': rms_dist,
+                             'molecule_rel': compare_molecules(ts_a, ts_b, step)})
+    finally:
+        for d in dirs:
+            shutil.rmtree(d, ignore_errors=True)
+
+    print(f'# double vs float storage (steps={args.steps})\n')
+    print('| output | cells | unmatched | max dist | rms dist | molecule rel |')
+    print('|---|---|---|---|---|---|')
+    for r in rows:
+        print(f'| {r["step"]} | {r["cells"]} | {r["unmatched"]} | {r["max_dist"]:.3e} | {r["rms_dist"]:.3e} | {r["molecule_rel"]:.3e} |')
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({'args': vars(args), 'results': rows}, f, indent=2)
+
+    if args.max_dist > 0 and rows and rows[-1]['max_dist'] > args.max_dist:
+        print(f'max dist {rows[-1]["max_dist"]:.3e} exceeds {args.max_dist:.3e}', file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
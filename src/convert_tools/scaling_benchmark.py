@@ -0,0 +1,201 @@
+"""
+Simulation::run全体のスケーリングを測るドライバ。
+
+src/config.yamlをもとに細胞数・フィールドの大きさ・分子の格子・分子の種類数を変えた設定ファイルを作り、
+出力を止めて(output.enabled: false)、スレッド数(parallel.threads)を変えながらSimMainを実行する。
+各実行のprofile.enabledの表から処理ごとの時間を読み取り、次の2つの表を出す。
+
+- strong scaling: 細胞数を固定してスレッド数を増やす。speedup = T(1) / T(p)、効率 = speedup / p
+- weak scaling: 1スレッドあたりの細胞数を固定し、フィールドの面積も細胞数に比例させる。効率 = T(1) / T(p)
+
+    make SimMain
+    python3 src/convert_tools/scaling_benchmark.py --threads 1,2,4,8 --strong-cells 10000,100000 --weak-cells 10000
+    python3 src/convert_tools/scaling_benchmark.py --strong-cells 1000000,10000000 --weak-cells 0 --steps 5
+
+時間は1ステップあたりのwall時間(各スレッドの合計の最大)[ms]。--jsonを指定すると生の結果も書き出す。
+"""
+
+import argparse
+import copy
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import yaml
+
+MIN_FIELD_LEN = 256
+
+# 表に出す処理(Profilerのパス)。molecule[i]は分子の種類ごとに足し合わせる
+PHASES = [
+    ('step', 'run/step'),
+    ('cellList', 'run/step/nextStep/cellList'),
+    ('force', 'run/step/nextStep/force'),
+    ('molecule', 'run/step/nextStep/molecule'),
+    ('integration', 'run/step/nextStep/integration'),
+    ('preprocess', 'run/step/preprocess'),
+    ('endProcess', 'run/step/endProcess'),
+    ('cellStore', 'run/step/cellStore'),
+]
+
+REPORT_ROW = re.compile(r'^( *)(\S+)\s+(\d+)\s+(\d+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)$')
+
+
+def field_size(cells, density):
+    """density(1万平方単位あたりの細胞数)以下になる、2のべき乗のフィールドの大きさを返す。
+    面積が2倍ずつ増えるので、細胞数を2のべき乗倍にすれば密度は変わらない。"""
+    area = cells * 1e4 / density
+    x = y = MIN_FIELD_LEN
+    while x * y < area:
+        if x <= y:
+            x *= 2
+        else:
+            y *= 2
+    return x, y
+
+
+def make_config(base, cells, threads, args):
+    config = copy.deepcopy(base)
+    x, y = field_size(cells, args.density)
+
+    config['cell']['cell_num'] = cells
+    config['cell']['init_file'] = ''
+    config['simulation']['sim_step'] = args.steps + 1  # ステップ0は初期化なので計測しない
+    config['simulation']['field_x_len'] = x
+    config['simulation']['field_y_len'] = y
+    config['simulation']['field_z_len'] = 0
+    config['molecule']['default_molecule_nums'] = [3000] * args.species
+    config['molecule']['field_x_len'] = args.molecule_grid
+    config['molecule']['field_y_len'] = args.molecule_grid
+    config['molecule']['field_z_len'] = 1
+    config['output']['enabled'] = False
+    config.setdefault('checkpoint', {})['interval'] = 0
+    config['checkpoint']['restart'] = False
+    config['profile'] = {'enabled': True, 'trace_path': ''}
+    config['parallel'] = {'threads': threads}
+    return config
+
+
+def parse_report(stdout):
+    """Profiler::reportの表から、パス -> wall[ms] の辞書を返す。"""
+    times = {}
+    stack = []
+    in_table = False
+    for line in stdout.splitlines():
+        if line.startswith('phase'):
+            in_table = True
+            continue
+        if not in_table:
+            continue
+        m = REPORT_ROW.match(line)
+        if m is None:
+            break
+        depth = len(m.group(1)) // 2
+        stack = stack[:depth] + [m.group(2)]
+        path = '/'.join(stack)
+        path = re.sub(r'molecule\[\d+\]', 'molecule', path)
+        times[path] = times.get(path, 0.0) + float(m.group(6))
+    return times
+
+
+def run_case(simmain, base, cells, threads, args):
+    """設定ファイルを作ってSimMainを実行し、処理ごとの1ステップあたりの時間[ms]を返す。repeat回のうち最小を使う。"""
+    best = None
+    for _ in range(args.repeat):
+        workdir = tempfile.mkdtemp(prefix='scaling_')
+        try:
+            config_path = os.path.join(workdir, 'config.yaml')
+            with open(config_path, 'w') as f:
+                yaml.safe_dump(make_config(base, cells, threads, args), f, sort_keys=False)
+
+            result = subprocess.run([simmain, config_path], cwd=workdir, capture_output=True, text=True)
+            if result.returncode != 0:
+                sys.stderr.write(result.stdout[-2000:] + result.stderr[-2000:])
+                raise RuntimeError(f'SimMain failed (cells={cells}, threads={threads})')
+        finally:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+        report = parse_report(result.stdout)
+        times = {name: report.get(path, 0.0) / args.steps for name, path in PHASES}
+        if best is None or times['step'] < best['step']:
+            best = times
+
+    print(f'  cells={cells:>9} threads={threads:>3} step={best["step"]:10.2f}ms', file=sys.stderr)
+    return best
+
+
+def print_table(title, rows, threads, metric):
+    """rows: [(ラベル, {スレッド数: 処理ごとの時間})]。metric(t1, tp, p)で効率を計算する。"""
+    print(f'\n## {title}\n')
+    header = ['case', 'phase'] + [f'{p} thr [ms]' for p in threads] + [f'eff@{p}' for p in threads[1:]]
+    print('| ' + ' | '.join(header) + ' |')
+    print('|' + '---|' * len(header))
+    for label, results in rows:
+        for name, _ in PHASES:
+            t1 = results[threads[0]][name]
+            cols = [label, name] + [f'{results[p][name]:.3f}' for p in threads]
+            for p in threads[1:]:
+                tp = results[p][name]
+                cols.append(f'{metric(t1, tp, p / threads[0]):.2f}' if t1 > 0 and tp > 0 else '-')
+            print('| ' + ' | '.join(cols) + ' |')
+
+
+def parse_list(text):
+    return [int(v) for v in text.split(',') if v.strip() and int(v) > 0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='strong/weak scaling of Simulation::run')
+    parser.add_argument('--simmain', default='./SimMain')
+    parser.add_argument('--config', default='./src/config.yaml', help='もとにする設定ファイル')
+    parser.add_argument('--threads', default='1,2,4,8', help='カンマ区切りのスレッド数')
+    parser.add_argument('--strong-cells', default='10000,100000', help='strong scalingの細胞数。空なら行わない')
+    parser.add_argument('--weak-cells', type=int, default=10000, help='weak scalingの1スレッドあたりの細胞数。0なら行わない')
+    parser.add_argument('--density', type=float, default=10.0, help='1万平方単位あたりの細胞数')
+    parser.add_argument('--molecule-grid', type=int, default=64, help='分子の格子の一辺')
+    parser.add_argument('--species', type=int, default=1, help='分子の種類数')
+    parser.add_argument('--steps', type=int, default=20, help='計測するステップ数')
+    parser.add_argument('--repeat', type=int, default=1, help='同じ条件で繰り返す回数(最小値を使う)')
+    parser.add_argument('--json', help='生の結果の出力先')
+    args = parser.parse_args()
+
+    simmain = os.path.abspath(args.simmain)
+    with open(args.config) as f:
+        base = yaml.safe_load(f)
+
+    threads = sorted(parse_list(args.threads))
+    if len(threads) == 0:
+        parser.error('--threads is empty')
+
+    print(f'# Scaling (steps={args.steps}, density={args.density}, molecule grid={args.molecule_grid}, species={args.species}, '
+          f'cpus={os.cpu_count()})')
+
+    raw = {'strong': {}, 'weak': {}}
+
+    strong_rows = []
+    for cells in parse_list(args.strong_cells):
+        results = {p: run_case(simmain, base, cells, p, args) for p in threads}
+        strong_rows.append((f'{cells} cells', results))
+        raw['strong'][cells] = results
+    if strong_rows:
+        print_table('Strong scaling (efficiency = T1 / (p * Tp))', strong_rows, threads, lambda t1, tp, p: t1 / (p * tp))
+
+    if args.weak_cells > 0:
+        results = {}
+        for p in threads:
+            cells = args.weak_cells * p // threads[0]
+            results[p] = run_case(simmain, base, cells, p, args)
+            results[p]['cells'] = cells
+        print_table('Weak scaling (efficiency = T1 / Tp)', [(f'{args.weak_cells} cells/thr', results)], threads, lambda t1, tp, p: t1 / tp)
+        raw['weak'] = results
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({'args': vars(args), 'results': raw}, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,96 @@
+"""
+CellSnapshot(src/core/CellSnapshot.hpp)のバイナリ形式を読むためのモジュール。
+
+    from snapshot_reader import read_snapshot
+    snap = read_snapshot('./result/cells_0000')
+    snap.columns['x']           # numpy配列
+    snap.type_name(snap.columns['type'][0])
+
+テキスト形式(output.format: TEXT)のファイルは is_snapshot() が False になる。
+"""
+
+import struct
+from dataclasses import dataclass, field
+
+import numpy as np
+
+MAGIC = b'MCMCSNAP'
+SUPPORTED_VERSION = 1
+FLAG_FLOAT32 = 1 << 0
+COLUMN_NAME_LEN = 16
+
+# SnapshotColumnType の値 -> numpy の dtype
+COLUMN_DTYPES = {
+    0: np.dtype('<i4'),
+    1: np.dtype('u1'),
+    2: np.dtype('<f4'),
+    3: np.dtype('<f8'),
+}
+
+
+@dataclass
+class Snapshot:
+    step: int
+    flags: int
+    type_names: list
+    columns: dict = field(default_factory=dict)
+
+    def __len__(self):
+        return len(self.columns['id'])
+
+    def type_name(self, type_value):
+        return self.type_names[int(type_value)]
+
+    def contacts(self, i):
+        """i番目のCellの接着相手のIDを返す。"""
+        offset = self.columns['contact_offset']
+        return self.columns['contact_id'][offset[i]:offset[i + 1]]
+
+
+def is_snapshot(path):
+    with open(path, 'rb') as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+def parse_snapshot(buf, offset=0):
+    """bytes(あるいはmemoryview)のoffsetから始まるスナップショットを読む。"""
+    if bytes(buf[offset:offset + 8]) != MAGIC:
+        raise ValueError('not a cell snapshot')
+    offset += 8
+
+    version, flags, step, column_count, cell_count = struct.unpack_from('<IIiIQ', buf, offset)
+    offset += struct.calcsize('<IIiIQ')
+    if version > SUPPORTED_VERSION:
+        raise ValueError(f'unsupported snapshot version {version}')
+
+    (type_name_count,) = struct.unpack_from('<I', buf, offset)
+    offset += 4
+    type_names = []
+    for _ in range(type_name_count):
+        (length,) = struct.unpack_from('<I', buf, offset)
+        offset += 4
+        type_names.append(bytes(buf[offset:offset + length]).decode())
+        offset += length
+
+    headers = []
+    for _ in range(column_count):
+        name = bytes(buf[offset:offset + COLUMN_NAME_LEN]).split(b'\0', 1)[0].decode()
+        offset += COLUMN_NAME_LEN
+        column_type, count = struct.unpack_from('<B7xQ', buf, offset)
+        offset += struct.calcsize('<B7xQ')
+        headers.append((name, COLUMN_DTYPES[column_type], count))
+
+    snapshot = Snapshot(step=step, flags=flags, type_names=type_names)
+    for name, dtype, count in headers:
+        snapshot.columns[name] = np.frombuffer(buf, dtype=dtype, count=count, offset=offset)
+        offset += dtype.itemsize * count
+
+    return snapshot, offset
+
+
+def read_snapshot(path):
+    with open(path, 'rb') as f:
+        buf = f.read()
+
+    snapshot, _ = parse_snapshot(buf)
+    return snapshot
@@ -0,0 +1,121 @@
+"""
+TimeSeriesFile(src/core/TimeSeriesFile.hpp)の形式を読むためのモジュール。
+output.format: CONTAINER のときの ./result/timeseries.mcmc を読む。
+
+    from timeseries_reader import TimeSeries
+    with TimeSeries('./result/timeseries.mcmc') as ts:
+        for step in ts.steps():
+            snap = ts.cells(step)           # snapshot_reader.Snapshot
+            grid = ts.molecules(step, 0)    # 境界を含む (x, y, z) の numpy 配列
+
+ファイルはmmapで開き、必要なチャンクだけを読む(読んだチャンクはコピーして返す)。索引がない(シミュレーションが途中で止まった、
+あるいは実行中の)ファイルはチャンクを先頭からたどって読む。
+"""
+
+import mmap
+import struct
+from dataclasses import dataclass
+
+from field_codec import parse_grid
+from snapshot_reader import parse_snapshot
+
+MAGIC = b'MCMCSERI'
+INDEX_MAGIC = b'MCMCINDX'
+CHUNK_TAG = b'CHNK'
+SUPPORTED_VERSION = 1
+
+HEADER_SIZE = 16
+CHUNK_HEADER = struct.Struct('<4sB3xiiQ')
+ENTRY = struct.Struct('<B3xiiQQ')
+FOOTER = struct.Struct('<QI8s')
+
+KIND_CELLS = 0
+KIND_MOLECULES = 1
+
+
+@dataclass
+class Entry:
+    kind: int
+    step: int
+    channel: int
+    offset: int
+    size: int
+
+
+def is_timeseries(path):
+    with open(path, 'rb') as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+class TimeSeries:
+    def __init__(self, path):
+        self._file = open(path, 'rb')
+        self._buf = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        if self._buf[:8] != MAGIC:
+            raise ValueError(f'{path} is not a time series file')
+        (version,) = struct.unpack_from('<I', self._buf, 8)
+        if version > SUPPORTED_VERSION:
+            raise ValueError(f'unsupported time series version {version}')
+
+        self.entries = self._read_index()
+        self.has_index = self.entries is not None
+        if not self.has_index:
+            self.entries = self._scan_chunks()
+
+        self._lookup = {(e.kind, e.step, e.channel): e for e in self.entries}
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        self._buf.close()
+        self._file.close()
+
+    def _read_index(self):
+        size = len(self._buf)
+        if size < HEADER_SIZE + FOOTER.size:
+            return None
+
+        index_offset, count, magic = FOOTER.unpack_from(self._buf, size - FOOTER.size)
+        if magic != INDEX_MAGIC or index_offset + count * ENTRY.size + FOOTER.size != size:
+            return None
+
+        return [Entry(*ENTRY.unpack_from(self._buf, index_offset + i * ENTRY.size)) for i in range(count)]
+
+    def _scan_chunks(self):
+        entries = []
+        size = len(self._buf)
+        pos = HEADER_SIZE
+        while pos + CHUNK_HEADER.size <= size:
+            tag, kind, step, channel, length = CHUNK_HEADER.unpack_from(self._buf, pos)
+            offset = pos + CHUNK_HEADER.size
+            # 書き込み中のチャンクはsizeが0のままか、ファイルの末尾を超えている
+            if tag != CHUNK_TAG or length == 0 or offset + length > size:
+                break
+            entries.append(Entry(kind, step, channel, offset, length))
+            pos = offset + length
+
+        return entries
+
+    def steps(self):
+        """Cellの状態が記録されている出力番号を昇順で返す。"""
+        return sorted(e.step for e in self.entries if e.kind == KIND_CELLS)
+
+    def molecule_types(self):
+        return sorted({e.channel for e in self.entries if e.kind == KIND_MOLECULES})
+
+    def cells(self, step):
+        entry = self._lookup[(KIND_CELLS, step, -1)]
+        # mmapのスライスはコピーになるので、返した配列はclose()のあとも使える
+        snapshot, _ = parse_snapshot(self._buf[entry.offset:entry.offset + entry.size])
+        return snapshot
+
+    def molecules(self, step, molecule_type):
+        """境界を含む格子の値を (width + 2, height + 2, depth + 2) の配列で返す。"""
+        entry = self._lookup[(KIND_MOLECULES, step, molecule_type)]
+        grid, _ = parse_grid(self._buf[entry.offset:entry.offset + entry.size])
+        return grid
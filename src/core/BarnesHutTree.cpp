@@ -0,0 +1,351 @@
+/**
+ * @file BarnesHutTree.cpp
+ * @author Takanori Saiki
+ * @brief 遠隔力をBarnes-Hut法(2次元は四分木、3次元は八分木)で近似計算するクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "BarnesHutTree.hpp"
+#include "../utils/RadixSort.hpp"
+#include "../utils/SpaceFillingCurve.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <omp.h>
+
+namespace {
+    /**
+     * @brief posにある細胞がxにある重みwの発生源から受ける遠隔力 w (x - pos) / d * e^(-d/λ) を足す。
+     */
+    inline void addSource(Vec3& force, const Vec3& pos, double x, double y, double z, double w, double lambda) noexcept
+    {
+        const double dx   = x - pos.x;
+        const double dy   = y - pos.y;
+        const double dz   = z - pos.z;
+        const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (dist == 0) {
+            return;
+        }
+
+        const double scale = w * std::exp(-dist / lambda) / dist;
+        force.x += dx * scale;
+        force.y += dy * scale;
+        force.z += dz * scale;
+    }
+} // namespace
+
+BarnesHutTree::BarnesHutTree()
+{
+}
+
+BarnesHutTree::~BarnesHutTree()
+{
+}
+
+/**
+ * @brief 発生源から木を作り直す。
+ * @details 発生源を外接立方体で量子化してMorton番号を付け、基数ソートで並べ替える。
+ *          根から数段(2次元は3段、3次元は2段)は1スレッドで分割し、その下の部分木(最大64個)はスレッドごとに別の配列に作ってから後ろにつなげる。
+ *          最後に上の段のノードの重みの中心を下から順に求める。
+ *
+ * @param positions 発生源の位置
+ * @param sourceWeights 発生源の重み(positionsと同じ長さ)
+ * @param dim 2なら四分木(z座標は使わない)、3なら八分木
+ */
+void BarnesHutTree::build(const std::vector<Vec3>& positions, const std::vector<double>& sourceWeights, int32_t dim)
+{
+    dimension       = dim;
+    const int32_t n = positions.size();
+
+    nodes.clear();
+    keys.resize(n);
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    weights.resize(n);
+    if (n == 0) {
+        return;
+    }
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    double minX = INF, minY = INF, minZ = INF;
+    double maxX = -INF, maxY = -INF, maxZ = -INF;
+#pragma omp parallel for reduction(min : minX, minY, minZ) reduction(max : maxX, maxY, maxZ)
+    for (int32_t i = 0; i < n; i++) {
+        minX = std::min(minX, positions[i].x);
+        minY = std::min(minY, positions[i].y);
+        minZ = std::min(minZ, positions[i].z);
+        maxX = std::max(maxX, positions[i].x);
+        maxY = std::max(maxY, positions[i].y);
+        maxZ = std::max(maxZ, positions[i].z);
+    }
+
+    // 外接立方体の一辺を2^KEY_BITS個に区切る
+    const double extent = std::max({ maxX - minX, maxY - minY, dimension == 3 ? maxZ - minZ : 0.0 });
+    const double scale  = extent > 0 ? ((1u << KEY_BITS) - 1) / extent : 0.0;
+
+    std::vector<int32_t> order(n);
+#pragma omp parallel for
+    for (int32_t i = 0; i < n; i++) {
+        const uint32_t qx = (positions[i].x - minX) * scale;
+        const uint32_t qy = (positions[i].y - minY) * scale;
+        const uint32_t qz = (positions[i].z - minZ) * scale;
+        keys[i]           = dimension == 3 ? SpaceFillingCurve::morton3D(qx, qy, qz) : SpaceFillingCurve::morton2D(qx, qy);
+        order[i]          = i;
+    }
+
+    RadixSort::sortByKey(keys, order);
+
+#pragma omp parallel for
+    for (int32_t i = 0; i < n; i++) {
+        xs[i]      = positions[order[i]].x;
+        ys[i]      = positions[order[i]].y;
+        zs[i]      = dimension == 3 ? positions[order[i]].z : 0.0;
+        weights[i] = sourceWeights[order[i]];
+    }
+
+    Node root{};
+    root.begin      = 0;
+    root.end        = n;
+    root.firstChild = -1;
+    nodes.push_back(root);
+
+    const int32_t stopLevel = (6 + dimension - 1) / dimension;
+    std::vector<int32_t> pending;
+    buildChildren(nodes, 0, 0, stopLevel, &pending);
+    const int32_t topNum = nodes.size();
+
+    std::vector<std::vector<Node>> subtrees(pending.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int32_t k = 0; k < (int32_t)pending.size(); k++) {
+        subtrees[k].push_back(nodes[pending[k]]);
+        buildChildren(subtrees[k], 0, stopLevel, -1, nullptr);
+    }
+
+    // 部分木の根はpendingの位置に、それ以外は後ろにつなげる
+    for (int32_t k = 0; k < (int32_t)pending.size(); k++) {
+        const int32_t offset = (int32_t)nodes.size() - 1;
+        for (int32_t j = 0; j < (int32_t)subtrees[k].size(); j++) {
+            Node node = subtrees[k][j];
+            if (node.firstChild != -1) {
+                node.firstChild += offset;
+            }
+
+            if (j == 0) {
+                nodes[pending[k]] = node;
+            } else {
+                nodes.push_back(node);
+            }
+        }
+    }
+
+    // 子ノードは親ノードより後ろにあるので、後ろから求めれば子ノードは求まっている
+    for (int32_t i = topNum - 1; i >= 0; i--) {
+        computeMoments(nodes, i);
+    }
+}
+
+/**
+ * @brief out[index]の子ノードを作り、再帰的に分割する。
+ * @details 同じノードの発生源はMorton番号の上位level桁が等しいので、次の桁は範囲内で単調に増える。
+ *          その桁が変わる位置を二分探索で探して子ノードに分ける。子ノードは先にまとめて追加してから再帰する(子ノードを連続させるため)。
+ *
+ * @param out ノードの追加先
+ * @param index 分割するノード
+ * @param level 分割するノードの深さ
+ * @param stopLevel この深さに達したら分割せずpendingに入れる(-1なら最後まで分割する)
+ * @param pending 分割を後回しにしたノードの添字。stopLevelが-1ならnullptr
+ */
+void BarnesHutTree::buildChildren(std::vector<Node>& out, int32_t index, int32_t level, int32_t stopLevel, std::vector<int32_t>* pending) const
+{
+    const int32_t begin = out[index].begin;
+    const int32_t end   = out[index].end;
+
+    if (end - begin <= LEAF_SIZE || level == KEY_BITS) {
+        computeMoments(out, index);
+        return;
+    }
+    if (level == stopLevel) {
+        pending->push_back(index);
+        return;
+    }
+
+    const int32_t shift = (KEY_BITS - 1 - level) * dimension;
+    const uint64_t mask = (1u << dimension) - 1;
+    const int32_t first = out.size();
+
+    for (int32_t pos = begin; pos < end;) {
+        const uint64_t digit = (keys[pos] >> shift) & mask;
+        const auto last = std::partition_point(keys.begin() + pos, keys.begin() + end, [&](uint64_t k) { return ((k >> shift) & mask) == digit; });
+
+        Node child{};
+        child.begin      = pos;
+        child.end        = last - keys.begin();
+        child.firstChild = -1;
+        out.push_back(child);
+
+        pos = child.end;
+    }
+
+    out[index].firstChild = first;
+    out[index].childNum   = (int32_t)out.size() - first;
+
+    for (int32_t c = first; c < first + out[index].childNum; c++) {
+        buildChildren(out, c, level + 1, stopLevel, pending);
+    }
+
+    // 上の段は子ノードがそろってから、build()の最後に求める
+    if (pending == nullptr) {
+        computeMoments(out, index);
+    }
+}
+
+/**
+ * @brief ノードの重みの和、重みの中心、外接箱を求める。葉なら発生源から、そうでなければ子ノードから求める。
+ * @details 重みの和が0の場合は外接箱の中心を重みの中心とする(力には寄与しない)。
+ */
+void BarnesHutTree::computeMoments(std::vector<Node>& out, int32_t index) const noexcept
+{
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    Node& node           = out[index];
+
+    double weight = 0, sx = 0, sy = 0, sz = 0;
+    node.minX = node.minY = node.minZ = INF;
+    node.maxX = node.maxY = node.maxZ = -INF;
+
+    if (node.firstChild == -1) {
+        for (int32_t i = node.begin; i < node.end; i++) {
+            weight += weights[i];
+            sx += weights[i] * xs[i];
+            sy += weights[i] * ys[i];
+            sz += weights[i] * zs[i];
+            node.minX = std::min(node.minX, xs[i]);
+            node.minY = std::min(node.minY, ys[i]);
+            node.minZ = std::min(node.minZ, zs[i]);
+            node.maxX = std::max(node.maxX, xs[i]);
+            node.maxY = std::max(node.maxY, ys[i]);
+            node.maxZ = std::max(node.maxZ, zs[i]);
+        }
+    } else {
+        for (int32_t c = node.firstChild; c < node.firstChild + node.childNum; c++) {
+            const Node& child = out[c];
+            weight += child.weight;
+            sx += child.weight * child.cx;
+            sy += child.weight * child.cy;
+            sz += child.weight * child.cz;
+            node.minX = std::min(node.minX, child.minX);
+            node.minY = std::min(node.minY, child.minY);
+            node.minZ = std::min(node.minZ, child.minZ);
+            node.maxX = std::max(node.maxX, child.maxX);
+            node.maxY = std::max(node.maxY, child.maxY);
+            node.maxZ = std::max(node.maxZ, child.maxZ);
+        }
+    }
+
+    node.weight = weight;
+    if (weight > 0) {
+        node.cx = sx / weight;
+        node.cy = sy / weight;
+        node.cz = sz / weight;
+    } else {
+        node.cx = (node.minX + node.maxX) / 2;
+        node.cy = (node.minY + node.maxY) / 2;
+        node.cz = (node.minZ + node.maxZ) / 2;
+    }
+}
+
+/**
+ * @brief posに働く遠隔力の和 Σ w_i (x_i - pos) / d_i * e^(-d_i/λ) を求める。
+ * @details 深さ優先で木をたどる。posがノードの外接箱の外にあり、外接箱の一辺 < theta * (重みの中心までの距離) なら単極子で近似する。
+ *          posと同じ位置の発生源(自分自身)は足さない。
+ *
+ * @param pos 力を受ける位置
+ * @param theta 開き角。0なら近似しない
+ * @param lambda 減衰距離
+ * @param maxDistance 0より大きければ、これより遠い発生源を足さない
+ * @return Vec3
+ */
+Vec3 BarnesHutTree::sum(const Vec3& pos, double theta, double lambda, double maxDistance) const noexcept
+{
+    Vec3 force = Vec3::zero();
+    if (nodes.empty()) {
+        return force;
+    }
+
+    const double theta2       = theta * theta;
+    const double maxDistance2 = maxDistance * maxDistance;
+    const bool cutoff         = maxDistance > 0;
+
+    // 深さはKEY_BITS+1段まで、1段あたり高々8個の子ノードを積む
+    std::array<int32_t, (KEY_BITS + 1) * 8> stack;
+    int32_t top    = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+
+        // 外接箱までの最短距離と最長距離
+        const double nx = std::max({ node.minX - pos.x, 0.0, pos.x - node.maxX });
+        const double ny = std::max({ node.minY - pos.y, 0.0, pos.y - node.maxY });
+        const double nz = std::max({ node.minZ - pos.z, 0.0, pos.z - node.maxZ });
+        const double near2 = nx * nx + ny * ny + nz * nz;
+        if (cutoff && near2 > maxDistance2) {
+            continue;
+        }
+
+        if (node.firstChild == -1) {
+            for (int32_t i = node.begin; i < node.end; i++) {
+                if (cutoff) {
+                    const double dx = xs[i] - pos.x, dy = ys[i] - pos.y, dz = zs[i] - pos.z;
+                    if (dx * dx + dy * dy + dz * dz > maxDistance2) {
+                        continue;
+                    }
+                }
+                addSource(force, pos, xs[i], ys[i], zs[i], weights[i], lambda);
+            }
+            continue;
+        }
+
+        if (near2 > 0) {
+            const double fx = std::max(std::abs(pos.x - node.minX), std::abs(pos.x - node.maxX));
+            const double fy = std::max(std::abs(pos.y - node.minY), std::abs(pos.y - node.maxY));
+            const double fz = std::max(std::abs(pos.z - node.minZ), std::abs(pos.z - node.maxZ));
+            const bool inside = !cutoff || fx * fx + fy * fy + fz * fz <= maxDistance2; // 一部がmaxDistanceの外にあるノードは近似しない
+
+            const double size  = std::max({ node.maxX - node.minX, node.maxY - node.minY, node.maxZ - node.minZ });
+            const double dx    = node.cx - pos.x, dy = node.cy - pos.y, dz = node.cz - pos.z;
+            const double dist2 = dx * dx + dy * dy + dz * dz;
+            if (inside && size * size < theta2 * dist2) {
+                addSource(force, pos, node.cx, node.cy, node.cz, node.weight, lambda);
+                continue;
+            }
+        }
+
+        for (int32_t c = node.firstChild; c < node.firstChild + node.childNum; c++) {
+            stack[top++] = c;
+        }
+    }
+
+    return force;
+}
+
+/**
+ * @brief 木に入っている発生源の数
+ */
+int32_t BarnesHutTree::size() const noexcept
+{
+    return weights.size();
+}
+
+/**
+ * @brief ノードの数
+ */
+int32_t BarnesHutTree::nodeCount() const noexcept
+{
+    return nodes.size();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file BarnesHutTree.hpp
+ * @author Takanori Saiki
+ * @brief 遠隔力をBarnes-Hut法(2次元は四分木、3次元は八分木)で近似計算するクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../utils/Vec3.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class BarnesHutTree
+ * @brief 遠隔力の発生源(位置と重み)を木にまとめ、ある点に働く遠隔力の和をO(log n)で近似する。
+ * @details 発生源をMorton番号の順に並べ、番号の上位の桁が等しい範囲を1つのノードにする(線形の四分木/八分木)。
+ *          ノードには重みの和と重みの中心、含まれる発生源の外接箱を持たせる。
+ *          評価する点から見てノードが十分小さい(外接箱の一辺/重みの中心までの距離 < theta)とき、
+ *          ノードを重みの中心にある1つの発生源とみなす(単極子近似)。そうでなければ子ノードを開く。
+ *          thetaが0なら近似せず、すべての発生源を直接足す。
+ *          木はステップごとにbuild()で作り直す。評価(sum())は読み出しだけなので、複数のスレッドから同時に呼べる。
+ */
+class BarnesHutTree
+{
+  public:
+    static constexpr int32_t LEAF_SIZE = 8;  //!< 葉ノードに入れる発生源の最大数
+    static constexpr int32_t KEY_BITS  = 21; //!< Morton番号を作るときの1軸あたりのビット数(木の最大の深さ)
+
+    /**
+     * @brief 木のノード。子ノードはnodes上で連続して並ぶ。
+     */
+    struct Node {
+        double weight;                   //!< 含まれる発生源の重みの和
+        double cx, cy, cz;               //!< 重みの中心
+        double minX, minY, minZ;         //!< 含まれる発生源の外接箱
+        double maxX, maxY, maxZ;         //!< 含まれる発生源の外接箱
+        int32_t begin, end;              //!< 並べ替えた発生源の範囲 [begin, end)
+        int32_t firstChild = -1;         //!< 最初の子ノードの添字。葉なら-1
+        int32_t childNum   = 0;          //!< 子ノードの数
+    };
+
+  private:
+    int32_t dimension = 2;
+
+    std::vector<uint64_t> keys;                 //!< 並べ替えた発生源のMorton番号
+    std::vector<double> xs, ys, zs, weights;    //!< Morton番号の順に並べ替えた発生源
+    std::vector<Node> nodes;                    //!< nodes[0]が根
+
+    void buildChildren(std::vector<Node>& out, int32_t index, int32_t level, int32_t stopLevel, std::vector<int32_t>* pending) const;
+    void computeMoments(std::vector<Node>& out, int32_t index) const noexcept;
+
+  public:
+    BarnesHutTree();
+    ~BarnesHutTree();
+
+    void build(const std::vector<Vec3>& positions, const std::vector<double>& sourceWeights, int32_t dim);
+    Vec3 sum(const Vec3& pos, double theta, double lambda, double maxDistance = 0.0) const noexcept;
+
+    int32_t size() const noexcept;
+    int32_t nodeCount() const noexcept;
+};
@@ -10,11 +10,30 @@
  */
 
 #include "Cell.hpp"
+#include "../utils/BinaryIO.hpp"
 
 // static変数の初期化
-int32_t Cell::upperOfCellCount  = 0;
 int32_t Cell::numberOfCellsBorn = 0;
-std::queue<int> Cell::cellPool  = std::queue<int>();
+int32_t Cell::currentStep       = 0;
+
+namespace {
+    // チェックポイントはStorageRealによらず常にdoubleで書く。StoredVec3もVec3に直してから成分ごとに読み書きする。
+    void writeVec3(std::ostream& os, const Vec3& v)
+    {
+        BinaryIO::writeValue(os, v.x);
+        BinaryIO::writeValue(os, v.y);
+        BinaryIO::writeValue(os, v.z);
+    }
+
+    Vec3 readVec3(std::istream& is)
+    {
+        const double x = BinaryIO::readValue<double>(is);
+        const double y = BinaryIO::readValue<double>(is);
+        const double z = BinaryIO::readValue<double>(is);
+
+        return Vec3(x, y, z);
+    }
+} // namespace
 
 /**
  * @brief たぶん使わないけど一応作っておく
@@ -50,16 +69,59 @@ Cell::Cell(CellType _typeID, double x, double y, double radius, double vx, doubl
  * @param v
  */
 Cell::Cell(CellType _typeID, Vec3 pos, double radius, Vec3 v)
+  : Cell(numberOfCellsBorn, _typeID, pos, radius, v)
+{
+    if (!(typeID == CellType::TMP || typeID == CellType::NONE)) { // TMP細胞、NONE細胞はカウントしない
+        numberOfCellsBorn++;
+    }
+}
+
+/**
+ * @brief IDを指定して初期化するコンストラクタ。numberOfCellsBornは変更しないので、呼び出し側で進める。
+ * @details 多数の細胞を複数のスレッドで同時に作る場合に使う。
+ *
+ * @param _id
+ * @param _typeID
+ * @param pos
+ * @param radius
+ * @param v
+ */
+Cell::Cell(int32_t _id, CellType _typeID, Vec3 pos, double radius, Vec3 v)
   : typeID(_typeID)
   , position(pos)
   , velocity(v)
   , weight(1.0)
   , radius(radius)
-  , id(numberOfCellsBorn)
-  , arrayIndex(getNewCellIndex())
+  , arrayIndex(-1)
+  , id(_id)
 {
-    if (!(typeID == CellType::TMP || typeID == CellType::NONE)) { // TMP細胞、NONE細胞はカウントしない
-        numberOfCellsBorn++;
+}
+
+/**
+ * @brief writeState()で書き込んだ状態から復元するコンストラクタ。numberOfCellsBornは変更しない。
+ * @details arrayIndexは復元しないので、Simulationが配列に入れるときに割り当てる。
+ *
+ * @param is
+ */
+Cell::Cell(std::istream& is)
+  : arrayIndex(-1)
+  , id(BinaryIO::readValue<int32_t>(is))
+{
+    typeID   = BinaryIO::readValue<CellType>(is);
+    position = StoredVec3(readVec3(is));
+    velocity = StoredVec3(readVec3(is));
+    weight   = BinaryIO::readValue<double>(is);
+    radius   = BinaryIO::readValue<double>(is);
+
+    molecularStocks.resize(BinaryIO::readValue<uint32_t>(is));
+    BinaryIO::readArray(is, molecularStocks.data(), molecularStocks.size());
+
+    const uint32_t queueSize = BinaryIO::readValue<uint32_t>(is);
+    if (queueSize > 4) {
+        throw std::runtime_error("Cell::Cell() : too many previous velocities.");
+    }
+    for (uint32_t i = 0; i < queueSize; i++) {
+        preVelocitiesQueue.push(readVec3(is));
     }
 }
 
@@ -71,6 +133,34 @@ Cell::~Cell()
 {
 }
 
+/**
+ * @brief チェックポイント用に、シミュレーションの再開に必要な状態を書き込む。
+ * @details 接着情報は毎ステップの力の計算で作り直すので書き込まない。
+ *          派生クラスで状態を追加した場合は、このメソッドをオーバーライドして基底クラスの後に書き込むこと。
+ *
+ * @param os
+ */
+void Cell::writeState(std::ostream& os) const
+{
+    BinaryIO::writeValue<int32_t>(os, id);
+    BinaryIO::writeValue(os, typeID);
+    writeVec3(os, position);
+    writeVec3(os, velocity);
+    BinaryIO::writeValue(os, weight);
+    BinaryIO::writeValue(os, radius);
+
+    BinaryIO::writeValue<uint32_t>(os, molecularStocks.size());
+    BinaryIO::writeArray(os, molecularStocks.data(), molecularStocks.size());
+
+    // std::queueは走査できないのでコピーして先頭から取り出す
+    VelocityQueue velocities = preVelocitiesQueue;
+    BinaryIO::writeValue<uint32_t>(os, velocities.size());
+    while (!velocities.empty()) {
+        writeVec3(os, velocities.front());
+        velocities.pop();
+    }
+}
+
 /**
  * @brief Cellの速度を計算する。引数には今までの速度を格納したキューを渡す。
  * @note キューの長さは計算アルゴリズムによって変わる。ユーザ側はあまり考えなくていいが、コントリビューターは注意すること。
@@ -78,7 +168,7 @@ Cell::~Cell()
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcVelocity(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcVelocity(VelocityQueue& velocities) noexcept
 {
     // パラメータに合わせて計算方法を変える
     switch (SimulationSettings::POSITION_UPDATE_METHOD) {
@@ -105,7 +195,7 @@ Vec3 Cell::calcVelocity(std::queue<Vec3>& velocities) noexcept
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcAB4(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcAB4(VelocityQueue& velocities) noexcept
 {
     assert(velocities.size() == 4);
 
@@ -134,7 +224,7 @@ Vec3 Cell::calcAB4(std::queue<Vec3>& velocities) noexcept
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcAB3(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcAB3(VelocityQueue& velocities) noexcept
 {
     assert(velocities.size() == 3);
 
@@ -163,7 +253,7 @@ Vec3 Cell::calcAB3(std::queue<Vec3>& velocities) noexcept
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcAB2(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcAB2(VelocityQueue& velocities) noexcept
 {
     assert(velocities.size() == 2);
 
@@ -192,7 +282,7 @@ Vec3 Cell::calcAB2(std::queue<Vec3>& velocities) noexcept
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcEuler(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcEuler(VelocityQueue& velocities) noexcept
 {
     assert(velocities.size() == 1);
     return velocities.front();
@@ -204,7 +294,7 @@ Vec3 Cell::calcEuler(std::queue<Vec3>& velocities) noexcept
  * @param velocities
  * @return Vec3
  */
-Vec3 Cell::calcOriginal(std::queue<Vec3>& velocities) noexcept
+Vec3 Cell::calcOriginal(VelocityQueue& velocities) noexcept
 {
     assert(1 <= velocities.size() && velocities.size() <= 4);
 
@@ -250,25 +340,6 @@ double Cell::calcVolumeFromRadius(double radius) noexcept
     return 4.0 / 3.0 * M_PI * std::pow(radius, 3.0);
 }
 
-/**
- * @brief 接着しているCellのリストを初期化する。初期化は遅いので注意が必要。必要ならSimulation::stepPreprocessで呼び出す。
- *
- */
-void Cell::clearAdhereCells() noexcept
-{
-    adhereCells.clear();
-}
-
-/**
- * @brief Cell cと接着する。内部的には配列に追加するだけ。接着のタイミングは今の所ユーザ定義
- *
- * @param c
- */
-void Cell::adhere(const Cell& c) noexcept
-{
-    adhereCells.emplace_back(&c);
-}
-
 bool Cell::checkWillDie() const noexcept
 {
     return false;
@@ -298,14 +369,15 @@ void Cell::metabolize() noexcept
 
 /**
  * @brief 細胞死。死亡時の処理(細胞を残すのか、消滅させるのか、あるいは分解されるのか)はユーザが定義する。
+ * @note NONEになった細胞の場所は、Simulationが次の新しい細胞に再利用するか、コンパクションで詰める。
  *
- * @return int32_t
+ * @return int32_t 空いた配列の添字
  */
 int32_t Cell::die() noexcept
 {
     typeID = CellType::NONE;
 
-    return releaseIndex();
+    return arrayIndex;
 }
 
 /**
@@ -315,8 +387,7 @@ int32_t Cell::die() noexcept
  */
 Cell Cell::divide() noexcept
 {
-    Vec3 pos            = this->getPosition();
-    Vec3 childDirection = Vec3::randomDirection2(); // どの方向に分裂するかを決める。分裂元は逆方向に動く。
+    Vec3 childDirection = Vec3::direction2(randomStream(RandomPurpose::DIVISION_DIRECTION).angle()); // どの方向に分裂するかを決める。分裂元は逆方向に動く。
     // 体積を二分割したときの半径を求める。
     double halfVolumeRadius = this->radius / std::pow(2, 1.0 / 3.0);
 
@@ -354,43 +425,24 @@ double Cell::absorbMolecule(int moleculeId, double amountOnTheSpot) noexcept
     return 0.0;
 }
 
-/**
- * @brief 余っているCellのインデックスを返す。プールが空になっていれば新しいインデックスを生成する。
- *
- * @return int32_t
- * @note 例えば、Cellが分裂したときなどに用いる。cellPoolはCellが死滅した際などに補充される。
- */
-int32_t Cell::getNewCellIndex() noexcept
-{
-    if (Cell::cellPool.empty()) {
-        int32_t newIndex = upperOfCellCount;
-        upperOfCellCount++;
-
-        return newIndex;
-    }
-
-    int32_t newIndex = cellPool.front();
-    Cell::cellPool.pop();
-    return newIndex;
-}
-
 /**
  * @brief Cellの情報をすべて出力する。
  *
+ * @param contactIds 接触している細胞のID(Simulation::getContactGraph().contactsOf(getArrayIndex()))
  */
-void Cell::printCell() const noexcept
+void Cell::printCell(std::span<const int32_t> contactIds) const noexcept
 {
     std::cout << id << "\t" << NAMEOF_ENUM(typeID) << "\t";
-    std::cout << position.x << "\t" << position.y << "\t" << position.z << "\t" << velocity.x << "\t" << velocity.y << "\t" << velocity.z << "\t" << radius << "\t" << adhereCells.size() << "\t"
+    std::cout << position.x << "\t" << position.y << "\t" << position.z << "\t" << velocity.x << "\t" << velocity.y << "\t" << velocity.z << "\t" << radius << "\t" << contactIds.size() << "\t"
               << "_";
 
     // std::cout << id << "\t";
     // std::cout << position.x << "\t" << position.y;
 
-    for (int i = 0; i < (int)adhereCells.size(); i++) {
-        std::cout << adhereCells[i]->id;
+    for (size_t i = 0; i < contactIds.size(); i++) {
+        std::cout << contactIds[i];
 
-        if (i != (int)adhereCells.size() - 1) {
+        if (i != contactIds.size() - 1) {
             std::cout << ",";
         }
     }
@@ -410,38 +462,26 @@ void Cell::printDebug() const noexcept
     std::cout << std::endl;
 }
 
-/**
- * @brief Cellに割り当てられたIndexをcellPoolに戻す。細胞が完全に消滅した場合に呼び出す。
- *
- * @return int32_t
- */
-int32_t Cell::releaseIndex() noexcept
-{
-    int32_t idx = this->arrayIndex;
-    cellPool.push(idx);
-
-    return idx;
-}
-
 /**
  * @brief Cellの位置をシミュレーションフィールド内に戻す
+ * @details x、y、zをそれぞれの軸の長さ(FIELD_X_LEN、FIELD_Y_LEN、FIELD_Z_LEN)で戻す。FIELD_Z_LENが0(2次元)ならzは触らない。
  *
  */
 void Cell::adjustPosInField() noexcept
 {
-    const int32_t FIELD_WIDTH = SimulationSettings::FIELD_X_LEN;
-
     // 座標が画面外に出たら、一周回して画面内に戻す
-    if (position.x < -(double)(FIELD_WIDTH / 2)) {
-        position.x = (FIELD_WIDTH / 2) - 1;
-    }
-    if ((double)(FIELD_WIDTH / 2) <= position.x) {
-        position.x = -FIELD_WIDTH / 2;
-    }
-    if (position.y < -(double)(FIELD_WIDTH / 2)) {
-        position.y = (FIELD_WIDTH / 2) - 1;
-    }
-    if ((double)(FIELD_WIDTH / 2) <= position.y) {
-        position.y = -FIELD_WIDTH / 2;
+    auto wrap = [](StorageReal& coordinate, int32_t fieldWidth) {
+        if (coordinate < -(double)(fieldWidth / 2)) {
+            coordinate = (fieldWidth / 2) - 1;
+        }
+        if ((double)(fieldWidth / 2) <= coordinate) {
+            coordinate = -fieldWidth / 2;
+        }
+    };
+
+    wrap(position.x, SimulationSettings::FIELD_X_LEN);
+    wrap(position.y, SimulationSettings::FIELD_Y_LEN);
+    if (SimulationSettings::FIELD_Z_LEN > 0) {
+        wrap(position.z, SimulationSettings::FIELD_Z_LEN);
     }
 }
@@ -14,14 +14,21 @@
 #include "../CellType.hpp"
 #include "../SimulationSettings.hpp"
 #include "../thirdparty/nameof.hpp"
+#include "../utils/CounterRNG.hpp"
+#include "../utils/FixedRing.hpp"
+#include "../utils/Precision.hpp"
 #include "../utils/Vec3.hpp"
 #include <iostream>
 #include <memory>
 #include <queue>
 #include <random>
+#include <span>
 
 class MoleculeSpace;
 
+// 過去の速度は多くても4つ(AB4)しか持たないので、ヒープを使わない固定長のキューにする
+using VelocityQueue = std::queue<Vec3, FixedRing<Vec3, 4>>;
+
 /**
  * @class Cell
  * @brief Cell単体の状態を管理するクラス
@@ -29,39 +36,39 @@ class MoleculeSpace;
 class Cell
 {
   protected:
-    CellType typeID; //!< Cellの種類
-    Vec3 position;   //!< Cellの座標(x,y,z)
-    Vec3 velocity;   //!< Cellの速度(x,y,z)
-    double weight;   //!< Cellの質量
-    double radius;   //!< Cellの半径
-
-    std::vector<const Cell*> adhereCells; //!< 接着しているCellのポインタを格納する配列
+    CellType typeID;     //!< Cellの種類
+    StoredVec3 position; //!< Cellの座標(x,y,z)。StorageRealで保存する
+    StoredVec3 velocity; //!< Cellの速度(x,y,z)。StorageRealで保存する
+    double weight;       //!< Cellの質量
+    double radius;       //!< Cellの半径
 
     std::vector<MoleculeSpace*> moleculeSpaces; //!< 分子空間のポインタを格納する配列
     std::vector<int> molecularStocks;           //!< 細胞の保持している分子数。配列の添字は分子の種類。
 
-    int32_t releaseIndex() noexcept;
-
     void adjustPosInField() noexcept;
 
   private:
-    static int32_t upperOfCellCount; //!< 同時に存在していた細胞の上限数。static変数。
+    int32_t arrayIndex; //!< Simulation::cellsのどこに入っているか。Simulationが割り当て、コンパクション時に更新する。
 
-    std::queue<Vec3> preVelocitiesQueue; //!< 速度計算用のキュー
+    VelocityQueue preVelocitiesQueue; //!< 速度計算用のキュー
 
     // Simulation *sim; //!< Cellの呼び出し元になるSimulationインスタンスのポインタ
-    static Vec3 calcVelocity(std::queue<Vec3>& velocities) noexcept;
-    static Vec3 calcAB4(std::queue<Vec3>& velocities) noexcept;
-    static Vec3 calcAB3(std::queue<Vec3>& velocities) noexcept;
-    static Vec3 calcAB2(std::queue<Vec3>& velocities) noexcept;
-    static Vec3 calcEuler(std::queue<Vec3>& velocities) noexcept;
-    static Vec3 calcOriginal(std::queue<Vec3>& velocities) noexcept;
+    static Vec3 calcVelocity(VelocityQueue& velocities) noexcept;
+    static Vec3 calcAB4(VelocityQueue& velocities) noexcept;
+    static Vec3 calcAB3(VelocityQueue& velocities) noexcept;
+    static Vec3 calcAB2(VelocityQueue& velocities) noexcept;
+    static Vec3 calcEuler(VelocityQueue& velocities) noexcept;
+    static Vec3 calcOriginal(VelocityQueue& velocities) noexcept;
 
   public:
     Cell();
     Cell(CellType _typeID, double x, double y, double radius = 5.0, double vx = 0, double vy = 0);
     Cell(CellType _typeID, Vec3 pos, double radius = 5.0, Vec3 v = Vec3::zero());
-    ~Cell();
+    Cell(int32_t _id, CellType _typeID, Vec3 pos, double radius, Vec3 v);
+    explicit Cell(std::istream& is);
+    virtual ~Cell();
+
+    virtual void writeState(std::ostream& os) const;
 
     static double calcRadiusFromVolume(double volume) noexcept;
     static double calcVolumeFromRadius(double radius) noexcept;
@@ -78,9 +85,6 @@ class Cell
     void addForce(Vec3 f) noexcept;
     void nextStep() noexcept;
 
-    void clearAdhereCells() noexcept;
-    void adhere(const Cell& c) noexcept;
-
     virtual bool checkWillDie() const noexcept;    // ユーザが定義
     virtual bool checkWillDivide() const noexcept; // ユーザが定義
     virtual void metabolize() noexcept;            // ユーザが定義
@@ -90,16 +94,19 @@ class Cell
     virtual double emitMolecule(int moleculeId) noexcept;
     virtual double absorbMolecule(int moleculeId, double amountOnTheSpot) noexcept;
 
-    static int32_t getNewCellIndex() noexcept;
+    int32_t getArrayIndex() const noexcept;
 
-    void printCell() const noexcept;
+    CounterRNG randomStream(RandomPurpose purpose) const noexcept;
+
+    void printCell(std::span<const int32_t> contactIds = {}) const noexcept;
     void printDebug() const noexcept; // デバッグ用
 
     static int32_t numberOfCellsBorn; //!< 今までに生成した生きているCellの数。static変数。
-    static std::queue<int> cellPool;  //!< CellのIDを管理するためのキュー
+    static int32_t currentStep;       //!< 現在のシミュレーションステップ。Simulationが各ステップの開始時に更新し、乱数のキーに用いる。
+
+    const int id; //!< CellのID。コンパクションなどで配列内の位置が変わっても不変。
 
-    const int id;         //!< CellのID
-    const int arrayIndex; //!< 配列のどこに入るか
+    friend class Simulation; // arrayIndexの割り当てはSimulationだけが行う
 };
 
 /**
@@ -112,6 +119,17 @@ inline CellType Cell::getCellType() const noexcept
     return typeID;
 }
 
+/**
+ * @brief CellがSimulation::cellsのどこに入っているかを返す。
+ * @note コンパクションによって変わるので、ステップをまたいでCellを参照する場合はidを使う。
+ *
+ * @return int32_t 配列の添字。まだ登録されていない場合は-1
+ */
+inline int32_t Cell::getArrayIndex() const noexcept
+{
+    return arrayIndex;
+}
+
 /**
  * @brief Cellの座標を返す。必ず副作用をつけない点に注意。
  *
@@ -168,13 +186,26 @@ inline double Cell::setRadius(double r)
     return radius;
 }
 
+/**
+ * @brief (シード値, CellのID, 現在のステップ, 用途)をキーにした乱数列を返す。
+ * @details 同じキーからは常に同じ乱数列が得られるので、どのスレッドから・どの順番で呼び出しても結果は変わらない。
+ *          同じステップ・同じ用途で複数回呼び出すと同じ乱数列になる点に注意。
+ *
+ * @param purpose 乱数の用途
+ * @return CounterRNG
+ */
+inline CounterRNG Cell::randomStream(RandomPurpose purpose) const noexcept
+{
+    return CounterRNG(SimulationSettings::CELL_SEED, id, currentStep, purpose);
+}
+
 /**
  * @brief Cellにかかっている力を初期化する。
  *
  */
 inline void Cell::initForce() noexcept
 {
-    velocity = Vec3::zero();
+    velocity = StoredVec3::zero();
 }
 
 /**
@@ -196,7 +227,7 @@ inline void Cell::addForce(double fx, double fy) noexcept
  */
 inline void Cell::addForce(Vec3 f) noexcept
 {
-    velocity += f.timesScalar(1.0 / weight);
+    velocity = StoredVec3(Vec3(velocity) + f.timesScalar(1.0 / weight));
 }
 
 /**
@@ -238,7 +269,7 @@ inline void Cell::nextStep() noexcept
     if (!(SimulationSettings::POSITION_UPDATE_METHOD == PositionUpdateMethod::ORIGINAL && preVelocitiesQueue.size() < 4))
         preVelocitiesQueue.pop(); // 一番古い速度をキューから削除
 
-    position += adjustedVelocity; // 位置を更新
+    position = StoredVec3(Vec3(position) + adjustedVelocity); // 位置を更新
 
     adjustPosInField(); // 枠外にはみ出さないように調整
 }
\ No newline at end of file
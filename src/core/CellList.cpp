@@ -10,6 +10,10 @@
  */
 
 #include "CellList.hpp"
+#include "../utils/SpaceFillingCurve.hpp"
+#include <algorithm>
+#include <bit>
+#include <omp.h>
 
 /**
  * @brief CellListの初期化を呼びだす。
@@ -18,7 +22,16 @@
 CellList::CellList()
   : CELL_GRID_LEN_X(SimulationSettings::FIELD_X_LEN / SimulationSettings::GRID_SIZE_MAGNIFICATION)
   , CELL_GRID_LEN_Y(SimulationSettings::FIELD_Y_LEN / SimulationSettings::GRID_SIZE_MAGNIFICATION)
+  , CELL_GRID_LEN_Z(std::max(SimulationSettings::FIELD_Z_LEN / SimulationSettings::GRID_SIZE_MAGNIFICATION, 1))
+  , GRID_BITS(std::bit_width((uint32_t)std::max({ CELL_GRID_LEN_X, CELL_GRID_LEN_Y, CELL_GRID_LEN_Z }) - 1))
 {
+    const int32_t CHECK_GRID_WIDTH = (SimulationSettings::SEARCH_RADIUS + SimulationSettings::GRID_SIZE_MAGNIFICATION - 1) / SimulationSettings::GRID_SIZE_MAGNIFICATION; // 切り上げの割り算
+    const bool periodic            = SimulationSettings::CELL_LIST_PERIODIC;
+
+    stencilX = makeStencilAxis(CELL_GRID_LEN_X, CHECK_GRID_WIDTH, SimulationSettings::FIELD_X_LEN, periodic);
+    stencilY = makeStencilAxis(CELL_GRID_LEN_Y, CHECK_GRID_WIDTH, SimulationSettings::FIELD_Y_LEN, periodic);
+    stencilZ = makeStencilAxis(CELL_GRID_LEN_Z, CELL_GRID_LEN_Z > 1 ? CHECK_GRID_WIDTH : 0, SimulationSettings::FIELD_Z_LEN, periodic);
+
     init();
 }
 
@@ -32,33 +45,111 @@ CellList::~CellList()
  */
 void CellList::init()
 {
-    cellField.resize(CELL_GRID_LEN_Y);
-    for (int32_t y = 0; y < CELL_GRID_LEN_Y; y++) {
-        cellField[y].resize(CELL_GRID_LEN_X);
-        for (int32_t x = 0; x < CELL_GRID_LEN_X; x++) {
-            cellField[y][x] = std::vector<std::shared_ptr<UserCell>>();
-        }
-    }
+    cellField.assign((size_t)CELL_GRID_LEN_X * CELL_GRID_LEN_Y * CELL_GRID_LEN_Z, std::vector<std::shared_ptr<UserCell>>());
 }
 
 /**
  * @brief 設定されたグリッドサイズに合わせてCellが入っているグリッドの座標(整数)を返却する。
  *
+ * @details 2次元(FIELD_Z_LENが0)のときzは常に0になる。
+ *
  * @param c
- * @return std::tuple<int32_t, int32_t>
+ * @return std::tuple<int32_t, int32_t, int32_t>
  */
-std::tuple<int32_t, int32_t> CellList::getGridCoordinateByCellPos(const std::shared_ptr<UserCell> c) const
+std::tuple<int32_t, int32_t, int32_t> CellList::getGridCoordinateByCellPos(const std::shared_ptr<UserCell> c) const
 {
     Vec3 pos = c->getPosition();
 
     const int32_t gridX = (pos.x + SimulationSettings::FIELD_X_LEN / 2) / SimulationSettings::GRID_SIZE_MAGNIFICATION;
     const int32_t gridY = (pos.y + SimulationSettings::FIELD_Y_LEN / 2) / SimulationSettings::GRID_SIZE_MAGNIFICATION;
+    const int32_t gridZ = CELL_GRID_LEN_Z > 1 ? (int32_t)((pos.z + SimulationSettings::FIELD_Z_LEN / 2) / SimulationSettings::GRID_SIZE_MAGNIFICATION) : 0;
+
+    return std::forward_as_tuple(gridX, gridY, gridZ);
+}
+
+/**
+ * @brief Cellが入っているグリッドを一次元の通し番号(x、y、zの順の行優先)で返す。近い番号のグリッドは空間的にも近い。
+ *
+ * @param c
+ * @return int32_t
+ */
+int32_t CellList::getGridIndex(const std::shared_ptr<UserCell> c) const
+{
+    auto [gridX, gridY, gridZ] = getGridCoordinateByCellPos(c);
+
+    return (gridZ * CELL_GRID_LEN_Y + gridY) * CELL_GRID_LEN_X + gridX;
+}
+
+/**
+ * @brief Cellが入っているグリッドの、orderの順での通し番号を返す。番号順に並べると、空間的に近い細胞がメモリ上でも近くなる。
+ * @details フィールドの外にいる細胞は一番近いグリッドに入っているものとして扱う。
+ *          3次元のグリッドではHILBERTもMorton番号(Z曲線)で代用する。
+ *
+ * @param c
+ * @param order
+ * @return uint64_t
+ */
+uint64_t CellList::getOrderKey(const std::shared_ptr<UserCell> c, CellOrder order) const
+{
+    auto [gridX, gridY, gridZ] = getGridCoordinateByCellPos(c);
+    const uint32_t x           = std::clamp(gridX, 0, CELL_GRID_LEN_X - 1);
+    const uint32_t y           = std::clamp(gridY, 0, CELL_GRID_LEN_Y - 1);
+    const uint32_t z           = std::clamp(gridZ, 0, CELL_GRID_LEN_Z - 1);
+
+    if (CELL_GRID_LEN_Z > 1 && order != CellOrder::ROW_MAJOR) {
+        return SpaceFillingCurve::morton3D(x, y, z);
+    }
+
+    switch (order) {
+        case CellOrder::MORTON:
+            return SpaceFillingCurve::morton2D(x, y);
+        case CellOrder::HILBERT:
+            return SpaceFillingCurve::hilbert2D(GRID_BITS, x, y);
+        default:
+            return ((uint64_t)z * CELL_GRID_LEN_Y + y) * CELL_GRID_LEN_X + x;
+    }
+}
 
-    return std::forward_as_tuple(gridX, gridY);
+/**
+ * @brief 1つの軸について、各グリッドから調べるグリッドと像のずれの表を作る。
+ * @details 周期境界では、グリッドの座標がフィールドを何周はみ出したか(k)で反対側のグリッドに戻し、像のずれをk * fieldLenにする。
+ *          探索半径がフィールドの長さの半分未満なら、同じ細胞の像が2つ以上探索半径に入ることはないので、
+ *          グリッドの数が2 * width + 1より少なく同じグリッドを2回調べる場合でも、近傍として返るのは1回だけになる。
+ *
+ * @param gridLen この軸のグリッドの数
+ * @param width 片側に調べるグリッドの数
+ * @param fieldLen この軸のフィールドの長さ
+ * @param periodic 周期境界にするか
+ * @return CellList::StencilAxis
+ */
+CellList::StencilAxis CellList::makeStencilAxis(int32_t gridLen, int32_t width, double fieldLen, bool periodic)
+{
+    StencilAxis axis;
+    axis.width       = width;
+    const int32_t nd = 2 * width + 1;
+    axis.grid.assign((size_t)gridLen * nd, -1);
+    axis.shift.assign((size_t)gridLen * nd, 0.0);
+
+    for (int32_t g = 0; g < gridLen; g++) {
+        for (int32_t d = -width; d <= width; d++) {
+            const int32_t n = g + d;
+            const int32_t k = (n >= 0 ? n : n - gridLen + 1) / gridLen; // 床関数の割り算
+            if (k != 0 && (!periodic || gridLen == 1)) {
+                continue;
+            }
+            axis.grid[g * nd + d + width]  = n - k * gridLen;
+            axis.shift[g * nd + d + width] = k * fieldLen;
+        }
+    }
+
+    return axis;
 }
 
 /**
  * @brief 指定したCellの周囲にあるCellのIDリストを返す。
+ * @details 3次元のグリッドでは、z方向にも同じ幅のグリッドを調べる(探索半径がグリッド1つ分なら3x3x3の27個)。
+ *          周期境界では反対側の端の細胞も返すが、座標の差は像のずれを足して計算する必要があるので、
+ *          力の計算にはshiftsを受け取る方を使う。
  *
  * @param c
  * @return std::vector<int>
@@ -67,38 +158,89 @@ std::tuple<int32_t, int32_t> CellList::getGridCoordinateByCellPos(const std::sha
 std::vector<int32_t> CellList::aroundCellList(const std::shared_ptr<UserCell> c) const
 {
     std::vector<int32_t> aroundCells;
-    const int32_t CHECK_GRID_WIDTH = (SimulationSettings::SEARCH_RADIUS + SimulationSettings::GRID_SIZE_MAGNIFICATION - 1) / SimulationSettings::GRID_SIZE_MAGNIFICATION; // 切り上げの割り算
+    collectAroundCells(c, aroundCells, nullptr);
+
+    return aroundCells;
+}
 
-    auto [gridX, gridY] = getGridCoordinateByCellPos(c);
+/**
+ * @brief 指定したCellの周囲にあるCellのIDリストと、それぞれの像のずれを返す。
+ * @details 近傍の細胞dについて、cから見たdの位置(最小像)はd->getPosition() + shifts[i]になる。周期境界でなければshiftsはすべて0。
+ *
+ * @param c
+ * @param shifts 返り値と同じ順の像のずれ(上書きする)
+ * @return std::vector<int32_t>
+ */
+std::vector<int32_t> CellList::aroundCellList(const std::shared_ptr<UserCell> c, std::vector<Vec3>& shifts) const
+{
+    std::vector<int32_t> aroundCells;
+    shifts.clear();
+    collectAroundCells(c, aroundCells, &shifts);
+
+    return aroundCells;
+}
+
+/**
+ * @brief aroundCellListの本体。shiftsがnullptrでなければ像のずれも追加する。
+ * @details 調べるグリッドと像のずれは軸ごとの表(StencilAxis)から引くので、周期境界でも細胞の組ごとの剰余はいらない。
+ */
+void CellList::collectAroundCells(const std::shared_ptr<UserCell>& c, std::vector<int32_t>& aroundCells, std::vector<Vec3>* shifts) const
+{
+    auto [gridX, gridY, gridZ] = getGridCoordinateByCellPos(c);
+    const Vec3 pos             = c->getPosition();
 
-    for (int32_t y = gridY - CHECK_GRID_WIDTH; y <= gridY + CHECK_GRID_WIDTH; y++) {
-        for (int32_t x = gridX - CHECK_GRID_WIDTH; x <= gridX + CHECK_GRID_WIDTH; x++) {
-            if (!isInGrid(x, y)) { // グリッド外を参照している場合は飛ばす
+    // フィールドの外にいる細胞は一番近いグリッドから調べる
+    const int32_t ndX = 2 * stencilX.width + 1;
+    const int32_t ndY = 2 * stencilY.width + 1;
+    const int32_t ndZ = 2 * stencilZ.width + 1;
+    const int32_t* xs = &stencilX.grid[std::clamp(gridX, 0, CELL_GRID_LEN_X - 1) * ndX];
+    const int32_t* ys = &stencilY.grid[std::clamp(gridY, 0, CELL_GRID_LEN_Y - 1) * ndY];
+    const int32_t* zs = &stencilZ.grid[std::clamp(gridZ, 0, CELL_GRID_LEN_Z - 1) * ndZ];
+    const double* sx  = &stencilX.shift[std::clamp(gridX, 0, CELL_GRID_LEN_X - 1) * ndX];
+    const double* sy  = &stencilY.shift[std::clamp(gridY, 0, CELL_GRID_LEN_Y - 1) * ndY];
+    const double* sz  = &stencilZ.shift[std::clamp(gridZ, 0, CELL_GRID_LEN_Z - 1) * ndZ];
+
+    for (int32_t k = 0; k < ndZ; k++) {
+        if (zs[k] == -1) { // グリッド外を参照している場合は飛ばす
+            continue;
+        }
+        for (int32_t j = 0; j < ndY; j++) {
+            if (ys[j] == -1) {
                 continue;
             }
+            for (int32_t i = 0; i < ndX; i++) {
+                if (xs[i] == -1) {
+                    continue;
+                }
 
-            for (int i = 0; i < (int32_t)cellField[y][x].size(); i++) {
-                if (checkInSearchRadius(c->getPosition(), cellField[y][x][i]->getPosition())) {
-                    aroundCells.emplace_back(cellField[y][x][i]->arrayIndex);
+                const Vec3 shift  = Vec3(sx[i], sy[j], sz[k]);
+                const Vec3 target = pos - shift; // 像との距離 |pos - (p + shift)| を |target - p| で測る
+                const auto& grid  = cellField[(zs[k] * CELL_GRID_LEN_Y + ys[j]) * CELL_GRID_LEN_X + xs[i]];
+                for (int32_t n = 0; n < (int32_t)grid.size(); n++) {
+                    if (checkInSearchRadius(target, grid[n]->getPosition())) {
+                        aroundCells.emplace_back(grid[n]->getArrayIndex());
+                        if (shifts != nullptr) {
+                            shifts->emplace_back(shift);
+                        }
+                    }
                 }
             }
         }
     }
-
-    return aroundCells;
 }
 
 /**
- * @brief 指定されたグリッド座標(x, y)がグリッドの定義域に存在するかを返す。
+ * @brief 指定されたグリッド座標(x, y, z)がグリッドの定義域に存在するかを返す。
  *
  * @param x
  * @param y
+ * @param z 2次元のグリッドでは0だけが定義域に入る
  * @return bool
  */
-bool CellList::isInGrid(const int32_t x, const int32_t y) const
+bool CellList::isInGrid(const int32_t x, const int32_t y, const int32_t z) const
 {
     // 範囲外の場合は空のvectorを返す
-    if (x < 0 || CELL_GRID_LEN_X <= x || y < 0 || CELL_GRID_LEN_Y <= y) {
+    if (x < 0 || CELL_GRID_LEN_X <= x || y < 0 || CELL_GRID_LEN_Y <= y || z < 0 || CELL_GRID_LEN_Z <= z) {
         return false;
     }
 
@@ -115,8 +257,7 @@ bool CellList::isInGrid(const int32_t x, const int32_t y) const
  */
 bool CellList::checkInSearchRadius(const Vec3 v, const Vec3 u) const
 {
-    Vec3 diff            = v - u;
-    const bool isInRange = (diff.x * diff.x + diff.y * diff.y + diff.z * diff.z) <= SimulationSettings::SEARCH_RADIUS * SimulationSettings::SEARCH_RADIUS;
+    const bool isInRange = (v - u).lengthSquared() <= SimulationSettings::SEARCH_RADIUS * SimulationSettings::SEARCH_RADIUS;
 
     // 距離がSEARCH_RADIUSより離れている場合はfalse
     if (!isInRange) {
@@ -132,24 +273,133 @@ bool CellList::checkInSearchRadius(const Vec3 v, const Vec3 u) const
  */
 void CellList::resetGrid() noexcept
 {
-    for (int32_t y = 0; y < CELL_GRID_LEN_Y; y++) {
-        for (int32_t x = 0; x < CELL_GRID_LEN_X; x++) {
-            cellField[y][x].clear();
+    isTracking = false;
+    for (auto& grid : cellField) {
+        grid.clear();
+    }
+}
+
+/**
+ * @brief グリッドを空にして、cellsのすべての細胞を添字の順に登録し直す。以後はupdate()で差分だけを反映できる。
+ * @details 細胞のグリッドは並列に求め、グリッドへの登録は添字の順に行うので、各グリッドの中は添字の昇順に並ぶ。
+ *
+ * @param cells Simulation::cells
+ */
+void CellList::rebuild(const std::vector<std::shared_ptr<UserCell>>& cells)
+{
+    resetGrid();
+
+    gridOfSlot.resize(cells.size());
+    cellOfSlot.resize(cells.size());
+#pragma omp parallel for
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        gridOfSlot[i] = getGridIndex(cells[i]);
+        cellOfSlot[i] = cells[i].get();
+    }
+
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        cellField[gridOfSlot[i]].emplace_back(cells[i]);
+    }
+
+    isTracking     = true;
+    lastMovedCount = cells.size();
+}
+
+/**
+ * @brief 前回のrebuild()/update()から、グリッドをまたいだ細胞と、添字の中身が変わった(分裂で追加された)細胞だけを入れ直す。
+ * @details 1. 全細胞の今のグリッドを並列に求め、登録したグリッドと違う添字をスレッドごとに集める。
+ *          2. 集めた添字だけを、古いグリッドから取り除いて新しいグリッドに入れる(一括で逐次に反映)。
+ *          グリッドの中は添字の昇順に保つので、rebuild()し直した場合と同じ順で近傍の細胞が返り、力の足し算の順も変わらない。
+ *          消滅してNONEになった細胞は位置が変わらないのでそのまま残り、その添字に新しい細胞が入ったときに入れ替わる。
+ *          コンパクションや読み込みで添字が振り直されたとき(invalidate()の後)や、cellsが短くなったときはrebuild()する。
+ *          入れ直しの手間はグリッドをまたいだ細胞の数に比例する。全細胞を調べる1.は読み出しだけなので軽い。
+ *
+ * @param cells Simulation::cells
+ */
+void CellList::update(const std::vector<std::shared_ptr<UserCell>>& cells)
+{
+    if (!isTracking || cells.size() < gridOfSlot.size()) {
+        rebuild(cells);
+        return;
+    }
+
+    gridOfSlot.resize(cells.size(), -1);
+    cellOfSlot.resize(cells.size(), nullptr);
+
+    std::vector<std::vector<int32_t>> movedPerThread(omp_get_max_threads());
+#pragma omp parallel
+    {
+        std::vector<int32_t>& moved = movedPerThread[omp_get_thread_num()];
+
+#pragma omp for schedule(static)
+        for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+            if (cells[i].get() != cellOfSlot[i] || getGridIndex(cells[i]) != gridOfSlot[i]) {
+                moved.push_back(i);
+            }
         }
     }
+
+    lastMovedCount = 0;
+    for (const std::vector<int32_t>& moved : movedPerThread) {
+        for (const int32_t slot : moved) {
+            if (gridOfSlot[slot] != -1) {
+                removeSorted(gridOfSlot[slot], slot);
+            }
+
+            const int32_t gridIndex = getGridIndex(cells[slot]);
+            insertSorted(gridIndex, cells[slot]);
+            gridOfSlot[slot] = gridIndex;
+            cellOfSlot[slot] = cells[slot].get();
+        }
+        lastMovedCount += moved.size();
+    }
 }
 
 /**
- * @brief CellListのグリッドにCellのポインタを登録する。
+ * @brief 細胞の添字が振り直されたことを知らせる。次のupdate()はrebuild()になる。
  *
- * @param cell
  */
-void CellList::addCell(std::shared_ptr<UserCell> cell)
+void CellList::invalidate() noexcept
+{
+    isTracking = false;
+}
+
+/**
+ * @brief 直前のrebuild()/update()でグリッドに入れ直した細胞の数
+ *
+ * @return int32_t
+ */
+int32_t CellList::movedCount() const noexcept
 {
-    Vec3 pos = cell->getPosition();
+    return lastMovedCount;
+}
 
-    const int32_t scaledY = (pos.y + SimulationSettings::FIELD_Y_LEN / 2) / SimulationSettings::GRID_SIZE_MAGNIFICATION;
-    const int32_t scaledX = (pos.x + SimulationSettings::FIELD_X_LEN / 2) / SimulationSettings::GRID_SIZE_MAGNIFICATION;
+/**
+ * @brief グリッドの中の添字の昇順を保つ位置に細胞を入れる。
+ *
+ * @param gridIndex グリッドの通し番号(getGridIndex()の値)
+ * @param cell
+ */
+void CellList::insertSorted(int32_t gridIndex, const std::shared_ptr<UserCell>& cell)
+{
+    auto& grid = cellField[gridIndex];
+    auto it    = std::lower_bound(grid.begin(), grid.end(), cell->getArrayIndex(),
+                                  [](const std::shared_ptr<UserCell>& c, int32_t slot) { return c->getArrayIndex() < slot; });
+    grid.insert(it, cell);
+}
 
-    cellField[scaledY][scaledX].emplace_back(cell);
-}
\ No newline at end of file
+/**
+ * @brief グリッドから添字slotの細胞を取り除く。
+ * @details 添字に新しい細胞が入った場合でも、グリッドに残っている古い細胞のarrayIndexは同じslotのままなので、添字で探せる。
+ *
+ * @param gridIndex グリッドの通し番号(getGridIndex()の値)
+ * @param slot 細胞の添字
+ */
+void CellList::removeSorted(int32_t gridIndex, int32_t slot)
+{
+    auto& grid = cellField[gridIndex];
+    auto it    = std::lower_bound(grid.begin(), grid.end(), slot, [](const std::shared_ptr<UserCell>& c, int32_t s) { return c->getArrayIndex() < s; });
+    if (it != grid.end() && (*it)->getArrayIndex() == slot) {
+        grid.erase(it);
+    }
+}
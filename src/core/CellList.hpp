@@ -19,15 +19,49 @@
 #include <tuple>
 #include <vector>
 
+/**
+ * @class CellList
+ * @brief フィールドを一辺GRID_SIZE_MAGNIFICATIONのグリッドに分け、近傍の細胞をグリッド単位で探す。
+ * @details FIELD_Z_LENが0より大きければz方向にも分けた3次元のグリッドになる(0なら z方向のグリッドは1つ)。
+ *          グリッドは2次元でも3次元でも通し番号(getGridIndex())で1次元に並べる。
+ *          CELL_LIST_PERIODICがtrueなら、フィールドの端のグリッドは反対側の端のグリッドとも隣り合う(周期境界)。
+ *          反対側の細胞は、フィールドの長さだけずらした像(最小像)との距離で判定する。
+ */
 class CellList
 {
   private:
-    Field<std::vector<std::shared_ptr<UserCell>>> cellField; //!< セルのポインタが格納されている2次元配列
+    /**
+     * @brief 1つの軸について、グリッドgから見てd個先(-width <= d <= width)に調べるグリッドと、像のずれ
+     * @details 添字はg * (2 * width + 1) + (d + width)。コンストラクタで全てのgとdについて求めておくので、
+     *          aroundCellListは細胞の組ごとに剰余や場合分けをせずに像の位置を得られる。
+     */
+    struct StencilAxis {
+        int32_t width = 0;         //!< 片側に調べるグリッドの数
+        std::vector<int32_t> grid; //!< 調べるグリッドの座標。フィールドの外で周期境界でなければ-1
+        std::vector<double> shift; //!< 周期境界をまたいだとき、近傍の細胞の座標に足すフィールドの長さ(またがなければ0)
+    };
 
-    std::tuple<int32_t, int32_t> getGridCoordinateByCellPos(const std::shared_ptr<UserCell> c) const;
+    std::vector<std::vector<std::shared_ptr<UserCell>>> cellField; //!< グリッドの通し番号ごとの、セルのポインタの配列
+
+    std::tuple<int32_t, int32_t, int32_t> getGridCoordinateByCellPos(const std::shared_ptr<UserCell> c) const;
 
     const int32_t CELL_GRID_LEN_X;
     const int32_t CELL_GRID_LEN_Y;
+    const int32_t CELL_GRID_LEN_Z; //!< z方向のグリッドの数。2次元(FIELD_Z_LENが0)なら1
+    const uint32_t GRID_BITS;      //!< グリッドの一辺の数が2^GRID_BITS以下になる最小のビット数(Hilbert番号に使う)
+
+    StencilAxis stencilX, stencilY, stencilZ; //!< 軸ごとの、近傍として調べるグリッド
+
+    // update()で使う、細胞の添字(arrayIndex)ごとの登録状態
+    std::vector<int32_t> gridOfSlot;          //!< 添字の細胞が入っているグリッドの通し番号。入っていなければ-1
+    std::vector<const UserCell*> cellOfSlot; //!< 添字に登録した細胞。cellsの同じ添字が別の細胞に変わったら入れ直す
+    bool isTracking        = false;          //!< gridOfSlotとcellOfSlotがグリッドの中身と一致しているか
+    int32_t lastMovedCount = 0;              //!< 直前のupdate()で入れ直した細胞の数
+
+    static StencilAxis makeStencilAxis(int32_t gridLen, int32_t width, double fieldLen, bool periodic);
+    void collectAroundCells(const std::shared_ptr<UserCell>& c, std::vector<int32_t>& aroundCells, std::vector<Vec3>* shifts) const;
+    void insertSorted(int32_t gridIndex, const std::shared_ptr<UserCell>& cell);
+    void removeSorted(int32_t gridIndex, int32_t slot);
 
   public:
     CellList();
@@ -35,8 +69,15 @@ class CellList
 
     void init();
     std::vector<int32_t> aroundCellList(const std::shared_ptr<UserCell> c) const;
-    bool isInGrid(const int32_t x, const int32_t y) const;
+    std::vector<int32_t> aroundCellList(const std::shared_ptr<UserCell> c, std::vector<Vec3>& shifts) const;
+    int32_t getGridIndex(const std::shared_ptr<UserCell> c) const;
+    uint64_t getOrderKey(const std::shared_ptr<UserCell> c, CellOrder order) const;
+    bool isInGrid(const int32_t x, const int32_t y, const int32_t z = 0) const;
     bool checkInSearchRadius(const Vec3 v, const Vec3 u) const;
     void resetGrid() noexcept;
-    void addCell(std::shared_ptr<UserCell> cell);
+
+    void rebuild(const std::vector<std::shared_ptr<UserCell>>& cells);
+    void update(const std::vector<std::shared_ptr<UserCell>>& cells);
+    void invalidate() noexcept;
+    int32_t movedCount() const noexcept;
 };
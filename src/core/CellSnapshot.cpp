@@ -0,0 +1,506 @@
+/**
+ * @file CellSnapshot.cpp
+ * @author Takanori Saiki
+ * @brief ある時刻のすべてのCellの状態を列ごとにまとめたもの(出力用)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "CellSnapshot.hpp"
+#include "../thirdparty/nameof.hpp"
+#include "../utils/BinaryIO.hpp"
+#include "../utils/MappedFile.hpp"
+#include "../utils/TextParse.hpp"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+namespace {
+    constexpr int32_t MAX_CELL_TYPE_NUM = 64; //!< CellTypeの名前表を作るときに調べる値の上限
+
+    /**
+     * @brief CellTypeの値から名前を引く表を作る。値は0から連番であることを前提にする。
+     *
+     * @return std::vector<std::string>
+     */
+    std::vector<std::string> cellTypeNames()
+    {
+        std::vector<std::string> names;
+
+        for (int32_t i = 0; i < MAX_CELL_TYPE_NUM; i++) {
+            auto name = NAMEOF_ENUM(static_cast<CellType>(i));
+            if (name.empty()) {
+                break;
+            }
+            names.emplace_back(name);
+        }
+
+        return names;
+    }
+
+    /**
+     * @brief 列の情報(名前、型、要素数)を書き込む。
+     */
+    void writeColumnHeader(std::ostream& os, const char* name, SnapshotColumnType type, uint64_t count)
+    {
+        char nameBuf[CellSnapshot::COLUMN_NAME_LEN] = {};
+        std::strncpy(nameBuf, name, CellSnapshot::COLUMN_NAME_LEN - 1);
+        const uint8_t reserved[7] = {};
+
+        BinaryIO::writeArray(os, nameBuf, CellSnapshot::COLUMN_NAME_LEN);
+        BinaryIO::writeValue(os, type);
+        BinaryIO::writeArray(os, reserved, 7);
+        BinaryIO::writeValue(os, count);
+    }
+
+    /**
+     * @brief 実数の列を書き込む。useFloat32がtrueの場合はfloatに変換してから書き込む。
+     */
+    void writeRealColumn(std::ostream& os, const std::vector<double>& column, bool useFloat32)
+    {
+        if (!useFloat32) {
+            BinaryIO::writeArray(os, column.data(), column.size());
+            return;
+        }
+
+        std::vector<float> downcast(column.begin(), column.end());
+        BinaryIO::writeArray(os, downcast.data(), downcast.size());
+    }
+
+    /**
+     * @brief 型に合わせて列を読み込み、Tに変換して返す。
+     */
+    template<typename T>
+    std::vector<T> readColumn(std::istream& is, SnapshotColumnType type, uint64_t count)
+    {
+        switch (type) {
+            case SnapshotColumnType::INT32: {
+                std::vector<int32_t> buf(count);
+                BinaryIO::readArray(is, buf.data(), count);
+                return std::vector<T>(buf.begin(), buf.end());
+            }
+            case SnapshotColumnType::UINT8: {
+                std::vector<uint8_t> buf(count);
+                BinaryIO::readArray(is, buf.data(), count);
+                return std::vector<T>(buf.begin(), buf.end());
+            }
+            case SnapshotColumnType::FLOAT32: {
+                std::vector<float> buf(count);
+                BinaryIO::readArray(is, buf.data(), count);
+                return std::vector<T>(buf.begin(), buf.end());
+            }
+            case SnapshotColumnType::FLOAT64: {
+                std::vector<double> buf(count);
+                BinaryIO::readArray(is, buf.data(), count);
+                return std::vector<T>(buf.begin(), buf.end());
+            }
+            default:
+                throw std::runtime_error("CellSnapshot::readBinary() : unknown column type.");
+        }
+    }
+
+    /**
+     * @brief 列の型の1要素あたりのバイト数を返す。
+     */
+    size_t columnTypeSize(SnapshotColumnType type)
+    {
+        switch (type) {
+            case SnapshotColumnType::INT32:
+                return 4;
+            case SnapshotColumnType::UINT8:
+                return 1;
+            case SnapshotColumnType::FLOAT32:
+                return 4;
+            case SnapshotColumnType::FLOAT64:
+                return 8;
+            default:
+                throw std::runtime_error("CellSnapshot::readBinary() : unknown column type.");
+        }
+    }
+
+    constexpr size_t TEXT_CHUNK_SIZE = 1 << 18; //!< readText()で1つのスレッドが一度に受け持つバイト数の目安
+
+    /**
+     * @brief typeIDのフィールドを読む。CellTypeの名前(WORKERなど)でも値でもよい。
+     *
+     * @return int32_t 読めない場合は-1
+     */
+    int32_t parseCellType(std::string_view field, const std::vector<std::string>& names) noexcept
+    {
+        const char* p = field.data();
+        int64_t value;
+        if (TextParse::parseInt(p, field.data() + field.size(), value) && p == field.data() + field.size()) {
+            return (0 <= value && value < (int64_t)names.size()) ? value : -1;
+        }
+
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == field) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief 表の1行(ID, typeID, X, Y, Z, Vx, Vy, Vz, R, ...)を読んでsnapshotのrow番目に入れる。10列目以降(接着情報)は読まない。
+     *
+     * @return const char* 読めなかった列の名前。読めた場合はnullptr
+     */
+    const char* parseRow(const char* p, const char* end, CellSnapshot& snapshot, size_t row, const std::vector<std::string>& names) noexcept
+    {
+        int64_t id;
+        if (!TextParse::parseInt(p, end, id)) {
+            return "ID";
+        }
+        snapshot.id[row] = id;
+
+        const int32_t type = parseCellType(TextParse::nextField(p, end), names);
+        if (type < 0) {
+            return "typeID";
+        }
+        snapshot.type[row] = type;
+
+        if (!TextParse::parseDouble(p, end, snapshot.x[row])) return "X";
+        if (!TextParse::parseDouble(p, end, snapshot.y[row])) return "Y";
+        if (!TextParse::parseDouble(p, end, snapshot.z[row])) return "Z";
+        if (!TextParse::parseDouble(p, end, snapshot.vx[row])) return "Vx";
+        if (!TextParse::parseDouble(p, end, snapshot.vy[row])) return "Vy";
+        if (!TextParse::parseDouble(p, end, snapshot.vz[row])) return "Vz";
+        if (!TextParse::parseDouble(p, end, snapshot.radius[row])) return "R";
+
+        return nullptr;
+    }
+} // namespace
+
+/**
+ * @brief スナップショットに含まれるCellの数を返す。
+ *
+ * @return size_t
+ */
+size_t CellSnapshot::size() const noexcept
+{
+    return id.size();
+}
+
+/**
+ * @brief Cellの数をnにする。接着情報はcontactOffsetだけ確保し、contactIdとclusterは空にする。
+ *
+ * @param n
+ */
+void CellSnapshot::resize(size_t n)
+{
+    id.resize(n);
+    type.resize(n);
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    vx.resize(n);
+    vy.resize(n);
+    vz.resize(n);
+    radius.resize(n);
+    contactOffset.assign(n + 1, 0);
+    contactId.clear();
+    cluster.clear();
+}
+
+/**
+ * @brief バイナリ形式で書き込む。形式はクラスのコメントを参照。
+ *
+ * @param os バイナリモードで開いたストリーム
+ * @param useFloat32 trueの場合、実数の列をfloat32に落として書き込む
+ */
+void CellSnapshot::writeBinary(std::ostream& os, bool useFloat32) const
+{
+    const SnapshotColumnType realType        = useFloat32 ? SnapshotColumnType::FLOAT32 : SnapshotColumnType::FLOAT64;
+    const uint64_t n                         = size();
+    const std::vector<std::string> typeNames = cellTypeNames();
+
+    BinaryIO::writeArray(os, MAGIC, 8);
+    BinaryIO::writeValue(os, VERSION);
+    BinaryIO::writeValue<uint32_t>(os, useFloat32 ? FLAG_FLOAT32 : 0);
+    BinaryIO::writeValue(os, step);
+    BinaryIO::writeValue<uint32_t>(os, cluster.empty() ? 11 : 12);
+    BinaryIO::writeValue(os, n);
+    BinaryIO::writeValue<uint32_t>(os, typeNames.size());
+    for (const std::string& name : typeNames) {
+        BinaryIO::writeString(os, name);
+    }
+
+    writeColumnHeader(os, "id", SnapshotColumnType::INT32, n);
+    writeColumnHeader(os, "type", SnapshotColumnType::UINT8, n);
+    writeColumnHeader(os, "x", realType, n);
+    writeColumnHeader(os, "y", realType, n);
+    writeColumnHeader(os, "z", realType, n);
+    writeColumnHeader(os, "vx", realType, n);
+    writeColumnHeader(os, "vy", realType, n);
+    writeColumnHeader(os, "vz", realType, n);
+    writeColumnHeader(os, "radius", realType, n);
+    writeColumnHeader(os, "contact_offset", SnapshotColumnType::INT32, contactOffset.size());
+    writeColumnHeader(os, "contact_id", SnapshotColumnType::INT32, contactId.size());
+    if (!cluster.empty()) {
+        writeColumnHeader(os, "cluster", SnapshotColumnType::INT32, n);
+    }
+
+    BinaryIO::writeArray(os, id.data(), n);
+    BinaryIO::writeArray(os, type.data(), n);
+    writeRealColumn(os, x, useFloat32);
+    writeRealColumn(os, y, useFloat32);
+    writeRealColumn(os, z, useFloat32);
+    writeRealColumn(os, vx, useFloat32);
+    writeRealColumn(os, vy, useFloat32);
+    writeRealColumn(os, vz, useFloat32);
+    writeRealColumn(os, radius, useFloat32);
+    BinaryIO::writeArray(os, contactOffset.data(), contactOffset.size());
+    BinaryIO::writeArray(os, contactId.data(), contactId.size());
+    if (!cluster.empty()) {
+        BinaryIO::writeArray(os, cluster.data(), n);
+    }
+}
+
+/**
+ * @brief 従来のタブ区切りのテキスト形式で書き込む。Cell::printCell()と同じ形式。
+ *
+ * @param os
+ */
+void CellSnapshot::writeText(std::ostream& os) const
+{
+    os << "ID\ttypeID\tX\tY\tZ\tVx\tVy\tVz\tR\tN_contact\tContact_IDs" << "\n";
+
+    for (size_t i = 0; i < size(); i++) {
+        const int32_t contactBegin = contactOffset[i];
+        const int32_t contactEnd   = contactOffset[i + 1];
+
+        os << id[i] << "\t" << NAMEOF_ENUM(static_cast<CellType>(type[i])) << "\t";
+        os << x[i] << "\t" << y[i] << "\t" << z[i] << "\t" << vx[i] << "\t" << vy[i] << "\t" << vz[i] << "\t" << radius[i] << "\t" << contactEnd - contactBegin << "\t";
+
+        if (contactBegin == contactEnd) {
+            os << "_";
+        }
+        for (int32_t j = contactBegin; j < contactEnd; j++) {
+            os << contactId[j] << (j != contactEnd - 1 ? "," : "");
+        }
+        os << "\n";
+    }
+}
+
+/**
+ * @brief バイナリ形式のスナップショットを読み込む。知らない名前の列は読み飛ばす。
+ * @details 列の要素数が細胞の数と合わない場合や、contact_offsetが0から始まらない、減っている、contact_idの数で終わらない場合は、
+ *          壊れたファイルとしてstd::runtime_errorを投げる(読み込んだ後に範囲外を読まないようにするため)。
+ *
+ * @param is バイナリモードで開いたストリーム
+ * @return CellSnapshot 実数の列はfloat32で書かれていてもdoubleに戻す
+ */
+CellSnapshot CellSnapshot::readBinary(std::istream& is)
+{
+    char magic[8];
+    BinaryIO::readArray(is, magic, 8);
+    if (!std::equal(magic, magic + 8, MAGIC)) {
+        throw std::runtime_error("CellSnapshot::readBinary() : not a cell snapshot.");
+    }
+
+    const uint32_t version = BinaryIO::readValue<uint32_t>(is);
+    if (version > VERSION) {
+        throw std::runtime_error("CellSnapshot::readBinary() : unsupported version " + std::to_string(version) + ".");
+    }
+
+    CellSnapshot snapshot;
+    BinaryIO::readValue<uint32_t>(is); // flagsは列の型から分かるので使わない
+    snapshot.step                = BinaryIO::readValue<int32_t>(is);
+    const uint32_t columnCount   = BinaryIO::readValue<uint32_t>(is);
+    const uint64_t n             = BinaryIO::readValue<uint64_t>(is);
+    const uint32_t typeNameCount = BinaryIO::readValue<uint32_t>(is);
+    for (uint32_t i = 0; i < typeNameCount; i++) {
+        BinaryIO::readString(is);
+    }
+    snapshot.resize(n);
+
+    struct Column
+    {
+        std::string name;
+        SnapshotColumnType type;
+        uint64_t count;
+    };
+    std::vector<Column> columns(columnCount);
+    for (Column& column : columns) {
+        char nameBuf[COLUMN_NAME_LEN + 1] = {};
+        uint8_t reserved[7];
+        BinaryIO::readArray(is, nameBuf, COLUMN_NAME_LEN);
+        column.name = nameBuf;
+        column.type = BinaryIO::readValue<SnapshotColumnType>(is);
+        BinaryIO::readArray(is, reserved, 7);
+        column.count = BinaryIO::readValue<uint64_t>(is);
+    }
+
+    // 細胞ごとの列は細胞の数だけ、contact_offsetはそれより1つ多く要素がなければならない
+    for (const Column& column : columns) {
+        static const std::vector<std::string> PER_CELL = { "id", "type", "x", "y", "z", "vx", "vy", "vz", "radius", "cluster" };
+        const bool perCell      = std::find(PER_CELL.begin(), PER_CELL.end(), column.name) != PER_CELL.end();
+        const bool offsetColumn = column.name == "contact_offset";
+        if ((perCell && column.count != n) || (offsetColumn && column.count != n + 1)) {
+            throw std::runtime_error("CellSnapshot::readBinary() : column " + column.name + " has " + std::to_string(column.count) + " values for " + std::to_string(n) + " cells.");
+        }
+    }
+
+    for (const Column& column : columns) {
+        if (column.name == "id") {
+            snapshot.id = readColumn<int32_t>(is, column.type, column.count);
+        } else if (column.name == "type") {
+            snapshot.type = readColumn<uint8_t>(is, column.type, column.count);
+        } else if (column.name == "x") {
+            snapshot.x = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "y") {
+            snapshot.y = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "z") {
+            snapshot.z = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "vx") {
+            snapshot.vx = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "vy") {
+            snapshot.vy = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "vz") {
+            snapshot.vz = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "radius") {
+            snapshot.radius = readColumn<double>(is, column.type, column.count);
+        } else if (column.name == "contact_offset") {
+            snapshot.contactOffset = readColumn<int32_t>(is, column.type, column.count);
+        } else if (column.name == "contact_id") {
+            snapshot.contactId = readColumn<int32_t>(is, column.type, column.count);
+        } else if (column.name == "cluster") {
+            snapshot.cluster = readColumn<int32_t>(is, column.type, column.count);
+        } else {
+            is.ignore(column.count * columnTypeSize(column.type));
+        }
+    }
+
+    const std::vector<int32_t>& offsets = snapshot.contactOffset;
+    if (offsets.front() != 0 || !std::is_sorted(offsets.begin(), offsets.end()) || offsets.back() != (int64_t)snapshot.contactId.size()) {
+        throw std::runtime_error("CellSnapshot::readBinary() : inconsistent contact_offset.");
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief ストリームの先頭がバイナリスナップショットかどうかを調べる。ストリームの位置は元に戻す。
+ *
+ * @param is
+ * @return true
+ * @return false
+ */
+bool CellSnapshot::isBinary(std::istream& is)
+{
+    char magic[8]  = {};
+    const auto pos = is.tellg();
+
+    is.read(magic, 8);
+    const bool res = is.gcount() == 8 && std::equal(magic, magic + 8, MAGIC);
+
+    is.clear();
+    is.seekg(pos);
+
+    return res;
+}
+
+/**
+ * @brief writeText()の形式(input/init_cellも同じ)の表を読み込む。
+ * @details 先頭の行が数値で始まらなければ見出しとして読み飛ばす。typeIDはCellTypeの名前でも値でもよい。
+ *          接着情報の列は読まない(contactOffsetはすべて0になる)。空行は無視する。
+ *          [begin, end)を行の境界で区切り、まず各区間の行数を、次に各区間の行を並列に読む。
+ *
+ * @param begin
+ * @param end
+ * @return CellSnapshot stepは0
+ */
+CellSnapshot CellSnapshot::readText(const char* begin, const char* end)
+{
+    const char* body = begin;
+    {
+        const char* p = begin;
+        TextParse::skipBlanks(p, end);
+        if (p < end && !('0' <= *p && *p <= '9') && *p != '-' && *p != '+') {
+            body = TextParse::nextLine(begin, end);
+        }
+    }
+
+    // 区間の境界は必ず行の先頭にする
+    const size_t chunkCount = std::max<size_t>(1, (end - body) / TEXT_CHUNK_SIZE);
+    std::vector<const char*> bounds(chunkCount + 1);
+    bounds[0]          = body;
+    bounds[chunkCount] = end;
+    for (size_t c = 1; c < chunkCount; c++) {
+        const char* nominal = body + (end - body) * c / chunkCount;
+        bounds[c]           = std::max(bounds[c - 1], TextParse::nextLine(nominal, end));
+    }
+
+    std::vector<size_t> rowOffsets(chunkCount + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < chunkCount; c++) {
+        size_t rows = 0;
+        for (const char* p = bounds[c]; p < bounds[c + 1]; p = TextParse::nextLine(p, bounds[c + 1])) {
+            rows += !TextParse::isBlankLine(p, bounds[c + 1]);
+        }
+        rowOffsets[c + 1] = rows;
+    }
+    for (size_t c = 0; c < chunkCount; c++) {
+        rowOffsets[c + 1] += rowOffsets[c];
+    }
+
+    CellSnapshot snapshot;
+    snapshot.resize(rowOffsets[chunkCount]);
+    const std::vector<std::string> names = cellTypeNames();
+
+    // 並列区間の外に例外を投げられないので、最初の例外を覚えておいて後で投げ直す
+    std::exception_ptr error = nullptr;
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < chunkCount; c++) {
+        size_t row = rowOffsets[c];
+        for (const char* p = bounds[c]; p < bounds[c + 1]; p = TextParse::nextLine(p, bounds[c + 1])) {
+            if (TextParse::isBlankLine(p, bounds[c + 1])) {
+                continue;
+            }
+
+            const char* column = parseRow(p, bounds[c + 1], snapshot, row, names);
+            if (column != nullptr) {
+#pragma omp critical
+                if (!error) {
+                    error = std::make_exception_ptr(std::runtime_error("CellSnapshot::readText() : invalid " + std::string(column) + " in row " + std::to_string(row + 1) + "."));
+                }
+                break;
+            }
+            row++;
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief ファイルからスナップショットを読み込む。バイナリ形式かどうかは先頭のマジックナンバーで判断し、そうでなければ表として読む。
+ * @details 表はmmapして読むので、大きなファイルでもコピーは作らない。
+ *
+ * @param path
+ * @return CellSnapshot
+ */
+CellSnapshot CellSnapshot::load(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("CellSnapshot::load() : cannot open " + path + ".");
+    }
+
+    if (isBinary(ifs)) {
+        return readBinary(ifs);
+    }
+    ifs.close();
+
+    const MappedFile file(path);
+    return readText(file.begin(), file.end());
+}
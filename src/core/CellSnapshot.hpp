@@ -0,0 +1,80 @@
+/**
+ * @file CellSnapshot.hpp
+ * @author Takanori Saiki
+ * @brief ある時刻のすべてのCellの状態を列ごとにまとめたもの(出力用)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../CellType.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief バイナリスナップショットの列の型
+ */
+enum class SnapshotColumnType : uint8_t
+{
+    INT32,
+    UINT8,
+    FLOAT32,
+    FLOAT64,
+};
+
+/**
+ * @class CellSnapshot
+ * @brief ある時刻のすべてのCellの状態を列(Structure of Arrays)で保持する。
+ * @details バイナリ形式は次の通り。数値はすべてリトルエンディアン。
+ * @code
+ * char     magic[8]        "MCMCSNAP"
+ * uint32   version
+ * uint32   flags           bit0 : 実数の列をfloat32で書いた
+ * int32    step            出力番号
+ * uint32   columnCount
+ * uint64   cellCount
+ * uint32   typeNameCount   続けて(uint32 長さ, 文字列)をtypeNameCount個。CellTypeの値が添字。
+ * column * columnCount     (char name[16], uint8 type, uint8 reserved[7], uint64 count)
+ * data                     各列のデータをcolumnの順に隙間なく並べる
+ * @endcode
+ * 接着情報はCSR形式で、i番目のCellの接着相手はcontact_id[contact_offset[i] : contact_offset[i + 1]]。
+ * Simulationはそのステップの力の計算で重なっていた相手(Simulation::getContactGraph())を書く。
+ * analysis.clustersがtrueなら、接触でつながった集団の番号の列clusterを最後に足す(テキスト形式には書かない)。
+ * 読み込み側は知らない名前の列を読み飛ばすので、列の追加は後方互換になる。
+ */
+class CellSnapshot
+{
+  public:
+    static constexpr char MAGIC[8]           = { 'M', 'C', 'M', 'C', 'S', 'N', 'A', 'P' };
+    static constexpr uint32_t VERSION        = 1;
+    static constexpr uint32_t FLAG_FLOAT32   = 1u << 0;
+    static constexpr int32_t COLUMN_NAME_LEN = 16;
+
+    int32_t step = 0; //!< 出力番号
+
+    std::vector<int32_t> id;            //!< Cell::id
+    std::vector<uint8_t> type;          //!< CellTypeの値
+    std::vector<double> x, y, z;        //!< 座標
+    std::vector<double> vx, vy, vz;     //!< 速度
+    std::vector<double> radius;         //!< 半径
+    std::vector<int32_t> contactOffset; //!< 接着相手の開始位置。要素数はsize() + 1
+    std::vector<int32_t> contactId;     //!< 接着相手のCell::id
+    std::vector<int32_t> cluster;       //!< 接触でつながった集団の番号(ClusterAnalysis::label)。空なら列を書かない
+
+    size_t size() const noexcept;
+    void resize(size_t n);
+
+    void writeBinary(std::ostream& os, bool useFloat32) const;
+    void writeText(std::ostream& os) const;
+    static CellSnapshot readBinary(std::istream& is);
+    static CellSnapshot readText(const char* begin, const char* end);
+    static bool isBinary(std::istream& is);
+    static CellSnapshot load(const std::string& path);
+};
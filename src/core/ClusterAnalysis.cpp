@@ -0,0 +1,156 @@
+/**
+ * @file ClusterAnalysis.cpp
+ * @author Takanori Saiki
+ * @brief 接触でつながった細胞の集団(クラスタ)を出力のたびに求めるクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ClusterAnalysis.hpp"
+#include "../utils/ConcurrentUnionFind.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+/**
+ * @brief snapshotの細胞を接触でつながったクラスタに分け、snapshot.clusterに細胞ごとのクラスタ番号を書く。
+ * @details 1. Cell::idからスナップショットの行を引く表を作る
+ *          2. 行ごとに接触相手と並列に併合する(ConcurrentUnionFind)
+ *          3. 根(クラスタの最小の行)の順に番号を振り、各行に根の番号を写す
+ *
+ * @param snapshot
+ * @return Summary
+ */
+ClusterAnalysis::Summary ClusterAnalysis::label(CellSnapshot& snapshot)
+{
+    const int32_t n = (int32_t)snapshot.size();
+
+    Summary summary;
+    summary.step      = snapshot.step;
+    summary.cellCount = n;
+    snapshot.cluster.assign(n, 0);
+    if (n == 0) {
+        return summary;
+    }
+
+    const int32_t maxId = std::max(*std::max_element(snapshot.id.begin(), snapshot.id.end()), 0);
+    std::vector<int32_t> rowOfId(maxId + 1, -1);
+#pragma omp parallel for
+    for (int32_t i = 0; i < n; i++) {
+        if (snapshot.id[i] >= 0) {
+            rowOfId[snapshot.id[i]] = i;
+        }
+    }
+
+    ConcurrentUnionFind sets(n);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int32_t i = 0; i < n; i++) {
+        for (int32_t j = snapshot.contactOffset[i]; j < snapshot.contactOffset[i + 1]; j++) {
+            const int32_t contactId = snapshot.contactId[j];
+            if (contactId < 0 || maxId < contactId) {
+                continue;
+            }
+
+            const int32_t row = rowOfId[contactId];
+            if (row >= 0 && row != i) {
+                sets.unite(i, row);
+            }
+        }
+    }
+
+    std::vector<int32_t> root(n);
+#pragma omp parallel for
+    for (int32_t i = 0; i < n; i++) {
+        root[i] = sets.find(i);
+    }
+
+    // 根は集合の最小の行なので、行の順に見れば根はクラスタの最初の細胞で、番号はその順になる
+    std::vector<int32_t> numberOfRoot(n, -1);
+    std::vector<int32_t> sizes;
+    for (int32_t i = 0; i < n; i++) {
+        if (root[i] == i) {
+            numberOfRoot[i] = (int32_t)sizes.size();
+            sizes.push_back(0);
+        }
+    }
+
+#pragma omp parallel for
+    for (int32_t i = 0; i < n; i++) {
+        snapshot.cluster[i] = numberOfRoot[root[i]];
+    }
+    for (int32_t i = 0; i < n; i++) {
+        sizes[snapshot.cluster[i]]++;
+    }
+
+    summary.clusterCount = (int32_t)sizes.size();
+    std::sort(sizes.begin(), sizes.end());
+    summary.largest = sizes.back();
+    for (const int32_t size : sizes) {
+        if (summary.histogram.empty() || summary.histogram.back().first != size) {
+            summary.histogram.emplace_back(size, 0);
+        }
+        summary.histogram.back().second++;
+    }
+
+    return summary;
+}
+
+/**
+ * @brief writeSummary()の表の見出しを書き込む。
+ *
+ * @param os
+ */
+void ClusterAnalysis::writeHeader(std::ostream& os)
+{
+    os << "output\tcells\tclusters\tlargest\thistogram" << "\n";
+}
+
+/**
+ * @brief 1回の出力の集計をタブ区切りの1行で書き込む。histogramは「細胞数:クラスタ数」をカンマでつなぐ(細胞がなければ_)。
+ *
+ * @param os
+ * @param summary
+ */
+void ClusterAnalysis::writeSummary(std::ostream& os, const Summary& summary)
+{
+    os << summary.step << "\t" << summary.cellCount << "\t" << summary.clusterCount << "\t" << summary.largest << "\t";
+
+    if (summary.histogram.empty()) {
+        os << "_";
+    }
+    for (size_t i = 0; i < summary.histogram.size(); i++) {
+        os << summary.histogram[i].first << ":" << summary.histogram[i].second << (i + 1 != summary.histogram.size() ? "," : "");
+    }
+    os << "\n";
+}
+
+/**
+ * @brief チェックポイントから再開するときに、pathの表を出力番号lastOutputまでの行に戻す。
+ * @details チェックポイントより後に書いた行は、再開後にもう一度書くので消す。表がなければ見出しだけを書く。
+ *
+ * @param path writeHeader()とwriteSummary()で書いた表
+ * @param lastOutput チェックポイントの時点の出力番号
+ */
+void ClusterAnalysis::resumeSummary(const std::string& path, int32_t lastOutput)
+{
+    std::vector<std::string> rows;
+    {
+        std::ifstream ifs(path);
+        std::string line;
+        std::getline(ifs, line); // 見出し
+        while (std::getline(ifs, line)) {
+            if (!line.empty() && std::strtol(line.c_str(), nullptr, 10) <= lastOutput) {
+                rows.push_back(line);
+            }
+        }
+    }
+
+    std::ofstream ofs(path, std::ios::trunc);
+    writeHeader(ofs);
+    for (const std::string& row : rows) {
+        ofs << row << "\n";
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * @file ClusterAnalysis.hpp
+ * @author Takanori Saiki
+ * @brief 接触でつながった細胞の集団(クラスタ)を出力のたびに求めるクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "CellSnapshot.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ClusterAnalysis
+ * @brief CellSnapshotの接着情報(contact_offset, contact_id)をグラフとみなし、連結成分を並列のUnion-Findで求める。
+ * @details label()はスナップショットのclusterの列に細胞ごとのクラスタ番号を書き、クラスタの数と大きさの分布を返す。
+ *          クラスタ番号は、クラスタに含まれる細胞のうちスナップショットで最初に現れるものの順に0から振る。
+ *          出力ごとに振り直すので、ステップをまたいで同じ番号が同じクラスタを指すとは限らない。
+ *          接触のない細胞は大きさ1のクラスタになる。スナップショットにない細胞(NONE)との接触は無視する。
+ */
+class ClusterAnalysis
+{
+  public:
+    /**
+     * @brief 1回の出力のクラスタの集計
+     */
+    struct Summary {
+        int32_t step         = 0;                    //!< 出力番号
+        int32_t cellCount    = 0;                    //!< 細胞の数
+        int32_t clusterCount = 0;                    //!< クラスタの数
+        int32_t largest      = 0;                    //!< 最大のクラスタの細胞数
+        std::vector<std::pair<int32_t, int32_t>> histogram; //!< (クラスタの細胞数, その大きさのクラスタの数)。細胞数の昇順
+    };
+
+    static Summary label(CellSnapshot& snapshot);
+
+    static void writeHeader(std::ostream& os);
+    static void writeSummary(std::ostream& os, const Summary& summary);
+    static void resumeSummary(const std::string& path, int32_t lastOutput);
+};
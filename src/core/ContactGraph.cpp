@@ -0,0 +1,138 @@
+/**
+ * @file ContactGraph.cpp
+ * @author Takanori Saiki
+ * @brief 力の計算で見つけた細胞どうしの接触(重なり)をCSR形式で持つクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ContactGraph.hpp"
+#include <algorithm>
+#include <omp.h>
+
+ContactGraph::ContactGraph()
+{
+}
+
+ContactGraph::~ContactGraph()
+{
+}
+
+/**
+ * @brief 行の数をrowCountにして、すべての行を空にする。スレッドのバッファは確保したまま使い回す。
+ * @details 並列領域の外で呼ぶ。バッファはomp_get_max_threads()個用意する。
+ *
+ * @param rowCount
+ */
+void ContactGraph::reset(int32_t rowCount)
+{
+    buffers.resize(std::max(omp_get_max_threads(), 1));
+    for (Buffer& buffer : buffers) {
+        buffer.ids.clear();
+    }
+
+    rowThread.assign(rowCount, -1);
+    rowBegin.assign(rowCount, 0);
+    offsets.assign(rowCount + 1, 0);
+    contacts.clear();
+}
+
+/**
+ * @brief 行rowの接触相手をidsにする。行ごとに1回だけ呼ぶ。
+ * @details 今のスレッドのバッファに足すだけなので、別の行なら複数のスレッドから同時に呼べる。
+ *          行の数を超えた添字は無視する。
+ *
+ * @param row Simulation::cellsの添字
+ * @param ids 接触相手のCell::id
+ */
+void ContactGraph::addRow(int32_t row, std::span<const int32_t> ids) noexcept
+{
+    if (row < 0 || rowCount() <= row || ids.empty()) {
+        return;
+    }
+
+    const int32_t thread = omp_get_thread_num();
+    Buffer& buffer       = buffers[thread];
+
+    rowThread[row]   = thread;
+    rowBegin[row]    = (int32_t)buffer.ids.size();
+    offsets[row + 1] = (int32_t)ids.size();
+    buffer.ids.insert(buffer.ids.end(), ids.begin(), ids.end());
+}
+
+/**
+ * @brief 行ごとの数の累積和をoffsetsにし、スレッドのバッファからcontactsに行の順で写す。並列領域の外で呼ぶ。
+ */
+void ContactGraph::finish()
+{
+    const int32_t rows = rowCount();
+    for (int32_t i = 0; i < rows; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    contacts.resize(offsets.back());
+
+#pragma omp parallel for
+    for (int32_t i = 0; i < rows; i++) {
+        if (rowThread[i] < 0) {
+            continue;
+        }
+
+        const int32_t* src = buffers[rowThread[i]].ids.data() + rowBegin[i];
+        std::copy(src, src + (offsets[i + 1] - offsets[i]), contacts.begin() + offsets[i]);
+    }
+}
+
+/**
+ * @brief 行を並べ替える。新しい行iは元の行order[i]。orderに入っていない行は捨てる。
+ * @details Simulation::compactCellsでcellsを並べ替えたときに、行をcellsの添字と合わせるために呼ぶ。接触相手はCell::idなので変わらない。
+ *
+ * @param order
+ */
+void ContactGraph::reorderRows(const std::vector<int32_t>& order)
+{
+    std::vector<int32_t> newOffsets(order.size() + 1, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        newOffsets[i + 1] = newOffsets[i] + degree(order[i]);
+    }
+
+    std::vector<int32_t> newContacts(newOffsets.back());
+#pragma omp parallel for
+    for (int32_t i = 0; i < (int32_t)order.size(); i++) {
+        const std::span<const int32_t> row = contactsOf(order[i]);
+        std::copy(row.begin(), row.end(), newContacts.begin() + newOffsets[i]);
+    }
+
+    offsets.swap(newOffsets);
+    contacts.swap(newContacts);
+    rowThread.clear();
+    rowBegin.clear();
+}
+
+/**
+ * @brief 行の数(最後に力を計算したときのSimulation::cellsの大きさ)
+ */
+int32_t ContactGraph::rowCount() const noexcept
+{
+    return (int32_t)offsets.size() - 1;
+}
+
+/**
+ * @brief 接触の数。1つの接触は両方の細胞の行に現れるので、組の数の2倍になる。
+ */
+int64_t ContactGraph::size() const noexcept
+{
+    return (int64_t)contacts.size();
+}
+
+const std::vector<int32_t>& ContactGraph::getOffsets() const noexcept
+{
+    return offsets;
+}
+
+const std::vector<int32_t>& ContactGraph::getContacts() const noexcept
+{
+    return contacts;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file ContactGraph.hpp
+ * @author Takanori Saiki
+ * @brief 力の計算で見つけた細胞どうしの接触(重なり)をCSR形式で持つクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @class ContactGraph
+ * @brief 細胞どうしの接触(中心間の距離 < 半径の和)の隣接リスト。行はSimulation::cellsの添字、行の中身は接触相手のCell::id。
+ * @details Simulation::nextStepの力の計算で、近傍の細胞との距離を求めるついでに作る。
+ *          1. reset(): 行の数を決め、スレッドごとのバッファを空にする(並列領域の外)
+ *          2. addRow(): 行ごとに1回、接触相手を今のスレッドのバッファの末尾に足す(並列領域の中で呼べる)
+ *          3. finish(): 行ごとの数の累積和をoffsetsにし、スレッドのバッファからcontactsに並列に写す(並列領域の外)
+ *          細胞ごとのvectorは持たないので、細胞の数によらずメモリの確保はスレッドごとのバッファとCSRの配列だけで済む。
+ *          接触は両方の細胞の行に現れる(cがdに接触していれば、dの行にもcが入る)。
+ *          reset()からfinish()までの間はcontactsOf()などを使えない。
+ */
+class ContactGraph
+{
+  private:
+    /**
+     * @brief 1つのスレッドが書き込んだ接触。隣のスレッドのBufferと同じキャッシュラインに乗らないようにそろえる
+     */
+    struct alignas(64) Buffer {
+        std::vector<int32_t> ids; //!< 接触相手のCell::id。行ごとに連続する
+    };
+
+    std::vector<Buffer> buffers;          //!< スレッドごとのバッファ
+    std::vector<int32_t> rowThread;       //!< 行を書き込んだスレッド。-1なら接触なし
+    std::vector<int32_t> rowBegin;        //!< 行がバッファのどこから始まるか
+    std::vector<int32_t> offsets = { 0 }; //!< 行iの接触相手はcontacts[offsets[i] : offsets[i + 1]]。要素数は行の数 + 1
+    std::vector<int32_t> contacts;        //!< 接触相手のCell::id
+
+  public:
+    ContactGraph();
+    ~ContactGraph();
+
+    void reset(int32_t rowCount);
+    void addRow(int32_t row, std::span<const int32_t> ids) noexcept;
+    void finish();
+    void reorderRows(const std::vector<int32_t>& order);
+
+    int32_t rowCount() const noexcept;
+    int64_t size() const noexcept;
+    int32_t degree(int32_t row) const noexcept;
+    std::span<const int32_t> contactsOf(int32_t row) const noexcept;
+
+    const std::vector<int32_t>& getOffsets() const noexcept;
+    const std::vector<int32_t>& getContacts() const noexcept;
+};
+
+/**
+ * @brief 行rowの接触の数。行の数を超えた添字(力の計算の後に加わった細胞)は0
+ */
+inline int32_t ContactGraph::degree(int32_t row) const noexcept
+{
+    if (row < 0 || rowCount() <= row) {
+        return 0;
+    }
+
+    return offsets[row + 1] - offsets[row];
+}
+
+/**
+ * @brief 行rowの接触相手のCell::id。行の数を超えた添字は空
+ */
+inline std::span<const int32_t> ContactGraph::contactsOf(int32_t row) const noexcept
+{
+    if (row < 0 || rowCount() <= row) {
+        return {};
+    }
+
+    return std::span<const int32_t>(contacts.data() + offsets[row], offsets[row + 1] - offsets[row]);
+}
@@ -0,0 +1,201 @@
+/**
+ * @file InteractionMatrix.cpp
+ * @author Takanori Saiki
+ * @brief 細胞の種類の組ごとの相互作用のパラメータ(遠隔力の係数、λ、体積排除と接着の強さ)の表
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "InteractionMatrix.hpp"
+#include "../thirdparty/nameof.hpp"
+#include <stdexcept>
+
+/**
+ * @brief すべての組が無効な表を作る。
+ *
+ */
+InteractionMatrix::InteractionMatrix()
+  : typeNum(cellTypeNum())
+  , table((size_t)typeNum * typeNum, Interaction{ 0.0, 30.0, 0.0, 0.0, false })
+  , remoteSources(typeNum, false)
+{
+}
+
+/**
+ * @brief 既定の表。WORKERどうしだけが遠隔力で引き合い、WORKERとDEADはNONE以外のすべての細胞と体積排除・接着で作用する。
+ * @details config.yamlにinteractionがない場合に使う。UserSimulationの以前の場合分けと同じ力になる。
+ *
+ * @param lambda 遠隔力の減衰距離
+ * @return InteractionMatrix
+ */
+InteractionMatrix InteractionMatrix::standard(double lambda)
+{
+    InteractionMatrix matrix;
+
+    for (int32_t s = 0; s < matrix.typeNum; s++) {
+        const CellType source = (CellType)s;
+        if (source == CellType::NONE) {
+            continue;
+        }
+
+        Interaction interaction;
+        interaction.lambda  = lambda;
+        interaction.enabled = true;
+        matrix.set(CellType::DEAD, source, interaction);
+
+        interaction.remoteCoefficient = source == CellType::WORKER ? 1.0 : 0.0;
+        matrix.set(CellType::WORKER, source, interaction);
+    }
+
+    return matrix;
+}
+
+/**
+ * @brief CellTypeの種類の数。列挙子の名前が取れる値を0から数える。
+ *
+ * @return int32_t
+ */
+int32_t InteractionMatrix::cellTypeNum() noexcept
+{
+    static const int32_t num = [] {
+        int32_t n = 0;
+        while (!NAMEOF_ENUM((CellType)n).empty()) {
+            n++;
+        }
+        return n;
+    }();
+
+    return num;
+}
+
+/**
+ * @brief 名前(WORKERなど)からCellTypeを返す。
+ * @note 知らない名前なら例外を投げる。
+ *
+ * @param name
+ * @return CellType
+ */
+CellType InteractionMatrix::parseCellType(const std::string& name)
+{
+    for (int32_t t = 0; t < cellTypeNum(); t++) {
+        if (NAMEOF_ENUM((CellType)t) == name) {
+            return (CellType)t;
+        }
+    }
+
+    throw std::invalid_argument("unknown cell type: " + name);
+}
+
+/**
+ * @brief config.yamlのinteraction(組のリスト)から表を作り直す。書かなかった組は無効になる。
+ * @details 各要素は次のキーを持つ。receiverとsourceは1つの名前か名前のリスト。
+ *          - receiver: 力を受ける細胞の種類
+ *          - source: 力を及ぼす細胞の種類
+ *          - remote_coefficient: 遠隔力の係数(既定値0)
+ *          - lambda: 遠隔力の減衰距離(既定値defaultLambda)
+ *          - exclusion_bias, adhesion_bias: 体積排除と接着の強さ(既定値10、0.4)
+ *          - enabled: falseなら無効(既定値true)
+ *          知らない種類の名前やλ <= 0はstd::invalid_argumentを投げる。
+ *
+ * @param node config["interaction"]
+ * @param defaultLambda lambdaを書かなかった組のλ
+ */
+void InteractionMatrix::load(const YAML::Node& node, double defaultLambda)
+{
+    if (!node.IsSequence()) {
+        throw std::invalid_argument("interaction must be a list of receiver/source pairs");
+    }
+
+    auto readTypes = [](const YAML::Node& names) {
+        std::vector<CellType> types;
+        if (names.IsSequence()) {
+            for (const auto& name : names) {
+                types.push_back(parseCellType(name.as<std::string>()));
+            }
+        } else {
+            types.push_back(parseCellType(names.as<std::string>()));
+        }
+        return types;
+    };
+
+    *this = InteractionMatrix();
+    for (const auto& entry : node) {
+        Interaction interaction;
+        interaction.remoteCoefficient = entry["remote_coefficient"].as<double>(0.0);
+        interaction.lambda            = entry["lambda"].as<double>(defaultLambda);
+        interaction.exclusionBias     = entry["exclusion_bias"].as<double>(DEFAULT_EXCLUSION_BIAS);
+        interaction.adhesionBias      = entry["adhesion_bias"].as<double>(DEFAULT_ADHESION_BIAS);
+        interaction.enabled           = entry["enabled"].as<bool>(true);
+        if (interaction.lambda <= 0.0) {
+            throw std::invalid_argument("lambda must be positive");
+        }
+
+        for (const CellType receiver : readTypes(entry["receiver"])) {
+            for (const CellType source : readTypes(entry["source"])) {
+                set(receiver, source, interaction);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 1つの組のパラメータを設定する。無効な組は係数を0にして入れる。
+ *
+ * @param receiver 力を受ける細胞の種類
+ * @param source 力を及ぼす細胞の種類
+ * @param interaction
+ */
+void InteractionMatrix::set(CellType receiver, CellType source, const Interaction& interaction) noexcept
+{
+    Interaction& entry = table[(int32_t)receiver * typeNum + (int32_t)source];
+    entry              = interaction;
+    if (!entry.enabled) {
+        entry.remoteCoefficient = 0.0;
+        entry.exclusionBias     = 0.0;
+        entry.adhesionBias      = 0.0;
+    }
+
+    updateRemoteSources();
+}
+
+void InteractionMatrix::updateRemoteSources() noexcept
+{
+    for (int32_t s = 0; s < typeNum; s++) {
+        remoteSources[s] = false;
+        for (int32_t r = 0; r < typeNum; r++) {
+            remoteSources[s] = remoteSources[s] || table[r * typeNum + s].remoteCoefficient != 0.0;
+        }
+    }
+}
+
+/**
+ * @brief sourceの種類の細胞が、どれかの種類の細胞に遠隔力を及ぼすか。Barnes-Hut法などで遠隔力の発生源を選ぶのに使う。
+ *
+ * @param source
+ * @return bool
+ */
+bool InteractionMatrix::isRemoteSource(CellType source) const noexcept
+{
+    return remoteSources[(int32_t)source];
+}
+
+/**
+ * @brief receiverの種類の細胞が、どれかの種類の細胞から遠隔力を受けるか。
+ *
+ * @param receiver
+ * @return bool
+ */
+bool InteractionMatrix::receivesRemote(CellType receiver) const noexcept
+{
+    const Interaction* entries = row(receiver);
+    for (int32_t s = 0; s < typeNum; s++) {
+        if (entries[s].remoteCoefficient != 0.0) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file InteractionMatrix.hpp
+ * @author Takanori Saiki
+ * @brief 細胞の種類の組ごとの相互作用のパラメータ(遠隔力の係数、λ、体積排除と接着の強さ)の表
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../CellType.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+/**
+ * @class InteractionMatrix
+ * @brief 力を受ける細胞の種類(receiver)と力を及ぼす細胞の種類(source)の組ごとに、相互作用のパラメータを持つ表。
+ * @details 表は receiver * 種類の数 + source の1次元の配列なので、力の計算では種類を添字にして引くだけで済み、
+ *          種類ごとの場合分けがいらない。無効(enabled = false)の組は係数をすべて0にしておくので、
+ *          計算しても力は0になる。
+ *          config.yamlのinteractionから読み込む(load())。書かなかった場合はstandard()の表を使う。
+ */
+class InteractionMatrix
+{
+  public:
+    static constexpr double DEFAULT_EXCLUSION_BIAS = 10.0; //!< 体積排除の強さの既定値
+    static constexpr double DEFAULT_ADHESION_BIAS  = 0.4;  //!< 接着の強さの既定値
+
+    /**
+     * @brief 1つの組の相互作用のパラメータ
+     */
+    struct Interaction {
+        double remoteCoefficient = 0.0;                    //!< 遠隔力の係数。0なら遠隔力を受けない
+        double lambda            = 30.0;                   //!< 遠隔力の減衰距離(e^(-d/λ)のλ)
+        double exclusionBias     = DEFAULT_EXCLUSION_BIAS; //!< 重なったときに押し返す強さ
+        double adhesionBias      = DEFAULT_ADHESION_BIAS;  //!< 重なったときに引き合う強さ
+        bool enabled             = false;                  //!< falseなら力を及ぼさない
+    };
+
+  private:
+    int32_t typeNum;                 //!< 細胞の種類の数
+    std::vector<Interaction> table;  //!< [receiver * typeNum + source]
+    std::vector<bool> remoteSources; //!< 種類ごとに、遠隔力を及ぼす相手がいるか
+
+    void updateRemoteSources() noexcept;
+
+  public:
+    InteractionMatrix();
+
+    static InteractionMatrix standard(double lambda);
+    static int32_t cellTypeNum() noexcept;
+    static CellType parseCellType(const std::string& name);
+
+    void load(const YAML::Node& node, double defaultLambda);
+    void set(CellType receiver, CellType source, const Interaction& interaction) noexcept;
+
+    const Interaction& get(CellType receiver, CellType source) const noexcept;
+    const Interaction* row(CellType receiver) const noexcept;
+    bool isRemoteSource(CellType source) const noexcept;
+    bool receivesRemote(CellType receiver) const noexcept;
+};
+
+/**
+ * @brief receiverがsourceから受ける相互作用のパラメータ
+ */
+inline const InteractionMatrix::Interaction& InteractionMatrix::get(CellType receiver, CellType source) const noexcept
+{
+    return table[(int32_t)receiver * typeNum + (int32_t)source];
+}
+
+/**
+ * @brief receiverの行の先頭。row(receiver)[(int32_t)source]がget(receiver, source)になる。
+ */
+inline const InteractionMatrix::Interaction* InteractionMatrix::row(CellType receiver) const noexcept
+{
+    return &table[(int32_t)receiver * typeNum];
+}
@@ -0,0 +1,184 @@
+/**
+ * @file MoleculeGrid.cpp
+ * @author Takanori Saiki
+ * @brief 分子空間の格子の値をコピーしたもの(出力用)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MoleculeGrid.hpp"
+#include "../utils/BinaryIO.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief 境界部分を含めた値の数を返す。
+ *
+ * @return size_t
+ */
+size_t MoleculeGrid::valueCount() const noexcept
+{
+    return (size_t)(width + 2) * (height + 2) * (depth + 2);
+}
+
+/**
+ * @brief 格子の値をテキストで書き込む。
+ * @details depth == 1の場合は境界部分も含めてxごとに1行、それ以外は境界を除いてyごとに"|"で区切る。
+ *
+ * @param os
+ */
+void MoleculeGrid::writeText(std::ostream& os) const
+{
+    if (depth == 1) {
+        for (u_int32_t x = 0; x <= width + 1; x++) {
+            for (u_int32_t y = 0; y <= height + 1; y++) {
+                os << at(x, y, 1) << " ";
+            }
+            os << "\n";
+        }
+
+        return;
+    }
+
+    for (u_int32_t x = 1; x <= width; x++) {
+        for (u_int32_t y = 1; y <= height; y++) {
+            for (u_int32_t z = 1; z <= depth; z++) {
+                os << at(x, y, z) << " ";
+            }
+            os << "|";
+        }
+        os << "\n";
+    }
+}
+
+/**
+ * @brief バイナリ形式で書き込む。形式は構造体のコメントを参照。
+ *
+ * @param os バイナリモードで開いたストリーム
+ * @param useFloat32 圧縮しない場合に、実数をfloat32に落として書き込むかどうか
+ * @param compression NONE以外ならFieldCodecで圧縮する(useFloat32は無視する)
+ * @param errorBound compressionがLOSSYのときの誤差の上限
+ */
+void MoleculeGrid::writeBinary(std::ostream& os, bool useFloat32, CompressionMode compression, double errorBound) const
+{
+    const bool compressed = compression != CompressionMode::NONE;
+    uint32_t flags        = 0;
+    if (compressed) {
+        flags |= FLAG_COMPRESSED;
+    } else if (useFloat32) {
+        flags |= FLAG_FLOAT32;
+    }
+
+    BinaryIO::writeValue(os, width);
+    BinaryIO::writeValue(os, height);
+    BinaryIO::writeValue(os, depth);
+    BinaryIO::writeValue(os, flags);
+
+    if (compressed) {
+        FieldCodec::encode(os, values, compression, errorBound);
+    } else if (useFloat32) {
+        std::vector<float> downcast(values.begin(), values.end());
+        BinaryIO::writeArray(os, downcast.data(), downcast.size());
+    } else {
+        BinaryIO::writeArray(os, values.data(), values.size());
+    }
+}
+
+/**
+ * @brief writeBinaryで書き込んだ格子を読み込む。float32で書かれていた場合はdoubleに戻す。
+ *
+ * @param is
+ * @return MoleculeGrid
+ */
+MoleculeGrid MoleculeGrid::readBinary(std::istream& is)
+{
+    MoleculeGrid grid;
+    grid.width           = BinaryIO::readValue<uint32_t>(is);
+    grid.height          = BinaryIO::readValue<uint32_t>(is);
+    grid.depth           = BinaryIO::readValue<uint32_t>(is);
+    const uint32_t flags = BinaryIO::readValue<uint32_t>(is);
+    const size_t count   = grid.valueCount();
+
+    if (flags & FLAG_COMPRESSED) {
+        grid.values = FieldCodec::decode(is);
+        if (grid.values.size() != count) {
+            throw std::runtime_error("MoleculeGrid::readBinary() : value count mismatch.");
+        }
+    } else if (flags & FLAG_FLOAT32) {
+        std::vector<float> buf(count);
+        BinaryIO::readArray(is, buf.data(), count);
+        grid.values.assign(buf.begin(), buf.end());
+    } else {
+        grid.values.resize(count);
+        BinaryIO::readArray(is, grid.values.data(), count);
+    }
+
+    return grid;
+}
+
+/**
+ * @brief MAGICとVERSIONを付けて1つのファイルに書き込む。
+ *
+ * @param path
+ * @param useFloat32
+ * @param compression
+ * @param errorBound
+ */
+void MoleculeGrid::save(const std::string& path, bool useFloat32, CompressionMode compression, double errorBound) const
+{
+    std::ofstream ofs(path, std::ios::binary);
+    BinaryIO::writeArray(ofs, MAGIC, 8);
+    BinaryIO::writeValue(ofs, VERSION);
+    writeBinary(ofs, useFloat32, compression, errorBound);
+
+    if (!ofs) {
+        throw std::runtime_error("MoleculeGrid::save() : failed to write " + path + ".");
+    }
+}
+
+/**
+ * @brief ストリームの先頭がMAGICかどうかを調べる。ストリームの位置は元に戻す。
+ *
+ * @param is
+ * @return bool
+ */
+bool MoleculeGrid::isBinary(std::istream& is)
+{
+    const auto pos = is.tellg();
+    char magic[8]  = {};
+    is.read(magic, 8);
+    const bool result = is.gcount() == 8 && std::equal(magic, magic + 8, MAGIC);
+    is.clear();
+    is.seekg(pos);
+
+    return result;
+}
+
+/**
+ * @brief save()で書き込んだファイルを読み込む。
+ *
+ * @param path
+ * @return MoleculeGrid
+ */
+MoleculeGrid MoleculeGrid::load(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("MoleculeGrid::load() : cannot open " + path + ".");
+    }
+    if (!isBinary(ifs)) {
+        throw std::runtime_error("MoleculeGrid::load() : " + path + " is not a molecule grid.");
+    }
+
+    ifs.seekg(8);
+    const uint32_t version = BinaryIO::readValue<uint32_t>(ifs);
+    if (version > VERSION) {
+        throw std::runtime_error("MoleculeGrid::load() : unsupported version " + std::to_string(version) + ".");
+    }
+
+    return readBinary(ifs);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file MoleculeGrid.hpp
+ * @author Takanori Saiki
+ * @brief 分子空間の格子の値をコピーしたもの(出力用)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../utils/FieldCodec.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @brief 分子空間の格子の値をコピーしたもの。出力スレッドに渡すために使う。
+ * @details 値は境界部分も含めて(width + 2) * (height + 2) * (depth + 2)個をx, y, zの順に並べる。
+ * バイナリ形式は次の通り。数値はすべてリトルエンディアン。
+ * @code
+ * uint32   width, height, depth
+ * uint32   flags       bit0 : float32で書いた, bit1 : FieldCodecで圧縮した
+ * values               圧縮していなければ実数をそのまま並べる。圧縮した場合はFieldCodecの形式
+ * @endcode
+ * save()で書くファイルは先頭にMAGICとVERSION(uint32)を付ける。
+ */
+struct MoleculeGrid
+{
+    static constexpr char MAGIC[8]            = { 'M', 'C', 'M', 'C', 'G', 'R', 'I', 'D' };
+    static constexpr uint32_t VERSION         = 1;
+    static constexpr uint32_t FLAG_FLOAT32    = 1u << 0;
+    static constexpr uint32_t FLAG_COMPRESSED = 1u << 1;
+
+    u_int32_t width;  // x方向の格子数(境界を除く)
+    u_int32_t height; // y方向の格子数(境界を除く)
+    u_int32_t depth;  // z方向の格子数(境界を除く)
+    std::vector<double> values;
+
+    double at(u_int32_t x, u_int32_t y, u_int32_t z) const noexcept;
+    size_t valueCount() const noexcept;
+
+    void writeText(std::ostream& os) const;
+    void writeBinary(std::ostream& os, bool useFloat32, CompressionMode compression, double errorBound) const;
+    static MoleculeGrid readBinary(std::istream& is);
+
+    void save(const std::string& path, bool useFloat32, CompressionMode compression, double errorBound) const;
+    static bool isBinary(std::istream& is);
+    static MoleculeGrid load(const std::string& path);
+};
+
+/**
+ * @brief 格子(x, y, z)の値を返す。添字は境界部分を0とする。
+ */
+inline double MoleculeGrid::at(u_int32_t x, u_int32_t y, u_int32_t z) const noexcept
+{
+    return values[((size_t)x * (height + 2) + y) * (depth + 2) + z];
+}
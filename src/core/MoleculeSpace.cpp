@@ -1,4 +1,6 @@
 #include "MoleculeSpace.hpp"
+#include "../utils/BinaryIO.hpp"
+#include <algorithm>
 
 // Distribution::Distribution(/* args */)
 // {
@@ -29,10 +31,11 @@
 // }
 
 // 3次元拡散方程式の参考文献 https://cvtech.cc/diffusion3d/
+// 格子がfloat(StorageReal)でも、差分はdoubleで足す
 double MoleculeSpace::diffuse(int32_t x, int32_t y, int32_t z)
 {
     return D *
-           (moleculeSpace[x + 1][y][z] + moleculeSpace[x - 1][y][z] + moleculeSpace[x][y + 1][z]   //
+           ((double)moleculeSpace[x + 1][y][z] + moleculeSpace[x - 1][y][z] + moleculeSpace[x][y + 1][z]   //
             + moleculeSpace[x][y - 1][z] + moleculeSpace[x][y][z + 1] + moleculeSpace[x][y][z - 1] //
             - 6.0 * moleculeSpace[x][y][z]) /
            (dr * dr);
@@ -53,7 +56,7 @@ double MoleculeSpace::advection(int32_t x, int32_t y, int32_t z)
     return 0.0;
 }
 
-void MoleculeSpace::setupBoundary(Field3D<double>& ms, MoleculeSpaceBorderType borderType)
+void MoleculeSpace::setupBoundary(Field3D<StorageReal>& ms, MoleculeSpaceBorderType borderType)
 {
     switch (borderType) {
         case MoleculeSpaceBorderType::NEUMANN:
@@ -147,8 +150,8 @@ MoleculeSpace::MoleculeSpace(const u_int64_t moleculeNum, const MoleculeDistribu
   , ID(ID)
 {
     std::mt19937 randGen(0); // TODO: シード値を変更できるようにする
-    moleculeSpace      = make_vector<double>({ (size_t)(width + 2), (size_t)(height + 2), (size_t)(depth + 2) });
-    deltaMoleculeSpace = make_vector<double>({ (size_t)(width + 2), (size_t)(height + 2), (size_t)(depth + 2) });
+    moleculeSpace      = make_vector<StorageReal>({ (size_t)(width + 2), (size_t)(height + 2), (size_t)(depth + 2) });
+    deltaMoleculeSpace = make_vector<StorageReal>({ (size_t)(width + 2), (size_t)(height + 2), (size_t)(depth + 2) });
 
     switch (distributionType) {
         case MoleculeDistributionType::UNIFORM: {
@@ -251,10 +254,13 @@ MoleculeSpace::~MoleculeSpace()
 
 void MoleculeSpace::calcConcentrationDiff() noexcept
 {
-    for (int32_t x = 1; x <= width; x++) {
-        for (int32_t y = 1; y <= height; y++) {
-            for (int32_t z = 1; z <= depth; z++) {
-                deltaMoleculeSpace[x][y][z] = diffuse(x, y, z) + production(x, y, z) - decay(x, y, z) - advection(x, y, z);
+    {
+        ProfileScope scope("diffusion");
+        for (int32_t x = 1; x <= width; x++) {
+            for (int32_t y = 1; y <= height; y++) {
+                for (int32_t z = 1; z <= depth; z++) {
+                    deltaMoleculeSpace[x][y][z] = diffuse(x, y, z) + production(x, y, z) - decay(x, y, z) - advection(x, y, z);
+                }
             }
         }
     }
@@ -262,6 +268,7 @@ void MoleculeSpace::calcConcentrationDiff() noexcept
     const int32_t width  = SimulationSettings::FIELD_X_LEN;
     const int32_t height = SimulationSettings::FIELD_Y_LEN;
     const int32_t depth  = SimulationSettings::FIELD_Z_LEN;
+    ProfileScope scope("emission");
     for (u_int32_t i = 0; i < cells.size(); i++) {
         std::shared_ptr<UserCell> cell = cells[i];
 
@@ -275,6 +282,7 @@ void MoleculeSpace::calcConcentrationDiff() noexcept
 
 void MoleculeSpace::nextStep() noexcept
 {
+    ProfileScope scope("update");
     // #pragma omp parallel for
     for (int32_t x = 1; x <= width; x++) {
         for (int32_t y = 1; y <= height; y++) {
@@ -300,26 +308,76 @@ double MoleculeSpace::getMoleculeNum(Vec3 pos) const noexcept
     return moleculeSpace[(int)x][(int)y][(int)z];
 }
 
+/**
+ * @brief 現在の分子空間の値を境界部分も含めてコピーする。
+ *
+ * @return MoleculeGrid
+ */
+MoleculeGrid MoleculeSpace::exportGrid() const
+{
+    MoleculeGrid grid{ width, height, depth, {} };
+    grid.values.reserve((size_t)(width + 2) * (height + 2) * (depth + 2));
+
+    for (u_int32_t x = 0; x <= width + 1; x++) {
+        for (u_int32_t y = 0; y <= height + 1; y++) {
+            grid.values.insert(grid.values.end(), moleculeSpace[x][y].begin(), moleculeSpace[x][y].end());
+        }
+    }
+
+    return grid;
+}
+
 void MoleculeSpace::print() const noexcept
 {
-    if (depth == 1) {
-        for (int x = 0; x <= width + 1; x++) {
-            for (int y = 0; y <= height + 1; y++) {
-                std::cout << moleculeSpace[x][y][1] << " ";
+    exportGrid().writeText(std::cout);
+}
+
+/**
+ * @brief チェックポイント用に、分子の総数と格子(増減分を含む)を境界部分も含めて書き込む。
+ * @details 格子の値はStorageRealによらずdoubleで書くので、floatでビルドしたものとチェックポイントをやり取りできる。
+ *
+ * @param os
+ */
+void MoleculeSpace::writeState(std::ostream& os) const
+{
+    BinaryIO::writeValue(os, width);
+    BinaryIO::writeValue(os, height);
+    BinaryIO::writeValue(os, depth);
+    BinaryIO::writeValue(os, moleculeNum);
+
+    std::vector<double> line(depth + 2);
+    for (const Field3D<StorageReal>* field : { &moleculeSpace, &deltaMoleculeSpace }) {
+        for (u_int32_t x = 0; x <= width + 1; x++) {
+            for (u_int32_t y = 0; y <= height + 1; y++) {
+                std::copy((*field)[x][y].begin(), (*field)[x][y].end(), line.begin());
+                BinaryIO::writeArray(os, line.data(), depth + 2);
             }
-            std::cout << std::endl;
         }
-
-        return;
     }
+}
 
-    for (int x = 1; x <= width; x++) {
-        for (int y = 1; y <= height; y++) {
-            for (int z = 1; z <= depth; z++) {
-                std::cout << moleculeSpace[x][y][z] << " ";
+/**
+ * @brief writeState()で書き込んだ状態を読み込む。格子の大きさが違う場合は例外を投げる。
+ *
+ * @param is
+ */
+void MoleculeSpace::readState(std::istream& is)
+{
+    const u_int32_t w = BinaryIO::readValue<u_int32_t>(is);
+    const u_int32_t h = BinaryIO::readValue<u_int32_t>(is);
+    const u_int32_t d = BinaryIO::readValue<u_int32_t>(is);
+    if (w != width || h != height || d != depth) {
+        throw std::runtime_error("MoleculeSpace::readState() : grid size mismatch.");
+    }
+    moleculeNum = BinaryIO::readValue<u_int64_t>(is);
+
+    std::vector<double> line(depth + 2);
+    for (Field3D<StorageReal>* field : { &moleculeSpace, &deltaMoleculeSpace }) {
+        for (u_int32_t x = 0; x <= width + 1; x++) {
+            for (u_int32_t y = 0; y <= height + 1; y++) {
+                BinaryIO::readArray(is, line.data(), depth + 2);
+                std::copy(line.begin(), line.end(), (*field)[x][y].begin());
             }
-            std::cout << "|";
         }
-        std::cout << std::endl;
     }
 }
\ No newline at end of file
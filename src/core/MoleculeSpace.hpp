@@ -15,8 +15,11 @@
 #include "../UserCell.hpp"
 #include "../thirdparty/nameof.hpp"
 #include "../utils/MakeVector.hpp"
+#include "../utils/Precision.hpp"
+#include "../utils/Profiler.hpp"
 #include "../utils/Util.hpp"
 #include "../utils/Vec3.hpp"
+#include "MoleculeGrid.hpp"
 #include <random>
 
 enum class MoleculeDistributionType
@@ -59,8 +62,8 @@ class MoleculeSpace
     u_int64_t moleculeNum;              // 現在の分子の総数
     MoleculeSpaceBorderType borderType; // 境界条件の種類
 
-    Field3D<double> deltaMoleculeSpace;            // 次のステップでの分子の増減を格納する空間
-    Field3D<double> moleculeSpace;                 // 分子を扱う空間。各格子に分子の数を格納する。
+    Field3D<StorageReal> deltaMoleculeSpace;       // 次のステップでの分子の増減を格納する空間
+    Field3D<StorageReal> moleculeSpace;            // 分子を扱う空間。各格子に分子の数を格納する。
     std::vector<std::shared_ptr<UserCell>>& cells; // 格子の情報を格納する配列
 
     const double D; // 拡散係数
@@ -71,7 +74,7 @@ class MoleculeSpace
     double decay(int32_t x, int32_t y, int32_t z);
     double advection(int32_t x, int32_t y, int32_t z);
 
-    void setupBoundary(Field3D<double>& ms, MoleculeSpaceBorderType borderType);
+    void setupBoundary(Field3D<StorageReal>& ms, MoleculeSpaceBorderType borderType);
 
   public:
     MoleculeSpace(const u_int64_t moleculeNum, const MoleculeDistributionType distributionType, const MoleculeSpaceBorderType borderType, std::vector<std::shared_ptr<UserCell>>& cells,
@@ -83,5 +86,9 @@ class MoleculeSpace
 
     double getMoleculeNum(Vec3 pos) const noexcept;
 
+    MoleculeGrid exportGrid() const;
     void print() const noexcept;
+
+    void writeState(std::ostream& os) const;
+    void readState(std::istream& is);
 };
\ No newline at end of file
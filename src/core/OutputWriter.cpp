@@ -0,0 +1,163 @@
+/**
+ * @file OutputWriter.cpp
+ * @author Takanori Saiki
+ * @brief 結果の書き出しを別スレッドで行うクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "OutputWriter.hpp"
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+/**
+ * @brief asyncがtrueの場合は書き出しスレッドを起動する。
+ *
+ * @param async 別スレッドで書き出すかどうか
+ * @param maxPendingJobs ためておけるジョブの数の上限(1以上)
+ */
+OutputWriter::OutputWriter(bool async, size_t maxPendingJobs)
+  : async(async)
+  , maxPendingJobs(maxPendingJobs < 1 ? 1 : maxPendingJobs)
+{
+    if (async) {
+        worker = std::thread(&OutputWriter::workerLoop, this);
+    }
+}
+
+/**
+ * @brief 残っているジョブをすべて実行してからスレッドを終了する。
+ * @details まだ投げ直していない失敗があれば投げる。ただし、別の例外で巻き戻している最中は標準エラー出力に書くだけにする。
+ *
+ */
+OutputWriter::~OutputWriter() noexcept(false)
+{
+    if (!async) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    jobAdded.notify_all();
+    worker.join();
+
+    if (std::uncaught_exceptions() > 0) {
+        if (failure) {
+            try {
+                std::rethrow_exception(failure);
+            } catch (const std::exception& e) {
+                std::cerr << "OutputWriter: " << e.what() << std::endl;
+            }
+        }
+        return;
+    }
+    rethrowFailure();
+}
+
+/**
+ * @brief ジョブを登録する。未処理のジョブが上限に達している場合は空くまで待つ。
+ * @details それまでのジョブが書き出しスレッドで失敗していた場合は、登録せずにその例外を投げる。
+ *
+ * @param job 書き出し処理。必要なデータはすべてキャプチャしておくこと。
+ */
+void OutputWriter::submit(std::function<void()> job)
+{
+    if (!async) {
+        job();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    rethrowFailure();
+    if (jobs.size() >= maxPendingJobs) {
+        auto start = std::chrono::steady_clock::now();
+        jobFinished.wait(lock, [this] { return jobs.size() < maxPendingJobs; });
+        stallMillis += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    jobs.emplace_back(std::move(job));
+    lock.unlock();
+
+    jobAdded.notify_one();
+}
+
+/**
+ * @brief 登録済みのジョブがすべて書き終わるまで待つ。失敗したジョブがあればその例外を投げる。
+ *
+ */
+void OutputWriter::flush()
+{
+    if (!async) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    jobFinished.wait(lock, [this] { return jobs.empty() && !isWriting; });
+    rethrowFailure();
+}
+
+/**
+ * @brief 書き出しスレッドで失敗したジョブがあれば、その例外を投げて失敗を空に戻す。mtxを取った状態で呼ぶ(デストラクタではスレッドの終了後に呼ぶ)。
+ *
+ */
+void OutputWriter::rethrowFailure()
+{
+    if (failure) {
+        std::rethrow_exception(std::exchange(failure, nullptr));
+    }
+}
+
+/**
+ * @brief submit()が空きを待った合計時間(ミリ秒)を返す。書き出しが計算に追いついていない目安になる。
+ *
+ * @return double
+ */
+double OutputWriter::getStallMillis() noexcept
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return stallMillis;
+}
+
+/**
+ * @brief 書き出しスレッドの本体。ジョブがなくなり、かつstoppingになったら終了する。
+ *
+ */
+void OutputWriter::workerLoop()
+{
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            jobAdded.wait(lock, [this] { return !jobs.empty() || stopping; });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            isWriting = true;
+        }
+        jobFinished.notify_all();
+
+        std::exception_ptr error;
+        try {
+            job();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isWriting = false;
+            if (error && !failure) {
+                failure = error;
+            }
+        }
+        jobFinished.notify_all();
+    }
+}
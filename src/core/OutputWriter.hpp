@@ -0,0 +1,58 @@
+/**
+ * @file OutputWriter.hpp
+ * @author Takanori Saiki
+ * @brief 結果の書き出しを別スレッドで行うクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class OutputWriter
+ * @brief 書き出しの処理(ジョブ)を受け取り、専用のスレッドで順番に実行する。
+ * @details ジョブは必要なデータをすべてコピーして持つこと(シミュレーションの状態を参照しない)。
+ *          未処理のジョブがmaxPendingJobs個たまっている場合、submit()は空きができるまで待つ(back-pressure)。
+ *          asyncがfalseの場合はsubmit()の中でそのまま実行する。
+ *          書き出しスレッドでジョブが例外を投げた場合は最初の1つを取っておき、次のsubmit()、flush()、デストラクタで投げ直す。
+ *          同期の場合と同じく、書き出しの失敗に気づかずにシミュレーションを続けないようにするため。
+ */
+class OutputWriter
+{
+  private:
+    const bool async;            //!< 別スレッドで書き出すかどうか
+    const size_t maxPendingJobs; //!< ためておけるジョブの数の上限
+
+    std::deque<std::function<void()>> jobs; //!< 未処理のジョブ
+    bool isWriting     = false;             //!< 書き出しスレッドがジョブを実行中かどうか
+    bool stopping      = false;             //!< デストラクタが呼ばれたかどうか
+    double stallMillis = 0;                 //!< submit()で空きを待った合計時間
+    std::exception_ptr failure;             //!< 書き出しスレッドで最初に失敗したジョブの例外。投げ直したら空に戻す
+
+    std::mutex mtx;
+    std::condition_variable jobAdded;    //!< ジョブが追加された
+    std::condition_variable jobFinished; //!< ジョブが取り出された、あるいは終わった
+    std::thread worker;                  //!< 書き出しスレッド
+
+    void workerLoop();
+    void rethrowFailure();
+
+  public:
+    OutputWriter(bool async, size_t maxPendingJobs);
+    ~OutputWriter() noexcept(false);
+
+    void submit(std::function<void()> job);
+    void flush();
+    double getStallMillis() noexcept;
+};
@@ -0,0 +1,215 @@
+/**
+ * @file RemoteForceMesh.cpp
+ * @author Takanori Saiki
+ * @brief 遠隔力を格子上の畳み込み(particle-mesh法)で計算するクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "RemoteForceMesh.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+    /**
+     * @brief 格子座標uをCICの左の格子点i0と右の格子点の重みfに分ける。格子の外は端の格子点に寄せる。
+     */
+    inline void cicWeight(double u, int32_t n, int32_t& i0, double& f) noexcept
+    {
+        if (n == 1) {
+            i0 = 0;
+            f  = 0;
+            return;
+        }
+
+        u  = std::clamp(u, 0.0, (double)(n - 1));
+        i0 = std::min((int32_t)u, n - 2);
+        f  = u - i0;
+    }
+
+    /**
+     * @brief 0で埋めて巡回しないようにした変換の長さ
+     */
+    inline int32_t paddedLength(int32_t n) noexcept
+    {
+        return n == 1 ? 1 : (int32_t)std::bit_ceil((uint32_t)(2 * n));
+    }
+} // namespace
+
+RemoteForceMesh::RemoteForceMesh()
+{
+}
+
+RemoteForceMesh::~RemoteForceMesh()
+{
+}
+
+size_t RemoteForceMesh::meshIndex(int32_t x, int32_t y, int32_t z) const noexcept
+{
+    return ((size_t)x * ny + y) * nz + z;
+}
+
+size_t RemoteForceMesh::paddedIndex(int32_t x, int32_t y, int32_t z) const noexcept
+{
+    return ((size_t)x * py + y) * pz + z;
+}
+
+/**
+ * @brief 格子を確保し、核をフーリエ変換しておく。
+ *
+ * @param meshOrigin 格子点(0, 0, 0)の位置
+ * @param countX x方向の格子点の数
+ * @param countY y方向の格子点の数
+ * @param countZ z方向の格子点の数。1なら2次元
+ * @param meshSpacing 格子の間隔
+ * @param lambda 遠隔力の減衰距離
+ */
+void RemoteForceMesh::init(const Vec3& meshOrigin, int32_t countX, int32_t countY, int32_t countZ, double meshSpacing, double lambda)
+{
+    nx      = std::max(countX, 1);
+    ny      = std::max(countY, 1);
+    nz      = std::max(countZ, 1);
+    px      = paddedLength(nx);
+    py      = paddedLength(ny);
+    pz      = paddedLength(nz);
+    spacing = meshSpacing;
+    origin  = meshOrigin;
+
+    // 核は格子点の差(巡回した添字の負の側も含む)の距離で決まる
+    kernelHat.assign((size_t)px * py * pz, 0);
+#pragma omp parallel for
+    for (int32_t x = 0; x < px; x++) {
+        const int32_t ox = x < px / 2 ? x : x - px;
+        for (int32_t y = 0; y < py; y++) {
+            const int32_t oy = y < py / 2 ? y : y - py;
+            for (int32_t z = 0; z < pz; z++) {
+                const int32_t oz                = z < pz / 2 ? z : z - pz;
+                const double r                  = spacing * std::sqrt((double)ox * ox + (double)oy * oy + (double)oz * oz);
+                kernelHat[paddedIndex(x, y, z)] = lambda * std::exp(-r / lambda);
+            }
+        }
+    }
+    FFT::transform3D(kernelHat, px, py, pz, false);
+
+    work.assign(kernelHat.size(), 0);
+    density.assign((size_t)nx * ny * nz, 0);
+    potential.assign((size_t)nx * ny * nz, 0);
+}
+
+bool RemoteForceMesh::isInitialized() const noexcept
+{
+    return !kernelHat.empty();
+}
+
+/**
+ * @brief 発生源の重みを格子に割り振り、ポテンシャルを求める。
+ *
+ * @param positions 発生源の位置
+ * @param weights 発生源の重み(positionsと同じ長さ)
+ */
+void RemoteForceMesh::build(const std::vector<Vec3>& positions, const std::vector<double>& weights)
+{
+    std::fill(density.begin(), density.end(), 0.0);
+
+#pragma omp parallel for
+    for (int32_t i = 0; i < (int32_t)positions.size(); i++) {
+        int32_t x0, y0, z0;
+        double fx, fy, fz;
+        cicWeight((positions[i].x - origin.x) / spacing, nx, x0, fx);
+        cicWeight((positions[i].y - origin.y) / spacing, ny, y0, fy);
+        cicWeight((positions[i].z - origin.z) / spacing, nz, z0, fz);
+
+        for (int32_t dx = 0; dx <= (nx > 1); dx++) {
+            for (int32_t dy = 0; dy <= (ny > 1); dy++) {
+                for (int32_t dz = 0; dz <= (nz > 1); dz++) {
+                    const double w = weights[i] * (dx ? fx : 1 - fx) * (dy ? fy : 1 - fy) * (dz ? fz : 1 - fz);
+#pragma omp atomic
+                    density[meshIndex(x0 + dx, y0 + dy, z0 + dz)] += w;
+                }
+            }
+        }
+    }
+
+    std::fill(work.begin(), work.end(), FFT::Complex(0));
+#pragma omp parallel for
+    for (int32_t x = 0; x < nx; x++) {
+        for (int32_t y = 0; y < ny; y++) {
+            for (int32_t z = 0; z < nz; z++) {
+                work[paddedIndex(x, y, z)] = density[meshIndex(x, y, z)];
+            }
+        }
+    }
+
+    FFT::transform3D(work, px, py, pz, false);
+#pragma omp parallel for
+    for (int64_t i = 0; i < (int64_t)work.size(); i++) {
+        work[i] *= kernelHat[i];
+    }
+    FFT::transform3D(work, px, py, pz, true);
+
+#pragma omp parallel for
+    for (int32_t x = 0; x < nx; x++) {
+        for (int32_t y = 0; y < ny; y++) {
+            for (int32_t z = 0; z < nz; z++) {
+                potential[meshIndex(x, y, z)] = work[paddedIndex(x, y, z)].real();
+            }
+        }
+    }
+}
+
+/**
+ * @brief 格子点(x, y, z)でのポテンシャルのaxis方向の勾配。中心差分で求め、格子の端では片側差分にする。
+ */
+double RemoteForceMesh::nodeGradient(int32_t x, int32_t y, int32_t z, int32_t axis) const noexcept
+{
+    const int32_t n = axis == 0 ? nx : (axis == 1 ? ny : nz);
+    const int32_t i = axis == 0 ? x : (axis == 1 ? y : z);
+    if (n == 1) {
+        return 0.0;
+    }
+
+    const int32_t lo = std::max(i - 1, 0);
+    const int32_t hi = std::min(i + 1, n - 1);
+    const int32_t d[3][3] = { { lo, y, z }, { x, lo, z }, { x, y, lo } };
+    const int32_t u[3][3] = { { hi, y, z }, { x, hi, z }, { x, y, hi } };
+
+    const double below = potential[meshIndex(d[axis][0], d[axis][1], d[axis][2])];
+    const double above = potential[meshIndex(u[axis][0], u[axis][1], u[axis][2])];
+    return (above - below) / ((hi - lo) * spacing);
+}
+
+/**
+ * @brief posでのポテンシャルの勾配。格子点での勾配をCICで補間する。
+ * @details build()のあとは読み出しだけなので、複数のスレッドから同時に呼べる。
+ *
+ * @param pos
+ * @return Vec3 Σ w_i (x_i - pos) / d_i * e^(-d_i/λ) の近似
+ */
+Vec3 RemoteForceMesh::gradient(const Vec3& pos) const noexcept
+{
+    int32_t x0, y0, z0;
+    double fx, fy, fz;
+    cicWeight((pos.x - origin.x) / spacing, nx, x0, fx);
+    cicWeight((pos.y - origin.y) / spacing, ny, y0, fy);
+    cicWeight((pos.z - origin.z) / spacing, nz, z0, fz);
+
+    Vec3 grad = Vec3::zero();
+    for (int32_t dx = 0; dx <= (nx > 1); dx++) {
+        for (int32_t dy = 0; dy <= (ny > 1); dy++) {
+            for (int32_t dz = 0; dz <= (nz > 1); dz++) {
+                const double w  = (dx ? fx : 1 - fx) * (dy ? fy : 1 - fy) * (dz ? fz : 1 - fz);
+                const int32_t x = x0 + dx, y = y0 + dy, z = z0 + dz;
+
+                grad.x += w * nodeGradient(x, y, z, 0);
+                grad.y += w * nodeGradient(x, y, z, 1);
+                grad.z += w * nodeGradient(x, y, z, 2);
+            }
+        }
+    }
+
+    return grad;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file RemoteForceMesh.hpp
+ * @author Takanori Saiki
+ * @brief 遠隔力を格子上の畳み込み(particle-mesh法)で計算するクラス
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../utils/FFT.hpp"
+#include "../utils/Vec3.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class RemoteForceMesh
+ * @brief 遠隔力のポテンシャル φ(p) = Σ w_i λ e^(-|x_i - p|/λ) を格子上で求め、その勾配を遠隔力とする。
+ * @details ∇φ(p) = Σ w_i (x_i - p) / |x_i - p| * e^(-|x_i - p|/λ) なので、勾配はcalcRemoteForceの和(重みの積と係数を除く)になる。
+ *          1. 発生源の重みをCIC(Cloud-In-Cell)で格子に割り振る。
+ *          2. 核 λ e^(-r/λ) との畳み込みをFFTで求める。周期的にならないよう、各軸を2倍以上に0で埋めて変換する。
+ *          3. 格子点での勾配を中心差分で求め、CICで細胞の位置に補間する。
+ *          割り振りと補間に同じ重みを使うので、細胞が自分自身から受ける力はほぼ0になる。
+ *          格子の間隔より近い細胞どうしの力はならされる。計算量は細胞数をn、格子点数をGとしてO(n + G log G)。
+ *          格子はMoleculeSpaceと同じく x, y, z の順に並べ、フィールドの外の細胞は一番近い格子点に割り振る。
+ */
+class RemoteForceMesh
+{
+  private:
+    int32_t nx = 0, ny = 0, nz = 0; //!< 格子点の数(nz = 1なら2次元)
+    int32_t px = 0, py = 0, pz = 0; //!< 0で埋めたあとの変換の長さ
+    double spacing = 1.0;           //!< 格子の間隔
+    Vec3 origin;                    //!< 格子点(0, 0, 0)の位置
+
+    std::vector<FFT::Complex> kernelHat; //!< 核をフーリエ変換したもの
+    std::vector<FFT::Complex> work;      //!< 変換の作業領域
+    std::vector<double> density;         //!< 割り振った重み
+    std::vector<double> potential;       //!< 格子点でのポテンシャル(nx * ny * nz個)
+
+    size_t meshIndex(int32_t x, int32_t y, int32_t z) const noexcept;
+    size_t paddedIndex(int32_t x, int32_t y, int32_t z) const noexcept;
+    double nodeGradient(int32_t x, int32_t y, int32_t z, int32_t axis) const noexcept;
+
+  public:
+    RemoteForceMesh();
+    ~RemoteForceMesh();
+
+    void init(const Vec3& meshOrigin, int32_t countX, int32_t countY, int32_t countZ, double meshSpacing, double lambda);
+    bool isInitialized() const noexcept;
+
+    void build(const std::vector<Vec3>& positions, const std::vector<double>& weights);
+    Vec3 gradient(const Vec3& pos) const noexcept;
+};
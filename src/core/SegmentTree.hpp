@@ -1,15 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <vector>
 
-template<typename T, typename F>
+/**
+ * @brief 2次元のセグメント木
+ *
+ * @tparam T 値の型
+ * @tparam F 値をまとめる関数オブジェクトの型(結合的で、Iを単位元とすること)。既定では和をとる
+ */
+template<typename T, typename F = std::plus<T>>
 class SegmentTree
 {
     public:
     int H, W;
     std::vector<T> seg;
-    const F f(const T& a, const T& b);
+    F f;
     const T I;
 
     SegmentTree(int h, int w, const T& i);
@@ -22,8 +30,8 @@ class SegmentTree
 
     void update(int h, int w, const T& x);
 
-    T _inner_query(int h, int w1, int w2);
-    T query(int h1, int w1, int h2, int w2);
+    T _inner_query(int h, int w1, int w2) const;
+    T query(int h1, int w1, int h2, int w2) const;
 
     private:
     int id(int h, int w) const;
@@ -36,12 +44,6 @@ SegmentTree<T, F>::SegmentTree(int h, int w, const T& i)
     init(h, w);
 }
 
-template<typename T, typename F>
-const F SegmentTree<T, F>::f(const T& a, const T& b)
-{
-    return a + b;
-}
-
 template<typename T, typename F>
 void SegmentTree<T, F>::init(int h, int w)
 {
@@ -109,7 +111,7 @@ void SegmentTree<T, F>::update(int h, int w, const T& x)
 }
 
 template<typename T, typename F>
-T SegmentTree<T, F>::_inner_query(int h, int w1, int w2)
+T SegmentTree<T, F>::_inner_query(int h, int w1, int w2) const
 {
     T res = I;
     for (; w1 < w2; w1 >>= 1, w2 >>= 1) {
@@ -126,7 +128,7 @@ T SegmentTree<T, F>::_inner_query(int h, int w1, int w2)
 }
 
 template<typename T, typename F>
-T SegmentTree<T, F>::query(int h1, int w1, int h2, int w2)
+T SegmentTree<T, F>::query(int h1, int w1, int h2, int w2) const
 {
     h1 = std::max(h1, 0);
     w1 = std::max(w1, 0);
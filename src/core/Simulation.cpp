@@ -1,20 +1,20 @@
 #include "Simulation.hpp"
+#include "../utils/BinaryIO.hpp"
+#include "../utils/RadixSort.hpp"
 
 // TODO: cellsをスマートポインタの配列にする。
 
 /**
  * @brief 基本となるコンストラクタ。
  * @details
- * 各乱数生成器と遠隔力フィールドを初期化する。また、標準出力のストリームバッファを保存しておく。
- * @note
- * 例えば、(-8/2, 8/2)でランダムな値を生成すると長さ8の配列に収まるようになる。
- * {[-4, -3), [-3, -2), [-2, -1), [-1, 0), [0, 1), [1, 2), [2, 3), [3, 4)}
+ * 分子空間を初期化する。また、標準出力のストリームバッファを保存しておく。
  */
 Simulation::Simulation()
   : cellList()
-  , randomCellPosX(-SimulationSettings::FIELD_X_LEN / 2, SimulationSettings::FIELD_X_LEN / 2)
-  , randomCellPosY(-SimulationSettings::FIELD_Y_LEN / 2, SimulationSettings::FIELD_Y_LEN / 2)
+  , variableRatioCellList(SimulationSettings::FIELD_X_LEN, SimulationSettings::FIELD_Y_LEN, SimulationSettings::ADAPTIVE_BASE_GRID_SIZE,
+                          SimulationSettings::ADAPTIVE_BUCKET_CELLS, SimulationSettings::SEARCH_RADIUS)
   , moleculeSpaces(SimulationSettings::MOLECULE_TYPE_NUM)
+  , outputWriter(SimulationSettings::OUTPUT_ASYNC, SimulationSettings::OUTPUT_QUEUE_DEPTH)
 // , aroundCellSetList(SimulationSettings::FIELD_Y_LEN, std::unordered_set<int32_t>())
 {
     consoleStream        = std::cout.rdbuf();
@@ -26,6 +26,34 @@ Simulation::Simulation()
         moleculeSpaces[i] = std::make_unique<UserMoleculeSpace>(SimulationSettings::DEFAULT_MOLECULE_NUMS[i], MoleculeDistributionType::UNIFORM, MoleculeSpaceBorderType::NEUMANN, cells, i);
         // moleculeSpaces[i]->
     }
+
+    if (SimulationSettings::REMOTE_FORCE_METHOD == RemoteForceMethod::PARTICLE_MESH) {
+        // 細胞のフィールドと同じく原点を中心にする
+        const double spacing = SimulationSettings::REMOTE_FORCE_MESH_SPACING;
+        const Vec3 origin(-SimulationSettings::FIELD_X_LEN / 2, -SimulationSettings::FIELD_Y_LEN / 2, -SimulationSettings::FIELD_Z_LEN / 2);
+        remoteForceMesh.init(origin, std::ceil(SimulationSettings::FIELD_X_LEN / spacing), std::ceil(SimulationSettings::FIELD_Y_LEN / spacing),
+                             SimulationSettings::FIELD_Z_LEN > 0 ? std::ceil(SimulationSettings::FIELD_Z_LEN / spacing) : 1, spacing, SimulationSettings::REMOTE_FORCE_LAMBDA);
+    }
+
+    // CUTOFFで近傍の細胞に使うe^(-d/λ)の引数は、search_radius / (最小のλ) までに収まる
+    double minLambda = SimulationSettings::REMOTE_FORCE_LAMBDA;
+    for (int32_t r = 0; r < InteractionMatrix::cellTypeNum(); r++) {
+        for (int32_t s = 0; s < InteractionMatrix::cellTypeNum(); s++) {
+            const auto& interaction = SimulationSettings::INTERACTION_MATRIX.get((CellType)r, (CellType)s);
+            if (interaction.remoteCoefficient != 0.0) {
+                minLambda = std::min(minLambda, interaction.lambda);
+            }
+        }
+    }
+    remoteExp = FastExp(SimulationSettings::REMOTE_FORCE_EXP, SimulationSettings::SEARCH_RADIUS / minLambda);
+
+    if (SimulationSettings::REMOTE_FORCE_EXP != ExpMethod::LIBM) {
+        const double error = remoteExp.maxRelativeError();
+        std::cout << "REMOTE FORCE EXP MAX RELATIVE ERROR : " << error << std::endl;
+        if (SimulationSettings::REMOTE_FORCE_EXP_TOLERANCE > 0.0 && error > SimulationSettings::REMOTE_FORCE_EXP_TOLERANCE) {
+            throw std::runtime_error("Simulation::Simulation() : remote_force.exp exceeds remote_force.exp_tolerance.");
+        }
+    }
 }
 
 /**
@@ -55,95 +83,744 @@ void Simulation::exportConfig() const
 }
 
 /**
- * @brief 各セルをランダムな座標で初期化する。
+ * @brief (シード値, streamId, 現在のステップ, 用途)をキーにした乱数列を返す。
+ * @details 細胞に紐づく乱数はCell::randomStream()を使う。こちらは初期配置などSimulation側で使う乱数用。
  *
+ * @param streamId 乱数列を区別するID
+ * @param purpose 乱数の用途
+ * @return CounterRNG
+ */
+CounterRNG Simulation::randomStream(uint64_t streamId, RandomPurpose purpose) const noexcept
+{
+    return CounterRNG(SimulationSettings::CELL_SEED, streamId, currentStep, purpose);
+}
+
+/**
+ * @brief 各セルをランダムな座標で初期化する。FIELD_Z_LENが0より大きければz座標もランダムにする。
+ * @note
+ * 例えば、[-8/2, 8/2)でランダムな値を生成すると長さ8の配列に収まるようになる。
+ * {[-4, -3), [-3, -2), [-2, -1), [-1, 0), [0, 1), [1, 2), [2, 3), [3, 4)}
  */
 void Simulation::initCells() noexcept
 {
+    const double halfX = SimulationSettings::FIELD_X_LEN / 2;
+    const double halfY = SimulationSettings::FIELD_Y_LEN / 2;
+    const double halfZ = SimulationSettings::FIELD_Z_LEN / 2;
+
     for (int32_t i = 0; i < SimulationSettings::CELL_NUM; i++) {
-        double xPos = randomCellPosX(rand_gen);
-        double yPos = randomCellPosY(rand_gen);
-        UserCell c(CellType::WORKER, xPos, yPos, 10.0);
-        cells.push_back(std::make_shared<UserCell>(c));
+        CounterRNG rng = randomStream(i, RandomPurpose::INIT_POSITION);
+        double xPos    = rng.uniform(-halfX, halfX);
+        double yPos    = rng.uniform(-halfY, halfY);
+        double zPos    = halfZ > 0 ? rng.uniform(-halfZ, halfZ) : 0.0;
+        UserCell c(CellType::WORKER, Vec3(xPos, yPos, zPos), 10.0);
+        addCell(std::make_shared<UserCell>(c));
+    }
+}
+
+/**
+ * @brief ファイルから細胞の初期状態を読み込む。initCells()の代わりに呼ぶ。
+ * @details 読み込めるのは次のいずれか。
+ *          - input/init_cellやTEXT形式の出力(cells_*)のような表
+ *          - BINARY形式の出力(cells_*)
+ *          - CONTAINER形式の出力(timeseries.mcmc)。最後に出力したステップを使う
+ *          種類、座標、速度、半径だけを使い、IDは読み込んだ順に振り直す。NONE、TMPの行は読み込まない。
+ *          読み込めない場合は例外を投げる。
+ *
+ * @param path
+ */
+void Simulation::loadCells(const std::string& path)
+{
+    auto start = std::chrono::system_clock::now();
+
+    CellSnapshot snapshot;
+    if (TimeSeriesReader::isTimeSeries(path)) {
+        TimeSeriesReader reader(path);
+        const std::vector<int32_t> steps = reader.steps();
+        if (steps.empty()) {
+            throw std::runtime_error("Simulation::loadCells() : " + path + " has no cells.");
+        }
+        snapshot = reader.readCells(steps.back());
+    } else {
+        snapshot = CellSnapshot::load(path);
+    }
+
+    std::vector<int32_t> rows;
+    rows.reserve(snapshot.size());
+    for (size_t i = 0; i < snapshot.size(); i++) {
+        const CellType type = static_cast<CellType>(snapshot.type[i]);
+        if (type != CellType::NONE && type != CellType::TMP) {
+            rows.push_back(i);
+        }
+    }
+
+    // IDを先に決めておけば、細胞は並列に作れる
+    const int32_t firstId = Cell::numberOfCellsBorn;
+    std::vector<std::shared_ptr<UserCell>> loaded(rows.size());
+#pragma omp parallel for
+    for (size_t k = 0; k < rows.size(); k++) {
+        const int32_t i = rows[k];
+        const Vec3 pos(snapshot.x[i], snapshot.y[i], snapshot.z[i]);
+        const Vec3 v(snapshot.vx[i], snapshot.vy[i], snapshot.vz[i]);
+        loaded[k] = std::make_shared<UserCell>(firstId + k, static_cast<CellType>(snapshot.type[i]), pos, snapshot.radius[i], v);
+    }
+    Cell::numberOfCellsBorn += rows.size();
+
+    cells.reserve(cells.size() + loaded.size());
+    for (auto& cell : loaded) {
+        addCell(std::move(cell));
+    }
+
+    auto end  = std::chrono::system_clock::now();
+    auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << "loaded " << cells.size() << " cells from " << path << " (" << msec << "msec)" << std::endl;
+}
+
+/**
+ * @brief Cellをcellsに登録する。NONEになった細胞の場所が空いていればそこを再利用し、なければ末尾に追加する。
+ * @note 分裂などで新しい細胞を作った場合は、cellsに直接push_backせずにこれを使う。
+ *
+ * @param cell
+ * @return int32_t 登録した添字
+ */
+int32_t Simulation::addCell(std::shared_ptr<UserCell> cell) noexcept
+{
+    int32_t slot;
+
+    if (freeSlots.empty()) {
+        slot = cells.size();
+        cells.push_back(cell);
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        cells[slot] = cell;
+    }
+    registerSlot(slot);
+
+    return slot;
+}
+
+/**
+ * @brief Cell::idから、そのCellが入っているcellsの添字を返す。
+ *
+ * @param id
+ * @return int32_t 存在しない(消滅した)場合は-1
+ */
+int32_t Simulation::findSlotById(int32_t id) const noexcept
+{
+    if (id < 0 || (int32_t)idToSlot.size() <= id) {
+        return -1;
+    }
+
+    return idToSlot[id];
+}
+
+/**
+ * @brief Cell::idからCellを返す。コンパクションで添字が変わってもidは変わらないので、ステップをまたいで細胞を参照するときに使う。
+ *
+ * @param id
+ * @return std::shared_ptr<UserCell> 存在しない(消滅した)場合はnullptr
+ */
+std::shared_ptr<UserCell> Simulation::findCellById(int32_t id) const noexcept
+{
+    const int32_t slot = findSlotById(id);
+
+    if (slot < 0) {
+        return nullptr;
+    }
+
+    return cells[slot];
+}
+
+/**
+ * @brief cells[slot]に入っているCellの添字とIDの対応を更新する。
+ *
+ * @param slot
+ */
+void Simulation::registerSlot(int32_t slot) noexcept
+{
+    std::shared_ptr<UserCell>& cell = cells[slot];
+
+    cell->arrayIndex = slot;
+    if ((int32_t)idToSlot.size() <= cell->id) {
+        idToSlot.resize(cell->id + 1, -1);
+    }
+    idToSlot[cell->id] = slot;
+}
+
+/**
+ * @brief NONEになった細胞の場所を集め、その割合がCOMPACTION_THRESHOLDを超えていればコンパクションを行う。
+ * @details cellsに直接追加された細胞もここで添字を登録する。ステップの終わりに1回呼び出す。
+ *          REORDER_INTERVALステップごとにも、NONEの割合によらずコンパクションを行って細胞をCELL_ORDERの順に並べ直す。
+ *          分裂した娘細胞は末尾や空いた場所に入るので、放っておくと近傍の細胞がメモリ上でばらばらになっていく。
+ *
+ * @return true コンパクションを行った
+ * @return false
+ */
+bool Simulation::maintainCellStore() noexcept
+{
+    freeSlots.clear();
+
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        if (cells[i]->arrayIndex != i) {
+            if (cells[i]->arrayIndex != -1) {
+                cellList.invalidate(); // 別の添字から移された細胞があるので、CellListの添字ごとの登録が使えない
+            }
+            registerSlot(i);
+        }
+        if (cells[i]->getCellType() == CellType::NONE) {
+            if (idToSlot[cells[i]->id] == i) {
+                idToSlot[cells[i]->id] = -1;
+            }
+            freeSlots.push_back(i);
+        }
+    }
+
+    const bool willReorder = SimulationSettings::REORDER_INTERVAL > 0 && currentStep > 0 && (currentStep % SimulationSettings::REORDER_INTERVAL) == 0;
+    if (willReorder || (double)freeSlots.size() > SimulationSettings::COMPACTION_THRESHOLD * (double)cells.size()) {
+        compactCells();
+        return true;
     }
+
+    // 添字の小さい場所から再利用する
+    std::reverse(freeSlots.begin(), freeSlots.end());
+
+    return false;
 }
 
+/**
+ * @brief NONEになった細胞を取り除いてcellsを詰め直す。
+ * @details 生きている細胞はCellListのグリッドをCELL_ORDERの順(Hilbert曲線など)にたどった順に並べ直すので、
+ *          空間的に近い細胞がメモリ上でも近くなり、力の計算の並列ループも空間的にまとまった範囲を受け持つようになる。
+ *          同じグリッドの中では元の順序を保つ。
+ *          添字(Cell::arrayIndex、idToSlot)は振り直すが、Cell::idとfindCellById()による参照はそのまま使える。
+ *          CellListは次のnextStep()で作り直すので、それまでaroundCellList()の添字は使えない。
+ */
+void Simulation::compactCells() noexcept
+{
+    std::vector<int32_t> order; // 生きている細胞の元の添字
+    order.reserve(cells.size() - freeSlots.size());
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        if (cells[i]->getCellType() != CellType::NONE) {
+            order.push_back(i);
+        }
+    }
+
+    std::vector<uint64_t> keys(order.size());
+#pragma omp parallel for
+    for (int32_t i = 0; i < (int32_t)order.size(); i++) {
+        keys[i] = cellList.getOrderKey(cells[order[i]], SimulationSettings::CELL_ORDER);
+    }
+    RadixSort::sortByKey(keys, order);
+
+    std::vector<std::shared_ptr<UserCell>> compacted(order.size());
+#pragma omp parallel for
+    for (int32_t i = 0; i < (int32_t)order.size(); i++) {
+        compacted[i] = std::move(cells[order[i]]);
+    }
+    cells.swap(compacted); // MoleculeSpaceがcellsへの参照を持っているので、vector自体は差し替えない
+    cellList.invalidate();
+    contactGraph.reorderRows(order);
+
+    std::fill(idToSlot.begin(), idToSlot.end(), -1);
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        registerSlot(i);
+    }
+    freeSlots.clear();
+}
+
+/**
+ * @brief 出力先のディレクトリを作成する。
+ * @details output.formatがCONTAINERの場合は./result/timeseries.mcmcを作成し、分子のディレクトリは作らない。
+ *          output.enabledがfalseの場合は、チェックポイントの出力先だけを作る。
+ *          チェックポイントから再開する場合はloadCheckpoint()の後に呼ぶこと。
+ */
 void Simulation::initDirectories()
 {
-    std::string command = "mkdir -p ./result";
-    system(command.c_str());
+    const std::filesystem::path checkpointDir = std::filesystem::path(SimulationSettings::CHECKPOINT_PATH).parent_path();
+    if (SimulationSettings::CHECKPOINT_INTERVAL > 0 && !checkpointDir.empty()) {
+        std::filesystem::create_directories(checkpointDir);
+    }
 
-    command = "mkdir -p ./molecule_result";
-    system(command.c_str());
+    if (!SimulationSettings::OUTPUT_ENABLED) {
+        return;
+    }
+    std::filesystem::create_directories("./result");
+
+    // 再開した場合は、チェックポイントまでの集計を残して続きを追記する
+    if (SimulationSettings::ANALYSIS_CLUSTERS && startStep == 0) {
+        std::ofstream ofs(CLUSTER_SUMMARY_PATH);
+        ClusterAnalysis::writeHeader(ofs);
+    } else if (SimulationSettings::ANALYSIS_CLUSTERS) {
+        ClusterAnalysis::resumeSummary(CLUSTER_SUMMARY_PATH, startStep / SimulationSettings::OUTPUT_INTERVAL_STEP);
+    }
+
+    if (SimulationSettings::OUTPUT_FORMAT == OutputFormat::CONTAINER) {
+        // 再開した場合は、チェックポイントまでに出力したチャンクを残して続きから書く
+        const int32_t resumeStep = startStep > 0 ? startStep / SimulationSettings::OUTPUT_INTERVAL_STEP : -1;
+        container = std::make_shared<TimeSeriesWriter>(CONTAINER_PATH, SimulationSettings::OUTPUT_FLOAT32, SimulationSettings::MOLECULE_COMPRESSION, SimulationSettings::MOLECULE_ERROR_BOUND, resumeStep);
+        return;
+    }
 
     for (int i = 0; i < SimulationSettings::MOLECULE_TYPE_NUM; i++) {
-        command = "mkdir -p ./molecule_result/" + std::string(moleculeTypeNumDigit, '0');
-        system(command.c_str());
+        std::filesystem::create_directories(moleculeDirectory(i));
     }
 }
 
 /**
- * @brief ファイルにヘッダ情報を出力する。
+ * @brief 現在のすべてのCell(NONEを除く)の状態を列ごとに集める。
+ * @details 各列への書き込みは互いに独立なので並列に行う。
  *
+ * @param time 出力番号
+ * @return CellSnapshot
  */
-void Simulation::printHeader() const noexcept
+CellSnapshot Simulation::captureCells(int32_t time) const
 {
-    // std::cout << "ID\ttypeID\tX\tY\tZ\tVx\tVy\tVz\tR\tN_contact\tContact_IDs" << std::endl;
-    std::cout << "ID\tX\tY" << std::endl;
+    std::vector<int32_t> liveSlots;
+    liveSlots.reserve(cells.size());
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        if (cells[i]->getCellType() != CellType::NONE) {
+            liveSlots.push_back(i);
+        }
+    }
+
+    CellSnapshot snapshot;
+    snapshot.step = time;
+    snapshot.resize(liveSlots.size());
+
+#pragma omp parallel for
+    for (int32_t k = 0; k < (int32_t)liveSlots.size(); k++) {
+        const std::shared_ptr<UserCell>& c = cells[liveSlots[k]];
+        const Vec3 pos                     = c->getPosition();
+        const Vec3 v                       = c->getVelocity();
+
+        snapshot.id[k]                = c->id;
+        snapshot.type[k]              = static_cast<uint8_t>(c->getCellType());
+        snapshot.x[k]                 = pos.x;
+        snapshot.y[k]                 = pos.y;
+        snapshot.z[k]                 = pos.z;
+        snapshot.vx[k]                = v.x;
+        snapshot.vy[k]                = v.y;
+        snapshot.vz[k]                = v.z;
+        snapshot.radius[k]            = c->getRadius();
+        snapshot.contactOffset[k + 1] = contactGraph.degree(liveSlots[k]);
+    }
+
+    for (int32_t k = 0; k < (int32_t)liveSlots.size(); k++) {
+        snapshot.contactOffset[k + 1] += snapshot.contactOffset[k];
+    }
+    snapshot.contactId.resize(snapshot.contactOffset.back());
+
+#pragma omp parallel for
+    for (int32_t k = 0; k < (int32_t)liveSlots.size(); k++) {
+        const std::span<const int32_t> contactIds = contactGraph.contactsOf(liveSlots[k]);
+        std::copy(contactIds.begin(), contactIds.end(), snapshot.contactId.begin() + snapshot.contactOffset[k]);
+    }
+
+    return snapshot;
 }
 
 /**
- * @brief ファイルに現在のすべてのCell情報を出力する。
+ * @brief 出力番号timeのCell情報の出力先を返す。
  *
- * @param time
+ * @param time 出力番号
+ * @return std::string ./result/cells_<stepNum>
  */
-void Simulation::printCells(int32_t time) const
+std::string Simulation::cellOutputPath(int32_t time) const
 {
     std::ostringstream sout;
-    sout << std::setfill('0') << std::setw(stepNumDigit) << time;
+    sout << "./result/cells_" << std::setfill('0') << std::setw(stepNumDigit) << time;
 
-    std::string outputPath = "./result/cells_" + sout.str();
-    std::ofstream ofs(outputPath);
-    std::cout.rdbuf(ofs.rdbuf()); // 標準出力の出力先を指定ファイルに変更
-                                  // ./result/cells_<stepNum>
+    return sout.str();
+}
 
-    printHeader();
-    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
-        if (cells[i]->getCellType() == CellType::NONE)
-            continue;
-        cells[i]->printCell();
-    }
+/**
+ * @brief 分子の種類ごとの出力ディレクトリを返す。
+ *
+ * @param moleculeType 分子の種類
+ * @return std::string ./molecule_result/<moleculeTypeNum>
+ */
+std::string Simulation::moleculeDirectory(int32_t moleculeType) const
+{
+    std::ostringstream sout;
+    sout << "./molecule_result/" << std::setfill('0') << std::setw(moleculeTypeNumDigit) << moleculeType;
 
-    std::cout.rdbuf(consoleStream);
+    return sout.str();
 }
 
-void Simulation::printMolecules(int32_t time) const
+/**
+ * @brief 出力番号timeの分子情報の出力先を返す。
+ *
+ * @param moleculeType 分子の種類
+ * @param time 出力番号
+ * @return std::string ./molecule_result/<moleculeTypeNum>/molecule_<stepNum>
+ */
+std::string Simulation::moleculeOutputPath(int32_t moleculeType, int32_t time) const
 {
     std::ostringstream sout;
-    sout << std::setfill('0') << std::setw(stepNumDigit) << time;
-    std::string outputPath = "./molecule_result/" + std::string(moleculeTypeNumDigit, '0') + "/molecule_" + sout.str();
+    sout << moleculeDirectory(moleculeType) << "/molecule_" << std::setfill('0') << std::setw(stepNumDigit) << time;
 
+    return sout.str();
+}
+
+/**
+ * @brief 現在のCellと分子の状態をファイルに出力する。
+ * @details 状態のコピーはこのスレッドで取り、ファイルへの書き込みはoutputWriterに任せる。
+ *          コピーを取ったあとはシミュレーションを進めてよい。
+ *          形式は設定ファイルのoutput.formatで選ぶ。CONTAINERの場合はcontainerに追記する。
+ *          BINARYとCONTAINERでは、分子の格子をoutput.molecule_compressionに従って圧縮する。
+ *          analysis.clustersがtrueなら、スナップショットのクラスタを求め、集計をCLUSTER_SUMMARY_PATHに追記する。
+ *
+ * @param time 出力番号
+ */
+void Simulation::output(int32_t time)
+{
+    ProfileScope scope("output");
+
+    CellSnapshot snapshot = captureCells(time);
+
+    std::string clusterLine;
+    if (SimulationSettings::ANALYSIS_CLUSTERS) {
+        ProfileScope clusterScope("clusters");
+        std::ostringstream line;
+        ClusterAnalysis::writeSummary(line, ClusterAnalysis::label(snapshot));
+        clusterLine = std::move(line).str();
+    }
+
+    std::vector<MoleculeGrid> grids;
     for (int32_t i = 0; i < SimulationSettings::MOLECULE_TYPE_NUM; i++) {
-        std::ostringstream typeSout;
-        typeSout << std::setfill('0') << std::setw(moleculeTypeNumDigit) << i;
-        outputPath.replace(18, moleculeTypeNumDigit, typeSout.str());
-        std::ofstream ofs(outputPath);
-        std::cout.rdbuf(ofs.rdbuf()); // 標準出力の出力先を指定ファイルに変更
-                                      // ./molecule_result/<moleculeTypeNum>/molecule_<stepNum>
+        grids.emplace_back(moleculeSpaces[i]->exportGrid());
+    }
+
+    // 書き出しは別スレッドで行うので、計測の親のパスを渡しておく
+    std::string profilePath = Profiler::currentPath();
+
+    if (container) {
+        outputWriter.submit([container = container, snapshot = std::move(snapshot), grids = std::move(grids), time, clusterLine = std::move(clusterLine), profilePath = std::move(profilePath)] {
+            ProfileScope scope(profilePath, "write");
+            if (!clusterLine.empty()) {
+                std::ofstream summary(CLUSTER_SUMMARY_PATH, std::ios::app);
+                summary << clusterLine;
+                if (!summary) {
+                    throw std::runtime_error("Simulation::output() : failed to write " + std::string(CLUSTER_SUMMARY_PATH) + ".");
+                }
+            }
+            container->appendCells(snapshot);
+            for (int32_t i = 0; i < (int32_t)grids.size(); i++) {
+                container->appendMolecules(time, i, grids[i]);
+            }
+        });
 
-        moleculeSpaces[i]->print();
+        return;
     }
 
-    std::cout.rdbuf(consoleStream);
+    std::string cellPath = cellOutputPath(time);
+    std::vector<std::string> moleculePaths;
+    for (int32_t i = 0; i < SimulationSettings::MOLECULE_TYPE_NUM; i++) {
+        moleculePaths.emplace_back(moleculeOutputPath(i, time));
+    }
+
+    const OutputFormat format         = SimulationSettings::OUTPUT_FORMAT;
+    const bool useFloat32             = SimulationSettings::OUTPUT_FLOAT32;
+    const CompressionMode compression = SimulationSettings::MOLECULE_COMPRESSION;
+    const double errorBound           = SimulationSettings::MOLECULE_ERROR_BOUND;
+
+    outputWriter.submit([snapshot = std::move(snapshot), cellPath = std::move(cellPath), grids = std::move(grids), moleculePaths = std::move(moleculePaths), format, useFloat32, compression, errorBound,
+                         clusterLine = std::move(clusterLine), profilePath = std::move(profilePath)] {
+        ProfileScope scope(profilePath, "write");
+        if (!clusterLine.empty()) {
+            std::ofstream summary(CLUSTER_SUMMARY_PATH, std::ios::app);
+            summary << clusterLine;
+            if (!summary) {
+                throw std::runtime_error("Simulation::output() : failed to write " + std::string(CLUSTER_SUMMARY_PATH) + ".");
+            }
+        }
+        {
+            const auto mode = format == OutputFormat::BINARY ? std::ios::out | std::ios::binary : std::ios::out;
+            std::ofstream ofs(cellPath, mode);
+            if (format == OutputFormat::BINARY) {
+                snapshot.writeBinary(ofs, useFloat32);
+            } else {
+                snapshot.writeText(ofs);
+            }
+            ofs.flush();
+            if (!ofs) {
+                throw std::runtime_error("Simulation::output() : failed to write " + cellPath + ".");
+            }
+        }
+
+        for (size_t i = 0; i < grids.size(); i++) {
+            if (format == OutputFormat::BINARY) {
+                grids[i].save(moleculePaths[i], useFloat32, compression, errorBound);
+            } else {
+                std::ofstream ofs(moleculePaths[i]);
+                grids[i].writeText(ofs);
+                ofs.flush();
+                if (!ofs) {
+                    throw std::runtime_error("Simulation::output() : failed to write " + moleculePaths[i] + ".");
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief シミュレーションの再開に必要な状態をすべて書き込む。
+ * @details 形式は次の通り。数値はすべてリトルエンディアン。
+ * @code
+ * char     magic[8]            "MCMCCKPT"
+ * uint32   version
+ * int32    step                このステップまで終わった状態
+ * int32    numberOfCellsBorn
+ * int32    cellSeed            再開時の設定と違う場合は読み込まない
+ * int32    moleculeTypeNum
+ * uint64   cellCount           続けてcellsの順にUserCell::writeState()をcellCount個(NONEも含む)
+ * uint32   freeSlotCount       続けてint32 * freeSlotCount
+ * molecule * moleculeTypeNum   MoleculeSpace::writeState()
+ * @endcode
+ * 乱数は(シード値, ID, ステップ, 用途)から決まるので、乱数の状態を保存する必要はない。
+ *
+ * @param os バイナリモードのストリーム
+ */
+void Simulation::writeCheckpoint(std::ostream& os) const
+{
+    BinaryIO::writeArray(os, CHECKPOINT_MAGIC, 8);
+    BinaryIO::writeValue(os, CHECKPOINT_VERSION);
+    BinaryIO::writeValue(os, currentStep);
+    BinaryIO::writeValue(os, Cell::numberOfCellsBorn);
+    BinaryIO::writeValue(os, SimulationSettings::CELL_SEED);
+    BinaryIO::writeValue(os, SimulationSettings::MOLECULE_TYPE_NUM);
+
+    BinaryIO::writeValue<uint64_t>(os, cells.size());
+    for (const auto& c : cells) {
+        c->writeState(os);
+    }
+    BinaryIO::writeValue<uint32_t>(os, freeSlots.size());
+    BinaryIO::writeArray(os, freeSlots.data(), freeSlots.size());
+
+    for (const auto& space : moleculeSpaces) {
+        space->writeState(os);
+    }
+}
+
+/**
+ * @brief 現在の状態をチェックポイントとして保存する。
+ * @details 状態はこのスレッドでメモリに書き出し、ファイルへの書き込みはoutputWriterに任せる。
+ *          書き込み途中で止まっても前のチェックポイントが壊れないよう、一時ファイルに書いてから名前を変える。
+ */
+void Simulation::saveCheckpoint()
+{
+    ProfileScope scope("checkpoint");
+
+    std::ostringstream buf(std::ios::binary);
+    writeCheckpoint(buf);
+
+    outputWriter.submit([data = std::move(buf).str(), path = SimulationSettings::CHECKPOINT_PATH, profilePath = Profiler::currentPath()] {
+        ProfileScope scope(profilePath, "write");
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+            ofs.write(data.data(), data.size());
+            ofs.flush();
+            if (!ofs) {
+                throw std::runtime_error("Simulation::saveCheckpoint() : failed to write " + tmpPath + ".");
+            }
+        }
+        std::filesystem::rename(tmpPath, path);
+    });
+}
+
+/**
+ * @brief チェックポイントから状態を復元する。initCells()の代わりに呼ぶ。
+ * @details run()はチェックポイントのステップの次から始まり、中断しなかった場合と同じ結果になる。
+ *          読み込めない、あるいは設定と合わない場合は例外を投げる。
+ *
+ * @param path
+ */
+void Simulation::loadCheckpoint(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("Simulation::loadCheckpoint() : cannot open " + path + ".");
+    }
+
+    char magic[8];
+    BinaryIO::readArray(ifs, magic, 8);
+    if (!std::equal(magic, magic + 8, CHECKPOINT_MAGIC)) {
+        throw std::runtime_error("Simulation::loadCheckpoint() : " + path + " is not a checkpoint.");
+    }
+    const uint32_t version = BinaryIO::readValue<uint32_t>(ifs);
+    if (version > CHECKPOINT_VERSION) {
+        throw std::runtime_error("Simulation::loadCheckpoint() : unsupported version " + std::to_string(version) + ".");
+    }
+
+    const int32_t step              = BinaryIO::readValue<int32_t>(ifs);
+    const int32_t numberOfCellsBorn = BinaryIO::readValue<int32_t>(ifs);
+    const int32_t cellSeed          = BinaryIO::readValue<int32_t>(ifs);
+    const int32_t moleculeTypeNum   = BinaryIO::readValue<int32_t>(ifs);
+    if (cellSeed != SimulationSettings::CELL_SEED || moleculeTypeNum != SimulationSettings::MOLECULE_TYPE_NUM) {
+        throw std::runtime_error("Simulation::loadCheckpoint() : cell_seed or the number of molecule types differs from the checkpoint.");
+    }
+
+    cells.clear(); // MoleculeSpaceがcellsへの参照を持っているので、vector自体は差し替えない
+    cellList.invalidate();
+    idToSlot.clear();
+    const uint64_t cellCount = BinaryIO::readValue<uint64_t>(ifs);
+    for (uint64_t i = 0; i < cellCount; i++) {
+        cells.push_back(std::make_shared<UserCell>(ifs));
+        registerSlot(i);
+    }
+    freeSlots.resize(BinaryIO::readValue<uint32_t>(ifs));
+    BinaryIO::readArray(ifs, freeSlots.data(), freeSlots.size());
+    for (int32_t slot : freeSlots) {
+        idToSlot[cells[slot]->id] = -1;
+    }
+
+    for (auto& space : moleculeSpaces) {
+        space->readState(ifs);
+    }
+
+    Cell::numberOfCellsBorn = numberOfCellsBorn;
+    startStep               = step;
+    currentStep             = step;
+    Cell::currentStep       = step;
+
+    std::cout << "restored from " << path << " (step " << step << ", " << cellCount << " cells)" << std::endl;
 }
 
 void Simulation::setCellList() noexcept
 {
     debugCounter++;
 
-    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
-        cellList.addCell(cells[i]);
+    if (SimulationSettings::CELL_LIST_TYPE == CellListType::ADAPTIVE) {
+        std::vector<Vec3> positions(cells.size());
+        for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+            positions[i] = cells[i]->getPosition();
+        }
+        variableRatioCellList.build(positions);
+        return;
+    }
+
+    if (SimulationSettings::CELL_LIST_INCREMENTAL) {
+        cellList.update(cells);
+        return;
+    }
+
+    cellList.rebuild(cells);
+}
+
+/**
+ * @brief 細胞cからSEARCH_RADIUS内にある細胞の添字(cellsの添字)を、cell_list.typeに応じたCellListで探す。c自身も含む。
+ *
+ * @param c
+ * @return std::vector<int32_t>
+ */
+std::vector<int32_t> Simulation::findAroundCells(const std::shared_ptr<UserCell>& c) const
+{
+    if (SimulationSettings::CELL_LIST_TYPE == CellListType::ADAPTIVE) {
+        return variableRatioCellList.aroundCellList(c->getPosition());
+    }
+
+    return cellList.aroundCellList(c);
+}
+
+/**
+ * @brief findAroundCellsと同じ細胞の添字と、それぞれの像のずれを返す。
+ * @details cell_list.periodicがtrueのとき、フィールドの反対側の端にいる近傍の細胞iは、cから見てcells[i]->getPosition() + shifts[i]にいる。
+ *          力を計算するときはcalcRemoteForce、calcVolumeExclusionにshifts[i]を渡す。周期境界でなければshiftsはすべて0。
+ *
+ * @param c
+ * @param shifts 返り値と同じ順の像のずれ(上書きする)
+ * @return std::vector<int32_t>
+ */
+std::vector<int32_t> Simulation::findAroundCells(const std::shared_ptr<UserCell>& c, std::vector<Vec3>& shifts) const
+{
+    if (SimulationSettings::CELL_LIST_TYPE == CellListType::ADAPTIVE) {
+        std::vector<int32_t> aroundCells = variableRatioCellList.aroundCellList(c->getPosition());
+        shifts.assign(aroundCells.size(), Vec3::zero());
+        return aroundCells;
     }
+
+    return cellList.aroundCellList(c, shifts);
+}
+
+/**
+ * @brief 力の計算の中で、細胞cの接触相手(Cell::id)を記録する。calcCellCellForceを上書きする場合も、重なった相手をこれで記録する。
+ * @details cの添字の行に書き込む。行ごとに1回だけ呼ぶこと。nextStepの力の計算の外で呼んだ場合は何もしない。
+ *
+ * @param c
+ * @param contactIds
+ */
+void Simulation::recordContacts(const std::shared_ptr<UserCell>& c, std::span<const int32_t> contactIds) const noexcept
+{
+    contactGraph.addRow(c->getArrayIndex(), contactIds);
+}
+
+/**
+ * @brief 直前のnextStepの力の計算で見つけた接触(中心間の距離 < 半径の和)のグラフ。
+ * @details 行はcellsの添字(コンパクションの後も合わせてある)、行の中身は接触相手のCell::id。NONEとDEADの細胞は含まない。
+ *          stepEndProcessなどで、接触の数や組み合わせを数えるのに使える。
+ *
+ * @return const ContactGraph&
+ */
+const ContactGraph& Simulation::getContactGraph() const noexcept
+{
+    return contactGraph;
+}
+
+/**
+ * @brief 遠隔力の発生源(isRemoteForceSourceがtrueの細胞)の位置と重みから、remote_force.methodに応じてBarnes-Hut法の木か格子を作り直す。
+ */
+void Simulation::prepareRemoteForce()
+{
+    std::vector<Vec3> positions;
+    std::vector<double> weights;
+    positions.reserve(cells.size());
+    weights.reserve(cells.size());
+
+    for (const auto& c : cells) {
+        if (!isRemoteForceSource(c)) {
+            continue;
+        }
+        positions.push_back(c->getPosition());
+        weights.push_back(c->getWeight());
+    }
+
+    if (SimulationSettings::REMOTE_FORCE_METHOD == RemoteForceMethod::BARNES_HUT) {
+        remoteForceTree.build(positions, weights, SimulationSettings::FIELD_Z_LEN > 0 ? 3 : 2);
+    } else {
+        remoteForceMesh.build(positions, weights);
+    }
+}
+
+/**
+ * @brief 細胞cが遠隔力を発生させるかどうか。remote_force.methodがBARNES_HUTかPARTICLE_MESHのとき、trueの細胞だけが木や格子に入る。
+ * @details calcCellCellForceで遠隔力を足す相手の条件と合わせること。既定ではNONEとDEAD以外。
+ */
+bool Simulation::isRemoteForceSource(const std::shared_ptr<UserCell>& c) const noexcept
+{
+    return c->getCellType() != CellType::NONE && c->getCellType() != CellType::DEAD;
+}
+
+/**
+ * @brief 細胞cに働く遠隔力の和を、Barnes-Hut法の木(O(log n))か格子(O(1))で近似して求める。
+ * @details calcRemoteForce(c, c_i)をすべての発生源c_iについて足したものの近似。
+ *          BARNES_HUTならremote_force.theta、PARTICLE_MESHならremote_force.mesh_spacingで精度が決まる。
+ *          同じ位置にある発生源(c自身を含む)は、calcRemoteForceと同じく力を生まない(PARTICLE_MESHではほぼ0)。
+ *
+ * @param c
+ * @return Vec3
+ */
+Vec3 Simulation::calcRemoteForceSum(std::shared_ptr<UserCell> c) const noexcept
+{
+    Vec3 sum;
+    if (SimulationSettings::REMOTE_FORCE_METHOD == RemoteForceMethod::BARNES_HUT) {
+        sum = remoteForceTree.sum(c->getPosition(), SimulationSettings::BARNES_HUT_THETA, SimulationSettings::REMOTE_FORCE_LAMBDA,
+                                  SimulationSettings::REMOTE_FORCE_MAX_DISTANCE);
+    } else {
+        sum = remoteForceMesh.gradient(c->getPosition());
+    }
+
+    return sum.timesScalar(c->getWeight() * REMOTE_FORCE_COEFFICIENT);
 }
 
 /**
@@ -152,52 +829,125 @@ void Simulation::setCellList() noexcept
  * @param c
  * @return Vec3
  * @details Cellから働く力は遠隔力と近隣力の2つで構成される。さらに、近接力は体積排除効果と接着力の2つに分類される。
+ *          遠隔力はremote_force.methodがCUTOFFならCellListの近傍から、BARNES_HUTなら木から、PARTICLE_MESHなら格子から求める。
  */
 Vec3 Simulation::calcCellCellForce(std::shared_ptr<UserCell> c) const noexcept
 {
     Vec3 force = Vec3::zero();
 
-    auto aroundCellList = cellList.aroundCellList(c);
+    std::vector<Vec3> shifts;
+    auto aroundCellList = findAroundCells(c, shifts);
 
-    for (auto i : aroundCellList) {
-        if (cells[i]->getCellType() == CellType::NONE || cells[i]->getCellType() == CellType::DEAD)
-            continue;
+    if (SimulationSettings::REMOTE_FORCE_METHOD != RemoteForceMethod::CUTOFF) {
+        force = calcRemoteForceSum(c);
+    } else {
+        for (size_t n = 0; n < aroundCellList.size(); n++) {
+            if (!isRemoteForceSource(cells[aroundCellList[n]]))
+                continue;
 
-        force += calcRemoteForce(c, cells[i]);
+            force += calcRemoteForce(c, cells[aroundCellList[n]], shifts[n]);
+        }
     }
     force = force.normalize();
 
-    for (auto i : aroundCellList) {
-        if (cells[i]->getCellType() == CellType::NONE || cells[i]->getCellType() == CellType::DEAD)
+    int32_t contactNum = 0;
+    for (size_t n = 0; n < aroundCellList.size(); n++) {
+        const auto& other = cells[aroundCellList[n]];
+        if (other->getCellType() == CellType::NONE || other->getCellType() == CellType::DEAD)
             continue;
-        force += calcVolumeExclusion(c, cells[i]);
+        force += calcVolumeExclusion(c, other, shifts[n]);
+
+        // 読み終えた場所に接触相手のIDを詰める
+        if (other != c && (c->getPosition() - shifts[n] - other->getPosition()).length() < c->getRadius() + other->getRadius()) {
+            aroundCellList[contactNum++] = other->id;
+        }
     }
+    recordContacts(c, std::span(aroundCellList.data(), contactNum));
 
     return force;
 }
 
 /**
- * @brief 与えられたCellに対して働く遠隔力を計算する。O(n^2)
+ * @brief 細胞の種類の組ごとのパラメータ(matrix)を使って、cに働く遠隔力と体積排除・接着の力を計算する。
+ * @details 近傍の細胞ごとに、種類を添字にしてmatrixの行からパラメータを引き、遠隔力と体積排除・接着の力を同じループで足す。
+ *          無効な組は係数が0なので、種類による場合分けをせずに計算しても力は0になる。重なりもmax(0, 1 - d / (r1 + r2))にして場合分けしない。
+ *          遠隔力の和は正規化してから体積排除・接着の力と足す(calcCellCellForceと同じ)。
+ *          重なっている(NONEとDEAD以外の)細胞はrecordContactsで接触として記録する。
+ *          remote_force.methodがCUTOFF以外のときは、cの種類がどれかの種類から遠隔力を受ける場合だけcalcRemoteForceSumを使う。
+ *          このとき発生源はisRemoteForceSourceで選ばれ、組ごとの係数とλは使わない。
  *
  * @param c
+ * @param matrix
  * @return Vec3
- * @details @f{eqnarray*}{
+ */
+Vec3 Simulation::calcInteractionForce(const std::shared_ptr<UserCell>& c, const InteractionMatrix& matrix) const noexcept
+{
+    std::vector<Vec3> shifts;
+    std::vector<int32_t> aroundCells = findAroundCells(c, shifts);
+
+    const InteractionMatrix::Interaction* interactions = matrix.row(c->getCellType());
+    const bool useCutoff                               = SimulationSettings::REMOTE_FORCE_METHOD == RemoteForceMethod::CUTOFF;
+    const Vec3 pos                                     = c->getPosition();
+    const double weight                                = c->getWeight();
+    const double radius                                = c->getRadius();
+
+    Vec3 remote        = Vec3::zero();
+    Vec3 exclusion     = Vec3::zero();
+    int32_t contactNum = 0;
+    for (size_t n = 0; n < aroundCells.size(); n++) {
+        const auto& other                            = cells[aroundCells[n]];
+        const InteractionMatrix::Interaction& params = interactions[(int32_t)other->getCellType()];
+
+        const Vec3 diff   = pos - shifts[n] - other->getPosition();
+        const double dist = diff.length();
+        const Vec3 dir    = diff.normalize();
+
+        if (useCutoff) {
+            remote += -dir.timesScalar(other->getWeight() * weight * REMOTE_FORCE_COEFFICIENT * params.remoteCoefficient * remoteExp(dist / params.lambda));
+        }
+
+        const double overlap = std::max(0.0, 1.0 - dist / (radius + other->getRadius()));
+        exclusion += dir.timesScalar(ipow<2>(overlap) * (params.exclusionBias - params.adhesionBias));
+
+        // 読み終えた場所に接触相手のIDを詰める
+        if (overlap > 0.0 && other != c && other->getCellType() != CellType::NONE && other->getCellType() != CellType::DEAD) {
+            aroundCells[contactNum++] = other->id;
+        }
+    }
+    recordContacts(c, std::span(aroundCells.data(), contactNum));
+
+    if (!useCutoff && matrix.receivesRemote(c->getCellType())) {
+        remote = calcRemoteForceSum(c);
+    }
+
+    return remote.normalize() + exclusion;
+}
+
+/**
+ * @brief c2がc1に及ぼす遠隔力を計算する。
+ *
+ * @param c1
+ * @param c2
+ * @param shift c2の位置に足す像のずれ(周期境界で反対側の端にいる場合。findAroundCellsが返す)
+ * @return Vec3
+ * @details 細胞に働く遠隔力は、これを発生源について足したもの。
+ *          calcCellCellForceは、CUTOFFならsearch_radius内の細胞だけを足し(近傍の細胞数に比例)、BARNES_HUTとPARTICLE_MESHならcalcRemoteForceSumで近似する。
+ * @f{eqnarray*}{
  * F = \sum_i \frac{c(C - C_i)}{|C-C_i|}  *
  * e^{(-|C-C_i|/\lambda)}
  * @f}
  */
-Vec3 Simulation::calcRemoteForce(std::shared_ptr<UserCell> c1, std::shared_ptr<UserCell> c2) const noexcept
+Vec3 Simulation::calcRemoteForce(std::shared_ptr<UserCell> c1, std::shared_ptr<UserCell> c2, const Vec3& shift) const noexcept
 {
-    Vec3 force                   = Vec3::zero();
-    constexpr double COEFFICIENT = 1.0;
-    const Vec3 diff              = c1->getPosition() - c2->getPosition();
-    const double dist            = diff.length();
-    constexpr double LAMBDA      = 30.0;
-    const double weight          = c2->getWeight() * c1->getWeight();
+    Vec3 force          = Vec3::zero();
+    const Vec3 diff     = c1->getPosition() - shift - c2->getPosition();
+    const double dist   = diff.length();
+    const double lambda = SimulationSettings::REMOTE_FORCE_LAMBDA;
+    const double weight = c2->getWeight() * c1->getWeight();
 
     // d = |C1 - C2|
     // F += c (C1 - C2) / d * e^(-d/λ)
-    force += -diff.normalize().timesScalar(weight).timesScalar(COEFFICIENT).timesScalar(std::exp(-dist / LAMBDA));
+    force += -diff.normalize().timesScalar(weight).timesScalar(REMOTE_FORCE_COEFFICIENT).timesScalar(remoteExp(dist / lambda));
 
     return force;
 }
@@ -205,16 +955,18 @@ Vec3 Simulation::calcRemoteForce(std::shared_ptr<UserCell> c1, std::shared_ptr<U
 /**
  * @brief 与えられたCellに働く体積排除効果による力を計算する。O(n^2)
  *
- * @param c
+ * @param c1
+ * @param c2
+ * @param shift c2の位置に足す像のずれ(周期境界で反対側の端にいる場合。findAroundCellsが返す)
  * @return Vec3
  * @details @f{eqnarray*}{
  * F = \sum_i
  * @f}
  */
-Vec3 Simulation::calcVolumeExclusion(std::shared_ptr<UserCell> c1, std::shared_ptr<UserCell> c2) const noexcept
+Vec3 Simulation::calcVolumeExclusion(std::shared_ptr<UserCell> c1, std::shared_ptr<UserCell> c2, const Vec3& shift) const noexcept
 {
     Vec3 force        = Vec3::zero();
-    const Vec3 diff   = c1->getPosition() - c2->getPosition();
+    const Vec3 diff   = c1->getPosition() - shift - c2->getPosition();
     const double dist = diff.length();
     // const double weight               = c2->getWeight() * c1->getWeight();
     const double sumRadius = c1->getRadius() + c2->getRadius();
@@ -224,8 +976,8 @@ Vec3 Simulation::calcVolumeExclusion(std::shared_ptr<UserCell> c1, std::shared_p
 
     if (dist < sumRadius) {
         // force += diff.normalize().timesScalar(std::pow(1.8, overlapDist)).timesScalar(BIAS);
-        force += diff.normalize().timesScalar(pow(1.0 - dist / sumRadius, 2)).timesScalar(ELIMINATION_BIAS);
-        force -= diff.normalize().timesScalar(pow(1.0 - dist / sumRadius, 2)).timesScalar(ADHESION_BIAS);
+        force += diff.normalize().timesScalar(ipow<2>(1.0 - dist / sumRadius)).timesScalar(ELIMINATION_BIAS);
+        force -= diff.normalize().timesScalar(ipow<2>(1.0 - dist / sumRadius)).timesScalar(ADHESION_BIAS);
     }
 
     return force;
@@ -243,7 +995,7 @@ void Simulation::stepEndProcess() noexcept
 }
 
 /**
- * @brief 指定したCellにかかるすべての力を計算する。O(n^2)
+ * @brief 指定したCellにかかるすべての力を計算する。
  *
  * @param c
  * @return Vec3
@@ -268,36 +1020,98 @@ Vec3 Simulation::calcForce(std::shared_ptr<UserCell> c) const noexcept
 int32_t Simulation::nextStep() noexcept
 {
     if (SimulationSettings::USE_CELL_LIST) {
-        cellList.resetGrid();
+        ProfileScope scope("cellList");
         setCellList();
     }
-    Vec3 force = Vec3::zero();
+
+    if (SimulationSettings::REMOTE_FORCE_METHOD != RemoteForceMethod::CUTOFF) {
+        ProfileScope scope("remoteForce");
+        prepareRemoteForce();
+    }
+
+    {
+        // 各スレッドの計測が同じパスにまとまるように、親のパスを渡す
+        const std::string profilePath = Profiler::currentPath();
+        contactGraph.reset((int32_t)cells.size());
 
 // XXX: スレッド数を増やしてもメモリアクセスがボトルネックになってしまう。
-#pragma omp parallel for num_threads(8) schedule(dynamic) private(force)
-    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
-        if (cells[i]->getCellType() == CellType::DEAD || cells[i]->getCellType() == CellType::NONE)
-            continue;
+#pragma omp parallel
+        {
+            ProfileScope scope(profilePath, "force");
+            Vec3 force = Vec3::zero();
 
-        force = calcCellCellForce(cells[i]);
-        cells[i]->addForce(force);
+#pragma omp for schedule(dynamic) nowait
+            for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+                if (cells[i]->getCellType() == CellType::DEAD || cells[i]->getCellType() == CellType::NONE)
+                    continue;
+
+                force = calcCellCellForce(cells[i]);
+                cells[i]->addForce(force);
+            }
+        }
+
+        ProfileScope scope("contactGraph");
+        contactGraph.finish();
     }
 
     for (int32_t i = 0; i < SimulationSettings::MOLECULE_TYPE_NUM; i++) {
+        ProfileScope scope("molecule[" + std::to_string(i) + "]");
         moleculeSpaces[i]->calcConcentrationDiff();
     }
 
-    for (auto cell : cells) {
-        cell->nextStep();
+    {
+        ProfileScope scope("integration");
+        for (auto cell : cells) {
+            cell->nextStep();
+        }
     }
 
     for (int32_t i = 0; i < SimulationSettings::MOLECULE_TYPE_NUM; i++) {
+        ProfileScope scope("molecule[" + std::to_string(i) + "]");
         moleculeSpaces[i]->nextStep();
     }
 
     return 0;
 }
 
+/**
+ * @brief 力を計算せずに、今の位置での接触(中心間の距離 < 半径の和。NONEとDEADは除く)だけをcontactGraphに記録する。
+ * @details 最初の出力(出力番号0)はまだ力を計算していないので、接着情報とクラスタを正しく出すためにその前に呼ぶ。
+ *          接触の判定はcalcCellCellForceと同じで、周期境界では一番近い像との距離を使う。
+ */
+void Simulation::findContacts()
+{
+    ProfileScope scope("contactGraph");
+
+    if (SimulationSettings::USE_CELL_LIST) {
+        setCellList();
+    }
+    contactGraph.reset((int32_t)cells.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int32_t i = 0; i < (int32_t)cells.size(); i++) {
+        const auto& c = cells[i];
+        if (c->getCellType() == CellType::DEAD || c->getCellType() == CellType::NONE)
+            continue;
+
+        std::vector<Vec3> shifts;
+        std::vector<int32_t> aroundCells = findAroundCells(c, shifts);
+        int32_t contactNum               = 0;
+        for (size_t n = 0; n < aroundCells.size(); n++) {
+            const auto& other = cells[aroundCells[n]];
+            if (other == c || other->getCellType() == CellType::NONE || other->getCellType() == CellType::DEAD)
+                continue;
+
+            if ((c->getPosition() - shifts[n] - other->getPosition()).length() < c->getRadius() + other->getRadius()) {
+                aroundCells[contactNum++] = other->id;
+            }
+        }
+        recordContacts(c, std::span(aroundCells.data(), contactNum));
+    }
+
+    contactGraph.finish();
+}
+
 /**
  * @brief シミュレーションを実行する。
  *
@@ -306,41 +1120,126 @@ int32_t Simulation::nextStep() noexcept
  */
 int32_t Simulation::run()
 {
+    if (SimulationSettings::THREAD_NUM > 0) {
+        omp_set_num_threads(SimulationSettings::THREAD_NUM);
+    }
     std::cout << "Open MP max threads: " << omp_get_max_threads() << std::endl;
+    std::cout << "Storage precision: " << STORAGE_PRECISION_NAME << std::endl;
 
-    printCells(0);
-    printMolecules(0);
+    if (SimulationSettings::PROFILE_ENABLED) {
+        Profiler::enable(!SimulationSettings::PROFILE_TRACE_PATH.empty(), SimulationSettings::PROFILE_COUNTERS);
+        if (SimulationSettings::PROFILE_COUNTERS && !Profiler::counterErrorMessage().empty()) {
+            std::cout << (Profiler::isCounting() ? "Some performance counters are unavailable (" : "Performance counters are unavailable (") << Profiler::counterErrorMessage() << ")" << std::endl;
+        }
+    }
     auto sumTime = 0;
 
-    std::cout << "initialized." << std::endl;
+    {
+        ProfileScope runScope("run");
 
-    for (int32_t step = 1; step < SimulationSettings::SIM_STEP; step++) {
-        auto start = std::chrono::system_clock::now();
+        if (startStep == 0) {
+            maintainCellStore();
+            if (SimulationSettings::OUTPUT_ENABLED) {
+                findContacts();
+                output(0);
+            }
+        }
+
+        std::cout << "initialized." << std::endl;
+
+        for (int32_t step = startStep + 1; step < SimulationSettings::SIM_STEP; step++) {
+            ProfileScope stepScope("step");
+            auto start = std::chrono::steady_clock::now();
+
+            currentStep       = step;
+            Cell::currentStep = step; // 細胞の乱数のキーになるので、細胞を触る前に更新する
+
+            {
+                ProfileScope scope("preprocess");
+                stepPreprocess();
+            }
+            {
+                ProfileScope scope("nextStep");
+                nextStep();
+            }
+            {
+                ProfileScope scope("endProcess");
+                stepEndProcess();
+            }
+            bool wasCompacted;
+            {
+                ProfileScope scope("cellStore");
+                wasCompacted = maintainCellStore();
+            }
 
-        stepPreprocess();
-        nextStep();
-        stepEndProcess();
+            const bool willOut = SimulationSettings::OUTPUT_ENABLED && (step % SimulationSettings::OUTPUT_INTERVAL_STEP) == 0;
+            if (willOut) {
+                output(step / SimulationSettings::OUTPUT_INTERVAL_STEP);
+            }
+            const bool wasOut = willOut;
 
-        const bool willOut = (step % SimulationSettings::OUTPUT_INTERVAL_STEP) == 0;
-        if (willOut) {
-            printCells(step / SimulationSettings::OUTPUT_INTERVAL_STEP);
-            printMolecules(step / SimulationSettings::OUTPUT_INTERVAL_STEP);
+            const bool willCheckpoint = SimulationSettings::CHECKPOINT_INTERVAL > 0 && (step % SimulationSettings::CHECKPOINT_INTERVAL) == 0;
+            if (willCheckpoint) {
+                saveCheckpoint();
+            }
+
+            auto end  = std::chrono::steady_clock::now();
+            auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+            std::cout << "step: " << step << "  " << msec << "msec" << (wasOut ? " Outputed" : "") << (wasCompacted ? " Compacted" : "") << (willCheckpoint ? " Checkpointed" : "") << std::endl;
+            sumTime += msec;
         }
-        const bool wasOut = willOut;
 
-        auto end  = std::chrono::system_clock::now();
-        auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        ProfileScope scope("flush");
+        outputWriter.flush();
+        if (container) {
+            container->close();
+        }
+    }
 
-        std::cout << "step: " << step << "  " << msec << "msec" << (wasOut ? " Outputed" : "") << std::endl;
-        sumTime += msec;
+    if (Profiler::isEnabled()) {
+        writeProfile();
     }
 
-    const double averageTime = (double)sumTime / (double)SimulationSettings::SIM_STEP;
+    // 再開した場合はチェックポイントより後のステップだけを実行している
+    const int32_t executedSteps = std::max(SimulationSettings::SIM_STEP - 1 - startStep, 1);
+    const double averageTime    = (double)sumTime / (double)executedSteps;
     std::cout << "Initial cell count : " << SimulationSettings::CELL_NUM << "    average processing time : " << averageTime << std::endl;
+    std::cout << "Output stall time : " << outputWriter.getStallMillis() << "msec" << std::endl;
 
     return 0;
 }
 
+/**
+ * @brief 計測した時間の表(カウンタを集計した場合はその表も)を標準出力に出し、PROFILE_TRACE_PATHが指定されていればトレースを書き出す。
+ */
+void Simulation::writeProfile() const
+{
+    std::cout << std::endl;
+    Profiler::report(std::cout);
+    if (Profiler::isCounting()) {
+        std::cout << std::endl;
+        Profiler::reportCounters(std::cout);
+    }
+
+    const std::string& path = SimulationSettings::PROFILE_TRACE_PATH;
+    if (path.empty()) {
+        return;
+    }
+
+    const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    if (!dir.empty()) {
+        std::filesystem::create_directories(dir);
+    }
+    std::ofstream ofs(path);
+    Profiler::writeTrace(ofs);
+    if (!ofs) {
+        std::cerr << "Failed to write profile trace: " << path << std::endl;
+        return;
+    }
+    std::cout << "Profile trace : " << path << std::endl;
+}
+
 /**
  * @brief
  * なくてもいい。Pythonに情報を渡す都合上必要かもしれなかった。(使っていない)
@@ -16,9 +16,21 @@
 // #include "UserRule.hpp"
 #include "../SimulationSettings.hpp"
 #include "../UserMoleculeSpace.hpp"
+#include "../utils/FastMath.hpp"
+#include "../utils/Profiler.hpp"
 #include "../utils/Util.hpp"
+#include "BarnesHutTree.hpp"
 #include "CellList.hpp"
+#include "CellSnapshot.hpp"
+#include "ClusterAnalysis.hpp"
+#include "ContactGraph.hpp"
+#include "OutputWriter.hpp"
+#include "RemoteForceMesh.hpp"
+#include "TimeSeriesFile.hpp"
+#include "VariableRatioCellList.hpp"
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <memory>
@@ -40,27 +52,74 @@ class Simulation
 {
   protected:
     CellList cellList;                            //!< CellListのデータ構造を管理するクラス
+    VariableRatioCellList variableRatioCellList;  //!< cell_list.typeがADAPTIVEのときに使う、密度に応じてグリッドの大きさを変えるCellList
     std::vector<std::shared_ptr<UserCell>> cells; //!< シミュレーションで使うCellのリスト。
     std::streambuf* consoleStream;                //!< 標準出力のストリームバッファ
 
     std::vector<std::unique_ptr<UserMoleculeSpace>> moleculeSpaces; //!< 分子の空間を管理するクラス。分子の種類ごとに1つの空間を持つ。
 
-    // random
-    std::mt19937 rand_gen{ SimulationSettings::CELL_SEED }; //!< 乱数生成器(生成器はとりあえずメルセンヌ・ツイスタ)
-    std::uniform_real_distribution<> randomCellPosX;        //!< Cellのx座標の生成器
-    std::uniform_real_distribution<> randomCellPosY;        //!< Cellのy座標の生成器
+    int32_t currentStep = 0; //!< 現在のステップ数
+    int32_t startStep   = 0; //!< チェックポイントから再開した場合、そのチェックポイントのステップ数
+
+    CounterRNG randomStream(uint64_t streamId, RandomPurpose purpose) const noexcept;
+
+    static constexpr double REMOTE_FORCE_COEFFICIENT = 1.0; //!< 遠隔力の係数
+
+    BarnesHutTree remoteForceTree;   //!< remote_force.methodがBARNES_HUTのとき、ステップごとに遠隔力の発生源から作り直す
+    RemoteForceMesh remoteForceMesh; //!< remote_force.methodがPARTICLE_MESHのとき、ステップごとに遠隔力の発生源から作り直す
+    FastExp remoteExp;               //!< 遠隔力のe^(-d/λ)。remote_force.expで計算方法を選ぶ
+
+    virtual bool isRemoteForceSource(const std::shared_ptr<UserCell>& c) const noexcept;
+    Vec3 calcRemoteForceSum(std::shared_ptr<UserCell> c) const noexcept;
+    Vec3 calcInteractionForce(const std::shared_ptr<UserCell>& c, const InteractionMatrix& matrix) const noexcept;
+
+    void recordContacts(const std::shared_ptr<UserCell>& c, std::span<const int32_t> contactIds) const noexcept;
+    const ContactGraph& getContactGraph() const noexcept;
+
+    //  周辺のCellのIDを格納する。ただし、vectorは一列分のみしか確保しない。
+    void setCellList() noexcept;
+    std::vector<int32_t> findAroundCells(const std::shared_ptr<UserCell>& c) const;
+    std::vector<int32_t> findAroundCells(const std::shared_ptr<UserCell>& c, std::vector<Vec3>& shifts) const;
+
+    int32_t addCell(std::shared_ptr<UserCell> cell) noexcept;
+    int32_t findSlotById(int32_t id) const noexcept;
+    std::shared_ptr<UserCell> findCellById(int32_t id) const noexcept;
+    bool maintainCellStore() noexcept;
 
   private:
     Field<std::vector<std::shared_ptr<Cell>>> cellsInGrid; //!< グリッド内にcellのポインタを入れる。
 
-    void printHeader() const noexcept;
-    void printCells(int32_t time) const;
-    void printMolecules(int32_t time) const;
+    mutable ContactGraph contactGraph; //!< 直前の力の計算で見つけた接触。力の計算(const)の中で行ごとに書き込むのでmutable
+
+    std::vector<int32_t> idToSlot;  //!< Cell::idからcellsの添字を引くための表。存在しないIDは-1
+    std::vector<int32_t> freeSlots; //!< NONEになった細胞の添字。新しい細胞はここから再利用する
+
+    void registerSlot(int32_t slot) noexcept;
+    void compactCells() noexcept;
+
+    static constexpr const char* CONTAINER_PATH = "./result/timeseries.mcmc"; //!< output.formatがCONTAINERのときの出力先
+    static constexpr const char* CLUSTER_SUMMARY_PATH = "./result/clusters.tsv"; //!< analysis.clustersがtrueのときのクラスタの集計の出力先
+
+    OutputWriter outputWriter;                   //!< 結果の書き出しを行うスレッド
+    std::shared_ptr<TimeSeriesWriter> container; //!< output.formatがCONTAINERのときの出力先。outputWriterのスレッドからのみ触る
+
+    CellSnapshot captureCells(int32_t time) const;
+    std::string cellOutputPath(int32_t time) const;
+    std::string moleculeDirectory(int32_t moleculeType) const;
+    std::string moleculeOutputPath(int32_t moleculeType, int32_t time) const;
+    void output(int32_t time);
+
+    static constexpr char CHECKPOINT_MAGIC[8]    = { 'M', 'C', 'M', 'C', 'C', 'K', 'P', 'T' };
+    static constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+    void writeCheckpoint(std::ostream& os) const;
+    void saveCheckpoint();
+    void writeProfile() const;
 
     //  std::vector<std::unordered_set<int32_t>> aroundCellSetList;
 
-    //  周辺のCellのIDを格納する。ただし、vectorは一列分のみしか確保しない。
-    void setCellList() noexcept;
+    void prepareRemoteForce();
+    void findContacts();
 
     int32_t debugCounter = 0;
 
@@ -74,13 +133,15 @@ class Simulation
     void exportConfig() const;
 
     virtual void initCells() noexcept;
+    void loadCells(const std::string& path);
+    void loadCheckpoint(const std::string& path);
     void initDirectories();
 
     virtual Vec3 calcCellCellForce(std::shared_ptr<UserCell>) const noexcept;
     virtual void stepPreprocess() noexcept;
     virtual void stepEndProcess() noexcept;
-    Vec3 calcRemoteForce(std::shared_ptr<UserCell>, std::shared_ptr<UserCell>) const noexcept;
-    Vec3 calcVolumeExclusion(std::shared_ptr<UserCell>, std::shared_ptr<UserCell>) const noexcept;
+    Vec3 calcRemoteForce(std::shared_ptr<UserCell>, std::shared_ptr<UserCell>, const Vec3& shift = Vec3::zero()) const noexcept;
+    Vec3 calcVolumeExclusion(std::shared_ptr<UserCell>, std::shared_ptr<UserCell>, const Vec3& shift = Vec3::zero()) const noexcept;
     Vec3 calcForce(std::shared_ptr<UserCell>) const noexcept;
 
     int32_t nextStep() noexcept;
@@ -0,0 +1,402 @@
+/**
+ * @file TimeSeriesFile.cpp
+ * @author Takanori Saiki
+ * @brief Cellと分子の出力をすべてのステップ分まとめて1つのファイルに書き込む。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TimeSeriesFile.hpp"
+#include "../utils/BinaryIO.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+    /**
+     * @brief 索引の1項目を書き込む。
+     */
+    void writeEntry(std::ostream& os, const TimeSeriesEntry& entry)
+    {
+        const uint8_t reserved[3] = {};
+
+        BinaryIO::writeValue(os, entry.kind);
+        BinaryIO::writeArray(os, reserved, 3);
+        BinaryIO::writeValue(os, entry.step);
+        BinaryIO::writeValue(os, entry.channel);
+        BinaryIO::writeValue(os, entry.offset);
+        BinaryIO::writeValue(os, entry.size);
+    }
+
+    /**
+     * @brief 索引の1項目を読み込む。
+     */
+    TimeSeriesEntry readEntry(std::istream& is)
+    {
+        TimeSeriesEntry entry;
+        uint8_t reserved[3];
+
+        entry.kind = BinaryIO::readValue<ChunkKind>(is);
+        BinaryIO::readArray(is, reserved, 3);
+        entry.step    = BinaryIO::readValue<int32_t>(is);
+        entry.channel = BinaryIO::readValue<int32_t>(is);
+        entry.offset  = BinaryIO::readValue<uint64_t>(is);
+        entry.size    = BinaryIO::readValue<uint64_t>(is);
+
+        return entry;
+    }
+} // namespace
+
+/**
+ * @brief ファイルを作成し、先頭部分を書き込む。同じ名前のファイルがある場合は上書きする。
+ * @details resumeStepが0以上で既存のファイルがある場合は、出力番号がresumeStep以下のチャンクを残して続きから追記する。
+ *          (チェックポイントからの再開用。索引と、それより後のチャンクは切り捨てる)
+ *
+ * @param path 出力先
+ * @param useFloat32 trueの場合、実数をfloat32に落として書き込む
+ * @param compression 分子の格子の圧縮方法
+ * @param errorBound compressionがLOSSYのときの誤差の上限
+ * @param resumeStep 再開する場合は残す最後の出力番号。-1なら新しく作る
+ */
+TimeSeriesWriter::TimeSeriesWriter(const std::string& path, bool useFloat32, CompressionMode compression, double errorBound, int32_t resumeStep)
+  : useFloat32(useFloat32)
+  , compression(compression)
+  , errorBound(errorBound)
+{
+    if (resumeStep >= 0 && std::filesystem::exists(path) && TimeSeriesReader::isTimeSeries(path)) {
+        uint64_t end = TimeSeriesFile::HEADER_SIZE;
+        {
+            TimeSeriesReader reader(path);
+            for (const auto& entry : reader.getEntries()) {
+                if (entry.step > resumeStep) {
+                    break; // チャンクは出力番号の順に並んでいる
+                }
+                entries.push_back(entry);
+                end = entry.offset + entry.size;
+            }
+        }
+
+        std::filesystem::resize_file(path, end);
+        ofs.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        ofs.seekp(end);
+        if (!ofs) {
+            throw std::runtime_error("TimeSeriesWriter : cannot reopen " + path + ".");
+        }
+
+        return;
+    }
+
+    ofs.open(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        throw std::runtime_error("TimeSeriesWriter : cannot open " + path + ".");
+    }
+
+    BinaryIO::writeArray(ofs, TimeSeriesFile::MAGIC, 8);
+    BinaryIO::writeValue(ofs, TimeSeriesFile::VERSION);
+    BinaryIO::writeValue<uint32_t>(ofs, 0);
+}
+
+/**
+ * @brief close()が呼ばれていなければ索引を書き込む。
+ *
+ */
+TimeSeriesWriter::~TimeSeriesWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+/**
+ * @brief チャンクの先頭部分を書き込み、索引に項目を追加する。sizeはendChunk()で埋める。
+ *
+ * @param kind
+ * @param step
+ * @param channel
+ * @return std::ostream& 中身を書き込むストリーム
+ */
+std::ostream& TimeSeriesWriter::beginChunk(ChunkKind kind, int32_t step, int32_t channel)
+{
+    const uint8_t reserved[3] = {};
+
+    BinaryIO::writeArray(ofs, TimeSeriesFile::CHUNK_TAG, 4);
+    BinaryIO::writeValue(ofs, kind);
+    BinaryIO::writeArray(ofs, reserved, 3);
+    BinaryIO::writeValue(ofs, step);
+    BinaryIO::writeValue(ofs, channel);
+    BinaryIO::writeValue<uint64_t>(ofs, 0);
+
+    entries.push_back({ kind, step, channel, static_cast<uint64_t>(ofs.tellp()), 0 });
+
+    return ofs;
+}
+
+/**
+ * @brief 書き込んだ中身の大きさをチャンクの先頭部分に書き戻す。
+ * @details 書き戻したあとでflushするので、シミュレーションの実行中でも書き終わったチャンクまでは読める。
+ */
+void TimeSeriesWriter::endChunk()
+{
+    TimeSeriesEntry& entry = entries.back();
+    const uint64_t end     = ofs.tellp();
+    entry.size             = end - entry.offset;
+
+    ofs.seekp(entry.offset - sizeof(uint64_t));
+    BinaryIO::writeValue(ofs, entry.size);
+    ofs.seekp(end);
+    ofs.flush();
+
+    if (!ofs) {
+        throw std::runtime_error("TimeSeriesWriter : failed to write a chunk.");
+    }
+}
+
+/**
+ * @brief Cellの状態を1チャンクとして追記する。出力番号はsnapshot.stepを使う。
+ *
+ * @param snapshot
+ */
+void TimeSeriesWriter::appendCells(const CellSnapshot& snapshot)
+{
+    snapshot.writeBinary(beginChunk(ChunkKind::CELLS, snapshot.step, -1), useFloat32);
+    endChunk();
+}
+
+/**
+ * @brief 分子の格子の値を1チャンクとして追記する。
+ *
+ * @param step 出力番号
+ * @param moleculeType 分子の種類
+ * @param grid
+ */
+void TimeSeriesWriter::appendMolecules(int32_t step, int32_t moleculeType, const MoleculeGrid& grid)
+{
+    grid.writeBinary(beginChunk(ChunkKind::MOLECULES, step, moleculeType), useFloat32, compression, errorBound);
+    endChunk();
+}
+
+/**
+ * @brief 索引を書き込んでファイルを閉じる。2回目以降は何もしない。
+ *
+ */
+void TimeSeriesWriter::close()
+{
+    if (!ofs.is_open()) {
+        return;
+    }
+
+    const uint64_t indexOffset = ofs.tellp();
+    for (const auto& entry : entries) {
+        writeEntry(ofs, entry);
+    }
+    BinaryIO::writeValue(ofs, indexOffset);
+    BinaryIO::writeValue<uint32_t>(ofs, entries.size());
+    BinaryIO::writeArray(ofs, TimeSeriesFile::INDEX_MAGIC, 8);
+    ofs.close();
+
+    if (!ofs) {
+        throw std::runtime_error("TimeSeriesWriter : failed to write the index.");
+    }
+}
+
+/**
+ * @brief ファイルを開いて索引を読み込む。索引がない場合はチャンクをたどって作る。
+ *
+ * @param path
+ */
+TimeSeriesReader::TimeSeriesReader(const std::string& path)
+  : ifs(path, std::ios::binary)
+{
+    if (!ifs) {
+        throw std::runtime_error("TimeSeriesReader : cannot open " + path + ".");
+    }
+
+    char magic[8];
+    BinaryIO::readArray(ifs, magic, 8);
+    if (!std::equal(magic, magic + 8, TimeSeriesFile::MAGIC)) {
+        throw std::runtime_error("TimeSeriesReader : " + path + " is not a time series file.");
+    }
+    const uint32_t version = BinaryIO::readValue<uint32_t>(ifs);
+    if (version > TimeSeriesFile::VERSION) {
+        throw std::runtime_error("TimeSeriesReader : unsupported version " + std::to_string(version) + ".");
+    }
+
+    indexed = readIndex();
+    if (!indexed) {
+        scanChunks();
+    }
+}
+
+/**
+ * @brief ファイル末尾の索引を読み込む。
+ *
+ * @return true 索引があった
+ * @return false 索引がない、あるいは壊れている
+ */
+bool TimeSeriesReader::readIndex()
+{
+    ifs.seekg(0, std::ios::end);
+    const uint64_t fileSize = ifs.tellg();
+    if (fileSize < TimeSeriesFile::HEADER_SIZE + TimeSeriesFile::FOOTER_SIZE) {
+        return false;
+    }
+
+    ifs.seekg(fileSize - TimeSeriesFile::FOOTER_SIZE);
+    const uint64_t indexOffset = BinaryIO::readValue<uint64_t>(ifs);
+    const uint32_t entryCount  = BinaryIO::readValue<uint32_t>(ifs);
+    char magic[8];
+    BinaryIO::readArray(ifs, magic, 8);
+
+    if (!std::equal(magic, magic + 8, TimeSeriesFile::INDEX_MAGIC) || indexOffset + (uint64_t)entryCount * TimeSeriesFile::ENTRY_SIZE + TimeSeriesFile::FOOTER_SIZE != fileSize) {
+        return false;
+    }
+
+    ifs.seekg(indexOffset);
+    entries.resize(entryCount);
+    for (auto& entry : entries) {
+        entry = readEntry(ifs);
+    }
+
+    return true;
+}
+
+/**
+ * @brief 先頭からチャンクをたどって索引を作る。途中で切れているチャンクは無視する。
+ *
+ */
+void TimeSeriesReader::scanChunks()
+{
+    ifs.clear();
+    ifs.seekg(0, std::ios::end);
+    const uint64_t fileSize = ifs.tellg();
+    uint64_t pos            = TimeSeriesFile::HEADER_SIZE;
+
+    while (pos + TimeSeriesFile::CHUNK_HEADER_SIZE <= fileSize) {
+        ifs.seekg(pos);
+        char tag[4];
+        BinaryIO::readArray(ifs, tag, 4);
+        if (!std::equal(tag, tag + 4, TimeSeriesFile::CHUNK_TAG)) {
+            break;
+        }
+
+        TimeSeriesEntry entry;
+        uint8_t reserved[3];
+        entry.kind = BinaryIO::readValue<ChunkKind>(ifs);
+        BinaryIO::readArray(ifs, reserved, 3);
+        entry.step    = BinaryIO::readValue<int32_t>(ifs);
+        entry.channel = BinaryIO::readValue<int32_t>(ifs);
+        entry.size    = BinaryIO::readValue<uint64_t>(ifs);
+        entry.offset  = pos + TimeSeriesFile::CHUNK_HEADER_SIZE;
+
+        // 書き込み中のチャンクはsizeが0のままか、ファイルの末尾を超えている
+        if (entry.size == 0 || entry.offset + entry.size > fileSize) {
+            break;
+        }
+
+        entries.push_back(entry);
+        pos = entry.offset + entry.size;
+    }
+}
+
+const TimeSeriesEntry* TimeSeriesReader::find(ChunkKind kind, int32_t step, int32_t channel) const noexcept
+{
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const TimeSeriesEntry& e) { return e.kind == kind && e.step == step && e.channel == channel; });
+
+    return it == entries.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief すべてのチャンクの位置を返す。書き込んだ順に並んでいる。
+ *
+ * @return const std::vector<TimeSeriesEntry>&
+ */
+const std::vector<TimeSeriesEntry>& TimeSeriesReader::getEntries() const noexcept
+{
+    return entries;
+}
+
+/**
+ * @brief ファイルに索引があったかどうかを返す。falseの場合は途中までしか書かれていない。
+ *
+ * @return bool
+ */
+bool TimeSeriesReader::hasIndex() const noexcept
+{
+    return indexed;
+}
+
+/**
+ * @brief Cellの状態が記録されている出力番号を昇順で返す。
+ *
+ * @return std::vector<int32_t>
+ */
+std::vector<int32_t> TimeSeriesReader::steps() const
+{
+    std::vector<int32_t> result;
+    for (const auto& entry : entries) {
+        if (entry.kind == ChunkKind::CELLS) {
+            result.push_back(entry.step);
+        }
+    }
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+/**
+ * @brief 出力番号stepのCellの状態を読み込む。
+ *
+ * @param step 出力番号
+ * @return CellSnapshot
+ */
+CellSnapshot TimeSeriesReader::readCells(int32_t step)
+{
+    const TimeSeriesEntry* entry = find(ChunkKind::CELLS, step, -1);
+    if (entry == nullptr) {
+        throw std::out_of_range("TimeSeriesReader::readCells() : step " + std::to_string(step) + " is not recorded.");
+    }
+
+    ifs.clear();
+    ifs.seekg(entry->offset);
+
+    return CellSnapshot::readBinary(ifs);
+}
+
+/**
+ * @brief 出力番号stepの分子の格子の値を読み込む。
+ *
+ * @param step 出力番号
+ * @param moleculeType 分子の種類
+ * @return MoleculeGrid
+ */
+MoleculeGrid TimeSeriesReader::readMolecules(int32_t step, int32_t moleculeType)
+{
+    const TimeSeriesEntry* entry = find(ChunkKind::MOLECULES, step, moleculeType);
+    if (entry == nullptr) {
+        throw std::out_of_range("TimeSeriesReader::readMolecules() : step " + std::to_string(step) + " of molecule " + std::to_string(moleculeType) + " is not recorded.");
+    }
+
+    ifs.clear();
+    ifs.seekg(entry->offset);
+
+    return MoleculeGrid::readBinary(ifs);
+}
+
+/**
+ * @brief ファイルの先頭がTimeSeriesFile::MAGICかどうかを調べる。
+ *
+ * @param path
+ * @return bool
+ */
+bool TimeSeriesReader::isTimeSeries(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    char magic[8] = {};
+    ifs.read(magic, 8);
+
+    return ifs && std::equal(magic, magic + 8, TimeSeriesFile::MAGIC);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file TimeSeriesFile.hpp
+ * @author Takanori Saiki
+ * @brief Cellと分子の出力をすべてのステップ分まとめて1つのファイルに書き込む。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "CellSnapshot.hpp"
+#include "MoleculeGrid.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief チャンクの中身の種類
+ */
+enum class ChunkKind : uint8_t
+{
+    CELLS,     // CellSnapshotのバイナリ形式
+    MOLECULES, // MoleculeGrid
+};
+
+/**
+ * @brief 索引の1項目。1つのチャンクの位置を表す。
+ */
+struct TimeSeriesEntry
+{
+    ChunkKind kind;  //!< チャンクの種類
+    int32_t step;    //!< 出力番号
+    int32_t channel; //!< 分子の種類。Cellのチャンクは-1
+    uint64_t offset; //!< 中身の先頭のファイル内の位置
+    uint64_t size;   //!< 中身のバイト数
+};
+
+/**
+ * @class TimeSeriesFile
+ * @brief ファイルの形式を定義する。数値はすべてリトルエンディアン。
+ * @details
+ * @code
+ * char     magic[8]    "MCMCSERI"
+ * uint32   version
+ * uint32   reserved
+ * chunk * n            出力のたびに末尾へ追記する
+ * index                close()のときに書き込む
+ *
+ * chunk:
+ * char     tag[4]      "CHNK"
+ * uint8    kind        ChunkKind
+ * uint8    reserved[3]
+ * int32    step
+ * int32    channel
+ * uint64   size
+ * uint8    payload[size]
+ *
+ * index:
+ * entry * entryCount   (uint8 kind, uint8 reserved[3], int32 step, int32 channel, uint64 offset, uint64 size)
+ * uint64   indexOffset
+ * uint32   entryCount
+ * char     magic[8]    "MCMCINDX"
+ *
+ * CELLSのpayloadはCellSnapshot、MOLECULESのpayloadはMoleculeGridのバイナリ形式。
+ * @endcode
+ * 索引がない(シミュレーションが途中で止まった、あるいは実行中)ファイルはチャンクを先頭から順にたどって読む。
+ */
+class TimeSeriesFile
+{
+  public:
+    static constexpr char MAGIC[8]       = { 'M', 'C', 'M', 'C', 'S', 'E', 'R', 'I' };
+    static constexpr char INDEX_MAGIC[8] = { 'M', 'C', 'M', 'C', 'I', 'N', 'D', 'X' };
+    static constexpr char CHUNK_TAG[4]   = { 'C', 'H', 'N', 'K' };
+    static constexpr uint32_t VERSION    = 1;
+
+    static constexpr uint64_t HEADER_SIZE       = 16; //!< ファイルの先頭部分のバイト数
+    static constexpr uint64_t CHUNK_HEADER_SIZE = 24; //!< チャンクの先頭部分のバイト数
+    static constexpr uint64_t ENTRY_SIZE        = 28; //!< 索引の1項目のバイト数
+    static constexpr uint64_t FOOTER_SIZE       = 20; //!< 索引の末尾(indexOffset, entryCount, magic)のバイト数
+};
+
+/**
+ * @class TimeSeriesWriter
+ * @brief チャンクを追記していき、close()で索引を書き込む。
+ * @details 同時に使うスレッドは1つだけであること(OutputWriterの書き出しスレッドから使う)。
+ */
+class TimeSeriesWriter
+{
+  private:
+    std::ofstream ofs;
+    std::vector<TimeSeriesEntry> entries;
+    bool useFloat32;
+    CompressionMode compression; //!< 分子の格子の圧縮方法
+    double errorBound;           //!< compressionがLOSSYのときの誤差の上限
+
+    std::ostream& beginChunk(ChunkKind kind, int32_t step, int32_t channel);
+    void endChunk();
+
+  public:
+    TimeSeriesWriter(const std::string& path, bool useFloat32, CompressionMode compression = CompressionMode::NONE, double errorBound = 0.0, int32_t resumeStep = -1);
+    ~TimeSeriesWriter();
+
+    void appendCells(const CellSnapshot& snapshot);
+    void appendMolecules(int32_t step, int32_t moleculeType, const MoleculeGrid& grid);
+    void close();
+};
+
+/**
+ * @class TimeSeriesReader
+ * @brief 索引を読み込み、必要なチャンクだけをファイルから読む。
+ */
+class TimeSeriesReader
+{
+  private:
+    std::ifstream ifs;
+    std::vector<TimeSeriesEntry> entries;
+    bool indexed = false;
+
+    bool readIndex();
+    void scanChunks();
+    const TimeSeriesEntry* find(ChunkKind kind, int32_t step, int32_t channel) const noexcept;
+
+  public:
+    explicit TimeSeriesReader(const std::string& path);
+
+    const std::vector<TimeSeriesEntry>& getEntries() const noexcept;
+    bool hasIndex() const noexcept;
+    std::vector<int32_t> steps() const;
+
+    CellSnapshot readCells(int32_t step);
+    MoleculeGrid readMolecules(int32_t step, int32_t moleculeType);
+
+    static bool isTimeSeries(const std::string& path);
+};
@@ -1,7 +1,7 @@
 /**
  * @file VariableRatioCellList.cpp
  * @author Takanori Saiki
- * @brief SegmentTreeを用いた放射状の区間計算を行うデータ構造を管理するためのクラス。
+ * @brief 細胞の密度に応じてグリッドの大きさを変えるCellList
  * @version 0.1
  * @date 2022-06-20
  *
@@ -10,13 +10,30 @@
  */
 
 #include "VariableRatioCellList.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
 
 /**
- * @brief SegmentTreeを初期化する。
+ * @brief 細かいグリッドとSegmentTreeを確保する。
  *
+ * @param fieldXLen フィールドのx方向の長さ
+ * @param fieldYLen フィールドのy方向の長さ
+ * @param baseGridSize 最も細かいグリッドの一辺
+ * @param bucketCells 1つのバケツの細胞数がこれを超えたら4つに分ける
+ * @param searchRadius この半径内の細胞を近傍とする
  */
-VariableRatioCellList::VariableRatioCellList()
-  : sgTree(FIELD_X_LEN, FIELD_Y_LEN, 0)
+VariableRatioCellList::VariableRatioCellList(double fieldXLen, double fieldYLen, int32_t baseGridSize, int32_t bucketCells, double searchRadius)
+  : fieldX(fieldXLen)
+  , fieldY(fieldYLen)
+  , baseGridSize(std::max(baseGridSize, 1))
+  , baseLenX(std::max((int32_t)std::ceil(fieldXLen / this->baseGridSize), 1))
+  , baseLenY(std::max((int32_t)std::ceil(fieldYLen / this->baseGridSize), 1))
+  , rootSize((int32_t)std::bit_ceil((uint32_t)std::max(baseLenX, baseLenY)))
+  , bucketCells(std::max(bucketCells, 1))
+  , searchRadius(searchRadius)
+  , countTree(baseLenY, baseLenX, 0)
+  , bucketOfGrid((size_t)baseLenX * baseLenY, 0)
 {
 }
 
@@ -24,41 +41,146 @@ VariableRatioCellList::~VariableRatioCellList()
 {
 }
 
+int32_t VariableRatioCellList::gridX(double x) const noexcept
+{
+    return std::clamp((int32_t)std::floor((x + fieldX / 2) / baseGridSize), 0, baseLenX - 1);
+}
+
+int32_t VariableRatioCellList::gridY(double y) const noexcept
+{
+    return std::clamp((int32_t)std::floor((y + fieldY / 2) / baseGridSize), 0, baseLenY - 1);
+}
+
 /**
- * @brief 対象のセルを中心に放射状に広がるグリッドを考え、各グリッド内にあるセルをひとまとめにして返す。
+ * @brief 細胞の位置からバケツを作り直す。positionsの添字がaroundCellListの返す添字になる。
+ * @details 1. 細かいグリッドごとの細胞数をSegmentTreeに入れる。
+ *          2. 根から、細胞数がbucketCellsを超える正方形を4つに分ける。
+ *          3. 細胞をバケツごとに並べる(計数ソート)。
  *
- * @param c
- * @return std::vector<Cell*>
+ * @param positions 細胞の位置(Simulation::cellsと同じ順)
  */
-std::vector<Cell*> VariableRatioCellList::aroundCellList(const Cell& c)
+void VariableRatioCellList::build(const std::vector<Vec3>& positions)
 {
-    std::vector<Cell*> aroundCells;
+    const int32_t n = positions.size();
 
-    std::cout << c.getPosition().x << " " << c.getPosition().y << std::endl;
+    std::vector<int32_t> gridOf(n);
+    std::vector<int32_t> counts((size_t)baseLenX * baseLenY, 0);
+    for (int32_t i = 0; i < n; i++) {
+        gridOf[i] = gridY(positions[i].y) * baseLenX + gridX(positions[i].x);
+        counts[gridOf[i]]++;
+    }
 
-    return aroundCells;
+    for (int32_t y = 0; y < baseLenY; y++) {
+        for (int32_t x = 0; x < baseLenX; x++) {
+            countTree.set(y, x, counts[y * baseLenX + x]);
+        }
+    }
+    countTree.build();
+
+    nodes.clear();
+    nodes.push_back(Node{ 0, 0, rootSize });
+    split(0);
+
+    // バケツ(葉ノード)ごとの細胞数から、cellIndicesでの範囲を決める
+    std::vector<int32_t> offsets(nodes.size() + 1, 0);
+    for (int32_t i = 0; i < n; i++) {
+        offsets[bucketOfGrid[gridOf[i]] + 1]++;
+    }
+    for (size_t b = 0; b < nodes.size(); b++) {
+        offsets[b + 1] += offsets[b];
+        nodes[b].begin = offsets[b];
+        nodes[b].end   = offsets[b + 1];
+    }
+
+    cellIndices.resize(n);
+    cellPositions.resize(n);
+    for (int32_t i = 0; i < n; i++) {
+        const int32_t dst  = offsets[bucketOfGrid[gridOf[i]]]++;
+        cellIndices[dst]   = i;
+        cellPositions[dst] = positions[i];
+    }
 }
 
 /**
- * @brief 最小グリッド内にセルを追加する(実際には、そのグリッドの重さを加算するだけ)
- *
- * @param c
+ * @brief nodes[index]の細胞数がbucketCellsを超えていれば4つに分け、子ノードも再帰的に分ける。分けなければバケツにする。
  */
-void VariableRatioCellList::setCell(Cell* c)
+void VariableRatioCellList::split(int32_t index)
 {
-    int32_t nowWeight = sgTree.get(c->getPosition().x, c->getPosition().y);
-    sgTree.update(c->getPosition().x, c->getPosition().y, nowWeight + c->getWeight());
+    const Node node     = nodes[index];
+    const int32_t count = countTree.query(node.y, node.x, node.y + node.size, node.x + node.size);
+
+    if (count > bucketCells && node.size > 1) {
+        const int32_t half      = node.size / 2;
+        const int32_t first     = nodes.size();
+        nodes[index].firstChild = first;
+
+        nodes.push_back(Node{ node.x, node.y, half });
+        nodes.push_back(Node{ node.x + half, node.y, half });
+        nodes.push_back(Node{ node.x, node.y + half, half });
+        nodes.push_back(Node{ node.x + half, node.y + half, half });
+        for (int32_t c = first; c < first + 4; c++) {
+            split(c);
+        }
+        return;
+    }
+
+    for (int32_t y = node.y; y < std::min(node.y + node.size, baseLenY); y++) {
+        for (int32_t x = node.x; x < std::min(node.x + node.size, baseLenX); x++) {
+            bucketOfGrid[y * baseLenX + x] = index;
+        }
+    }
 }
 
 /**
- * @brief aroundCellListで取得したセルを削除する(メモリを開放する)
+ * @brief posからsearchRadius内にある細胞の添字(build()に渡した配列の添字)を返す。posにある細胞自身も含む。
+ * @details 探索範囲の正方形と重なるノードだけを根からたどり、重なったバケツの細胞との距離を調べる。
  *
+ * @param pos
+ * @return std::vector<int32_t>
  */
-void VariableRatioCellList::deleteCells()
+std::vector<int32_t> VariableRatioCellList::aroundCellList(const Vec3& pos) const
 {
-    while (!stackCells.empty()) {
-        Cell* c = stackCells.top();
-        stackCells.pop();
-        delete c;
+    std::vector<int32_t> aroundCells;
+    if (nodes.empty()) {
+        return aroundCells;
+    }
+
+    const int32_t x0     = gridX(pos.x - searchRadius);
+    const int32_t x1     = gridX(pos.x + searchRadius);
+    const int32_t y0     = gridY(pos.y - searchRadius);
+    const int32_t y1     = gridY(pos.y + searchRadius);
+    const double radius2 = searchRadius * searchRadius;
+
+    std::vector<int32_t> stack = { 0 };
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.x > x1 || node.x + node.size <= x0 || node.y > y1 || node.y + node.size <= y0) {
+            continue;
+        }
+
+        if (node.firstChild != -1) {
+            for (int32_t c = node.firstChild; c < node.firstChild + 4; c++) {
+                stack.push_back(c);
+            }
+            continue;
+        }
+
+        for (int32_t i = node.begin; i < node.end; i++) {
+            if ((cellPositions[i] - pos).lengthSquared() <= radius2) {
+                aroundCells.emplace_back(cellIndices[i]);
+            }
+        }
     }
-}
\ No newline at end of file
+
+    return aroundCells;
+}
+
+/**
+ * @brief バケツ(葉ノード)の数
+ */
+int32_t VariableRatioCellList::bucketCount() const noexcept
+{
+    return std::count_if(nodes.begin(), nodes.end(), [](const Node& node) { return node.firstChild == -1; });
+}
@@ -1,7 +1,7 @@
 /**
  * @file VariableRatioCellList.hpp
  * @author Takanori Saiki
- * @brief SegmentTreeを用いた放射状の区間計算を行うデータ構造を管理するためのクラス。
+ * @brief 細胞の密度に応じてグリッドの大きさを変えるCellList
  * @version 0.1
  * @date 2022-06-16
  *
@@ -11,23 +11,58 @@
 
 #pragma once
 
-#include "../SimulationSettings.hpp"
-#include "Cell.hpp"
+#include "../utils/Vec3.hpp"
 #include "SegmentTree.hpp"
-#include <stack>
+#include <cstdint>
 #include <vector>
 
+/**
+ * @class VariableRatioCellList
+ * @brief 細胞の多い領域は細かいグリッド(バケツ)に、少ない領域は粗いグリッドに分けて近傍の細胞を探す。
+ * @details フィールドを一辺baseGridSizeの細かいグリッドに分け、グリッドごとの細胞数を2次元のSegmentTreeに入れる。
+ *          フィールド全体を覆う正方形から始めて、中の細胞数(SegmentTreeの区間和)がbucketCellsを超える正方形を4つに分け(四分木)、
+ *          分けなくなった正方形を1つのバケツにする。細胞はバケツごとに連続して並べる(CSR形式)。
+ *          aroundCellListは探索範囲と重なるバケツだけを四分木でたどるので、
+ *          密集した場所では余分な細胞を、まばらな場所では空のグリッドをあまり調べずに済む。
+ *          フィールドの外の細胞は一番近いグリッドに入れる。
+ */
 class VariableRatioCellList
 {
-    private:
-    SegmentTree<int, int> sgTree;
-    std::stack<Cell*> stackCells; //!< aroundCellListで生成した仮想セルを管理するスタック
+  private:
+    /**
+     * @brief 四分木のノード。座標は細かいグリッドの単位。
+     */
+    struct Node {
+        int32_t x, y, size;      //!< 覆う正方形の左下の角と一辺
+        int32_t firstChild = -1; //!< 子ノード(4つ連続)の先頭。葉(バケツ)なら-1
+        int32_t begin = 0;       //!< 葉のとき、cellIndicesでの範囲 [begin, end)
+        int32_t end   = 0;
+    };
+
+    const double fieldX, fieldY; //!< フィールドの辺の長さ(原点が中心)
+    const int32_t baseGridSize;  //!< 細かいグリッドの一辺
+    const int32_t baseLenX;      //!< x方向の細かいグリッドの数
+    const int32_t baseLenY;      //!< y方向の細かいグリッドの数
+    const int32_t rootSize;      //!< 四分木の根の一辺(2のべき乗)
+    const int32_t bucketCells;   //!< 1つのバケツに入れる細胞数の目安
+    const double searchRadius;   //!< この半径内の細胞を近傍とする
 
-    public:
-    VariableRatioCellList(/* args */);
+    SegmentTree<int32_t> countTree;          //!< 細かいグリッドごとの細胞数(行がy、列がx)
+    std::vector<Node> nodes;                 //!< nodes[0]が根
+    std::vector<int32_t> bucketOfGrid;       //!< 細かいグリッドが属する葉ノード
+    std::vector<int32_t> cellIndices;        //!< バケツごとに並べた細胞の添字
+    std::vector<PaddedVec3<double>> cellPositions; //!< cellIndicesと同じ順の細胞の位置。1つを1回のロードで読めるよう32バイトにそろえる
+
+    int32_t gridX(double x) const noexcept;
+    int32_t gridY(double y) const noexcept;
+    void split(int32_t index);
+
+  public:
+    VariableRatioCellList(double fieldXLen, double fieldYLen, int32_t baseGridSize, int32_t bucketCells, double searchRadius);
     ~VariableRatioCellList();
 
-    std::vector<Cell*> aroundCellList(const Cell&);
-    void setCell(Cell*);
-    void deleteCells();
+    void build(const std::vector<Vec3>& positions);
+    std::vector<int32_t> aroundCellList(const Vec3& pos) const;
+
+    int32_t bucketCount() const noexcept;
 };
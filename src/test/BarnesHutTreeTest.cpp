@@ -0,0 +1,125 @@
+#include "../core/BarnesHutTree.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr double LAMBDA = 30.0;
+
+    struct Sources {
+        vector<Vec3> positions;
+        vector<double> weights;
+    };
+
+    Sources randomSources(int32_t n, int32_t dim, double len, uint64_t seed)
+    {
+        mt19937_64 engine(seed);
+        uniform_real_distribution<double> pos(0, len);
+        uniform_real_distribution<double> weight(0.5, 2.0);
+
+        Sources s;
+        for (int32_t i = 0; i < n; i++) {
+            s.positions.emplace_back(pos(engine), pos(engine), dim == 3 ? pos(engine) : 0.0);
+            s.weights.push_back(weight(engine));
+        }
+        return s;
+    }
+
+    Vec3 directSum(const Sources& s, const Vec3& p, double maxDistance)
+    {
+        Vec3 force = Vec3::zero();
+        for (size_t i = 0; i < s.positions.size(); i++) {
+            const Vec3 diff   = s.positions[i] - p;
+            const double dist = diff.length();
+            if (dist == 0 || (maxDistance > 0 && dist > maxDistance)) {
+                continue;
+            }
+            force += diff.timesScalar(s.weights[i] * exp(-dist / LAMBDA) / dist);
+        }
+        return force;
+    }
+} // namespace
+
+TEST(BarnesHutTreeTest, EmptyTreeGivesZero)
+{
+    BarnesHutTree tree;
+    tree.build({}, {}, 2);
+
+    EXPECT_EQ(tree.size(), 0);
+    EXPECT_EQ(tree.sum(Vec3(1, 2, 0), 0.5, LAMBDA), Vec3::zero());
+}
+
+TEST(BarnesHutTreeTest, ThetaZeroMatchesDirectSum)
+{
+    for (int32_t dim : { 2, 3 }) {
+        const Sources s = randomSources(3000, dim, 256, dim);
+        BarnesHutTree tree;
+        tree.build(s.positions, s.weights, dim);
+        ASSERT_EQ(tree.size(), 3000);
+
+        for (int32_t i = 0; i < 3000; i += 97) {
+            const Vec3 expected = directSum(s, s.positions[i], 0);
+            const Vec3 actual   = tree.sum(s.positions[i], 0, LAMBDA);
+            EXPECT_NEAR(actual.x, expected.x, 1e-9) << "dim " << dim;
+            EXPECT_NEAR(actual.y, expected.y, 1e-9) << "dim " << dim;
+            EXPECT_NEAR(actual.z, expected.z, 1e-9) << "dim " << dim;
+        }
+    }
+}
+
+TEST(BarnesHutTreeTest, ErrorShrinksWithTheta)
+{
+    for (int32_t dim : { 2, 3 }) {
+        const Sources s = randomSources(20000, dim, 1024, 10 + dim);
+        BarnesHutTree tree;
+        tree.build(s.positions, s.weights, dim);
+
+        double prevError = INFINITY;
+        // 打ち消し合った後の力に対する相対誤差なので、1つ1つの寄与の誤差よりは大きく出る
+        for (auto [theta, bound] : { pair{ 1.0, 0.5 }, pair{ 0.5, 0.05 }, pair{ 0.2, 0.01 } }) {
+            double error = 0, norm = 0;
+            for (int32_t i = 0; i < 20000; i += 199) {
+                const Vec3 expected = directSum(s, s.positions[i], 0);
+                error += (tree.sum(s.positions[i], theta, LAMBDA) - expected).length();
+                norm += expected.length();
+            }
+
+            EXPECT_LT(error / norm, bound) << "dim " << dim << " theta " << theta;
+            EXPECT_LE(error, prevError) << "dim " << dim << " theta " << theta;
+            prevError = error;
+        }
+    }
+}
+
+TEST(BarnesHutTreeTest, MaxDistanceMatchesCutoff)
+{
+    const Sources s = randomSources(5000, 2, 512, 7);
+    BarnesHutTree tree;
+    tree.build(s.positions, s.weights, 2);
+
+    for (int32_t i = 0; i < 5000; i += 101) {
+        const Vec3 expected = directSum(s, s.positions[i], 64);
+        const Vec3 actual   = tree.sum(s.positions[i], 0, LAMBDA, 64);
+        EXPECT_NEAR(actual.x, expected.x, 1e-9);
+        EXPECT_NEAR(actual.y, expected.y, 1e-9);
+    }
+}
+
+TEST(BarnesHutTreeTest, CoincidentSourcesDoNotRecurseForever)
+{
+    // 量子化すると同じ番号になる発生源は最も深い葉にまとめる
+    vector<Vec3> positions(100, Vec3(5, 5, 0));
+    vector<double> weights(100, 1.0);
+    positions.emplace_back(10, 5, 0);
+    weights.push_back(1.0);
+
+    BarnesHutTree tree;
+    tree.build(positions, weights, 2);
+
+    const Vec3 force = tree.sum(Vec3(10, 5, 0), 0.5, LAMBDA);
+    EXPECT_NEAR(force.x, -100 * exp(-5 / LAMBDA), 1e-9);
+    EXPECT_NEAR(force.y, 0, 1e-12);
+}
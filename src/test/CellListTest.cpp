@@ -0,0 +1,219 @@
+#include "../UserSimulation.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr int32_t FIELD = 512;
+
+    /**
+     * @brief cellsとCellListに触るためのSimulation
+     */
+    class CellListSimulation : public UserSimulation
+    {
+      public:
+        using Simulation::addCell;
+        using Simulation::cellList;
+        using Simulation::cells;
+    };
+
+    unique_ptr<CellListSimulation> makeSimulation(int32_t fieldY = FIELD, int32_t fieldZ = 0, bool periodic = false)
+    {
+        SimulationSettings::USE_CELL_LIST           = true;
+        SimulationSettings::CELL_NUM                = 0;
+        SimulationSettings::GRID_SIZE_MAGNIFICATION = 32;
+        SimulationSettings::SEARCH_RADIUS           = 64;
+        SimulationSettings::CELL_LIST_TYPE          = CellListType::UNIFORM;
+        SimulationSettings::CELL_LIST_PERIODIC      = periodic;
+        SimulationSettings::REMOTE_FORCE_METHOD     = RemoteForceMethod::CUTOFF;
+        SimulationSettings::POSITION_UPDATE_METHOD  = PositionUpdateMethod::EULER;
+        SimulationSettings::FIELD_X_LEN             = FIELD;
+        SimulationSettings::FIELD_Y_LEN             = fieldY;
+        SimulationSettings::FIELD_Z_LEN             = fieldZ;
+        SimulationSettings::MOLECULE_TYPE_NUM       = 1;
+        SimulationSettings::DEFAULT_MOLECULE_NUMS   = { 0 };
+        SimulationSettings::MOLECULE_FIELD_X_LEN    = 16;
+        SimulationSettings::MOLECULE_FIELD_Y_LEN    = 16;
+        SimulationSettings::MOLECULE_FIELD_Z_LEN    = 1;
+        SimulationSettings::DELTA_TIME              = 1.0;
+
+        // MoleculeSpaceのコンストラクタが標準出力に書くので、その間は止めておく
+        cout.setstate(ios::failbit);
+        auto sim = make_unique<CellListSimulation>();
+        cout.clear();
+        return sim;
+    }
+
+    /**
+     * @brief 毎回作り直したCellListと、近傍の細胞の添字が順序まで一致するか
+     */
+    void expectSameAsRebuild(CellListSimulation& sim)
+    {
+        CellList reference;
+        reference.rebuild(sim.cells);
+        for (auto& cell : sim.cells) {
+            ASSERT_EQ(sim.cellList.aroundCellList(cell), reference.aroundCellList(cell)) << cell->getArrayIndex();
+        }
+    }
+} // namespace
+
+TEST(CellListTest, UpdateMatchesRebuild)
+{
+    auto sim = makeSimulation();
+    mt19937_64 engine(1);
+    uniform_real_distribution<double> pos(-FIELD / 2 + 40, FIELD / 2 - 40);
+    normal_distribution<double> step(0, 3);
+
+    for (int32_t i = 0; i < 2000; i++) {
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine)));
+    }
+    sim->cellList.update(sim->cells);
+    EXPECT_EQ(sim->cellList.movedCount(), 2000); // 最初は全細胞を登録する
+
+    for (int32_t t = 0; t < 5; t++) {
+        for (auto& cell : sim->cells) {
+            cell->initForce();
+            cell->addForce(step(engine), step(engine));
+            cell->nextStep();
+        }
+        sim->cells[t * 7]->die(); // 消滅した細胞はNONEとして残る
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine)));
+
+        sim->cellList.update(sim->cells);
+        EXPECT_LT(sim->cellList.movedCount(), 1000); // グリッドをまたいだ細胞だけを入れ直す
+        expectSameAsRebuild(*sim);
+    }
+}
+
+TEST(CellListTest, InvalidateRebuildsEverything)
+{
+    auto sim = makeSimulation();
+    for (int32_t i = 0; i < 100; i++) {
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, i * 4.0 - 200, 0));
+    }
+    sim->cellList.update(sim->cells);
+
+    sim->cellList.update(sim->cells);
+    EXPECT_EQ(sim->cellList.movedCount(), 0);
+
+    sim->cellList.invalidate();
+    sim->cellList.update(sim->cells);
+    EXPECT_EQ(sim->cellList.movedCount(), 100);
+    expectSameAsRebuild(*sim);
+
+    // resetGrid()した後は差分が使えない
+    sim->cellList.resetGrid();
+    sim->cellList.update(sim->cells);
+    EXPECT_EQ(sim->cellList.movedCount(), 100);
+    expectSameAsRebuild(*sim);
+}
+
+TEST(CellListTest, ThreeDimensionalGridFindsSameCellsAsBruteForce)
+{
+    constexpr int32_t DEPTH = 256;
+    auto sim                = makeSimulation(FIELD, DEPTH);
+    mt19937_64 engine(2);
+    uniform_real_distribution<double> pos(-FIELD / 2, FIELD / 2);
+    uniform_real_distribution<double> depth(-DEPTH / 2, DEPTH / 2);
+
+    for (int32_t i = 0; i < 3000; i++) {
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, Vec3(pos(engine), pos(engine), depth(engine))));
+    }
+    sim->cellList.update(sim->cells);
+
+    const double radius = SimulationSettings::SEARCH_RADIUS;
+    for (int32_t i = 0; i < (int32_t)sim->cells.size(); i += 13) {
+        vector<int32_t> expected;
+        for (auto& other : sim->cells) {
+            const Vec3 diff = other->getPosition() - sim->cells[i]->getPosition();
+            if (diff.x * diff.x + diff.y * diff.y + diff.z * diff.z <= radius * radius) {
+                expected.push_back(other->getArrayIndex());
+            }
+        }
+
+        vector<int32_t> actual = sim->cellList.aroundCellList(sim->cells[i]);
+        sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected) << i;
+    }
+}
+
+TEST(CellListTest, WrapsEachAxisWithItsOwnLength)
+{
+    auto sim = makeSimulation(256, 128);
+    sim->addCell(make_shared<UserCell>(CellType::WORKER, Vec3(0, 127, 63)));
+    sim->addCell(make_shared<UserCell>(CellType::WORKER, Vec3(0, 0, 0)));
+
+    auto& cell = sim->cells[0];
+    cell->initForce();
+    cell->addForce(Vec3(0, 2, 2).timesScalar(cell->getWeight()));
+    cell->nextStep();
+    EXPECT_DOUBLE_EQ(cell->getPosition().y, -128); // FIELD_X_LENではなくFIELD_Y_LENで戻る
+    EXPECT_DOUBLE_EQ(cell->getPosition().z, -64);
+
+    // 同じ(x, y)でもzが離れていれば近傍にならない
+    sim->cellList.update(sim->cells);
+    EXPECT_EQ(sim->cellList.aroundCellList(sim->cells[1]), (vector<int32_t>{ 1 }));
+}
+
+TEST(CellListTest, PeriodicSearchFindsNearestImages)
+{
+    constexpr int32_t DEPTH = 256;
+    auto sim                = makeSimulation(256, DEPTH, true);
+    mt19937_64 engine(3);
+    uniform_real_distribution<double> pos(-FIELD / 2, FIELD / 2);
+    uniform_real_distribution<double> posY(-128, 128);
+    uniform_real_distribution<double> depth(-DEPTH / 2, DEPTH / 2);
+
+    for (int32_t i = 0; i < 3000; i++) {
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, Vec3(pos(engine), posY(engine), depth(engine))));
+    }
+    sim->cellList.update(sim->cells);
+
+    // 細胞の組ごとに最小像を求めた結果と比べる
+    auto nearestImage = [](double d, double len) { return d - len * round(d / len); };
+    const double radius = SimulationSettings::SEARCH_RADIUS;
+    for (int32_t i = 0; i < (int32_t)sim->cells.size(); i += 11) {
+        const Vec3 p = sim->cells[i]->getPosition();
+        vector<pair<int32_t, Vec3>> expected;
+        for (auto& other : sim->cells) {
+            const Vec3 q = other->getPosition();
+            const Vec3 d(nearestImage(q.x - p.x, FIELD), nearestImage(q.y - p.y, 256), nearestImage(q.z - p.z, DEPTH));
+            if (d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius) {
+                expected.emplace_back(other->getArrayIndex(), p + d - q);
+            }
+        }
+
+        vector<Vec3> shifts;
+        const vector<int32_t> around = sim->cellList.aroundCellList(sim->cells[i], shifts);
+        ASSERT_EQ(around.size(), shifts.size());
+        vector<pair<int32_t, Vec3>> actual;
+        for (size_t n = 0; n < around.size(); n++) {
+            actual.emplace_back(around[n], shifts[n]);
+        }
+        sort(actual.begin(), actual.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        ASSERT_EQ(actual.size(), expected.size()) << i;
+        for (size_t n = 0; n < actual.size(); n++) {
+            EXPECT_EQ(actual[n].first, expected[n].first);
+            EXPECT_NEAR(actual[n].second.x, expected[n].second.x, 1e-9);
+            EXPECT_NEAR(actual[n].second.y, expected[n].second.y, 1e-9);
+            EXPECT_NEAR(actual[n].second.z, expected[n].second.z, 1e-9);
+        }
+    }
+}
+
+TEST(CellListTest, NonPeriodicSearchStopsAtTheEdge)
+{
+    auto sim = makeSimulation();
+    sim->addCell(make_shared<UserCell>(CellType::WORKER, FIELD / 2 - 1, 0));
+    sim->addCell(make_shared<UserCell>(CellType::WORKER, -FIELD / 2, 0));
+    sim->cellList.update(sim->cells);
+
+    vector<Vec3> shifts;
+    EXPECT_EQ(sim->cellList.aroundCellList(sim->cells[0], shifts), (vector<int32_t>{ 0 }));
+    EXPECT_EQ(shifts.size(), 1u);
+}
@@ -0,0 +1,236 @@
+#include "../core/CellSnapshot.hpp"
+#include "../utils/TextParse.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    CellSnapshot makeSnapshot()
+    {
+        CellSnapshot s;
+        s.step = 12;
+        s.resize(3);
+
+        for (int i = 0; i < 3; i++) {
+            s.id[i]     = 10 + i;
+            s.type[i]   = static_cast<uint8_t>(CellType::WORKER);
+            s.x[i]      = 1.0 / 3.0 + i;
+            s.y[i]      = -2.5 * i;
+            s.z[i]      = 0;
+            s.vx[i]     = 0.125 * i;
+            s.vy[i]     = -0.1;
+            s.vz[i]     = 0;
+            s.radius[i] = 10.0 + i;
+        }
+        s.type[2]       = static_cast<uint8_t>(CellType::DEAD);
+        s.contactOffset = { 0, 1, 2, 2 };
+        s.contactId     = { 11, 10 };
+
+        return s;
+    }
+} // namespace
+
+namespace Binary {
+    TEST(roundTripTest, float64)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream ss;
+        s.writeBinary(ss, false);
+
+        EXPECT_TRUE(CellSnapshot::isBinary(ss));
+        CellSnapshot r = CellSnapshot::readBinary(ss);
+
+        EXPECT_EQ(r.step, 12);
+        EXPECT_EQ(r.id, s.id);
+        EXPECT_EQ(r.type, s.type);
+        EXPECT_EQ(r.x, s.x);
+        EXPECT_EQ(r.y, s.y);
+        EXPECT_EQ(r.vx, s.vx);
+        EXPECT_EQ(r.radius, s.radius);
+        EXPECT_EQ(r.contactOffset, s.contactOffset);
+        EXPECT_EQ(r.contactId, s.contactId);
+        EXPECT_TRUE(r.cluster.empty());
+    }
+
+    TEST(roundTripTest, cluster)
+    {
+        CellSnapshot s = makeSnapshot();
+        s.cluster      = { 0, 0, 1 };
+        stringstream ss;
+        s.writeBinary(ss, true);
+        CellSnapshot r = CellSnapshot::readBinary(ss);
+
+        EXPECT_EQ(r.cluster, s.cluster);
+        EXPECT_EQ(r.contactId, s.contactId);
+    }
+
+    TEST(roundTripTest, float32)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream ss;
+        s.writeBinary(ss, true);
+        CellSnapshot r = CellSnapshot::readBinary(ss);
+
+        ASSERT_EQ(r.size(), s.size());
+        for (size_t i = 0; i < s.size(); i++) {
+            EXPECT_FLOAT_EQ(r.x[i], s.x[i]);
+            EXPECT_FLOAT_EQ(r.y[i], s.y[i]);
+            EXPECT_FLOAT_EQ(r.radius[i], s.radius[i]);
+        }
+    }
+
+    TEST(sizeTest, float32IsSmaller)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream f64, f32;
+        s.writeBinary(f64, false);
+        s.writeBinary(f32, true);
+
+        EXPECT_EQ(f64.str().size() - f32.str().size(), 7 * 3 * 4);
+    }
+
+    TEST(corruptTest, rejectsInconsistentColumns)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream ss;
+        s.writeBinary(ss, false);
+        const string bytes = ss.str();
+
+        // 途中で切れたファイル
+        stringstream truncated(bytes.substr(0, bytes.size() / 2));
+        EXPECT_THROW(CellSnapshot::readBinary(truncated), runtime_error);
+
+        // radiusの列の要素数を細胞の数と変える(列の見出しは名前16バイト、型1バイト、予約7バイト、要素数8バイト)
+        string badCount        = bytes;
+        const size_t countPos  = badCount.find("radius") + CellSnapshot::COLUMN_NAME_LEN + 8;
+        const uint64_t tooMany = 4;
+        memcpy(&badCount[countPos], &tooMany, sizeof(tooMany));
+        stringstream badCountStream(badCount);
+        EXPECT_THROW(CellSnapshot::readBinary(badCountStream), runtime_error);
+
+        // contact_offsetが減っている、またはcontact_idの数と合わない
+        for (const vector<int32_t>& offsets : { vector<int32_t>{ 0, 2, 1, 2 }, vector<int32_t>{ 0, 1, 2, 3 }, vector<int32_t>{ 1, 1, 2, 2 } }) {
+            CellSnapshot bad  = makeSnapshot();
+            bad.contactOffset = offsets;
+            stringstream badOffsets;
+            bad.writeBinary(badOffsets, false);
+            EXPECT_THROW(CellSnapshot::readBinary(badOffsets), runtime_error);
+        }
+    }
+
+    TEST(magicTest, notSnapshot)
+    {
+        stringstream ss("ID\ttypeID\tX\n");
+
+        EXPECT_FALSE(CellSnapshot::isBinary(ss));
+        EXPECT_THROW(CellSnapshot::readBinary(ss), runtime_error);
+    }
+} // namespace Binary
+
+namespace Text {
+    TEST(formatTest, columns)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream ss;
+        s.writeText(ss);
+
+        string header, line0, line2;
+        getline(ss, header);
+        getline(ss, line0);
+        getline(ss, line2);
+        getline(ss, line2);
+
+        EXPECT_EQ(header, "ID\ttypeID\tX\tY\tZ\tVx\tVy\tVz\tR\tN_contact\tContact_IDs");
+        EXPECT_EQ(line0.substr(0, 10), "10\tWORKER\t");
+        EXPECT_EQ(line0.substr(line0.size() - 4), "1\t11");
+        EXPECT_EQ(line2.substr(0, 8), "12\tDEAD\t");
+        EXPECT_EQ(line2.substr(line2.size() - 3), "0\t_");
+    }
+
+    CellSnapshot readString(const string& text)
+    {
+        return CellSnapshot::readText(text.data(), text.data() + text.size());
+    }
+
+    TEST(readTest, roundTrip)
+    {
+        CellSnapshot s = makeSnapshot();
+        stringstream ss;
+        s.writeText(ss);
+
+        CellSnapshot r = readString(ss.str());
+        ASSERT_EQ(r.size(), 3u);
+        EXPECT_EQ(r.id, s.id);
+        EXPECT_EQ(r.type, s.type);
+        for (int i = 0; i < 3; i++) {
+            EXPECT_NEAR(r.x[i], s.x[i], 1e-5);
+            EXPECT_DOUBLE_EQ(r.y[i], s.y[i]);
+            EXPECT_DOUBLE_EQ(r.vx[i], s.vx[i]);
+            EXPECT_DOUBLE_EQ(r.radius[i], s.radius[i]);
+        }
+        // 接着情報は読まない
+        EXPECT_EQ(r.contactOffset, (vector<int32_t>{ 0, 0, 0, 0 }));
+    }
+
+    TEST(readTest, numericTypeWithoutHeader)
+    {
+        CellSnapshot r = readString("0 3 1e2 -2.5E-1 0 0 0 0 10\r\n\n  \n1\t4\t-0\t.5\t0\t1\t2\t3\t5");
+        ASSERT_EQ(r.size(), 2u);
+        EXPECT_EQ(r.type, (vector<uint8_t>{ 3, 4 }));
+        EXPECT_EQ(r.x, (vector<double>{ 100.0, -0.0 }));
+        EXPECT_EQ(r.y, (vector<double>{ -0.25, 0.5 }));
+        EXPECT_EQ(r.vz, (vector<double>{ 0.0, 3.0 }));
+        EXPECT_EQ(r.radius, (vector<double>{ 10.0, 5.0 }));
+    }
+
+    TEST(readTest, invalidRow)
+    {
+        EXPECT_THROW(readString("ID\ttypeID\n0\tWORKER\t1\t2\t0\t0\t0\t0\t10\n1\tWORKER\t1\t2\n"), std::runtime_error);
+        EXPECT_THROW(readString("0\tUNKNOWN\t1\t2\t0\t0\t0\t0\t10\n"), std::runtime_error);
+        EXPECT_THROW(readString("0\tWORKER\t1x\t2\t0\t0\t0\t0\t10\n"), std::runtime_error);
+    }
+
+    TEST(readTest, manyChunksKeepOrder)
+    {
+        // 複数の区間に分かれる大きさにする
+        const int n = 50000;
+        string text = "ID\ttypeID\tX\tY\tZ\tVx\tVy\tVz\tR\tN_contact\tContact_IDs\n";
+        for (int i = 0; i < n; i++) {
+            text += to_string(i) + "\tWORKER\t" + to_string(i * 0.5) + "\t1\t0\t0\t0\t0\t10\t0\t_\n";
+        }
+
+        CellSnapshot r = readString(text);
+        ASSERT_EQ(r.size(), (size_t)n);
+        for (int i = 0; i < n; i++) {
+            ASSERT_EQ(r.id[i], i);
+            ASSERT_EQ(r.x[i], i * 0.5);
+        }
+    }
+
+    TEST(parseDoubleTest, matchesStrtod)
+    {
+        std::mt19937_64 engine(1);
+        std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+        std::uniform_int_distribution<int> exponent(-30, 30);
+        const char* formats[] = { "%.6g", "%.15g", "%.17g", "%.3f" };
+
+        for (int i = 0; i < 100000; i++) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), formats[i % 4], mantissa(engine) * pow(10.0, exponent(engine)));
+
+            const char* p = buf;
+            double value;
+            ASSERT_TRUE(TextParse::parseDouble(p, buf + strlen(buf), value)) << buf;
+            ASSERT_EQ(value, strtod(buf, nullptr)) << buf;
+            ASSERT_EQ(p, buf + strlen(buf));
+        }
+    }
+} // namespace Text
@@ -0,0 +1,142 @@
+#include "../core/ClusterAnalysis.hpp"
+#include "../utils/ConcurrentUnionFind.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <omp.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    // 細胞iのIDは100 + i。edgesの組(行の添字)を両方の行に接触として入れる
+    CellSnapshot makeSnapshot(int32_t n, const std::vector<std::pair<int32_t, int32_t>>& edges)
+    {
+        std::vector<std::vector<int32_t>> rows(n);
+        for (const auto& [a, b] : edges) {
+            rows[a].push_back(100 + b);
+            rows[b].push_back(100 + a);
+        }
+
+        CellSnapshot s;
+        s.step = 3;
+        s.resize(n);
+        for (int32_t i = 0; i < n; i++) {
+            s.id[i]                = 100 + i;
+            s.contactOffset[i + 1] = s.contactOffset[i] + (int32_t)rows[i].size();
+            s.contactId.insert(s.contactId.end(), rows[i].begin(), rows[i].end());
+        }
+
+        return s;
+    }
+} // namespace
+
+TEST(ConcurrentUnionFindTest, RootIsSmallestIndex)
+{
+    ConcurrentUnionFind sets(6);
+    EXPECT_TRUE(sets.unite(4, 2));
+    EXPECT_TRUE(sets.unite(5, 4));
+    EXPECT_FALSE(sets.unite(2, 5));
+    EXPECT_TRUE(sets.unite(3, 1));
+
+    EXPECT_EQ(sets.size(), 6);
+    EXPECT_EQ(sets.find(5), 2);
+    EXPECT_EQ(sets.find(3), 1);
+    EXPECT_EQ(sets.find(0), 0);
+}
+
+TEST(ClusterAnalysisTest, ChainsAndSingletons)
+{
+    // 0-3-4, 1-2, 5
+    CellSnapshot s = makeSnapshot(6, { { 3, 4 }, { 0, 3 }, { 2, 1 } });
+    // スナップショットにない細胞(ID 999)との接触は無視する
+    s.contactOffset[6]++;
+    s.contactId.push_back(999);
+
+    const ClusterAnalysis::Summary summary = ClusterAnalysis::label(s);
+
+    EXPECT_EQ(s.cluster, (std::vector<int32_t>{ 0, 1, 1, 0, 0, 2 }));
+    EXPECT_EQ(summary.step, 3);
+    EXPECT_EQ(summary.cellCount, 6);
+    EXPECT_EQ(summary.clusterCount, 3);
+    EXPECT_EQ(summary.largest, 3);
+    EXPECT_EQ(summary.histogram, (std::vector<std::pair<int32_t, int32_t>>{ { 1, 1 }, { 2, 1 }, { 3, 1 } }));
+
+    std::ostringstream os;
+    ClusterAnalysis::writeSummary(os, summary);
+    EXPECT_EQ(os.str(), "3\t6\t3\t3\t1:1,2:1,3:1\n");
+}
+
+TEST(ClusterAnalysisTest, EmptySnapshot)
+{
+    CellSnapshot s = makeSnapshot(0, {});
+    const ClusterAnalysis::Summary summary = ClusterAnalysis::label(s);
+
+    EXPECT_TRUE(s.cluster.empty());
+    EXPECT_EQ(summary.clusterCount, 0);
+
+    std::ostringstream os;
+    ClusterAnalysis::writeSummary(os, summary);
+    EXPECT_EQ(os.str(), "3\t0\t0\t0\t_\n");
+}
+
+TEST(ClusterAnalysisTest, ParallelMatchesSerial)
+{
+    // 10個ごとの鎖を、行の順とは逆向きにつなぐ
+    constexpr int32_t CELLS = 20000;
+    std::vector<std::pair<int32_t, int32_t>> edges;
+    for (int32_t i = CELLS - 1; i > 0; i--) {
+        if (i % 10 != 0) {
+            edges.emplace_back(i, i - 1);
+        }
+    }
+
+    CellSnapshot parallel = makeSnapshot(CELLS, edges);
+    const ClusterAnalysis::Summary summary = ClusterAnalysis::label(parallel);
+
+    const int32_t threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    CellSnapshot serial = makeSnapshot(CELLS, edges);
+    ClusterAnalysis::label(serial);
+    omp_set_num_threads(threads);
+
+    EXPECT_EQ(parallel.cluster, serial.cluster);
+    EXPECT_EQ(parallel.cluster[CELLS - 1], CELLS / 10 - 1);
+    EXPECT_EQ(summary.clusterCount, CELLS / 10);
+    EXPECT_EQ(summary.histogram, (std::vector<std::pair<int32_t, int32_t>>{ { 10, CELLS / 10 } }));
+}
+
+TEST(ClusterAnalysisTest, ResumeSummaryDropsRowsAfterCheckpoint)
+{
+    const std::string path = ::testing::TempDir() + "ClusterAnalysisTest_clusters.tsv";
+    {
+        std::ofstream ofs(path);
+        ClusterAnalysis::writeHeader(ofs);
+        for (int32_t output = 0; output < 6; output++) {
+            ClusterAnalysis::Summary summary;
+            summary.step = output;
+            ClusterAnalysis::writeSummary(ofs, summary);
+        }
+    }
+
+    ClusterAnalysis::resumeSummary(path, 3);
+
+    std::ifstream ifs(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(ifs, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0], "output\tcells\tclusters\tlargest\thistogram");
+    EXPECT_EQ(lines[4], "3\t0\t0\t0\t_");
+
+    // 表がなければ見出しだけを書く
+    std::remove(path.c_str());
+    ClusterAnalysis::resumeSummary(path, 3);
+    std::ifstream header(path);
+    std::string line;
+    std::getline(header, line);
+    EXPECT_EQ(line, "output\tcells\tclusters\tlargest\thistogram");
+    EXPECT_FALSE(std::getline(header, line));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,77 @@
+#include "../core/ContactGraph.hpp"
+#include <gtest/gtest.h>
+#include <omp.h>
+#include <vector>
+
+TEST(ContactGraphTest, RowsAreGatheredInOrder)
+{
+    ContactGraph graph;
+    graph.reset(4);
+
+    const std::vector<int32_t> row2 = { 10, 11 };
+    const std::vector<int32_t> row0 = { 12 };
+    graph.addRow(2, row2);
+    graph.addRow(0, row0);
+    graph.addRow(7, row0); // 行の数を超えた添字は無視する
+    graph.finish();
+
+    EXPECT_EQ(graph.rowCount(), 4);
+    EXPECT_EQ(graph.size(), 3);
+    EXPECT_EQ(graph.getOffsets(), (std::vector<int32_t>{ 0, 1, 1, 3, 3 }));
+    EXPECT_EQ(graph.getContacts(), (std::vector<int32_t>{ 12, 10, 11 }));
+    EXPECT_EQ(graph.degree(2), 2);
+    EXPECT_EQ(graph.degree(9), 0);
+    EXPECT_TRUE(graph.contactsOf(1).empty());
+    EXPECT_TRUE(graph.contactsOf(-1).empty());
+}
+
+TEST(ContactGraphTest, ParallelRowsMatchSerial)
+{
+    // 行iの接触相手はi + 1, ..., i + i % 5
+    constexpr int32_t ROWS = 10000;
+    ContactGraph graph;
+    graph.reset(ROWS);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int32_t i = 0; i < ROWS; i++) {
+        std::vector<int32_t> ids;
+        for (int32_t k = 1; k <= i % 5; k++) {
+            ids.push_back(i + k);
+        }
+        graph.addRow(i, ids);
+    }
+    graph.finish();
+
+    int64_t total = 0;
+    for (int32_t i = 0; i < ROWS; i++) {
+        ASSERT_EQ(graph.degree(i), i % 5);
+        for (int32_t k = 0; k < i % 5; k++) {
+            EXPECT_EQ(graph.contactsOf(i)[k], i + k + 1);
+        }
+        total += i % 5;
+    }
+    EXPECT_EQ(graph.size(), total);
+}
+
+TEST(ContactGraphTest, ReorderRowsFollowsCompaction)
+{
+    ContactGraph graph;
+    graph.reset(3);
+    graph.addRow(0, std::vector<int32_t>{ 5 });
+    graph.addRow(2, std::vector<int32_t>{ 6, 7 });
+    graph.finish();
+
+    // 行1は消え、2, 0の順になる。4は力の計算の後に加わった行
+    graph.reorderRows({ 2, 0, 4 });
+
+    EXPECT_EQ(graph.rowCount(), 3);
+    EXPECT_EQ(graph.getOffsets(), (std::vector<int32_t>{ 0, 2, 3, 3 }));
+    EXPECT_EQ(graph.getContacts(), (std::vector<int32_t>{ 6, 7, 5 }));
+
+    // 次のステップでは使い回したバッファから作り直す
+    graph.reset(2);
+    graph.addRow(1, std::vector<int32_t>{ 8 });
+    graph.finish();
+    EXPECT_EQ(graph.getContacts(), (std::vector<int32_t>{ 8 }));
+    EXPECT_EQ(graph.degree(0), 0);
+}
@@ -0,0 +1,101 @@
+#include "../utils/CounterRNG.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace Philox {
+    // Random123の既知解(kat_vectors)
+    TEST(knownAnswerTest, zero)
+    {
+        CounterRNG::Counter res = CounterRNG::philox4x32({ 0, 0, 0, 0 }, { 0, 0 });
+        EXPECT_EQ(res, (CounterRNG::Counter{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+    }
+
+    TEST(knownAnswerTest, allOne)
+    {
+        CounterRNG::Counter res = CounterRNG::philox4x32({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff });
+        EXPECT_EQ(res, (CounterRNG::Counter{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }));
+    }
+
+    TEST(knownAnswerTest, pi)
+    {
+        CounterRNG::Counter res = CounterRNG::philox4x32({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 });
+        EXPECT_EQ(res, (CounterRNG::Counter{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+    }
+} // namespace Philox
+
+namespace Stream {
+    TEST(reproducibilityTest, sameKey)
+    {
+        CounterRNG a(0, 42, 10, RandomPurpose::DIVISION_TIME);
+        CounterRNG b(0, 42, 10, RandomPurpose::DIVISION_TIME);
+
+        for (int i = 0; i < 100; i++) {
+            EXPECT_EQ(a.nextUInt32(), b.nextUInt32());
+        }
+    }
+
+    TEST(independenceTest, differentKey)
+    {
+        const double base = CounterRNG(0, 42, 10, RandomPurpose::DIVISION_TIME).uniform();
+
+        EXPECT_NE(base, CounterRNG(1, 42, 10, RandomPurpose::DIVISION_TIME).uniform());
+        EXPECT_NE(base, CounterRNG(0, 43, 10, RandomPurpose::DIVISION_TIME).uniform());
+        EXPECT_NE(base, CounterRNG(0, 42, 11, RandomPurpose::DIVISION_TIME).uniform());
+        EXPECT_NE(base, CounterRNG(0, 42, 10, RandomPurpose::DIE_TIME).uniform());
+    }
+
+    TEST(rangeTest, uniform)
+    {
+        CounterRNG rng(0, 0, 0, RandomPurpose::USER);
+        double sum = 0;
+
+        for (int i = 0; i < 100000; i++) {
+            double u = rng.uniform();
+            EXPECT_GE(u, 0.0);
+            EXPECT_LT(u, 1.0);
+            sum += u;
+        }
+        EXPECT_NEAR(sum / 100000, 0.5, 0.01);
+    }
+
+    TEST(meanTest, exponential)
+    {
+        CounterRNG rng(0, 0, 0, RandomPurpose::USER);
+        double sum = 0;
+
+        for (int i = 0; i < 100000; i++) {
+            sum += rng.exponential(1.0 / 130.0);
+        }
+        EXPECT_NEAR(sum / 100000, 130.0, 2.0);
+    }
+
+    TEST(threadTest, orderIndependent)
+    {
+        constexpr int N = 1000;
+        vector<double> serial(N), parallel(N);
+
+        for (int i = 0; i < N; i++) {
+            serial[i] = CounterRNG(7, i, 3, RandomPurpose::DIVISION_DIRECTION).angle();
+        }
+
+        // 逆順・別スレッドで生成しても同じ値になる
+        thread t1([&]() {
+            for (int i = N - 1; i >= N / 2; i--) {
+                parallel[i] = CounterRNG(7, i, 3, RandomPurpose::DIVISION_DIRECTION).angle();
+            }
+        });
+        thread t2([&]() {
+            for (int i = N / 2 - 1; i >= 0; i--) {
+                parallel[i] = CounterRNG(7, i, 3, RandomPurpose::DIVISION_DIRECTION).angle();
+            }
+        });
+        t1.join();
+        t2.join();
+
+        EXPECT_EQ(serial, parallel);
+    }
+} // namespace Stream
@@ -0,0 +1,48 @@
+#include "../utils/FastMath.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+
+TEST(FastMathTest, IpowMatchesRepeatedMultiplication)
+{
+    static_assert(ipow<0>(3.0) == 1.0);
+    static_assert(ipow<5>(2.0) == 32.0);
+
+    const double x = 0.8371;
+    EXPECT_EQ(ipow<2>(x), x * x);
+    EXPECT_EQ(ipow<2>(x), std::pow(x, 2));
+    EXPECT_DOUBLE_EQ(ipow<7>(x), std::pow(x, 7));
+}
+
+TEST(FastMathTest, LibmIsExact)
+{
+    const FastExp exp(ExpMethod::LIBM, 2.0);
+    EXPECT_EQ(exp(1.3), std::exp(-1.3));
+    EXPECT_EQ(exp.maxRelativeError(), 0.0);
+    EXPECT_EQ(exp.getRange(), 0.0);
+}
+
+TEST(FastMathTest, PolynomialIsAccurateEverywhere)
+{
+    const FastExp exp(ExpMethod::POLYNOMIAL);
+    EXPECT_EQ(exp(0.0), 1.0);
+    for (double x : { 1e-9, 0.5, 0.6931471805599453, 3.7, 40.0, 300.0, 700.0 }) {
+        EXPECT_NEAR(exp(x) / std::exp(-x), 1.0, 1e-14) << x;
+    }
+    EXPECT_EQ(exp(800.0), 0.0);
+    EXPECT_LT(exp.maxRelativeError(), 1e-14);
+}
+
+TEST(FastMathTest, TableIsAccurateInsideAndOutsideItsRange)
+{
+    const FastExp exp(ExpMethod::TABLE, 64.0 / 30.0);
+    EXPECT_GE(exp.getRange(), 64.0 / 30.0);
+    EXPECT_EQ(exp(0.0), 1.0);
+
+    for (double x = 0.0; x < 5.0; x += 0.0137) {
+        EXPECT_NEAR(exp(x) / std::exp(-x), 1.0, 1e-9) << x;
+    }
+
+    const double error = exp.maxRelativeError();
+    EXPECT_GT(error, 0.0);
+    EXPECT_LT(error, 1e-9);
+}
@@ -0,0 +1,120 @@
+#include "../utils/FieldCodec.hpp"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    // 分子の場に近い、滑らかな値
+    vector<double> smoothField(size_t n)
+    {
+        vector<double> values(n);
+        for (size_t i = 0; i < n; i++) {
+            values[i] = 100.0 * exp(-(double)(i % 1000) / 300.0) + 0.5 * sin(i * 0.01);
+        }
+
+        return values;
+    }
+
+    vector<double> roundTrip(const vector<double>& values, CompressionMode mode, double errorBound, size_t* compressedSize = nullptr)
+    {
+        stringstream ss;
+        FieldCodec::encode(ss, values, mode, errorBound);
+        if (compressedSize != nullptr) {
+            *compressedSize = ss.str().size();
+        }
+
+        return FieldCodec::decode(ss);
+    }
+} // namespace
+
+TEST(FieldCodecTest, Lz4RoundTrip)
+{
+    for (size_t n : { 0, 1, 12, 13, 100, 70000 }) {
+        vector<uint8_t> src(n);
+        for (size_t i = 0; i < n; i++) {
+            src[i] = (i / 7) % 5 == 0 ? (uint8_t)(i * 31) : (uint8_t)(i % 3);
+        }
+
+        const vector<uint8_t> compressed = FieldCodec::lz4Compress(src.data(), n);
+        vector<uint8_t> dst(n);
+        FieldCodec::lz4Decompress(compressed.data(), compressed.size(), dst.data(), n);
+        EXPECT_EQ(dst, src) << n;
+    }
+}
+
+TEST(FieldCodecTest, Lz4RejectsCorruptInput)
+{
+    vector<uint8_t> src(1000, 7);
+    vector<uint8_t> compressed = FieldCodec::lz4Compress(src.data(), src.size());
+    vector<uint8_t> dst(src.size());
+
+    EXPECT_THROW(FieldCodec::lz4Decompress(compressed.data(), compressed.size(), dst.data(), dst.size() - 1), runtime_error);
+    compressed.resize(compressed.size() / 2);
+    EXPECT_THROW(FieldCodec::lz4Decompress(compressed.data(), compressed.size(), dst.data(), dst.size()), runtime_error);
+}
+
+TEST(FieldCodecTest, ShuffleIsInvertible)
+{
+    vector<uint8_t> src(8 * 10), shuffled(src.size()), restored(src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = i;
+    }
+
+    FieldCodec::shuffle(src.data(), shuffled.data(), 10, 8);
+    EXPECT_EQ(shuffled[1], 8); // 2番目の要素の0バイト目
+    FieldCodec::unshuffle(shuffled.data(), restored.data(), 10, 8);
+    EXPECT_EQ(restored, src);
+}
+
+TEST(FieldCodecTest, LosslessIsExact)
+{
+    vector<double> values = smoothField(200000);
+    values[5]             = numeric_limits<double>::quiet_NaN();
+    values[6]             = -0.0;
+
+    const vector<double> decoded = roundTrip(values, CompressionMode::LOSSLESS, 0.0);
+    ASSERT_EQ(decoded.size(), values.size());
+    EXPECT_EQ(memcmp(decoded.data(), values.data(), values.size() * sizeof(double)), 0);
+}
+
+TEST(FieldCodecTest, LossyRespectsErrorBound)
+{
+    const vector<double> values = smoothField(200000);
+    const double errorBound     = 1e-4;
+    size_t lossySize, losslessSize;
+
+    const vector<double> decoded = roundTrip(values, CompressionMode::LOSSY, errorBound, &lossySize);
+    roundTrip(values, CompressionMode::LOSSLESS, 0.0, &losslessSize);
+
+    ASSERT_EQ(decoded.size(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_LE(abs(decoded[i] - values[i]), errorBound) << i;
+    }
+    EXPECT_LT(lossySize, losslessSize);
+    EXPECT_LT(lossySize * 5, values.size() * sizeof(double));
+}
+
+TEST(FieldCodecTest, LossyFallsBackForNonFiniteBlocks)
+{
+    vector<double> values = smoothField(FieldCodec::BLOCK_SIZE * 2);
+    values[10]            = numeric_limits<double>::infinity();
+
+    const vector<double> decoded = roundTrip(values, CompressionMode::LOSSY, 1e-3);
+    EXPECT_TRUE(isinf(decoded[10]));
+    EXPECT_EQ(decoded[11], values[11]); // 最初のブロックはLOSSLESSになる
+    EXPECT_LE(abs(decoded.back() - values.back()), 1e-3);
+}
+
+TEST(FieldCodecTest, ConstantFieldCompressesWell)
+{
+    const vector<double> values(100000, 3.0);
+    size_t size;
+
+    roundTrip(values, CompressionMode::LOSSLESS, 0.0, &size);
+    EXPECT_LT(size * 50, values.size() * sizeof(double));
+}
@@ -0,0 +1,70 @@
+#include "../core/InteractionMatrix.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(InteractionMatrixTest, StandardMatchesWorkerOnlyAttraction)
+{
+    const InteractionMatrix matrix = InteractionMatrix::standard(25.0);
+
+    EXPECT_EQ(InteractionMatrix::cellTypeNum(), (int32_t)CellType::ENEMY + 1);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::WORKER, CellType::WORKER).remoteCoefficient, 1.0);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::WORKER, CellType::WORKER).lambda, 25.0);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::WORKER, CellType::DEAD).remoteCoefficient, 0.0);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::DEAD, CellType::WORKER).exclusionBias, InteractionMatrix::DEFAULT_EXCLUSION_BIAS);
+    EXPECT_FALSE(matrix.get(CellType::WORKER, CellType::NONE).enabled);
+    EXPECT_FALSE(matrix.get(CellType::TARGET, CellType::WORKER).enabled);
+
+    EXPECT_TRUE(matrix.isRemoteSource(CellType::WORKER));
+    EXPECT_FALSE(matrix.isRemoteSource(CellType::DEAD));
+    EXPECT_TRUE(matrix.receivesRemote(CellType::WORKER));
+    EXPECT_FALSE(matrix.receivesRemote(CellType::DEAD));
+}
+
+TEST(InteractionMatrixTest, LoadsPairsFromYaml)
+{
+    const YAML::Node node = YAML::Load(R"(
+- receiver: [TARGET, ENEMY]
+  source: SENDER
+  remote_coefficient: 2.5
+  adhesion_bias: 1.0
+- receiver: ENEMY
+  source: ENEMY
+  exclusion_bias: 3.0
+  lambda: 8
+- receiver: WORKER
+  source: WORKER
+  remote_coefficient: 1.0
+  enabled: false
+)");
+
+    InteractionMatrix matrix = InteractionMatrix::standard(30.0);
+    matrix.load(node, 12.0);
+
+    const auto& targetSender = matrix.get(CellType::TARGET, CellType::SENDER);
+    EXPECT_TRUE(targetSender.enabled);
+    EXPECT_DOUBLE_EQ(targetSender.remoteCoefficient, 2.5);
+    EXPECT_DOUBLE_EQ(targetSender.lambda, 12.0);
+    EXPECT_DOUBLE_EQ(targetSender.exclusionBias, InteractionMatrix::DEFAULT_EXCLUSION_BIAS);
+    EXPECT_DOUBLE_EQ(targetSender.adhesionBias, 1.0);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::ENEMY, CellType::SENDER).remoteCoefficient, 2.5);
+    EXPECT_DOUBLE_EQ(matrix.get(CellType::ENEMY, CellType::ENEMY).lambda, 8.0);
+
+    // 無効にした組と、書かなかった組は力を及ぼさない
+    const auto& workerWorker = matrix.get(CellType::WORKER, CellType::WORKER);
+    EXPECT_FALSE(workerWorker.enabled);
+    EXPECT_DOUBLE_EQ(workerWorker.remoteCoefficient, 0.0);
+    EXPECT_DOUBLE_EQ(workerWorker.exclusionBias, 0.0);
+    EXPECT_FALSE(matrix.get(CellType::DEAD, CellType::WORKER).enabled);
+
+    EXPECT_TRUE(matrix.isRemoteSource(CellType::SENDER));
+    EXPECT_FALSE(matrix.isRemoteSource(CellType::WORKER));
+    EXPECT_EQ(matrix.row(CellType::ENEMY)[(int32_t)CellType::SENDER].remoteCoefficient, 2.5);
+}
+
+TEST(InteractionMatrixTest, RejectsInvalidEntries)
+{
+    InteractionMatrix matrix;
+    EXPECT_THROW(matrix.load(YAML::Load("- {receiver: WORKER, source: ALIEN}"), 30.0), std::invalid_argument);
+    EXPECT_THROW(matrix.load(YAML::Load("- {receiver: WORKER, source: WORKER, lambda: 0}"), 30.0), std::invalid_argument);
+    EXPECT_THROW(matrix.load(YAML::Load("receiver: WORKER"), 30.0), std::invalid_argument);
+}
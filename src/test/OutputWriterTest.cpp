@@ -0,0 +1,111 @@
+#include "../core/OutputWriter.hpp"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(OutputWriterTest, RunsJobsInOrder)
+{
+    vector<int> order;
+    {
+        OutputWriter writer(true, 2);
+        for (int i = 0; i < 10; i++) {
+            writer.submit([&order, i] { order.push_back(i); });
+        }
+        writer.flush();
+        EXPECT_EQ(order.size(), 10u);
+    }
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(OutputWriterTest, SyncModeRunsInCaller)
+{
+    OutputWriter writer(false, 1);
+    const auto caller = this_thread::get_id();
+    thread::id runner;
+
+    writer.submit([&runner] { runner = this_thread::get_id(); });
+    EXPECT_EQ(runner, caller);
+}
+
+TEST(OutputWriterTest, BackPressureLimitsPendingJobs)
+{
+    atomic<int> finished = 0;
+    OutputWriter writer(true, 1);
+
+    for (int i = 0; i < 4; i++) {
+        writer.submit([&finished] {
+            this_thread::sleep_for(chrono::milliseconds(20));
+            finished++;
+        });
+        // 実行中の1個と待ちの1個を超えてためることはない
+        EXPECT_GE(finished.load(), i - 1);
+    }
+    writer.flush();
+
+    EXPECT_EQ(finished.load(), 4);
+    EXPECT_GT(writer.getStallMillis(), 0.0);
+}
+
+TEST(OutputWriterTest, DestructorDrainsQueue)
+{
+    atomic<int> finished = 0;
+    {
+        OutputWriter writer(true, 8);
+        for (int i = 0; i < 8; i++) {
+            writer.submit([&finished] { finished++; });
+        }
+    }
+
+    EXPECT_EQ(finished.load(), 8);
+}
+
+TEST(OutputWriterTest, AsyncFailureIsRethrown)
+{
+    OutputWriter writer(true, 2);
+    atomic<bool> release = false;
+    atomic<int> finished = 0;
+    writer.submit([&release] {
+        while (!release) {
+            this_thread::yield();
+        }
+        throw runtime_error("disk full");
+    });
+    writer.submit([&finished] { finished++; }); // 失敗した後のジョブも実行する
+    release = true;
+    EXPECT_THROW(writer.flush(), runtime_error);
+    EXPECT_EQ(finished.load(), 1);
+
+    // 投げ直した失敗は一度きり
+    writer.submit([] {});
+    EXPECT_NO_THROW(writer.flush());
+
+    // 次のsubmit()で投げる
+    writer.submit([] { throw runtime_error("disk full"); });
+    bool thrown = false;
+    for (int i = 0; i < 1000 && !thrown; i++) {
+        try {
+            writer.submit([] {});
+        } catch (const runtime_error&) {
+            thrown = true;
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(thrown);
+}
+
+TEST(OutputWriterTest, DestructorRethrowsFailure)
+{
+    EXPECT_THROW(
+      {
+          OutputWriter writer(true, 1);
+          writer.submit([] { throw runtime_error("disk full"); });
+      },
+      runtime_error);
+}
@@ -0,0 +1,170 @@
+#include "../utils/Profiler.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    const Profiler::Summary* find(const vector<Profiler::Summary>& summaries, const string& path)
+    {
+        auto it = find_if(summaries.begin(), summaries.end(), [&](const Profiler::Summary& s) { return s.path == path; });
+        return it == summaries.end() ? nullptr : &*it;
+    }
+} // namespace
+
+TEST(ProfilerTest, DisabledRecordsNothing)
+{
+    {
+        ProfileScope scope("ignored");
+    }
+    EXPECT_TRUE(Profiler::merged().empty());
+}
+
+TEST(ProfilerTest, NestedScopesFormPaths)
+{
+    Profiler::enable(true);
+    Profiler::reset();
+
+    for (int i = 0; i < 3; i++) {
+        ProfileScope step("step");
+        {
+            ProfileScope a("a");
+            ProfileScope b("b");
+        }
+        ProfileScope a("a");
+    }
+
+    const auto summaries = Profiler::merged();
+    ASSERT_EQ(summaries.size(), 3u);
+    // 親のすぐ後に子が並ぶ
+    EXPECT_EQ(summaries[0].path, "step");
+    EXPECT_EQ(summaries[1].path, "step/a");
+    EXPECT_EQ(summaries[2].path, "step/a/b");
+    EXPECT_EQ(summaries[0].calls, 3u);
+    EXPECT_EQ(summaries[1].calls, 6u);
+    EXPECT_EQ(summaries[2].calls, 3u);
+    EXPECT_GE(summaries[0].totalNs, summaries[1].totalNs);
+}
+
+TEST(ProfilerTest, ParallelScopesMergeUnderParent)
+{
+    Profiler::enable(true);
+    Profiler::reset();
+
+    {
+        ProfileScope step("step");
+        const string parent = Profiler::currentPath();
+        EXPECT_EQ(parent, "step");
+
+#pragma omp parallel num_threads(4)
+        {
+            ProfileScope worker(parent, "worker");
+            ProfileScope inner("inner");
+        }
+    }
+
+    const auto summaries = Profiler::merged();
+    const Profiler::Summary* worker = find(summaries, "step/worker");
+    ASSERT_NE(worker, nullptr);
+    EXPECT_EQ(worker->calls, 4u);
+    EXPECT_EQ(worker->threads, 4);
+    EXPECT_LE(worker->maxThreadNs, worker->totalNs);
+    ASSERT_NE(find(summaries, "step/worker/inner"), nullptr);
+}
+
+TEST(ProfilerTest, TraceAndReport)
+{
+    Profiler::enable(true);
+    Profiler::reset();
+
+    for (int i = 0; i < 2; i++) {
+        ProfileScope scope("phase");
+    }
+
+    stringstream trace;
+    Profiler::writeTrace(trace);
+    const string json = trace.str();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find("\"traceEvents\""), string::npos);
+
+    size_t events = 0;
+    for (size_t pos = json.find("\"ph\":\"X\""); pos != string::npos; pos = json.find("\"ph\":\"X\"", pos + 1)) {
+        events++;
+    }
+    EXPECT_EQ(events, 2u);
+
+    stringstream report;
+    Profiler::report(report);
+    EXPECT_NE(report.str().find("phase"), string::npos);
+    EXPECT_NE(report.str().find("100.0"), string::npos);
+}
+
+TEST(PerfCountersTest, ReadIsMonotonic)
+{
+    PerfCounters counters;
+    if (!counters.isAnyAvailable()) {
+        GTEST_SKIP() << "no performance counters: " << counters.errorMessage();
+    }
+
+    const PerfCounters::Values before = counters.read();
+    volatile double sink = 0.0;
+    for (int i = 0; i < 1000000; i++) {
+        sink = sink + i * 0.5;
+    }
+    const PerfCounters::Values after = counters.read();
+
+    for (int32_t i = 0; i < PerfCounters::COUNTER_NUM; i++) {
+        const auto counter = static_cast<PerfCounters::Counter>(i);
+        if (counters.isAvailable(counter)) {
+            EXPECT_GE(after[i], before[i]) << PerfCounters::NAMES[i];
+        } else {
+            EXPECT_EQ(after[i], 0u) << PerfCounters::NAMES[i];
+        }
+    }
+    if (counters.isAvailable(PerfCounters::INSTRUCTIONS)) {
+        EXPECT_GT(after[PerfCounters::INSTRUCTIONS] - before[PerfCounters::INSTRUCTIONS], 1000000u);
+    }
+    if (counters.isAvailable(PerfCounters::TASK_CLOCK)) {
+        EXPECT_GT(after[PerfCounters::TASK_CLOCK], before[PerfCounters::TASK_CLOCK]);
+    }
+}
+
+TEST(ProfilerTest, CountersFallBackToTiming)
+{
+    Profiler::enable(false, true);
+    Profiler::reset();
+
+    {
+        ProfileScope scope("phase");
+        volatile double sink = 0.0;
+        for (int i = 0; i < 100000; i++) {
+            sink = sink + i;
+        }
+    }
+
+    // カウンタを開けない環境でも時間は計測できる
+    const auto summaries = Profiler::merged();
+    const Profiler::Summary* phase = find(summaries, "phase");
+    ASSERT_NE(phase, nullptr);
+    EXPECT_EQ(phase->calls, 1u);
+    EXPECT_GT(phase->totalNs, 0);
+
+    if (!Profiler::isCounting()) {
+        EXPECT_FALSE(Profiler::counterErrorMessage().empty());
+        EXPECT_EQ(phase->counts, PerfCounters::Values{});
+        return;
+    }
+    if (Profiler::isCounterAvailable(PerfCounters::TASK_CLOCK)) {
+        EXPECT_GT(phase->counts[PerfCounters::TASK_CLOCK], 0u);
+    }
+
+    stringstream report;
+    Profiler::reportCounters(report);
+    EXPECT_NE(report.str().find("IPC"), string::npos);
+    EXPECT_NE(report.str().find("phase"), string::npos);
+
+    Profiler::enable(false, false);
+}
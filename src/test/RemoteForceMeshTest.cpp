@@ -0,0 +1,124 @@
+#include "../core/RemoteForceMesh.hpp"
+#include "../utils/FFT.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr double LAMBDA = 30.0;
+
+    Vec3 directSum(const vector<Vec3>& positions, const vector<double>& weights, const Vec3& p)
+    {
+        Vec3 force = Vec3::zero();
+        for (size_t i = 0; i < positions.size(); i++) {
+            const Vec3 diff   = positions[i] - p;
+            const double dist = diff.length();
+            if (dist == 0) {
+                continue;
+            }
+            force += diff.timesScalar(weights[i] * exp(-dist / LAMBDA) / dist);
+        }
+        return force;
+    }
+} // namespace
+
+TEST(FFTTest, MatchesNaiveDFT)
+{
+    const int32_t n = 16;
+    mt19937_64 engine(1);
+    uniform_real_distribution<double> dist(-1, 1);
+
+    vector<FFT::Complex> a(n);
+    for (auto& v : a) {
+        v = { dist(engine), dist(engine) };
+    }
+
+    vector<FFT::Complex> b = a;
+    FFT::Plan(n).transform(b.data(), 1, false);
+
+    for (int32_t k = 0; k < n; k++) {
+        FFT::Complex expected = 0;
+        for (int32_t j = 0; j < n; j++) {
+            expected += a[j] * polar(1.0, -2.0 * numbers::pi * j * k / n);
+        }
+        EXPECT_NEAR(abs(b[k] - expected), 0, 1e-12) << k;
+    }
+}
+
+TEST(FFTTest, Transform3DRoundTrips)
+{
+    const int32_t nx = 8, ny = 4, nz = 2;
+    mt19937_64 engine(2);
+    uniform_real_distribution<double> dist(-1, 1);
+
+    vector<FFT::Complex> a(nx * ny * nz);
+    for (auto& v : a) {
+        v = dist(engine);
+    }
+
+    vector<FFT::Complex> b = a;
+    FFT::transform3D(b, nx, ny, nz, false);
+    EXPECT_NEAR(abs(b[0] - accumulate(a.begin(), a.end(), FFT::Complex(0))), 0, 1e-12); // 直流成分は総和
+    FFT::transform3D(b, nx, ny, nz, true);
+
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_NEAR(abs(b[i] - a[i]), 0, 1e-12) << i;
+    }
+}
+
+TEST(FFTTest, RejectsNonPowerOfTwo)
+{
+    EXPECT_THROW(FFT::Plan(12), std::invalid_argument);
+}
+
+TEST(RemoteForceMeshTest, ApproximatesDirectSum)
+{
+    for (int32_t dim : { 2, 3 }) {
+        const double len     = dim == 2 ? 256 : 64;
+        const double spacing = 2.0;
+        const int32_t count  = len / spacing;
+
+        mt19937_64 engine(dim);
+        uniform_real_distribution<double> pos(-len / 2, len / 2);
+        uniform_real_distribution<double> weight(0.5, 2.0);
+
+        vector<Vec3> positions;
+        vector<double> weights;
+        for (int32_t i = 0; i < 2000; i++) {
+            positions.emplace_back(pos(engine), pos(engine), dim == 3 ? pos(engine) : 0.0);
+            weights.push_back(weight(engine));
+        }
+
+        RemoteForceMesh mesh;
+        mesh.init(Vec3(-len / 2, -len / 2, dim == 3 ? -len / 2 : 0.0), count, count, dim == 3 ? count : 1, spacing, LAMBDA);
+        mesh.build(positions, weights);
+
+        double error = 0, norm = 0;
+        for (int32_t i = 0; i < 2000; i += 23) {
+            const Vec3 expected = directSum(positions, weights, positions[i]);
+            error += (mesh.gradient(positions[i]) - expected).length();
+            norm += expected.length();
+        }
+        EXPECT_LT(error / norm, 0.05) << "dim " << dim;
+    }
+}
+
+TEST(RemoteForceMeshTest, SingleSourceHasNoSelfForce)
+{
+    RemoteForceMesh mesh;
+    mesh.init(Vec3(-32, -32, 0), 32, 32, 1, 2.0, LAMBDA);
+    mesh.build({ Vec3(3.3, -7.1, 0) }, { 1.0 });
+
+    const Vec3 self = mesh.gradient(Vec3(3.3, -7.1, 0));
+    EXPECT_LT(self.length(), 0.05);
+
+    // 離れた位置では発生源の方を向く
+    const Vec3 far = mesh.gradient(Vec3(23.3, -7.1, 0));
+    EXPECT_NEAR(far.x, -exp(-20 / LAMBDA), 0.02);
+    EXPECT_NEAR(far.y, 0, 0.02);
+}
@@ -27,7 +27,7 @@ int main(void)
         }
     }
 
-    SegmentTree<int, int> seg(h, w, 0);
+    SegmentTree<int> seg(h, w, 0);
 
     for (int i = 0; i < h; i++) {
         for (int j = 0; j < w; j++) {
@@ -0,0 +1,380 @@
+#include "../UserSimulation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr int32_t FIELD = 512;
+
+    /**
+     * @brief 細胞の配列の管理に触るためのSimulation
+     */
+    class StoreSimulation : public UserSimulation
+    {
+      public:
+        using Simulation::addCell;
+        using Simulation::cells;
+        using Simulation::findCellById;
+        using Simulation::findSlotById;
+        using Simulation::maintainCellStore;
+    };
+
+    unique_ptr<StoreSimulation> makeSimulation()
+    {
+        SimulationSettings::USE_CELL_LIST           = true;
+        SimulationSettings::CELL_NUM                = 0;
+        SimulationSettings::GRID_SIZE_MAGNIFICATION = 32;
+        SimulationSettings::SEARCH_RADIUS           = 64;
+        SimulationSettings::CELL_LIST_TYPE          = CellListType::UNIFORM;
+        SimulationSettings::CELL_LIST_PERIODIC      = false;
+        SimulationSettings::REMOTE_FORCE_METHOD     = RemoteForceMethod::CUTOFF;
+        SimulationSettings::POSITION_UPDATE_METHOD  = PositionUpdateMethod::EULER;
+        SimulationSettings::COMPACTION_THRESHOLD    = 0.25;
+        SimulationSettings::REORDER_INTERVAL        = 0;
+        SimulationSettings::FIELD_X_LEN             = FIELD;
+        SimulationSettings::FIELD_Y_LEN             = FIELD;
+        SimulationSettings::FIELD_Z_LEN             = 0;
+        SimulationSettings::MOLECULE_TYPE_NUM       = 1;
+        SimulationSettings::DEFAULT_MOLECULE_NUMS   = { 0 };
+        SimulationSettings::MOLECULE_FIELD_X_LEN    = 16;
+        SimulationSettings::MOLECULE_FIELD_Y_LEN    = 16;
+        SimulationSettings::MOLECULE_FIELD_Z_LEN    = 1;
+        SimulationSettings::DELTA_TIME              = 1.0;
+
+        // MoleculeSpaceのコンストラクタが標準出力に書くので、その間は止めておく
+        cout.setstate(ios::failbit);
+        auto sim = make_unique<StoreSimulation>();
+        cout.clear();
+        return sim;
+    }
+
+    /**
+     * @brief 生きている細胞はすべてIDから引け、引いた添字がCell::getArrayIndex()と一致するか。消えた細胞は引けないか。
+     */
+    void expectConsistent(const StoreSimulation& sim, const set<int32_t>& deadIds)
+    {
+        for (int32_t i = 0; i < (int32_t)sim.cells.size(); i++) {
+            const auto& cell = sim.cells[i];
+            if (cell->getCellType() == CellType::NONE) {
+                continue;
+            }
+            ASSERT_EQ(cell->getArrayIndex(), i);
+            ASSERT_EQ(sim.findSlotById(cell->id), i);
+            ASSERT_EQ(sim.findCellById(cell->id), cell);
+        }
+        for (const int32_t id : deadIds) {
+            EXPECT_EQ(sim.findCellById(id), nullptr) << id;
+        }
+    }
+
+    /**
+     * @brief 一時ディレクトリを作って移り、抜けるときに元のディレクトリに戻って消す。結果は./resultなどに書かれるため。
+     */
+    class ScopedWorkDirectory
+    {
+      private:
+        filesystem::path previous;
+        filesystem::path directory;
+
+      public:
+        explicit ScopedWorkDirectory(const string& name)
+          : previous(filesystem::current_path())
+          , directory(filesystem::temp_directory_path() / (name + "_" + to_string(::getpid())))
+        {
+            filesystem::remove_all(directory);
+            filesystem::create_directories(directory);
+            filesystem::current_path(directory);
+        }
+
+        ~ScopedWorkDirectory()
+        {
+            filesystem::current_path(previous);
+            filesystem::remove_all(directory);
+        }
+    };
+
+    /**
+     * @brief src/config.yamlを読み、小さな実行に合わせて設定を上書きする。シミュレーションを作る前に呼ぶ。
+     */
+    void configureRun(int32_t simStep, int32_t checkpointInterval, int32_t cellCount = 200, bool clusters = false)
+    {
+        cout.setstate(ios::failbit);
+        ASSERT_TRUE(SimulationSettings::init_settings("src/config.yaml"));
+        cout.clear();
+
+        SimulationSettings::CELL_NUM             = cellCount;
+        SimulationSettings::SIM_STEP             = simStep;
+        SimulationSettings::OUTPUT_INTERVAL_STEP = 5;
+        SimulationSettings::REORDER_INTERVAL     = 10;
+        SimulationSettings::INIT_CELL_FILE       = "";
+        SimulationSettings::OUTPUT_ENABLED       = true;
+        SimulationSettings::OUTPUT_FORMAT        = OutputFormat::BINARY;
+        SimulationSettings::OUTPUT_ASYNC         = false;
+        SimulationSettings::CHECKPOINT_INTERVAL  = checkpointInterval;
+        SimulationSettings::CHECKPOINT_PATH      = "./result/checkpoint.mcmc";
+        SimulationSettings::RESTART              = false;
+        SimulationSettings::PROFILE_ENABLED      = false;
+        SimulationSettings::ANALYSIS_CLUSTERS    = clusters;
+    }
+
+    /**
+     * @brief SimMainと同じ手順で実行する。checkpointPathが空でなければそこから再開する。
+     */
+    void runSimulation(const string& checkpointPath = "")
+    {
+        cout.setstate(ios::failbit);
+        {
+            UserSimulation sim;
+            if (checkpointPath.empty()) {
+                sim.initCells();
+            } else {
+                sim.loadCheckpoint(checkpointPath);
+            }
+            sim.initDirectories();
+            sim.run();
+        }
+        cout.clear();
+    }
+
+    string readFile(const filesystem::path& path)
+    {
+        ifstream ifs(path, ios::binary);
+        return string(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+    }
+
+    /**
+     * @brief ScopedWorkDirectoryの中にsrc/config.yamlを写す。configureRun()はそこから読む。
+     */
+    void copyConfig(const filesystem::path& config)
+    {
+        filesystem::create_directories("src");
+        filesystem::copy_file(config, "src/config.yaml");
+    }
+
+    /**
+     * @brief ./resultと./molecule_resultの出力ファイル(チェックポイントを除く)の中身
+     */
+    map<string, string> readOutputs()
+    {
+        map<string, string> outputs;
+        for (const char* dir : { "result", "molecule_result" }) {
+            if (!filesystem::exists(dir)) {
+                continue;
+            }
+            for (const auto& entry : filesystem::recursive_directory_iterator(dir)) {
+                if (entry.is_regular_file() && entry.path().filename() != "checkpoint.mcmc") {
+                    outputs[entry.path().string()] = readFile(entry.path());
+                }
+            }
+        }
+        return outputs;
+    }
+} // namespace
+
+TEST(CellStoreTest, FreedSlotsAreReusedAndCompacted)
+{
+    auto sim = makeSimulation();
+    mt19937_64 engine(3);
+    uniform_real_distribution<double> pos(-FIELD / 2 + 40, FIELD / 2 - 40);
+
+    for (int32_t i = 0; i < 100; i++) {
+        sim->addCell(make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine)));
+    }
+    EXPECT_FALSE(sim->maintainCellStore());
+    expectConsistent(*sim, {});
+
+    // 割合が閾値以下なら詰めずに、空いた場所を添字の小さい順に再利用する
+    set<int32_t> deadIds;
+    for (const int32_t slot : { 40, 7, 63, 12 }) {
+        deadIds.insert(sim->cells[slot]->id);
+        sim->cells[slot]->die();
+    }
+    EXPECT_FALSE(sim->maintainCellStore());
+    EXPECT_EQ(sim->cells.size(), 100u);
+    expectConsistent(*sim, deadIds);
+
+    const auto born = make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine));
+    EXPECT_EQ(sim->addCell(born), 7);
+    EXPECT_EQ(sim->addCell(make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine))), 12);
+    EXPECT_FALSE(sim->maintainCellStore());
+    EXPECT_EQ(sim->findCellById(born->id), born);
+    expectConsistent(*sim, deadIds);
+
+    // 閾値を超えたら詰め直す。添字は変わるがIDからは同じ細胞が引ける
+    vector<shared_ptr<UserCell>> alive;
+    for (int32_t i = 0; i < (int32_t)sim->cells.size(); i++) {
+        if (sim->cells[i]->getCellType() == CellType::NONE) {
+            continue;
+        }
+        if (i % 3 == 0) {
+            deadIds.insert(sim->cells[i]->id);
+            sim->cells[i]->die();
+        } else {
+            alive.push_back(sim->cells[i]);
+        }
+    }
+    EXPECT_TRUE(sim->maintainCellStore());
+    EXPECT_EQ(sim->cells.size(), alive.size());
+    expectConsistent(*sim, deadIds);
+    for (const auto& cell : alive) {
+        EXPECT_EQ(sim->findCellById(cell->id), cell);
+    }
+
+    // 詰めた後は末尾に追加する
+    EXPECT_EQ(sim->addCell(make_shared<UserCell>(CellType::WORKER, pos(engine), pos(engine))), (int32_t)alive.size());
+    EXPECT_FALSE(sim->maintainCellStore());
+    expectConsistent(*sim, deadIds);
+}
+
+TEST(CheckpointTest, RestartMatchesUninterruptedRun)
+{
+    const filesystem::path config = filesystem::absolute("src/config.yaml");
+    ScopedWorkDirectory work("SimulationTest_checkpoint");
+    copyConfig(config);
+
+    // 40ステップを通しで実行し、20ステップ目でチェックポイントを書く
+    configureRun(40, 20);
+    runSimulation();
+    const map<string, string> uninterrupted = readOutputs();
+    ASSERT_TRUE(filesystem::exists("result/checkpoint.mcmc"));
+
+    // 出力を消してチェックポイントから再開すると、21ステップ目以降(出力5〜7)を書き直す
+    for (const char* dir : { "result", "molecule_result" }) {
+        for (const auto& entry : filesystem::recursive_directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().filename() != "checkpoint.mcmc") {
+                filesystem::remove(entry.path());
+            }
+        }
+    }
+    configureRun(40, 0);
+    runSimulation("./result/checkpoint.mcmc");
+    const map<string, string> resumed = readOutputs();
+
+    int32_t cellFiles = 0;
+    for (const auto& [path, bytes] : resumed) {
+        cellFiles += path.starts_with("result/cells_") ? 1 : 0;
+    }
+    EXPECT_EQ(cellFiles, 3);
+    for (const auto& [path, bytes] : resumed) {
+        ASSERT_TRUE(uninterrupted.count(path)) << path;
+        EXPECT_TRUE(uninterrupted.at(path) == bytes) << path << " differs from the uninterrupted run";
+    }
+}
+
+TEST(ClusterOutputTest, FirstOutputHasContactsAndClusters)
+{
+    const filesystem::path config = filesystem::absolute("src/config.yaml");
+    ScopedWorkDirectory work("SimulationTest_clusters");
+    copyConfig(config);
+
+    configureRun(6, 0, 1000, true);
+    runSimulation();
+
+    ifstream ifs("result/cells_00", ios::binary);
+    if (!ifs) {
+        ifs.open("result/cells_0", ios::binary);
+    }
+    ASSERT_TRUE(ifs);
+    const CellSnapshot snapshot = CellSnapshot::readBinary(ifs);
+    const int32_t n             = (int32_t)snapshot.size();
+
+    // 出力0の接触は、まだ力を計算していなくても位置から求めた重なりと一致する
+    for (int32_t i = 0; i < n; i++) {
+        set<int32_t> expected;
+        for (int32_t j = 0; j < n; j++) {
+            const double dx = snapshot.x[i] - snapshot.x[j];
+            const double dy = snapshot.y[i] - snapshot.y[j];
+            const double dz = snapshot.z[i] - snapshot.z[j];
+            if (i != j && sqrt(dx * dx + dy * dy + dz * dz) < snapshot.radius[i] + snapshot.radius[j]) {
+                expected.insert(snapshot.id[j]);
+            }
+        }
+        const set<int32_t> actual(snapshot.contactId.begin() + snapshot.contactOffset[i], snapshot.contactId.begin() + snapshot.contactOffset[i + 1]);
+        ASSERT_EQ(actual, expected) << "cell " << snapshot.id[i];
+    }
+    ASSERT_FALSE(snapshot.contactId.empty());
+
+    // クラスタの列と集計の1行目も接触を反映する
+    ASSERT_EQ((int32_t)snapshot.cluster.size(), n);
+    const int32_t clusterCount = *max_element(snapshot.cluster.begin(), snapshot.cluster.end()) + 1;
+    EXPECT_LT(clusterCount, n);
+
+    ifstream summary("result/clusters.tsv");
+    string header, first;
+    getline(summary, header);
+    getline(summary, first);
+    istringstream fields(first);
+    int32_t output, cells, clusters;
+    fields >> output >> cells >> clusters;
+    EXPECT_EQ(output, 0);
+    EXPECT_EQ(cells, n);
+    EXPECT_EQ(clusters, clusterCount);
+}
+
+TEST(ClusterOutputTest, RestartDoesNotDuplicateRows)
+{
+    const filesystem::path config = filesystem::absolute("src/config.yaml");
+    ScopedWorkDirectory work("SimulationTest_clusterRestart");
+    copyConfig(config);
+
+    configureRun(40, 20, 200, true);
+    runSimulation();
+    const string uninterrupted = readFile("result/clusters.tsv");
+
+    // 出力を残したまま20ステップ目から再開すると、出力5以降の行を書き直す
+    configureRun(40, 0, 200, true);
+    runSimulation("./result/checkpoint.mcmc");
+
+    EXPECT_EQ(readFile("result/clusters.tsv"), uninterrupted);
+}
+
+TEST(SettingsTest, ConfigWithoutOutputSectionWritesText)
+{
+    // 出力の節がない以前の設定ファイルも読め、テキストで出力する
+    YAML::Node config = YAML::LoadFile("src/config.yaml");
+    config.remove("output");
+    const string path = ::testing::TempDir() + "SimulationTest_config.yaml";
+    ofstream(path) << config;
+
+    cout.setstate(ios::failbit);
+    const bool loaded = SimulationSettings::init_settings(path);
+    cout.clear();
+    filesystem::remove(path);
+
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(SimulationSettings::OUTPUT_FORMAT, OutputFormat::TEXT);
+    EXPECT_FALSE(SimulationSettings::OUTPUT_FLOAT32);
+    EXPECT_TRUE(SimulationSettings::OUTPUT_ENABLED);
+}
+
+TEST(OutputFailureTest, UnwritableSnapshotIsReported)
+{
+    const filesystem::path config = filesystem::absolute("src/config.yaml");
+    ScopedWorkDirectory work("SimulationTest_outputFailure");
+    copyConfig(config);
+
+    // 出力1の書き込み先をディレクトリにして、書けないようにする
+    for (const bool async : { false, true }) {
+        configureRun(10, 0);
+        SimulationSettings::OUTPUT_ASYNC = async;
+        filesystem::remove_all("result");
+        filesystem::create_directories("result/cells_01");
+        filesystem::create_directories("result/cells_1");
+
+        EXPECT_THROW(runSimulation(), runtime_error) << "async: " << async;
+        cout.clear();
+    }
+}
@@ -0,0 +1,90 @@
+#include "../utils/RadixSort.hpp"
+#include "../utils/SpaceFillingCurve.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+namespace Curve {
+    TEST(mortonTest, interleavesBits)
+    {
+        EXPECT_EQ(SpaceFillingCurve::morton2D(0, 0), 0u);
+        EXPECT_EQ(SpaceFillingCurve::morton2D(1, 0), 1u);
+        EXPECT_EQ(SpaceFillingCurve::morton2D(0, 1), 2u);
+        EXPECT_EQ(SpaceFillingCurve::morton2D(3, 3), 15u);
+        EXPECT_EQ(SpaceFillingCurve::morton2D(0xffffffff, 0), 0x5555555555555555ULL);
+        EXPECT_EQ(SpaceFillingCurve::morton3D(1, 1, 1), 7u);
+        EXPECT_EQ(SpaceFillingCurve::morton3D(0x1fffff, 0, 0), 0x1249249249249249ULL);
+    }
+
+    TEST(hilbertTest, visitsEveryGridOnceThroughNeighbours)
+    {
+        for (uint32_t bits = 1; bits <= 5; bits++) {
+            const uint32_t n = 1u << bits;
+            vector<pair<uint32_t, uint32_t>> byKey(n * n, { n, n });
+
+            for (uint32_t y = 0; y < n; y++) {
+                for (uint32_t x = 0; x < n; x++) {
+                    const uint64_t d = SpaceFillingCurve::hilbert2D(bits, x, y);
+                    ASSERT_LT(d, (uint64_t)n * n);
+                    ASSERT_EQ(byKey[d].first, n) << "duplicate key " << d;
+                    byKey[d] = { x, y };
+                }
+            }
+
+            // 隣り合う番号は隣り合う格子
+            for (size_t d = 1; d < byKey.size(); d++) {
+                const int dx = abs((int)byKey[d].first - (int)byKey[d - 1].first);
+                const int dy = abs((int)byKey[d].second - (int)byKey[d - 1].second);
+                EXPECT_EQ(dx + dy, 1) << "bits " << bits << " key " << d;
+            }
+        }
+    }
+} // namespace Curve
+
+namespace Radix {
+    void checkSorted(size_t n, uint64_t maxKey)
+    {
+        mt19937_64 engine(n);
+        uniform_int_distribution<uint64_t> dist(0, maxKey);
+
+        vector<uint64_t> keys(n);
+        vector<int32_t> values(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i]   = dist(engine);
+            values[i] = i;
+        }
+
+        vector<pair<uint64_t, int32_t>> expected(n);
+        for (size_t i = 0; i < n; i++) {
+            expected[i] = { keys[i], values[i] };
+        }
+        stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        RadixSort::sortByKey(keys, values);
+
+        ASSERT_EQ(keys.size(), n);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(keys[i], expected[i].first) << i;
+            ASSERT_EQ(values[i], expected[i].second) << i; // 安定
+        }
+    }
+
+    TEST(radixSortTest, small)
+    {
+        checkSorted(0, 10);
+        checkSorted(1, 10);
+        checkSorted(1000, 255);
+        checkSorted(1000, 100000);
+    }
+
+    TEST(radixSortTest, parallelIsStable)
+    {
+        checkSorted(RadixSort::PARALLEL_MIN_LEN * 4 + 7, 1000);
+        checkSorted(RadixSort::PARALLEL_MIN_LEN * 4 + 7, UINT64_MAX);
+    }
+} // namespace Radix
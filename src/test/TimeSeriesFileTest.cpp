@@ -0,0 +1,156 @@
+#include "../core/TimeSeriesFile.hpp"
+#include <cmath>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    const string PATH = "TimeSeriesFileTest.mcmc";
+
+    CellSnapshot makeSnapshot(int32_t step, int32_t n)
+    {
+        CellSnapshot s;
+        s.step = step;
+        s.resize(n);
+
+        for (int i = 0; i < n; i++) {
+            s.id[i]     = step * 100 + i;
+            s.type[i]   = static_cast<uint8_t>(CellType::WORKER);
+            s.x[i]      = 0.1 * i + step;
+            s.radius[i] = 1.0;
+        }
+
+        return s;
+    }
+
+    MoleculeGrid makeGrid(double base)
+    {
+        MoleculeGrid g{ 2, 3, 1, {} };
+        g.values.resize(4 * 5 * 3);
+        for (size_t i = 0; i < g.values.size(); i++) {
+            g.values[i] = base + i / 3.0;
+        }
+
+        return g;
+    }
+
+    void writeSeries(bool useFloat32, bool closeFile, CompressionMode compression = CompressionMode::NONE)
+    {
+        TimeSeriesWriter writer(PATH, useFloat32, compression, 1e-3);
+        for (int32_t step = 0; step < 3; step++) {
+            writer.appendCells(makeSnapshot(step, 2 + step));
+            writer.appendMolecules(step, 0, makeGrid(step));
+            writer.appendMolecules(step, 1, makeGrid(-step));
+        }
+        if (closeFile) {
+            writer.close();
+        }
+    }
+} // namespace
+
+TEST(TimeSeriesFileTest, RandomAccessByStep)
+{
+    writeSeries(false, true);
+
+    TimeSeriesReader reader(PATH);
+    EXPECT_TRUE(reader.hasIndex());
+    EXPECT_EQ(reader.getEntries().size(), 9u);
+    EXPECT_EQ(reader.steps(), (vector<int32_t>{ 0, 1, 2 }));
+
+    // 後ろから読んでも前から読んでも同じ
+    for (int32_t step = 2; step >= 0; step--) {
+        const CellSnapshot s = reader.readCells(step);
+        EXPECT_EQ(s.step, step);
+        EXPECT_EQ(s.id, makeSnapshot(step, 2 + step).id);
+        EXPECT_EQ(s.x, makeSnapshot(step, 2 + step).x);
+
+        const MoleculeGrid g = reader.readMolecules(step, 1);
+        EXPECT_EQ(g.width, 2u);
+        EXPECT_EQ(g.height, 3u);
+        EXPECT_EQ(g.values, makeGrid(-step).values);
+    }
+
+    EXPECT_THROW(reader.readCells(3), std::out_of_range);
+    EXPECT_THROW(reader.readMolecules(0, 2), std::out_of_range);
+    filesystem::remove(PATH);
+}
+
+TEST(TimeSeriesFileTest, Float32Grid)
+{
+    writeSeries(true, true);
+
+    TimeSeriesReader reader(PATH);
+    const MoleculeGrid g = reader.readMolecules(1, 0);
+    const MoleculeGrid e = makeGrid(1);
+    for (size_t i = 0; i < e.values.size(); i++) {
+        EXPECT_FLOAT_EQ(g.values[i], e.values[i]);
+    }
+    filesystem::remove(PATH);
+}
+
+TEST(TimeSeriesFileTest, CompressedGrid)
+{
+    writeSeries(false, true, CompressionMode::LOSSLESS);
+    {
+        TimeSeriesReader reader(PATH);
+        EXPECT_EQ(reader.readMolecules(2, 0).values, makeGrid(2).values);
+    }
+
+    writeSeries(false, true, CompressionMode::LOSSY);
+    TimeSeriesReader reader(PATH);
+    const MoleculeGrid g = reader.readMolecules(2, 0);
+    const MoleculeGrid e = makeGrid(2);
+    for (size_t i = 0; i < e.values.size(); i++) {
+        EXPECT_LE(abs(g.values[i] - e.values[i]), 1e-3);
+    }
+    filesystem::remove(PATH);
+}
+
+TEST(TimeSeriesFileTest, ScanWithoutIndex)
+{
+    writeSeries(false, true);
+    const auto fullSize = filesystem::file_size(PATH);
+    // 索引と最後のチャンクの一部を切り落とし、書き込み途中で止まったファイルを作る
+    filesystem::resize_file(PATH, fullSize - 9 * TimeSeriesFile::ENTRY_SIZE - TimeSeriesFile::FOOTER_SIZE - 10);
+
+    TimeSeriesReader reader(PATH);
+    EXPECT_FALSE(reader.hasIndex());
+    EXPECT_EQ(reader.getEntries().size(), 8u);
+    EXPECT_EQ(reader.readCells(2).id, makeSnapshot(2, 4).id);
+    EXPECT_THROW(reader.readMolecules(2, 1), std::out_of_range);
+    filesystem::remove(PATH);
+}
+
+TEST(TimeSeriesFileTest, DestructorWritesIndex)
+{
+    writeSeries(false, false);
+
+    EXPECT_TRUE(TimeSeriesReader::isTimeSeries(PATH));
+    TimeSeriesReader reader(PATH);
+    EXPECT_TRUE(reader.hasIndex());
+    filesystem::remove(PATH);
+}
+
+TEST(TimeSeriesFileTest, ResumeDropsLaterChunks)
+{
+    // 索引の有無にかかわらず、再開したステップより後のチャンクは捨てて続きから書く
+    for (bool closeFile : { true, false }) {
+        writeSeries(false, closeFile);
+        {
+            TimeSeriesWriter writer(PATH, false, CompressionMode::NONE, 0.0, 1);
+            writer.appendCells(makeSnapshot(7, 3));
+        }
+
+        TimeSeriesReader reader(PATH);
+        EXPECT_TRUE(reader.hasIndex());
+        EXPECT_EQ(reader.steps(), (vector<int32_t>{ 0, 1, 7 }));
+        EXPECT_EQ(reader.readCells(1).id, makeSnapshot(1, 3).id);
+        EXPECT_EQ(reader.readMolecules(1, 1).values, makeGrid(-1).values);
+        EXPECT_EQ(reader.readCells(7).id, makeSnapshot(7, 3).id);
+        EXPECT_THROW(reader.readMolecules(2, 0), std::out_of_range);
+        filesystem::remove(PATH);
+    }
+}
@@ -0,0 +1,110 @@
+#include "../core/VariableRatioCellList.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr double FIELD  = 1024;
+    constexpr double RADIUS = 64;
+
+    vector<int32_t> bruteForce(const vector<Vec3>& positions, const Vec3& p)
+    {
+        vector<int32_t> result;
+        for (int32_t i = 0; i < (int32_t)positions.size(); i++) {
+            const Vec3 diff = positions[i] - p;
+            if (diff.x * diff.x + diff.y * diff.y <= RADIUS * RADIUS) {
+                result.push_back(i);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief 密集したコロニー(正規分布)と、まばらに散らばった細胞
+     */
+    vector<Vec3> clusteredPositions(int32_t n, uint64_t seed)
+    {
+        mt19937_64 engine(seed);
+        normal_distribution<double> core(0, 20);
+        uniform_real_distribution<double> sparse(-FIELD / 2, FIELD / 2);
+
+        vector<Vec3> positions;
+        for (int32_t i = 0; i < n; i++) {
+            if (i % 10 == 0) {
+                positions.emplace_back(sparse(engine), sparse(engine), 0);
+            } else {
+                positions.emplace_back(clamp(core(engine) + 200, -FIELD / 2, FIELD / 2 - 1), clamp(core(engine) - 100, -FIELD / 2, FIELD / 2 - 1), 0);
+            }
+        }
+        return positions;
+    }
+} // namespace
+
+TEST(VariableRatioCellListTest, FindsSameCellsAsBruteForce)
+{
+    const vector<Vec3> positions = clusteredPositions(5000, 1);
+
+    VariableRatioCellList list(FIELD, FIELD, 8, 32, RADIUS);
+    list.build(positions);
+
+    for (int32_t i = 0; i < (int32_t)positions.size(); i += 37) {
+        vector<int32_t> actual = list.aroundCellList(positions[i]);
+        sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, bruteForce(positions, positions[i])) << i;
+    }
+}
+
+TEST(VariableRatioCellListTest, DenseRegionsGetFinerBuckets)
+{
+    VariableRatioCellList list(FIELD, FIELD, 8, 32, RADIUS);
+
+    list.build(vector<Vec3>(100, Vec3(0, 0, 0)));
+    EXPECT_GT(list.bucketCount(), 1); // 1点に集まっていても最も細かいグリッドで止まる
+
+    const int32_t uniformBuckets = list.bucketCount();
+    list.build(clusteredPositions(5000, 2));
+    EXPECT_GT(list.bucketCount(), uniformBuckets);
+    EXPECT_LT(list.bucketCount(), (int32_t)((FIELD / 8) * (FIELD / 8))); // まばらな領域はまとめる
+}
+
+TEST(VariableRatioCellListTest, RebuildAndOutOfField)
+{
+    VariableRatioCellList list(FIELD, FIELD, 8, 4, RADIUS);
+
+    list.build({});
+    EXPECT_TRUE(list.aroundCellList(Vec3(0, 0, 0)).empty());
+
+    // フィールドの外の細胞は端のグリッドに入る
+    const vector<Vec3> positions = { Vec3(-600, 0, 0), Vec3(-500, 0, 0), Vec3(500, 500, 0) };
+    list.build(positions);
+    vector<int32_t> around = list.aroundCellList(Vec3(-540, 0, 0));
+    sort(around.begin(), around.end());
+    EXPECT_EQ(around, (vector<int32_t>{ 0, 1 }));
+}
+
+TEST(SegmentTreeTest, UsesGivenCombiner)
+{
+    const vector<vector<int32_t>> values = { { 3, 9, 1 }, { 4, 2, 7 } };
+    auto maxOf = [](const int32_t& a, const int32_t& b) { return max(a, b); };
+    SegmentTree<int32_t> sum(2, 3, 0);
+    SegmentTree<int32_t, decltype(maxOf)> largest(2, 3, 0);
+    for (int32_t h = 0; h < 2; h++) {
+        for (int32_t w = 0; w < 3; w++) {
+            sum.set(h, w, values[h][w]);
+            largest.set(h, w, values[h][w]);
+        }
+    }
+    sum.build();
+    largest.build();
+
+    EXPECT_EQ(sum.query(0, 0, 2, 3), 26);
+    EXPECT_EQ(largest.query(0, 0, 2, 3), 9);
+    EXPECT_EQ(largest.query(1, 0, 2, 2), 4);
+
+    largest.update(1, 1, 11);
+    EXPECT_EQ(largest.query(0, 1, 2, 2), 11);
+    EXPECT_EQ(largest.query(0, 2, 2, 3), 7);
+}
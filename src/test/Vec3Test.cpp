@@ -1,4 +1,6 @@
 #include "../utils/Vec3.hpp"
+#include "../utils/Vec2.hpp"
+#include "../utils/Precision.hpp"
 #include <cmath>
 #include <gtest/gtest.h>
 #include <iostream>
@@ -231,4 +233,66 @@ namespace AllPositive {
             }
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(Vec3Test, FloatRoundTrip)
+{
+    const Vec3 v(1.25, -3.5, 1e-3);
+
+    const StoredVec3 s(v);
+    EXPECT_NEAR(Vec3(s).dist(v), 0.0, 1e-6);
+
+    const Vec<float, 3> f(v);
+    const Vec3 back = f;
+    EXPECT_EQ(sizeof(f), 3 * sizeof(float));
+    EXPECT_DOUBLE_EQ(back.x, 1.25);
+    EXPECT_DOUBLE_EQ(back.y, -3.5);
+    EXPECT_NEAR(back.z, 1e-3, 1e-10);
+}
+
+TEST(Vec3Test, ConstexprArithmetic)
+{
+    constexpr Vec3 a(1, 2, 3);
+    constexpr Vec3 b(4, -5, 6);
+    static_assert(a + b == Vec3(5, -3, 9));
+    static_assert(a - b == Vec3(-3, 7, -3));
+    static_assert(a.timesScalar(2) == 2.0 * a);
+    static_assert(a.dot(b) == 12.0);
+    static_assert(a.cross(b) == Vec3(27, 6, -13));
+    static_assert(Vec2(3, 4).lengthSquared() == 25.0);
+    static_assert(Vec<int32_t, 4>(1, 2, 3, 4)[3] == 4);
+
+    EXPECT_EQ(Vec2(3, 4).length(), 5.0);
+    EXPECT_EQ(a.length(), std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z));
+}
+
+TEST(Vec3Test, PaddedVec3IsAligned)
+{
+    static_assert(sizeof(PaddedVec3<double>) == 32 && alignof(PaddedVec3<double>) == 32);
+    static_assert(sizeof(PaddedVec3<float>) == 16 && alignof(PaddedVec3<float>) == 16);
+
+    const std::vector<PaddedVec3<double>> points = { Vec3(1, 2, 3), Vec3(-1, 5, 0) };
+    EXPECT_EQ((size_t)points.data() % 32, 0u);
+    EXPECT_EQ(points[0] - Vec3(1, 1, 1), Vec3(0, 1, 2));
+    EXPECT_EQ(points[1].padding, 0.0);
+}
+
+TEST(Vec3Test, BatchOperations)
+{
+    std::vector<Vec3> positions = { Vec3(0, 0, 0), Vec3(1, 2, 3), Vec3(-4, 1, 2) };
+    const std::vector<Vec3> velocities = { Vec3(1, 1, 1), Vec3(0, 0, 2), Vec3(2, 0, 0) };
+
+    VecBatch::addScaled(std::span(positions), std::span(velocities), 0.5);
+    EXPECT_EQ(positions[0], Vec3(0.5, 0.5, 0.5));
+    EXPECT_EQ(positions[1], Vec3(1, 2, 4));
+    EXPECT_EQ(positions[2], Vec3(-3, 1, 2));
+
+    std::vector<double> dist2(positions.size());
+    VecBatch::distancesSquared(std::span<const Vec3>(positions), Vec3(1, 2, 4), std::span(dist2));
+    EXPECT_EQ(dist2[1], 0.0);
+    EXPECT_EQ(dist2[2], 16.0 + 1.0 + 4.0);
+
+    const auto [lower, upper] = VecBatch::boundingBox(std::span<const Vec3>(positions));
+    EXPECT_EQ(lower, Vec3(-3, 0.5, 0.5));
+    EXPECT_EQ(upper, Vec3(1, 2, 4));
+}
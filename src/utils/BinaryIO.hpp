@@ -0,0 +1,120 @@
+/**
+ * @file BinaryIO.hpp
+ * @author Takanori Saiki
+ * @brief バイナリ形式の入出力で使う小さな関数をまとめておく。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// 出力ファイルはリトルエンディアンで書く。ビッグエンディアンの環境に対応する場合はここで変換する。
+static_assert(std::endian::native == std::endian::little, "BinaryIO assumes a little-endian host.");
+
+namespace BinaryIO {
+    /**
+     * @brief 値をそのままのバイト列で書き込む。
+     *
+     * @tparam T トリビアルコピー可能な型
+     * @param os
+     * @param value
+     */
+    template<typename T>
+    void writeValue(std::ostream& os, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief 配列をそのままのバイト列で書き込む。
+     *
+     * @tparam T トリビアルコピー可能な型
+     * @param os
+     * @param data
+     * @param count 要素数
+     */
+    template<typename T>
+    void writeArray(std::ostream& os, const T* data, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        os.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+    }
+
+    /**
+     * @brief 長さ(uint32)付きで文字列を書き込む。
+     *
+     * @param os
+     * @param str
+     */
+    inline void writeString(std::ostream& os, const std::string& str)
+    {
+        writeValue<uint32_t>(os, str.size());
+        os.write(str.data(), str.size());
+    }
+
+    /**
+     * @brief writeValueで書き込んだ値を読み込む。読み込めなかった場合は例外を投げる。
+     *
+     * @tparam T
+     * @param is
+     * @return T
+     */
+    template<typename T>
+    T readValue(std::istream& is)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        is.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!is) {
+            throw std::runtime_error("BinaryIO::readValue() : unexpected end of stream.");
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief writeArrayで書き込んだ配列を読み込む。読み込めなかった場合は例外を投げる。
+     *
+     * @tparam T
+     * @param is
+     * @param data
+     * @param count 要素数
+     */
+    template<typename T>
+    void readArray(std::istream& is, T* data, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        is.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+        if (!is) {
+            throw std::runtime_error("BinaryIO::readArray() : unexpected end of stream.");
+        }
+    }
+
+    /**
+     * @brief writeStringで書き込んだ文字列を読み込む。
+     *
+     * @param is
+     * @return std::string
+     */
+    inline std::string readString(std::istream& is)
+    {
+        const uint32_t size = readValue<uint32_t>(is);
+        std::string str(size, '\0');
+        readArray(is, str.data(), size);
+
+        return str;
+    }
+} // namespace BinaryIO
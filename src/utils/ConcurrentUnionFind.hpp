@@ -0,0 +1,90 @@
+/**
+ * @file ConcurrentUnionFind.hpp
+ * @author Takanori Saiki
+ * @brief 複数のスレッドから同時に併合できるUnion-Find
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ConcurrentUnionFind
+ * @brief 親の添字をatomicで持つUnion-Find。unite()とfind()はロックを取らず、複数のスレッドから同時に呼べる。
+ * @details 併合は根どうしをCASでつなぎ、必ず添字の大きい根を小さい根の下につなぐ。
+ *          そのため、どの順で併合しても集合の根はその集合の最小の添字になり、結果はスレッドの数や順序によらない。
+ *          find()は経路半減(親を祖父にCASでつけ替える)で木を低く保つ。つけ替えに失敗しても、別のスレッドが先に縮めただけなので正しい。
+ */
+class ConcurrentUnionFind
+{
+  private:
+    std::vector<std::atomic<int32_t>> parent; //!< 親の添字。根は自分自身
+
+  public:
+    explicit ConcurrentUnionFind(int32_t n)
+      : parent(n)
+    {
+#pragma omp parallel for
+        for (int32_t i = 0; i < n; i++) {
+            parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief xが属する集合の根(集合の最小の添字)
+     */
+    int32_t find(int32_t x) noexcept
+    {
+        while (true) {
+            int32_t p = parent[x].load(std::memory_order_relaxed);
+            if (p == x) {
+                return x;
+            }
+
+            const int32_t grandParent = parent[p].load(std::memory_order_relaxed);
+            if (p != grandParent) {
+                parent[x].compare_exchange_weak(p, grandParent, std::memory_order_relaxed);
+            }
+            x = grandParent;
+        }
+    }
+
+    /**
+     * @brief aとbの集合を併合する。
+     *
+     * @return true 別の集合だったので併合した
+     * @return false すでに同じ集合だった
+     */
+    bool unite(int32_t a, int32_t b) noexcept
+    {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+
+            // aがまだ根なら、aをbの下につなぐ。別のスレッドが先にaをつないでいたら、根を探し直す
+            int32_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+
+    int32_t size() const noexcept
+    {
+        return (int32_t)parent.size();
+    }
+};
@@ -0,0 +1,179 @@
+/**
+ * @file CounterRNG.hpp
+ * @author Takanori Saiki
+ * @brief カウンタベースの乱数生成器(Philox4x32-10)
+ * @note 参照 : J. K. Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC11.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+/**
+ * @brief 乱数の用途。同じ細胞・同じステップでも用途ごとに独立した乱数列になる。
+ * @note 値を変更すると過去の結果が再現できなくなるので、追加する場合は末尾に追加すること。
+ */
+enum class RandomPurpose : uint32_t
+{
+    INIT_POSITION,      // 初期配置
+    DIVISION_TIME,      // 分裂周期
+    DIE_TIME,           // 死滅周期
+    DIVISION_DIRECTION, // 分裂方向
+    USER,               // ユーザ定義の用途。USER + n のように使ってもよい
+};
+
+/**
+ * @class CounterRNG
+ * @brief (シード値, ストリームID, ステップ, 用途)をキーにしたカウンタベースの乱数生成器。
+ * @details 内部状態は「何回目の乱数か」を表すカウンタだけなので、同じキーからは常に同じ乱数列が得られる。
+ *          インスタンスを共有しなければロックなしでどのスレッドからでも呼び出せ、評価順にも依存しない。
+ */
+class CounterRNG
+{
+  public:
+    using Counter = std::array<uint32_t, 4>;
+    using Key     = std::array<uint32_t, 2>;
+
+    CounterRNG(uint64_t seed, uint64_t streamId, uint32_t step, RandomPurpose purpose) noexcept;
+
+    static Counter philox4x32(Counter counter, Key key) noexcept;
+
+    uint32_t nextUInt32() noexcept;
+    uint64_t nextUInt64() noexcept;
+    double uniform() noexcept;
+    double uniform(double min, double max) noexcept;
+    double exponential(double lambda) noexcept;
+    double angle() noexcept;
+
+  private:
+    static constexpr uint32_t PHILOX_M0    = 0xD2511F53; //!< Philoxの乗数
+    static constexpr uint32_t PHILOX_M1    = 0xCD9E8D57; //!< Philoxの乗数
+    static constexpr uint32_t PHILOX_W0    = 0x9E3779B9; //!< 鍵の更新に用いる定数(黄金比)
+    static constexpr uint32_t PHILOX_W1    = 0xBB67AE85; //!< 鍵の更新に用いる定数(sqrt(3) - 1)
+    static constexpr int32_t PHILOX_ROUNDS = 10;         //!< ラウンド数
+
+    Key key;          //!< シード値から作る鍵
+    Counter counter;  //!< counter[0]がブロック番号、残りがストリームID・ステップ・用途
+    Counter block;    //!< 直近に生成した4語分の乱数
+    int32_t blockPos; //!< blockのうち次に使う位置
+};
+
+/**
+ * @brief 乱数列のキーを指定して初期化する。
+ *
+ * @param seed 全体のシード値(SimulationSettings::CELL_SEEDなど)
+ * @param streamId 乱数列を区別するID(細胞IDなど)
+ * @param step シミュレーションのステップ数
+ * @param purpose 乱数の用途
+ */
+inline CounterRNG::CounterRNG(uint64_t seed, uint64_t streamId, uint32_t step, RandomPurpose purpose) noexcept
+  : key{ (uint32_t)seed, (uint32_t)(seed >> 32) }
+  , counter{ 0, (uint32_t)streamId, step, ((uint32_t)purpose << 16) ^ (uint32_t)(streamId >> 32) }
+  , block{}
+  , blockPos(4)
+{
+}
+
+/**
+ * @brief Philox4x32-10のブロック関数。counterとkeyが同じなら常に同じ値を返す。
+ *
+ * @param counter
+ * @param key
+ * @return Counter
+ */
+inline CounterRNG::Counter CounterRNG::philox4x32(Counter counter, Key key) noexcept
+{
+    for (int32_t round = 0; round < PHILOX_ROUNDS; round++) {
+        if (round > 0) {
+            key[0] += PHILOX_W0;
+            key[1] += PHILOX_W1;
+        }
+
+        const uint64_t product0 = (uint64_t)PHILOX_M0 * counter[0];
+        const uint64_t product1 = (uint64_t)PHILOX_M1 * counter[2];
+
+        counter = { (uint32_t)(product1 >> 32) ^ counter[1] ^ key[0], (uint32_t)product1, (uint32_t)(product0 >> 32) ^ counter[3] ^ key[1], (uint32_t)product0 };
+    }
+
+    return counter;
+}
+
+/**
+ * @brief 32bitの乱数を返す。4回に1回だけブロック関数を呼ぶ。
+ *
+ * @return uint32_t
+ */
+inline uint32_t CounterRNG::nextUInt32() noexcept
+{
+    if (blockPos == 4) {
+        block = philox4x32(counter, key);
+        counter[0]++;
+        blockPos = 0;
+    }
+
+    return block[blockPos++];
+}
+
+/**
+ * @brief 64bitの乱数を返す。
+ *
+ * @return uint64_t
+ */
+inline uint64_t CounterRNG::nextUInt64() noexcept
+{
+    const uint64_t hi = nextUInt32();
+    const uint64_t lo = nextUInt32();
+
+    return (hi << 32) | lo;
+}
+
+/**
+ * @brief [0, 1)の一様乱数を返す。精度は53bit。
+ *
+ * @return double
+ */
+inline double CounterRNG::uniform() noexcept
+{
+    return (double)(nextUInt64() >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief [min, max)の一様乱数を返す。
+ *
+ * @param min
+ * @param max
+ * @return double
+ */
+inline double CounterRNG::uniform(double min, double max) noexcept
+{
+    return min + (max - min) * uniform();
+}
+
+/**
+ * @brief 指数分布に従う乱数を返す。std::exponential_distributionと同じく平均は1/lambda。
+ *
+ * @param lambda
+ * @return double
+ */
+inline double CounterRNG::exponential(double lambda) noexcept
+{
+    return -std::log1p(-uniform()) / lambda;
+}
+
+/**
+ * @brief [0, 2π)の角度を返す。
+ *
+ * @return double
+ */
+inline double CounterRNG::angle() noexcept
+{
+    return 2.0 * std::numbers::pi * uniform();
+}
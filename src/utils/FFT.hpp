@@ -0,0 +1,154 @@
+/**
+ * @file FFT.hpp
+ * @author Takanori Saiki
+ * @brief 長さが2のべき乗の高速フーリエ変換(1次元と3次元)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace FFT {
+    using Complex = std::complex<double>;
+
+    /**
+     * @class Plan
+     * @brief 長さnの変換に使うビット反転の表と回転因子を前もって求めておく。
+     * @details transform()は表を読むだけなので、同じPlanを複数のスレッドから同時に使ってよい。
+     */
+    class Plan
+    {
+      private:
+        int32_t n;
+        std::vector<int32_t> reversed; //!< ビット反転した添字
+        std::vector<Complex> roots;    //!< roots[k] = e^(-2πik/n) (0 <= k < n/2)
+
+      public:
+        /**
+         * @param length 2のべき乗。そうでなければstd::invalid_argumentを投げる
+         */
+        explicit Plan(int32_t length)
+          : n(length)
+          , reversed(length)
+          , roots(length / 2)
+        {
+            if (length <= 0 || (length & (length - 1)) != 0) {
+                throw std::invalid_argument("FFT length must be a power of 2: " + std::to_string(length));
+            }
+
+            int32_t bits = 0;
+            while ((1 << bits) < n) {
+                bits++;
+            }
+            for (int32_t i = 0; i < n; i++) {
+                int32_t r = 0;
+                for (int32_t b = 0; b < bits; b++) {
+                    r |= ((i >> b) & 1) << (bits - 1 - b);
+                }
+                reversed[i] = r;
+            }
+            for (int32_t k = 0; k < n / 2; k++) {
+                roots[k] = std::polar(1.0, -2.0 * std::numbers::pi * k / n);
+            }
+        }
+
+        int32_t size() const noexcept
+        {
+            return n;
+        }
+
+        /**
+         * @brief a[0], a[stride], ..., a[(n-1)*stride]をその場で変換する(反復型のCooley-Tukey)。
+         *
+         * @param a
+         * @param stride 要素の間隔
+         * @param inverse trueなら逆変換(1/nを掛ける)
+         */
+        void transform(Complex* a, int64_t stride, bool inverse) const noexcept
+        {
+            for (int32_t i = 0; i < n; i++) {
+                if (i < reversed[i]) {
+                    std::swap(a[i * stride], a[reversed[i] * stride]);
+                }
+            }
+
+            for (int32_t len = 2; len <= n; len <<= 1) {
+                const int32_t half = len / 2;
+                const int32_t step = n / len;
+                for (int32_t i = 0; i < n; i += len) {
+                    for (int32_t k = 0; k < half; k++) {
+                        const Complex w = inverse ? std::conj(roots[k * step]) : roots[k * step];
+                        const Complex u = a[(i + k) * stride];
+                        const Complex v = a[(i + k + half) * stride] * w;
+
+                        a[(i + k) * stride]        = u + v;
+                        a[(i + k + half) * stride] = u - v;
+                    }
+                }
+            }
+
+            if (inverse) {
+                const double scale = 1.0 / n;
+                for (int32_t i = 0; i < n; i++) {
+                    a[i * stride] *= scale;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief x, y, zの順に並べた(添字 (x * ny + y) * nz + z)3次元の配列をその場で変換する。長さ1の軸は飛ばす。
+     * @details 軸ごとに、その軸に沿った列を並列に1次元変換する。列は連続していないので、作業領域に集めてから変換する。
+     *
+     * @param data nx * ny * nz個
+     * @param nx 2のべき乗
+     * @param ny 2のべき乗
+     * @param nz 2のべき乗
+     * @param inverse trueなら逆変換
+     */
+    inline void transform3D(std::vector<Complex>& data, int32_t nx, int32_t ny, int32_t nz, bool inverse)
+    {
+        const int64_t strides[3] = { (int64_t)ny * nz, nz, 1 };
+        const int32_t lens[3]    = { nx, ny, nz };
+
+        for (int32_t axis = 0; axis < 3; axis++) {
+            const int32_t len = lens[axis];
+            if (len == 1) {
+                continue;
+            }
+
+            const Plan plan(len);
+            const int64_t stride   = strides[axis];
+            const int64_t lineNum  = (int64_t)nx * ny * nz / len;
+            const int32_t innerLen = axis == 2 ? 1 : (axis == 1 ? nz : ny * nz); // 軸より内側の要素数
+
+#pragma omp parallel
+            {
+                std::vector<Complex> line(len);
+
+#pragma omp for schedule(static)
+                for (int64_t l = 0; l < lineNum; l++) {
+                    // l = (軸より外側の添字) * innerLen + (軸より内側の添字)
+                    const int64_t base = (l / innerLen) * innerLen * len + l % innerLen;
+                    for (int32_t i = 0; i < len; i++) {
+                        line[i] = data[base + i * stride];
+                    }
+                    plan.transform(line.data(), 1, inverse);
+                    for (int32_t i = 0; i < len; i++) {
+                        data[base + i * stride] = line[i];
+                    }
+                }
+            }
+        }
+    }
+} // namespace FFT
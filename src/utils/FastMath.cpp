@@ -0,0 +1,84 @@
+/**
+ * @file FastMath.cpp
+ * @author Takanori Saiki
+ * @brief 力の計算で使う指数関数とべき乗の近似
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "FastMath.hpp"
+#include <algorithm>
+
+/**
+ * @brief TABLEなら[0, _range]の3次式の係数を作る。
+ *
+ * @param _method 計算方法
+ * @param _range TABLEで表にする範囲。これ以上のxはPOLYNOMIALで計算する
+ */
+FastExp::FastExp(ExpMethod _method, double _range)
+  : method(_method)
+  , range(std::max(_range, 0.0))
+{
+    if (method != ExpMethod::TABLE) {
+        return;
+    }
+
+    // 区間[x0, x0 + h]をt = (x - x0) / hで表し、両端の値f0, f1と微分-f0 h, -f1 hが一致する3次式にする
+    const int32_t steps = (int32_t)std::ceil(range * TABLE_STEPS);
+    const double h      = 1.0 / TABLE_STEPS;
+    coefficients.resize(4 * (size_t)steps);
+    for (int32_t i = 0; i < steps; i++) {
+        const double f0 = std::exp(-i * h);
+        const double f1 = std::exp(-(i + 1) * h);
+        const double d0 = -f0 * h;
+        const double d1 = -f1 * h;
+
+        coefficients[4 * i + 0] = f0;
+        coefficients[4 * i + 1] = d0;
+        coefficients[4 * i + 2] = 3.0 * (f1 - f0) - 2.0 * d0 - d1;
+        coefficients[4 * i + 3] = 2.0 * (f0 - f1) + d0 + d1;
+    }
+    range = steps * h;
+}
+
+ExpMethod FastExp::getMethod() const noexcept
+{
+    return method;
+}
+
+/**
+ * @brief TABLEで表にした範囲。TABLE以外では0
+ *
+ * @return double
+ */
+double FastExp::getRange() const noexcept
+{
+    return method == ExpMethod::TABLE ? range : 0.0;
+}
+
+/**
+ * @brief [0, max(range, 1)]をsamples等分した区間の中の点と、その外の点でstd::expと比べ、最大の相対誤差を返す。
+ *
+ * @param samples
+ * @return double
+ */
+double FastExp::maxRelativeError(int32_t samples) const
+{
+    const double upper = std::max(range, 1.0);
+    double maxError    = 0.0;
+    for (int32_t i = 0; i < samples; i++) {
+        // TABLEの区間の端(誤差0)ばかりにならないよう、少しずらして取る
+        const double x     = upper * (i + 0.37) / samples;
+        const double exact = std::exp(-x);
+        maxError           = std::max(maxError, std::abs((*this)(x)-exact) / exact);
+    }
+    for (double x = upper; x < upper + 50.0; x += 0.37) {
+        const double exact = std::exp(-x);
+        maxError           = std::max(maxError, std::abs((*this)(x)-exact) / exact);
+    }
+
+    return maxError;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file FastMath.hpp
+ * @author Takanori Saiki
+ * @brief 力の計算で使う指数関数とべき乗の近似
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+enum class ExpMethod
+{
+    LIBM,       // std::exp
+    TABLE,      // [0, 範囲]を細かく区切った3次のHermite補間。範囲の外はPOLYNOMIAL
+    POLYNOMIAL, // 2^kに分けた残りを多項式で計算する
+};
+
+/**
+ * @brief x^Nを掛け算だけで計算する。Nはコンパイル時に展開される。
+ *
+ * @tparam N 0以上の指数
+ * @param x
+ * @return double
+ */
+template <int32_t N>
+constexpr double ipow(double x) noexcept
+{
+    static_assert(N >= 0, "ipow needs a non-negative exponent");
+    if constexpr (N == 0) {
+        return 1.0;
+    } else if constexpr (N % 2 == 0) {
+        const double half = ipow<N / 2>(x);
+        return half * half;
+    } else {
+        return x * ipow<N - 1>(x);
+    }
+}
+
+/**
+ * @class FastExp
+ * @brief e^(-x) (x >= 0)を、選んだ方法で計算する。遠隔力の減衰e^(-d/λ)に使う。
+ * @details TABLEは[0, range]を1あたりTABLE_STEPS個に区切り、区間ごとに3次式の係数を持つ。
+ *          e^(-x)の値と微分(= -e^(-x))が区間の両端で一致するので、相対誤差はおよそ1e-10になる。
+ *          rangeにはsearch_radius / λを渡す。CUTOFFの近傍の細胞はこの範囲に収まる。
+ *          POLYNOMIALはx = k ln2 + r (|r| <= ln2 / 2)に分け、e^(-r)を11次の多項式で、2^kを指数部で作る。相対誤差は1e-14程度。
+ *          実際の誤差はmaxRelativeError()でstd::expと比べて測る。
+ *          計算は読み出しだけなので、複数のスレッドから同時に呼べる。
+ */
+class FastExp
+{
+  public:
+    static constexpr int32_t TABLE_STEPS = 64; //!< TABLEで1あたりに区切る区間の数
+
+  private:
+    ExpMethod method;
+    double range;
+    std::vector<double> coefficients; //!< TABLEの区間iの3次式の係数 [4i, 4i + 4)
+
+    static double polynomial(double x) noexcept;
+
+  public:
+    explicit FastExp(ExpMethod _method = ExpMethod::LIBM, double _range = 0.0);
+
+    double operator()(double x) const noexcept;
+
+    ExpMethod getMethod() const noexcept;
+    double getRange() const noexcept;
+    double maxRelativeError(int32_t samples = 100000) const;
+};
+
+/**
+ * @brief e^(-x)を返す。xは0以上とする。
+ *
+ * @param x
+ * @return double
+ */
+inline double FastExp::operator()(double x) const noexcept
+{
+    switch (method) {
+        case ExpMethod::TABLE:
+            if (x < range) {
+                const double scaled = x * TABLE_STEPS;
+                const int32_t i     = (int32_t)scaled;
+                const double t      = scaled - i;
+                const double* c     = &coefficients[4 * i];
+                return ((c[3] * t + c[2]) * t + c[1]) * t + c[0];
+            }
+            return polynomial(x);
+        case ExpMethod::POLYNOMIAL:
+            return polynomial(x);
+        default:
+            return std::exp(-x);
+    }
+}
+
+/**
+ * @brief e^(-x) = 2^(-k) e^(-r)として多項式で計算する。
+ *
+ * @param x
+ * @return double
+ */
+inline double FastExp::polynomial(double x) noexcept
+{
+    constexpr double LOG2E  = 1.4426950408889634;
+    constexpr double LN2_HI = 6.93147180369123816490e-01; // ln2の上位。k * LN2_HIは丸め誤差なしで計算できる
+    constexpr double LN2_LO = 1.90821492927058770002e-10;
+
+    if (x > 708.0) {
+        return 0.0; // 2^kが正規化数で表せない
+    }
+
+    const double k = std::nearbyint(x * LOG2E);
+    const double r = (k * LN2_HI - x) + k * LN2_LO; // -x - (-k) ln2
+
+    // e^r = Σ r^n / n! (n <= 11)。|r| <= ln2 / 2なので打ち切り誤差は1e-14以下
+    double p = 1.0 / 39916800.0;
+    p        = p * r + 1.0 / 3628800.0;
+    p        = p * r + 1.0 / 362880.0;
+    p        = p * r + 1.0 / 40320.0;
+    p        = p * r + 1.0 / 5040.0;
+    p        = p * r + 1.0 / 720.0;
+    p        = p * r + 1.0 / 120.0;
+    p        = p * r + 1.0 / 24.0;
+    p        = p * r + 1.0 / 6.0;
+    p        = p * r + 0.5;
+    p        = p * r + 1.0;
+    p        = p * r + 1.0;
+
+    // 2^(-k)を指数部に直接書く
+    const uint64_t bits = (uint64_t)(1023 - (int64_t)k) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return p * scale;
+}
@@ -0,0 +1,423 @@
+/**
+ * @file FieldCodec.cpp
+ * @author Takanori Saiki
+ * @brief 分子の格子のような実数の配列を圧縮する。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "FieldCodec.hpp"
+#include "BinaryIO.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+namespace {
+    // LZ4のブロック形式の制約。最後の5バイトは必ずリテラルで、一致は末尾12バイトより前から始める。
+    constexpr size_t MIN_MATCH     = 4;
+    constexpr size_t LAST_LITERALS = 5;
+    constexpr size_t MF_LIMIT      = 12;
+    constexpr size_t MAX_OFFSET    = 65535;
+    constexpr int32_t HASH_LOG     = 14;
+
+    constexpr double MAX_QUANTUM = 4503599627370496.0; //!< 2^52。これを超える量子化の値は差分がint64に収まらない可能性がある
+
+    uint32_t read32(const uint8_t* p) noexcept
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash32(uint32_t v) noexcept
+    {
+        return (v * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    /**
+     * @brief 長さの15以上の部分を255の連続で書き込む。
+     */
+    void writeLength(std::vector<uint8_t>& out, size_t len)
+    {
+        while (len >= 255) {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(len));
+    }
+
+    /**
+     * @brief リテラル列と一致(offset, matchLen)を1つのシーケンスとして書き込む。matchLenが0の場合は最後のシーケンス。
+     */
+    void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLen, size_t offset, size_t matchLen)
+    {
+        const size_t matchCode = matchLen == 0 ? 0 : matchLen - MIN_MATCH;
+        const uint8_t token    = static_cast<uint8_t>((std::min<size_t>(literalLen, 15) << 4) | std::min<size_t>(matchCode, 15));
+
+        out.push_back(token);
+        if (literalLen >= 15) {
+            writeLength(out, literalLen - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLen);
+
+        if (matchLen == 0) {
+            return;
+        }
+        out.push_back(static_cast<uint8_t>(offset & 0xff));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (matchCode >= 15) {
+            writeLength(out, matchCode - 15);
+        }
+    }
+
+    /**
+     * @brief lz4Decompressで使う。長さの続きを読む。
+     */
+    size_t readLength(const uint8_t*& ip, const uint8_t* end)
+    {
+        size_t len = 0;
+        uint8_t b;
+        do {
+            if (ip >= end) {
+                throw std::runtime_error("FieldCodec::lz4Decompress() : truncated length.");
+            }
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+
+        return len;
+    }
+
+    uint64_t zigzag(int64_t v) noexcept
+    {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    int64_t unzigzag(uint64_t v) noexcept
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    /**
+     * @brief バイト列をシャッフルしてからLZ4形式で圧縮する。
+     */
+    std::vector<uint8_t> shuffleAndCompress(const uint8_t* data, size_t count, size_t elemSize)
+    {
+        std::vector<uint8_t> shuffled(count * elemSize);
+        FieldCodec::shuffle(data, shuffled.data(), count, elemSize);
+
+        return FieldCodec::lz4Compress(shuffled.data(), shuffled.size());
+    }
+
+    /**
+     * @brief 値を2 * errorBound刻みに量子化し、隣との差分をジグザグ符号化する。
+     *
+     * @return true 全ての値が誤差の上限に収まった
+     * @return false 収まらない値があった(呼び出し側はLOSSLESSにする)
+     */
+    bool quantize(const double* values, size_t count, double errorBound, std::vector<uint64_t>& out)
+    {
+        const double quantum = 2.0 * errorBound;
+        int64_t prev         = 0;
+
+        out.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            const double scaled = values[i] / quantum;
+            if (!std::isfinite(scaled) || std::abs(scaled) >= MAX_QUANTUM) {
+                return false;
+            }
+
+            const int64_t q = std::llround(scaled);
+            if (!(std::abs((double)q * quantum - values[i]) <= errorBound)) {
+                return false;
+            }
+            out[i] = zigzag(q - prev);
+            prev   = q;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief 1ブロックを圧縮する。
+     */
+    std::vector<uint8_t> encodeBlock(const double* values, size_t count, CompressionMode mode, double errorBound, CompressionMode& usedMode)
+    {
+        if (mode == CompressionMode::LOSSY) {
+            std::vector<uint64_t> deltas;
+            if (quantize(values, count, errorBound, deltas)) {
+                usedMode = CompressionMode::LOSSY;
+                return shuffleAndCompress(reinterpret_cast<const uint8_t*>(deltas.data()), count, sizeof(uint64_t));
+            }
+        }
+
+        usedMode = CompressionMode::LOSSLESS;
+        return shuffleAndCompress(reinterpret_cast<const uint8_t*>(values), count, sizeof(double));
+    }
+
+    /**
+     * @brief 1ブロックを展開してvaluesに書き込む。
+     */
+    void decodeBlock(const uint8_t* src, size_t srcSize, CompressionMode mode, double errorBound, double* values, size_t count)
+    {
+        std::vector<uint8_t> shuffled(count * sizeof(uint64_t));
+        FieldCodec::lz4Decompress(src, srcSize, shuffled.data(), shuffled.size());
+
+        if (mode == CompressionMode::LOSSLESS) {
+            FieldCodec::unshuffle(shuffled.data(), reinterpret_cast<uint8_t*>(values), count, sizeof(double));
+            return;
+        }
+        if (mode != CompressionMode::LOSSY) {
+            throw std::runtime_error("FieldCodec::decode() : unknown block mode.");
+        }
+
+        std::vector<uint64_t> deltas(count);
+        FieldCodec::unshuffle(shuffled.data(), reinterpret_cast<uint8_t*>(deltas.data()), count, sizeof(uint64_t));
+
+        const double quantum = 2.0 * errorBound;
+        int64_t q            = 0;
+        for (size_t i = 0; i < count; i++) {
+            q += unzigzag(deltas[i]);
+            values[i] = (double)q * quantum;
+        }
+    }
+} // namespace
+
+/**
+ * @brief LZ4のブロック形式で圧縮する。ハッシュ表で直前の一致を探すだけの単純な(貪欲な)実装。
+ *
+ * @param src
+ * @param size srcのバイト数
+ * @return std::vector<uint8_t> 圧縮したバイト列
+ */
+std::vector<uint8_t> FieldCodec::lz4Compress(const uint8_t* src, size_t size)
+{
+    std::vector<uint8_t> out;
+    out.reserve(size / 2 + 16);
+
+    size_t anchor = 0;
+    if (size >= MF_LIMIT + 1) {
+        std::vector<int64_t> table(1 << HASH_LOG, -1);
+        const size_t matchLimit = size - LAST_LITERALS;
+        size_t ip               = 0;
+
+        while (ip + MF_LIMIT < size) {
+            const uint32_t seq = read32(src + ip);
+            const uint32_t h   = hash32(seq);
+            const int64_t ref  = table[h];
+            table[h]           = ip;
+
+            if (ref < 0 || ip - (size_t)ref > MAX_OFFSET || read32(src + ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            size_t len = MIN_MATCH;
+            while (ip + len < matchLimit && src[ref + len] == src[ip + len]) {
+                len++;
+            }
+
+            writeSequence(out, src + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+        }
+    }
+
+    writeSequence(out, src + anchor, size - anchor, 0, 0);
+
+    return out;
+}
+
+/**
+ * @brief LZ4のブロック形式を展開する。壊れたデータの場合は例外を投げる。
+ *
+ * @param src
+ * @param srcSize srcのバイト数
+ * @param dst 展開先
+ * @param dstSize 展開後のバイト数(ちょうどこの大きさにならなければ例外を投げる)
+ */
+void FieldCodec::lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    const uint8_t* ip        = src;
+    const uint8_t* const end = src + srcSize;
+    size_t op                = 0;
+
+    while (ip < end) {
+        const uint8_t token = *ip++;
+
+        size_t literalLen = token >> 4;
+        if (literalLen == 15) {
+            literalLen += readLength(ip, end);
+        }
+        if (literalLen > (size_t)(end - ip) || literalLen > dstSize - op) {
+            throw std::runtime_error("FieldCodec::lz4Decompress() : literal overflow.");
+        }
+        std::memcpy(dst + op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            throw std::runtime_error("FieldCodec::lz4Decompress() : truncated offset.");
+        }
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t matchLen = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15) {
+            matchLen += readLength(ip, end);
+        }
+        if (offset == 0 || offset > op || matchLen > dstSize - op) {
+            throw std::runtime_error("FieldCodec::lz4Decompress() : invalid match.");
+        }
+
+        // 一致部分は自分自身と重なることがあるので1バイトずつコピーする
+        for (size_t i = 0; i < matchLen; i++, op++) {
+            dst[op] = dst[op - offset];
+        }
+    }
+
+    if (op != dstSize) {
+        throw std::runtime_error("FieldCodec::lz4Decompress() : size mismatch.");
+    }
+}
+
+/**
+ * @brief 各要素のkバイト目を集めて並べ直す。滑らかな場では上位バイトがそろうので圧縮しやすくなる。
+ *
+ * @param src count * elemSizeバイト
+ * @param dst count * elemSizeバイト
+ * @param count 要素数
+ * @param elemSize 1要素のバイト数
+ */
+void FieldCodec::shuffle(const uint8_t* src, uint8_t* dst, size_t count, size_t elemSize) noexcept
+{
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < elemSize; b++) {
+            dst[b * count + i] = src[i * elemSize + b];
+        }
+    }
+}
+
+/**
+ * @brief shuffleの逆変換。
+ *
+ * @param src count * elemSizeバイト
+ * @param dst count * elemSizeバイト
+ * @param count 要素数
+ * @param elemSize 1要素のバイト数
+ */
+void FieldCodec::unshuffle(const uint8_t* src, uint8_t* dst, size_t count, size_t elemSize) noexcept
+{
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < elemSize; b++) {
+            dst[i * elemSize + b] = src[b * count + i];
+        }
+    }
+}
+
+/**
+ * @brief 配列を圧縮して書き込む。形式はFieldCodec.hppを参照。
+ *
+ * @param os バイナリモードで開いたストリーム
+ * @param values
+ * @param mode LOSSLESSかLOSSY
+ * @param errorBound LOSSYのときの誤差の上限(正の値)
+ */
+void FieldCodec::encode(std::ostream& os, const std::vector<double>& values, CompressionMode mode, double errorBound)
+{
+    if (mode == CompressionMode::NONE) {
+        throw std::invalid_argument("FieldCodec::encode() : mode must be LOSSLESS or LOSSY.");
+    }
+    if (mode == CompressionMode::LOSSY && !(errorBound > 0.0)) {
+        throw std::invalid_argument("FieldCodec::encode() : errorBound must be positive.");
+    }
+
+    const size_t blockCount = (values.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<std::vector<uint8_t>> blocks(blockCount);
+    std::vector<CompressionMode> blockModes(blockCount);
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blockCount; b++) {
+        const size_t begin = b * BLOCK_SIZE;
+        const size_t count = std::min<size_t>(BLOCK_SIZE, values.size() - begin);
+        blocks[b]          = encodeBlock(values.data() + begin, count, mode, errorBound, blockModes[b]);
+    }
+
+    const uint8_t reserved[3] = {};
+    BinaryIO::writeValue(os, mode);
+    BinaryIO::writeArray(os, reserved, 3);
+    BinaryIO::writeValue(os, BLOCK_SIZE);
+    BinaryIO::writeValue(os, errorBound);
+    BinaryIO::writeValue<uint64_t>(os, values.size());
+    BinaryIO::writeValue<uint32_t>(os, blockCount);
+    for (size_t b = 0; b < blockCount; b++) {
+        BinaryIO::writeValue(os, blockModes[b]);
+        BinaryIO::writeArray(os, reserved, 3);
+        BinaryIO::writeValue<uint32_t>(os, blocks[b].size());
+    }
+    for (const auto& block : blocks) {
+        BinaryIO::writeArray(os, block.data(), block.size());
+    }
+}
+
+/**
+ * @brief encodeで書き込んだ配列を読み込んで展開する。
+ *
+ * @param is
+ * @return std::vector<double>
+ */
+std::vector<double> FieldCodec::decode(std::istream& is)
+{
+    BinaryIO::readValue<CompressionMode>(is);
+    uint8_t reserved[3];
+    BinaryIO::readArray(is, reserved, 3);
+    const uint32_t blockSize  = BinaryIO::readValue<uint32_t>(is);
+    const double errorBound   = BinaryIO::readValue<double>(is);
+    const uint64_t count      = BinaryIO::readValue<uint64_t>(is);
+    const uint32_t blockCount = BinaryIO::readValue<uint32_t>(is);
+
+    if (blockSize == 0 || blockCount != (count + blockSize - 1) / blockSize) {
+        throw std::runtime_error("FieldCodec::decode() : inconsistent block table.");
+    }
+
+    std::vector<CompressionMode> blockModes(blockCount);
+    std::vector<size_t> blockOffsets(blockCount + 1, 0);
+    for (uint32_t b = 0; b < blockCount; b++) {
+        blockModes[b] = BinaryIO::readValue<CompressionMode>(is);
+        BinaryIO::readArray(is, reserved, 3);
+        blockOffsets[b + 1] = blockOffsets[b] + BinaryIO::readValue<uint32_t>(is);
+    }
+
+    std::vector<uint8_t> data(blockOffsets.back());
+    BinaryIO::readArray(is, data.data(), data.size());
+
+    // 並列区間の外に例外を投げられないので、最初の例外を覚えておいて後で投げ直す
+    std::vector<double> values(count);
+    std::exception_ptr error = nullptr;
+#pragma omp parallel for schedule(dynamic)
+    for (uint32_t b = 0; b < blockCount; b++) {
+        const size_t begin = (size_t)b * blockSize;
+        const size_t n     = std::min<size_t>(blockSize, count - begin);
+        try {
+            decodeBlock(data.data() + blockOffsets[b], blockOffsets[b + 1] - blockOffsets[b], blockModes[b], errorBound, values.data() + begin, n);
+        } catch (...) {
+#pragma omp critical
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return values;
+}
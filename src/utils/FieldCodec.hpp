@@ -0,0 +1,56 @@
+/**
+ * @file FieldCodec.hpp
+ * @author Takanori Saiki
+ * @brief 分子の格子のような実数の配列を圧縮する。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief 圧縮の方法
+ */
+enum class CompressionMode : uint8_t
+{
+    NONE,     // 圧縮しない
+    LOSSLESS, // バイトシャッフル + LZ4形式。値は完全に元に戻る
+    LOSSY,    // 誤差の上限を指定して量子化し、差分をLZ4形式で圧縮する
+};
+
+/**
+ * @brief 実数の配列の圧縮と展開を行う関数群。
+ * @details 配列はBLOCK_SIZE個ずつのブロックに分けて、ブロックごとに並列に圧縮する。形式は次の通り。
+ * @code
+ * uint8    mode            CompressionMode(LOSSLESSかLOSSY)
+ * uint8    reserved[3]
+ * uint32   blockSize       1ブロックの値の数
+ * float64  errorBound      LOSSYのときの誤差の上限
+ * uint64   valueCount
+ * uint32   blockCount
+ * block * blockCount       (uint8 mode, uint8 reserved[3], uint32 compressedSize)
+ * data                     各ブロックの圧縮したバイト列を順に並べる
+ * @endcode
+ * LOSSYでも、量子化で誤差の上限を守れない値(NaN、極端に大きい値)を含むブロックはLOSSLESSで圧縮する。
+ * 圧縮したバイト列はLZ4のブロック形式と互換なので、外部のLZ4の実装でも展開できる。
+ */
+namespace FieldCodec {
+    constexpr uint32_t BLOCK_SIZE = 1 << 16; //!< 1ブロックの値の数
+
+    std::vector<uint8_t> lz4Compress(const uint8_t* src, size_t size);
+    void lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+    void shuffle(const uint8_t* src, uint8_t* dst, size_t count, size_t elemSize) noexcept;
+    void unshuffle(const uint8_t* src, uint8_t* dst, size_t count, size_t elemSize) noexcept;
+
+    void encode(std::ostream& os, const std::vector<double>& values, CompressionMode mode, double errorBound);
+    std::vector<double> decode(std::istream& is);
+} // namespace FieldCodec
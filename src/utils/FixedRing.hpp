@@ -0,0 +1,84 @@
+/**
+ * @file FixedRing.hpp
+ * @author Takanori Saiki
+ * @brief 要素数の上限が決まっているキューのための、オブジェクト内に領域を持つリングバッファ。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+/**
+ * @class FixedRing
+ * @brief std::queueの下位コンテナとして使える、容量Nの固定長リングバッファ。
+ * @details std::dequeは空でも数百バイトを確保するので、細胞ごとに持つ小さなキューには向かない。
+ *          これはヒープを使わないので、細胞を大量に作る場合も割り当てが増えない。N個を超えて入れてはいけない。
+ *
+ * @tparam T 要素の型。デフォルトコンストラクタが必要
+ * @tparam N 容量
+ */
+template<typename T, size_t N>
+class FixedRing
+{
+  private:
+    std::array<T, N> buf;
+    size_t head  = 0; //!< 先頭の要素の位置
+    size_t count = 0;
+
+  public:
+    using value_type      = T;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = size_t;
+
+    bool empty() const noexcept
+    {
+        return count == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return count;
+    }
+
+    T& front() noexcept
+    {
+        return buf[head];
+    }
+
+    const T& front() const noexcept
+    {
+        return buf[head];
+    }
+
+    T& back() noexcept
+    {
+        return buf[(head + count - 1) % N];
+    }
+
+    const T& back() const noexcept
+    {
+        return buf[(head + count - 1) % N];
+    }
+
+    void push_back(const T& value) noexcept
+    {
+        assert(count < N);
+        buf[(head + count) % N] = value;
+        count++;
+    }
+
+    void pop_front() noexcept
+    {
+        assert(count > 0);
+        head = (head + 1) % N;
+        count--;
+    }
+};
@@ -0,0 +1,78 @@
+/**
+ * @file MappedFile.cpp
+ * @author Takanori Saiki
+ * @brief ファイルを読み込み専用でメモリにマップする。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MappedFile.hpp"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief pathを開いてマップする。開けない場合は例外を投げる。
+ *
+ * @param path
+ */
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile::MappedFile() : cannot open " + path + ".");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("MappedFile::MappedFile() : cannot stat " + path + ".");
+    }
+    length = st.st_size;
+
+    if (length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("MappedFile::MappedFile() : cannot map " + path + ".");
+        }
+        // すぐに全体を読むので、先に読み込みを始めてもらう
+        madvise(p, length, MADV_WILLNEED);
+        mapped = static_cast<const char*>(p);
+    }
+
+    // マップした後はファイル記述子がなくてもよい
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mapped != nullptr) {
+        munmap(const_cast<char*>(mapped), length);
+    }
+}
+
+const char* MappedFile::data() const noexcept
+{
+    return mapped;
+}
+
+size_t MappedFile::size() const noexcept
+{
+    return length;
+}
+
+const char* MappedFile::begin() const noexcept
+{
+    return mapped;
+}
+
+const char* MappedFile::end() const noexcept
+{
+    return mapped + length;
+}
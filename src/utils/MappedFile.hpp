@@ -0,0 +1,39 @@
+/**
+ * @file MappedFile.hpp
+ * @author Takanori Saiki
+ * @brief ファイルを読み込み専用でメモリにマップする。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief ファイル全体を読み込み専用でmmapし、破棄するときに解放する。
+ * @details 大きな入力ファイルをコピーせずに複数のスレッドから読むために使う。空のファイルはマップせず、size()が0になる。
+ */
+class MappedFile
+{
+  private:
+    const char* mapped = nullptr;
+    size_t length      = 0;
+
+  public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const noexcept;
+    size_t size() const noexcept;
+    const char* begin() const noexcept;
+    const char* end() const noexcept;
+};
@@ -0,0 +1,162 @@
+/**
+ * @file PerfCounters.cpp
+ * @author Takanori Saiki
+ * @brief Linuxのperf_event_openでハードウェアカウンタを読む。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "PerfCounters.hpp"
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+namespace {
+    /**
+     * @brief カウンタの種類をperf_event_attrのtypeとconfigに設定する。
+     */
+    void describe(PerfCounters::Counter counter, perf_event_attr& attr) noexcept
+    {
+        switch (counter) {
+        case PerfCounters::CYCLES:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfCounters::INSTRUCTIONS:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfCounters::LLC_MISSES:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfCounters::BRANCH_MISSES:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            attr.type   = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_TASK_CLOCK;
+            break;
+        }
+    }
+} // namespace
+#endif
+
+/**
+ * @brief 呼び出したスレッドのカウンタを開き、数え始める。開けなかったカウンタは飛ばす。
+ * @details ハードウェアのカウンタを先に開く(ソフトウェアのカウンタをリーダーにすると、ハードウェアのカウンタを足せない場合がある)。
+ *          カーネルの処理を除いて数えるので、perf_event_paranoidが2でも開ける。
+ */
+PerfCounters::PerfCounters()
+{
+    fds.fill(-1);
+    order.fill(-1);
+
+#ifdef __linux__
+    for (int32_t i = 0; i < COUNTER_NUM; i++) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        describe(static_cast<Counter>(i), attr);
+        attr.disabled       = leader == -1 ? 1 : 0; // リーダーを有効にするとグループ全体が数え始める
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0) {
+            if (error.empty()) {
+                error = std::string(NAMES[i]) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+
+        if (leader == -1) {
+            leader = fd;
+        }
+        fds[i]   = fd;
+        order[i] = openedNum++;
+    }
+
+    if (leader != -1) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    error = "perf_event_open is only available on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    // メンバーを先に閉じる
+    for (int32_t i = COUNTER_NUM - 1; i >= 0; i--) {
+        if (fds[i] != -1) {
+            close(fds[i]);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::isAvailable(Counter counter) const noexcept
+{
+    return fds[counter] != -1;
+}
+
+bool PerfCounters::isAnyAvailable() const noexcept
+{
+    return leader != -1;
+}
+
+/**
+ * @brief 最初に開けなかったカウンタの名前と理由を返す。すべて開けた場合は空文字列
+ */
+const std::string& PerfCounters::errorMessage() const noexcept
+{
+    return error;
+}
+
+/**
+ * @brief 生成してからの各カウンタの値を返す。
+ * @details カウンタの数がCPUのレジスタより多いと時分割で数えるので、数えていた時間の割合で補正する。
+ *
+ * @return Values 開けなかったカウンタは0
+ */
+PerfCounters::Values PerfCounters::read() const noexcept
+{
+    Values values{};
+    if (leader == -1) {
+        return values;
+    }
+
+#ifdef __linux__
+    // nr, time_enabled, time_running, value[nr]
+    uint64_t buf[3 + COUNTER_NUM];
+    if (::read(leader, buf, sizeof(buf)) < (ssize_t)(sizeof(uint64_t) * (3 + openedNum))) {
+        return values;
+    }
+
+    const uint64_t enabled = buf[1];
+    const uint64_t running = buf[2];
+    for (int32_t i = 0; i < COUNTER_NUM; i++) {
+        if (order[i] == -1) {
+            continue;
+        }
+        const uint64_t raw = buf[3 + order[i]];
+        values[i]          = (running == 0 || running == enabled) ? raw : (uint64_t)((double)raw * enabled / running);
+    }
+#endif
+
+    return values;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file PerfCounters.hpp
+ * @author Takanori Saiki
+ * @brief Linuxのperf_event_openでハードウェアカウンタを読む。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class PerfCounters
+ * @brief 呼び出したスレッドのサイクル数、命令数、LLCミス、分岐予測ミス、CPU時間を数える。
+ * @details 生成したスレッドだけを数える(子スレッドは含まない)ので、スレッドごとに生成すること。
+ *          カウンタは1つのグループとして開き、read()は1回のシステムコールで全部を読む。
+ *          仮想マシンやperf_event_paranoidの設定によっては開けないカウンタがあり、その値は常に0になる。
+ *          開けたかどうかはisAvailable()で確認する。Linux以外ではどのカウンタも開けない。
+ */
+class PerfCounters
+{
+  public:
+    enum Counter : int32_t
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        LLC_MISSES,    // 最終レベルキャッシュのミス
+        BRANCH_MISSES, // 分岐予測のミス
+        TASK_CLOCK,    // スレッドがCPU上で動いた時間[ns](ソフトウェアのカウンタなので、たいてい開ける)
+        COUNTER_NUM,
+    };
+
+    using Values = std::array<uint64_t, COUNTER_NUM>;
+
+    static constexpr std::array<const char*, COUNTER_NUM> NAMES = { "cycles", "instructions", "llcMisses", "branchMisses", "taskClock" };
+
+  private:
+    int leader = -1;                        //!< グループのリーダーのファイル記述子
+    std::array<int, COUNTER_NUM> fds;       //!< 開けなかったカウンタは-1
+    std::array<int32_t, COUNTER_NUM> order; //!< グループを読んだときの並び順での位置
+    int32_t openedNum = 0;
+    std::string error; //!< 最初に開けなかったカウンタの理由
+
+  public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&)            = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool isAvailable(Counter counter) const noexcept;
+    bool isAnyAvailable() const noexcept;
+    const std::string& errorMessage() const noexcept;
+
+    Values read() const noexcept;
+};
@@ -0,0 +1,35 @@
+/**
+ * @file Precision.hpp
+ * @author Takanori Saiki
+ * @brief 細胞の位置・速度と分子の格子を保存する実数の型
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "Vec3.hpp"
+
+/**
+ * @brief 状態を保存する実数の型。MCMC_FLOAT_STORAGEを定義してビルドするとfloatになる(make PRECISION=float)。
+ * @details 保存するときだけこの型に丸め、計算(力の和、拡散の差分など)はdoubleで行う。
+ *          floatにすると細胞1つと格子1つあたりのバイト数が半分になり、メモリ帯域で律速する場合に速くなる。
+ */
+#ifdef MCMC_FLOAT_STORAGE
+using StorageReal = float;
+#else
+using StorageReal = double;
+#endif
+
+/**
+ * @brief StorageRealの名前。開始時の表示に使う。
+ */
+inline constexpr const char* STORAGE_PRECISION_NAME = sizeof(StorageReal) == sizeof(float) ? "float" : "double";
+
+/**
+ * @brief 細胞の位置と速度を保存する型。Vec3(double)への変換は暗黙、Vec3からの変換はfloatのときexplicit
+ */
+using StoredVec3 = Vec<StorageReal, 3>;
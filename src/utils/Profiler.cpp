@@ -0,0 +1,439 @@
+/**
+ * @file Profiler.cpp
+ * @author Takanori Saiki
+ * @brief シミュレーションの各処理にかかった時間を計測する。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Profiler.hpp"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+
+namespace {
+    /**
+     * @brief パスの最後の名前を返す。
+     */
+    std::string_view leafName(std::string_view path) noexcept
+    {
+        const size_t pos = path.rfind('/');
+        return pos == std::string_view::npos ? path : path.substr(pos + 1);
+    }
+
+    /**
+     * @brief 親のパスを返す。親がなければ空文字列
+     */
+    std::string_view parentPath(std::string_view path) noexcept
+    {
+        const size_t pos = path.rfind('/');
+        return pos == std::string_view::npos ? std::string_view() : path.substr(0, pos);
+    }
+
+    /**
+     * @brief JSONの文字列として書き込む。
+     */
+    void writeJsonString(std::ostream& os, std::string_view str)
+    {
+        os << '"';
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << '"';
+    }
+} // namespace
+
+bool Profiler::enabled                                         = false;
+bool Profiler::tracing                                         = false;
+bool Profiler::counting                                        = false;
+std::array<bool, PerfCounters::COUNTER_NUM> Profiler::available = {};
+std::string Profiler::counterError;
+Profiler::Clock::time_point Profiler::epoch                    = Profiler::Clock::now();
+std::mutex Profiler::mtx;
+std::vector<std::unique_ptr<Profiler::ThreadState>> Profiler::threads;
+
+/**
+ * @brief 呼び出したスレッドの計測結果を返す。初めて呼んだスレッドは登録する。
+ *
+ * @return ThreadState&
+ */
+Profiler::ThreadState& Profiler::local()
+{
+    thread_local ThreadState* state = nullptr;
+
+    if (state == nullptr) {
+        std::lock_guard<std::mutex> lock(mtx);
+        threads.push_back(std::make_unique<ThreadState>());
+        state      = threads.back().get();
+        state->tid = threads.size() - 1;
+    }
+
+    return *state;
+}
+
+/**
+ * @brief 計測を始める。呼び出したスレッドがtid 0になる。
+ * @details countersがtrueでも、カウンタが1つも開けなければ時間だけを計測する。
+ *          どのカウンタを開けたかはisCounterAvailable()で確認できる(呼び出したスレッドで開いた結果)。
+ *
+ * @param trace trueならトレースのイベントも記録する
+ * @param counters trueならハードウェアカウンタも集計する
+ */
+void Profiler::enable(bool trace, bool counters)
+{
+    epoch   = Clock::now();
+    tracing = trace;
+    enabled = true;
+
+    ThreadState& state = local();
+    available.fill(false);
+    counterError.clear();
+    counting = false;
+    if (counters) {
+        state.counters = std::make_unique<PerfCounters>();
+        for (int32_t i = 0; i < PerfCounters::COUNTER_NUM; i++) {
+            available[i] = state.counters->isAvailable(static_cast<PerfCounters::Counter>(i));
+        }
+        counterError = state.counters->errorMessage();
+        counting     = state.counters->isAnyAvailable();
+    }
+}
+
+bool Profiler::isEnabled() noexcept
+{
+    return enabled;
+}
+
+bool Profiler::isCounting() noexcept
+{
+    return counting;
+}
+
+bool Profiler::isCounterAvailable(PerfCounters::Counter counter) noexcept
+{
+    return available[counter];
+}
+
+/**
+ * @brief enable()で最初に開けなかったカウンタの名前と理由を返す。
+ */
+const std::string& Profiler::counterErrorMessage() noexcept
+{
+    return counterError;
+}
+
+/**
+ * @brief これまでの計測結果を捨てる。スレッドの登録は残す。
+ */
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& t : threads) {
+        t->stats.clear();
+        t->lookup.clear();
+        t->stack.clear();
+        t->events.clear();
+        t->droppedEvents = 0;
+        t->countStack.clear();
+    }
+    epoch = Clock::now();
+}
+
+/**
+ * @brief 呼び出したスレッドで計測中の区間のパスを返す。並列区間に入る前に呼び、ProfileScopeのparentに渡す。
+ *
+ * @return std::string 計測中の区間がなければ空文字列
+ */
+std::string Profiler::currentPath()
+{
+    if (!enabled) {
+        return std::string();
+    }
+
+    ThreadState& state = local();
+    return state.stack.empty() ? std::string() : state.stats[state.stack.back()].path;
+}
+
+/**
+ * @brief 区間の計測を始める。
+ *
+ * @param parent 親のパス。空なら、このスレッドで計測中の区間を親にする
+ * @param name
+ * @return uint32_t end()に渡す添字
+ */
+uint32_t Profiler::begin(std::string_view parent, std::string_view name)
+{
+    ThreadState& state = local();
+
+    std::string path;
+    if (!parent.empty()) {
+        path.append(parent).append("/");
+    } else if (!state.stack.empty()) {
+        path.append(state.stats[state.stack.back()].path).append("/");
+    }
+    path.append(name);
+
+    auto [it, inserted] = state.lookup.try_emplace(path, state.stats.size());
+    if (inserted) {
+        state.stats.push_back(Stat{ std::move(path) });
+    }
+    state.stack.push_back(it->second);
+
+    if (counting) {
+        if (!state.counters) {
+            state.counters = std::make_unique<PerfCounters>();
+        }
+        state.countStack.push_back(state.counters->read());
+    }
+
+    return it->second;
+}
+
+/**
+ * @brief 区間の計測を終える。
+ *
+ * @param statIndex begin()が返した添字
+ * @param start 区間の開始時刻
+ */
+void Profiler::end(uint32_t statIndex, Clock::time_point start) noexcept
+{
+    const Clock::time_point now = Clock::now();
+    const int64_t ns            = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+    ThreadState& state          = local();
+
+    Stat& stat = state.stats[statIndex];
+    if (counting && !state.countStack.empty()) {
+        const PerfCounters::Values counts = state.counters->read();
+        for (int32_t i = 0; i < PerfCounters::COUNTER_NUM; i++) {
+            stat.counts[i] += counts[i] - state.countStack.back()[i];
+        }
+        state.countStack.pop_back();
+    }
+    stat.calls++;
+    stat.totalNs += ns;
+    stat.minNs = std::min(stat.minNs, ns);
+    stat.maxNs = std::max(stat.maxNs, ns);
+    state.stack.pop_back();
+
+    if (tracing) {
+        if (state.events.size() < MAX_TRACE_EVENTS) {
+            const int64_t beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count();
+            state.events.push_back(Event{ statIndex, beginNs, ns });
+        } else {
+            state.droppedEvents++;
+        }
+    }
+}
+
+/**
+ * @brief すべてのスレッドの集計をパスごとにまとめる。
+ *
+ * @return std::vector<Summary> 親のすぐ後に子が並ぶ順(子どうしは最初に計測した順)
+ */
+std::vector<Profiler::Summary> Profiler::merged()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    std::vector<Summary> found;
+    std::unordered_map<std::string, size_t> index;
+    for (auto& t : threads) {
+        for (const Stat& stat : t->stats) {
+            auto [it, inserted] = index.try_emplace(stat.path, found.size());
+            if (inserted) {
+                found.push_back(Summary{ stat.path });
+            }
+
+            Summary& s = found[it->second];
+            s.threads++;
+            s.calls += stat.calls;
+            s.totalNs += stat.totalNs;
+            s.maxThreadNs = std::max(s.maxThreadNs, stat.totalNs);
+            s.minNs       = std::min(s.minNs, stat.minNs);
+            s.maxNs       = std::max(s.maxNs, stat.maxNs);
+            for (int32_t i = 0; i < PerfCounters::COUNTER_NUM; i++) {
+                s.counts[i] += stat.counts[i];
+            }
+        }
+    }
+
+    // 親が計測されていないパス(別スレッドの処理など)は根として扱う
+    std::vector<std::vector<size_t>> children(found.size());
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < found.size(); i++) {
+        auto it = index.find(std::string(parentPath(found[i].path)));
+        if (it == index.end()) {
+            roots.push_back(i);
+        } else {
+            children[it->second].push_back(i);
+        }
+    }
+
+    std::vector<Summary> ordered;
+    std::function<void(size_t)> visit = [&](size_t i) {
+        ordered.push_back(found[i]);
+        for (size_t c : children[i]) {
+            visit(c);
+        }
+    };
+    for (size_t r : roots) {
+        visit(r);
+    }
+
+    return ordered;
+}
+
+/**
+ * @brief 集計を表にして書き込む。
+ * @details wallはスレッドごとの合計の最大で、並列区間ではほぼ経過時間になる。%は最上位の区間のwallに対する割合。
+ *          total/wallがスレッド数より小さいほど、スレッド間の負荷が偏っている。
+ *
+ * @param os
+ */
+void Profiler::report(std::ostream& os)
+{
+    const std::vector<Summary> summaries = merged();
+
+    constexpr int NAME_WIDTH = 32;
+    os << std::left << std::setw(NAME_WIDTH) << "phase" << std::right << std::setw(8) << "threads" << std::setw(10) << "calls" << std::setw(12) << "total[ms]" << std::setw(12) << "wall[ms]"
+       << std::setw(12) << "mean[us]" << std::setw(12) << "max[us]" << std::setw(8) << "%" << "\n";
+
+    const std::ios::fmtflags flags = os.flags();
+    os << std::fixed;
+    int64_t rootNs = 0;
+    for (const Summary& s : summaries) {
+        const size_t depth = std::count(s.path.begin(), s.path.end(), '/');
+        if (depth == 0) {
+            rootNs = s.maxThreadNs;
+        }
+
+        const std::string name = std::string(depth * 2, ' ') + std::string(leafName(s.path));
+        os << std::left << std::setw(NAME_WIDTH) << name << std::right << std::setw(8) << s.threads << std::setw(10) << s.calls;
+        os << std::setprecision(2) << std::setw(12) << s.totalNs / 1e6 << std::setw(12) << s.maxThreadNs / 1e6;
+        os << std::setw(12) << (s.calls > 0 ? s.totalNs / 1e3 / s.calls : 0.0) << std::setw(12) << s.maxNs / 1e3;
+        os << std::setprecision(1) << std::setw(8) << (rootNs > 0 ? 100.0 * s.maxThreadNs / rootNs : 0.0) << "\n";
+    }
+    os.flags(flags);
+}
+
+/**
+ * @brief ハードウェアカウンタの集計を表にして書き込む。すべてのスレッドの合計で、開けなかったカウンタは"-"にする。
+ * @details IPC(1サイクルあたりの命令数)が低く、LLCミスが多い区間はメモリの待ちが支配的だと考えられる。
+ *          cpuはスレッドがCPU上で動いた時間の合計で、report()のtotalより小さければその分だけ待っていた(あるいは他に奪われていた)ことになる。
+ *
+ * @param os
+ */
+void Profiler::reportCounters(std::ostream& os)
+{
+    const std::vector<Summary> summaries = merged();
+
+    constexpr int NAME_WIDTH = 32;
+    os << std::left << std::setw(NAME_WIDTH) << "phase" << std::right << std::setw(12) << "cycles[M]" << std::setw(12) << "instr[M]" << std::setw(8) << "IPC" << std::setw(14) << "LLC-miss[K]"
+       << std::setw(14) << "br-miss[K]" << std::setw(12) << "cpu[ms]" << "\n";
+
+    const std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(2);
+    auto column = [&](int width, PerfCounters::Counter counter, uint64_t value, double scale) {
+        if (available[counter]) {
+            os << std::setw(width) << value / scale;
+        } else {
+            os << std::setw(width) << "-";
+        }
+    };
+    for (const Summary& s : summaries) {
+        const size_t depth     = std::count(s.path.begin(), s.path.end(), '/');
+        const std::string name = std::string(depth * 2, ' ') + std::string(leafName(s.path));
+        const uint64_t cycles  = s.counts[PerfCounters::CYCLES];
+        const uint64_t instr   = s.counts[PerfCounters::INSTRUCTIONS];
+
+        os << std::left << std::setw(NAME_WIDTH) << name << std::right;
+        column(12, PerfCounters::CYCLES, cycles, 1e6);
+        column(12, PerfCounters::INSTRUCTIONS, instr, 1e6);
+        if (available[PerfCounters::CYCLES] && available[PerfCounters::INSTRUCTIONS] && cycles > 0) {
+            os << std::setw(8) << (double)instr / cycles;
+        } else {
+            os << std::setw(8) << "-";
+        }
+        column(14, PerfCounters::LLC_MISSES, s.counts[PerfCounters::LLC_MISSES], 1e3);
+        column(14, PerfCounters::BRANCH_MISSES, s.counts[PerfCounters::BRANCH_MISSES], 1e3);
+        column(12, PerfCounters::TASK_CLOCK, s.counts[PerfCounters::TASK_CLOCK], 1e6);
+        os << "\n";
+    }
+    os.flags(flags);
+}
+
+/**
+ * @brief 記録したイベントをChromeのトレース形式(chrome://tracing、Perfettoで読める)で書き込む。
+ *
+ * @param os
+ */
+void Profiler::writeTrace(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    const std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first   = true;
+    auto newItem = [&] {
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    uint64_t dropped = 0;
+    for (auto& t : threads) {
+        newItem();
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << t->tid << ",\"args\":{\"name\":\"" << (t->tid == 0 ? "main" : "thread " + std::to_string(t->tid)) << "\"}}";
+
+        for (const Event& e : t->events) {
+            const std::string& path = t->stats[e.statIndex].path;
+            newItem();
+            os << "{\"name\":";
+            writeJsonString(os, leafName(path));
+            os << ",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":0,\"tid\":" << t->tid << ",\"ts\":" << e.beginNs / 1e3 << ",\"dur\":" << e.durationNs / 1e3 << ",\"args\":{\"path\":";
+            writeJsonString(os, path);
+            os << "}}";
+        }
+        dropped += t->droppedEvents;
+    }
+    os << "\n],\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+    os.flags(flags);
+}
+
+/**
+ * @brief 計測を始める。Profilerが無効なら何もしない。
+ *
+ * @param name 区間の名前。'/'は含めない
+ */
+ProfileScope::ProfileScope(std::string_view name)
+  : ProfileScope(std::string_view(), name)
+{
+}
+
+/**
+ * @brief 親のパスを指定して計測を始める。並列区間の中で使う。
+ *
+ * @param parent Profiler::currentPath()で取ったパス
+ * @param name 区間の名前。'/'は含めない
+ */
+ProfileScope::ProfileScope(std::string_view parent, std::string_view name)
+  : active(Profiler::isEnabled())
+{
+    if (active) {
+        statIndex = Profiler::begin(parent, name);
+        start     = Profiler::Clock::now();
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (active) {
+        Profiler::end(statIndex, start);
+    }
+}
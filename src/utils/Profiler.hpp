@@ -0,0 +1,159 @@
+/**
+ * @file Profiler.hpp
+ * @author Takanori Saiki
+ * @brief シミュレーションの各処理にかかった時間を計測する。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "PerfCounters.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class Profiler
+ * @brief ProfileScopeで囲んだ区間の時間をスレッドごとに集計し、表とChromeのトレース形式(JSON)で出力する。
+ * @details 区間は入れ子にでき、"step/nextStep/force"のように親の区間の名前をつなげたパスで区別する。
+ *          集計はスレッドごとに行うのでロックは取らない(ロックを取るのは各スレッドが最初に計測するときだけ)。
+ *          enable()を呼ぶまでは何もしないので、計測しない場合のコストは分岐1つ分になる。
+ *          enable()でcountersをtrueにすると、区間ごとにハードウェアカウンタ(PerfCounters)の増分も集計する。
+ *          その場合は区間の開始と終了でそれぞれ1回システムコールを呼ぶので、ステップより細かい区間には使わないこと。
+ *          report()とwriteTrace()は、計測中のスレッドがない(並列区間や書き出しジョブが終わった)ときに呼ぶこと。
+ */
+class Profiler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_TRACE_EVENTS = 1 << 20; //!< 1スレッドが記録するトレースのイベント数の上限。超えた分は集計だけ行う
+
+    /**
+     * @brief 1スレッドでの1つのパスの集計
+     */
+    struct Stat
+    {
+        std::string path;
+        uint64_t calls  = 0;
+        int64_t totalNs = 0;
+        int64_t minNs   = INT64_MAX;
+        int64_t maxNs   = 0;
+        PerfCounters::Values counts{}; //!< カウンタの増分の合計
+    };
+
+    /**
+     * @brief すべてのスレッドの集計をパスごとにまとめたもの
+     */
+    struct Summary
+    {
+        std::string path;
+        int32_t threads     = 0; //!< このパスを計測したスレッドの数
+        uint64_t calls      = 0;
+        int64_t totalNs     = 0; //!< すべてのスレッドの合計
+        int64_t maxThreadNs = 0; //!< スレッドごとの合計の最大。並列区間ではこれが経過時間に近い
+        int64_t minNs       = INT64_MAX;
+        int64_t maxNs       = 0;
+        PerfCounters::Values counts{}; //!< すべてのスレッドのカウンタの増分の合計
+    };
+
+    /**
+     * @brief トレースの1イベント(Chromeのトレース形式の"X"イベント)
+     */
+    struct Event
+    {
+        uint32_t statIndex; //!< ThreadState::statsの添字
+        int64_t beginNs;    //!< enable()からの時間
+        int64_t durationNs;
+    };
+
+    /**
+     * @brief 1スレッド分の計測結果
+     */
+    struct ThreadState
+    {
+        int32_t tid;
+        std::vector<Stat> stats;                          //!< 最初に計測した順
+        std::unordered_map<std::string, uint32_t> lookup; //!< パスからstatsの添字
+        std::vector<uint32_t> stack;                      //!< 計測中の区間(statsの添字)
+        std::vector<Event> events;
+        uint64_t droppedEvents = 0;
+
+        std::unique_ptr<PerfCounters> counters;      //!< countingのときだけ開く
+        std::vector<PerfCounters::Values> countStack; //!< 計測中の区間の開始時のカウンタの値
+    };
+
+  private:
+    static bool enabled;
+    static bool tracing;
+    static bool counting;
+    static std::array<bool, PerfCounters::COUNTER_NUM> available; //!< enable()を呼んだスレッドで開けたカウンタ
+    static std::string counterError;
+    static Clock::time_point epoch;
+
+    static std::mutex mtx;
+    static std::vector<std::unique_ptr<ThreadState>> threads;
+
+    static ThreadState& local();
+
+  public:
+    static void enable(bool trace, bool counters = false);
+    static bool isEnabled() noexcept;
+    static bool isCounting() noexcept;
+    static bool isCounterAvailable(PerfCounters::Counter counter) noexcept;
+    static const std::string& counterErrorMessage() noexcept;
+    static void reset();
+
+    static std::string currentPath();
+    static uint32_t begin(std::string_view parent, std::string_view name);
+    static void end(uint32_t statIndex, Clock::time_point start) noexcept;
+
+    static std::vector<Summary> merged();
+    static void report(std::ostream& os);
+    static void reportCounters(std::ostream& os);
+    static void writeTrace(std::ostream& os);
+};
+
+/**
+ * @class ProfileScope
+ * @brief 生成してから破棄するまでの時間をProfilerに記録する。
+ * @details 並列区間の中で使う場合は、区間に入る前にProfiler::currentPath()で親のパスを取っておき、parentに渡す。
+ *          そうするとどのスレッドの計測も同じパスにまとまる。
+ * @code
+ * ProfileScope scope("force");
+ *
+ * const std::string parent = Profiler::currentPath();
+ * #pragma omp parallel
+ * {
+ *     ProfileScope scope(parent, "forceWorker");
+ * #pragma omp for
+ *     ...
+ * }
+ * @endcode
+ */
+class ProfileScope
+{
+  private:
+    bool active;
+    uint32_t statIndex = 0;
+    Profiler::Clock::time_point start;
+
+  public:
+    explicit ProfileScope(std::string_view name);
+    ProfileScope(std::string_view parent, std::string_view name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
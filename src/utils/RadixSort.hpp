@@ -0,0 +1,92 @@
+/**
+ * @file RadixSort.hpp
+ * @author Takanori Saiki
+ * @brief 64ビットのキーで値を並べ替える並列の基数ソート
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <omp.h>
+#include <vector>
+
+namespace RadixSort {
+    constexpr int32_t DIGIT_BITS      = 8;
+    constexpr int32_t BUCKET_NUM      = 1 << DIGIT_BITS;
+    constexpr size_t PARALLEL_MIN_LEN = 1 << 14; //!< これより短い配列は1スレッドで並べ替える
+
+    /**
+     * @brief keysの昇順にkeysとvaluesを並べ替える。キーが等しい要素の順序は保たれる(安定)。
+     * @details 下位の桁から8ビットずつ並べ替える(LSD)。最大のキーより上の桁は飛ばすので、キーが小さいほど速い。
+     *          各パスでは、スレッドごとに担当範囲の桁の頻度を数え、(桁, スレッド)の順に累積して書き込み位置を決める。
+     *          そうすると各スレッドは重ならない位置に書き込むのでロックは要らず、スレッド内の順序も保たれる。
+     *
+     * @tparam T 値の型
+     * @param keys
+     * @param values keysと同じ長さ
+     */
+    template <typename T>
+    void sortByKey(std::vector<uint64_t>& keys, std::vector<T>& values)
+    {
+        const size_t n = keys.size();
+        if (n < 2) {
+            return;
+        }
+
+        uint64_t maxKey = 0;
+        for (uint64_t k : keys) {
+            maxKey |= k;
+        }
+
+        std::vector<uint64_t> keyBuf(n);
+        std::vector<T> valueBuf(n);
+
+        const int32_t threadNum = n < PARALLEL_MIN_LEN ? 1 : omp_get_max_threads();
+        std::vector<std::array<size_t, BUCKET_NUM>> offsets(threadNum);
+
+        for (int32_t shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += DIGIT_BITS) {
+#pragma omp parallel num_threads(threadNum)
+            {
+                const int32_t t     = omp_get_thread_num();
+                const int32_t num   = omp_get_num_threads();
+                const size_t begin  = n * t / num;
+                const size_t end    = n * (t + 1) / num;
+                auto& count         = offsets[t];
+
+                count.fill(0);
+                for (size_t i = begin; i < end; i++) {
+                    count[(keys[i] >> shift) & (BUCKET_NUM - 1)]++;
+                }
+
+#pragma omp barrier
+#pragma omp single
+                {
+                    size_t sum = 0;
+                    for (int32_t b = 0; b < BUCKET_NUM; b++) {
+                        for (int32_t u = 0; u < num; u++) {
+                            const size_t c = offsets[u][b];
+                            offsets[u][b]  = sum;
+                            sum += c;
+                        }
+                    }
+                }
+
+                for (size_t i = begin; i < end; i++) {
+                    const size_t dst = count[(keys[i] >> shift) & (BUCKET_NUM - 1)]++;
+                    keyBuf[dst]      = keys[i];
+                    valueBuf[dst]    = std::move(values[i]);
+                }
+            }
+
+            keys.swap(keyBuf);
+            values.swap(valueBuf);
+        }
+    }
+} // namespace RadixSort
@@ -0,0 +1,93 @@
+/**
+ * @file SpaceFillingCurve.hpp
+ * @author Takanori Saiki
+ * @brief 格子座標を空間充填曲線(Morton曲線、Hilbert曲線)上の通し番号に変換する。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief 空間充填曲線の通し番号。番号が近い格子は空間的にも近いので、番号順に並べると近傍のデータがメモリ上でも近くなる。
+ * @details Hilbert曲線は隣り合う番号が必ず隣り合う格子になるが、Morton曲線はときどき遠くへ飛ぶ。
+ *          そのかわりMorton曲線はビットを交互に並べるだけなので計算が速い。
+ */
+namespace SpaceFillingCurve {
+    /**
+     * @brief 下位21ビットの間に0を2つずつ挟む(3次元のMorton番号用)。
+     */
+    constexpr uint64_t spreadBits3(uint64_t v) noexcept
+    {
+        v &= 0x1fffff;
+        v = (v | (v << 32)) & 0x1f00000000ffffULL;
+        v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+        v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+        v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+        v = (v | (v << 2)) & 0x1249249249249249ULL;
+        return v;
+    }
+
+    /**
+     * @brief 32ビットの間に0を1つずつ挟む(2次元のMorton番号用)。
+     */
+    constexpr uint64_t spreadBits2(uint64_t v) noexcept
+    {
+        v &= 0xffffffff;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+        v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+        v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+    }
+
+    /**
+     * @brief 2次元のMorton番号(xが下位ビット)
+     */
+    constexpr uint64_t morton2D(uint32_t x, uint32_t y) noexcept
+    {
+        return spreadBits2(x) | (spreadBits2(y) << 1);
+    }
+
+    /**
+     * @brief 3次元のMorton番号。各座標の下位21ビットだけを使う。
+     */
+    constexpr uint64_t morton3D(uint32_t x, uint32_t y, uint32_t z) noexcept
+    {
+        return spreadBits3(x) | (spreadBits3(y) << 1) | (spreadBits3(z) << 2);
+    }
+
+    /**
+     * @brief 2次元のHilbert番号
+     *
+     * @param bits 一辺の格子数が2^bits以下になるビット数(最大31)
+     * @param x 0 <= x < 2^bits
+     * @param y 0 <= y < 2^bits
+     */
+    constexpr uint64_t hilbert2D(uint32_t bits, uint32_t x, uint32_t y) noexcept
+    {
+        uint64_t d = 0;
+        for (uint32_t s = bits == 0 ? 0 : 1u << (bits - 1); s > 0; s >>= 1) {
+            const uint32_t rx = (x & s) != 0;
+            const uint32_t ry = (y & s) != 0;
+            d += (uint64_t)s * s * ((3 * rx) ^ ry);
+
+            // 部分正方形の向きに合わせて座標を回転する
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = ~x;
+                    y = ~y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+} // namespace SpaceFillingCurve
@@ -0,0 +1,195 @@
+/**
+ * @file TextParse.hpp
+ * @author Takanori Saiki
+ * @brief タブ区切りの表を読むための小さな関数をまとめておく。
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @brief [p, end)の文字列を先頭から読み進める関数群。
+ * @details 読めた場合はpを読んだ分だけ進めてtrueを返す。ストリームやロケールを使わないので、mmapした大きなファイルを複数のスレッドで読むのに向く。
+ */
+namespace TextParse {
+    inline bool isBlank(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline bool isSeparator(char c) noexcept
+    {
+        return isBlank(c) || c == '\n';
+    }
+
+    inline void skipBlanks(const char*& p, const char* end) noexcept
+    {
+        while (p < end && isBlank(*p)) {
+            p++;
+        }
+    }
+
+    /**
+     * @brief 次の行の先頭を返す。最後の行ならendを返す。
+     */
+    inline const char* nextLine(const char* p, const char* end) noexcept
+    {
+        const void* nl = std::memchr(p, '\n', end - p);
+        return nl == nullptr ? end : static_cast<const char*>(nl) + 1;
+    }
+
+    /**
+     * @brief 行の残りが空白だけならtrueを返す。
+     */
+    inline bool isBlankLine(const char* p, const char* end) noexcept
+    {
+        skipBlanks(p, end);
+        return p == end || *p == '\n';
+    }
+
+    /**
+     * @brief 空白を読み飛ばし、次の区切りまでを1つのフィールドとして返す。
+     */
+    inline std::string_view nextField(const char*& p, const char* end) noexcept
+    {
+        skipBlanks(p, end);
+        const char* begin = p;
+        while (p < end && !isSeparator(*p)) {
+            p++;
+        }
+
+        return std::string_view(begin, p - begin);
+    }
+
+    /**
+     * @brief 符号付きの整数を読む。
+     */
+    inline bool parseInt(const char*& p, const char* end, int64_t& value) noexcept
+    {
+        skipBlanks(p, end);
+        const char* q       = p;
+        const bool negative = q < end && *q == '-';
+        if (q < end && (*q == '-' || *q == '+')) {
+            q++;
+        }
+
+        const char* digits = q;
+        uint64_t v         = 0;
+        while (q < end && '0' <= *q && *q <= '9' && q - digits < 18) {
+            v = v * 10 + (*q - '0');
+            q++;
+        }
+        if (q == digits || (q < end && !isSeparator(*q))) {
+            return false;
+        }
+
+        value = negative ? -(int64_t)v : (int64_t)v;
+        p     = q;
+        return true;
+    }
+
+    /**
+     * @brief 実数を読む。
+     * @details 仮数が15桁以内で10の指数が±22以内なら、仮数と10の累乗はどちらもdoubleで正確に表せるので、1回の乗除算で正しく丸められた値になる。
+     *          それ以外(桁の多い値、inf、nanなど)はstrtodに任せる。出力した結果を読み直す場合はほとんどが前者になる。
+     */
+    inline bool parseDouble(const char*& p, const char* end, double& value) noexcept
+    {
+        static constexpr double POW10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        constexpr int32_t MAX_FAST_DIGITS   = 15;
+        constexpr int32_t MAX_FAST_EXPONENT = 22;
+        constexpr size_t MAX_TOKEN_LEN      = 63;
+
+        skipBlanks(p, end);
+        const char* q       = p;
+        const bool negative = q < end && *q == '-';
+        if (q < end && (*q == '-' || *q == '+')) {
+            q++;
+        }
+
+        uint64_t mantissa = 0;
+        int32_t digits    = 0; // 仮数の有効桁数(先頭の0は数えない)
+        int32_t exponent  = 0;
+        bool hasDigit     = false;
+
+        for (; q < end && '0' <= *q && *q <= '9'; q++) {
+            hasDigit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*q - '0');
+                digits += mantissa != 0;
+            } else {
+                exponent++;
+                digits++;
+            }
+        }
+        if (q < end && *q == '.') {
+            for (q++; q < end && '0' <= *q && *q <= '9'; q++) {
+                hasDigit = true;
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*q - '0');
+                    digits += mantissa != 0;
+                    exponent--;
+                } else {
+                    digits++;
+                }
+            }
+        }
+        if (hasDigit && q < end && (*q == 'e' || *q == 'E')) {
+            const char* e        = q + 1;
+            const bool expNegate = e < end && *e == '-';
+            if (e < end && (*e == '-' || *e == '+')) {
+                e++;
+            }
+            int32_t expValue = 0;
+            const char* expDigits = e;
+            for (; e < end && '0' <= *e && *e <= '9'; e++) {
+                expValue = expValue < 10000 ? expValue * 10 + (*e - '0') : expValue;
+            }
+            if (e != expDigits) {
+                exponent += expNegate ? -expValue : expValue;
+                q = e;
+            }
+        }
+
+        if (hasDigit && (q == end || isSeparator(*q)) && digits <= MAX_FAST_DIGITS && -MAX_FAST_EXPONENT <= exponent && exponent <= MAX_FAST_EXPONENT) {
+            double v = (double)mantissa;
+            v        = exponent < 0 ? v / POW10[-exponent] : v * POW10[exponent];
+            value    = negative ? -v : v;
+            p        = q;
+            return true;
+        }
+
+        // 遅い経路。strtodは終端文字が必要なのでトークンを写してから読む
+        const char* tokenEnd = p;
+        while (tokenEnd < end && !isSeparator(*tokenEnd)) {
+            tokenEnd++;
+        }
+        const size_t len = tokenEnd - p;
+        if (len == 0 || len > MAX_TOKEN_LEN) {
+            return false;
+        }
+
+        char buf[MAX_TOKEN_LEN + 1];
+        std::memcpy(buf, p, len);
+        buf[len] = '\0';
+        char* parsedEnd;
+        const double v = std::strtod(buf, &parsedEnd);
+        if (parsedEnd != buf + len) {
+            return false;
+        }
+
+        value = v;
+        p     = tokenEnd;
+        return true;
+    }
+} // namespace TextParse
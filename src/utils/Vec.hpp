@@ -0,0 +1,399 @@
+/**
+ * @file Vec.hpp
+ * @author Takanori Saiki
+ * @brief 要素の型と次元を引数にとるベクトル(Vec3、Vec2はその別名)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Vecの要素。x, y, z, wの名前で触れるように次元ごとに特殊化する。
+ */
+template <typename T, int32_t N>
+struct VecStorage;
+
+template <typename T>
+struct VecStorage<T, 2> {
+    T x, y; //!< x, y座標
+};
+
+template <typename T>
+struct VecStorage<T, 3> {
+    T x, y, z; //!< x, y, z座標
+};
+
+template <typename T>
+struct VecStorage<T, 4> {
+    T x, y, z, w; //!< x, y, z座標と4番目の要素
+};
+
+/**
+ * @class Vec
+ * @brief N次元のベクトル。演算はすべてヘッダ内のconstexprな関数なので、どの翻訳単位からもインライン展開される。
+ * @details 要素ごとの演算は次元についてのループで書いてあり、コンパイル時に展開される。
+ *          a + b.timesScalar(s)のような式の一時オブジェクトは、インライン展開されればレジスタ上の値になる。
+ *          要素の型が違うVecどうし(floatとdouble)は変換できる。精度が落ちる向きの変換はexplicitにする。
+ *
+ * @tparam T 要素の型
+ * @tparam N 次元(2、3、4)
+ */
+template <typename T, int32_t N>
+class Vec : public VecStorage<T, N>
+{
+  public:
+    using value_type                 = T;
+    static constexpr int32_t DIMENSION = N;
+
+    constexpr Vec() noexcept
+      : VecStorage<T, N>{}
+    {
+    }
+
+    constexpr Vec(T x, T y) noexcept
+        requires(N == 2)
+      : VecStorage<T, N>{ x, y }
+    {
+    }
+
+    constexpr Vec(T x, T y, T z = 0) noexcept
+        requires(N == 3)
+      : VecStorage<T, N>{ x, y, z }
+    {
+    }
+
+    constexpr Vec(T x, T y, T z, T w) noexcept
+        requires(N == 4)
+      : VecStorage<T, N>{ x, y, z, w }
+    {
+    }
+
+    /**
+     * @brief 要素の型が違うVecから変換する。doubleからfloatのように精度が落ちる場合はexplicit
+     */
+    template <typename U>
+    constexpr explicit(sizeof(U) > sizeof(T)) Vec(const Vec<U, N>& other) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            (*this)[i] = (T)other[i];
+        }
+    }
+
+    constexpr T& operator[](int32_t i) noexcept
+    {
+        if constexpr (N == 2) {
+            return i == 0 ? this->x : this->y;
+        } else if constexpr (N == 3) {
+            return i == 0 ? this->x : (i == 1 ? this->y : this->z);
+        } else {
+            return i == 0 ? this->x : (i == 1 ? this->y : (i == 2 ? this->z : this->w));
+        }
+    }
+
+    constexpr const T& operator[](int32_t i) const noexcept
+    {
+        return const_cast<Vec&>(*this)[i];
+    }
+
+    constexpr Vec operator-() const noexcept
+    {
+        Vec v;
+        for (int32_t i = 0; i < N; i++) {
+            v[i] = -(*this)[i];
+        }
+        return v;
+    }
+
+    constexpr Vec& operator+=(const Vec& obj) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            (*this)[i] += obj[i];
+        }
+        return *this;
+    }
+
+    constexpr Vec& operator-=(const Vec& obj) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            (*this)[i] -= obj[i];
+        }
+        return *this;
+    }
+
+    constexpr Vec& operator*=(T num) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            (*this)[i] *= num;
+        }
+        return *this;
+    }
+
+    constexpr Vec& operator/=(T num) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            (*this)[i] /= num;
+        }
+        return *this;
+    }
+
+    friend constexpr Vec operator+(Vec a, const Vec& b) noexcept
+    {
+        return a += b;
+    }
+
+    friend constexpr Vec operator-(Vec a, const Vec& b) noexcept
+    {
+        return a -= b;
+    }
+
+    friend constexpr Vec operator*(Vec a, T num) noexcept
+    {
+        return a *= num;
+    }
+
+    friend constexpr Vec operator*(T num, Vec a) noexcept
+    {
+        return a *= num;
+    }
+
+    friend constexpr Vec operator/(Vec a, T num) noexcept
+    {
+        return a /= num;
+    }
+
+    friend constexpr bool operator==(const Vec& a, const Vec& b) noexcept
+    {
+        for (int32_t i = 0; i < N; i++) {
+            if (a[i] != b[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief ベクトルを定数倍する。
+     */
+    constexpr Vec timesScalar(T num) const noexcept
+    {
+        return *this * num;
+    }
+
+    /**
+     * @brief 内積
+     */
+    constexpr T dot(const Vec& vec) const noexcept
+    {
+        T sum = (*this)[0] * vec[0];
+        for (int32_t i = 1; i < N; i++) {
+            sum += (*this)[i] * vec[i];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief 長さの2乗。距離の比較ではlength()のかわりにこれを使うと平方根がいらない。
+     */
+    constexpr T lengthSquared() const noexcept
+    {
+        return dot(*this);
+    }
+
+    /**
+     * @brief ベクトルの長さを返す。
+     */
+    T length() const noexcept
+    {
+        return std::sqrt(lengthSquared());
+    }
+
+    /**
+     * @brief ベクトル同士の距離を返す。
+     */
+    T dist(const Vec& vec) const noexcept
+    {
+        return (*this - vec).length();
+    }
+
+    /**
+     * @brief ベクトルを正規化する。ただし、長さが0の場合は0ベクトルを返す。
+     */
+    Vec normalize() const noexcept
+    {
+        const T len = length();
+        if (len == 0) {
+            return Vec();
+        }
+
+        Vec v;
+        for (int32_t i = 0; i < N; i++) {
+            v[i] = (*this)[i] / len;
+        }
+        return v;
+    }
+
+    /**
+     * @brief 外積
+     */
+    constexpr Vec cross(const Vec& vec) const noexcept
+        requires(N == 3)
+    {
+        return Vec(this->y * vec.z - this->z * vec.y, this->z * vec.x - this->x * vec.z, this->x * vec.y - this->y * vec.x);
+    }
+
+    /**
+     * @brief theta, phi = Rad で回転
+     */
+    Vec rotate(T theta, T phi) const noexcept
+        requires(N == 3)
+    {
+        const T rotate[3][3] = { { std::cos(theta) * std::cos(phi), std::sin(theta) * std::cos(phi), -std::sin(phi) },
+                                 { -std::sin(theta), std::cos(theta), 0 },
+                                 { std::cos(theta) * std::sin(phi), std::sin(theta) * std::sin(phi), std::cos(phi) } };
+
+        Vec v;
+        for (int32_t y_i = 0; y_i < 3; y_i++) {
+            T sum = 0;
+            for (int32_t x_i = 0; x_i < 3; x_i++) {
+                sum += rotate[y_i][x_i] * (*this)[x_i];
+            }
+            v[y_i] = sum;
+        }
+        return v;
+    }
+
+    void print() const noexcept
+    {
+        std::cout << "(";
+        for (int32_t i = 0; i < N; i++) {
+            std::cout << (*this)[i] << (i + 1 < N ? ", " : ")");
+        }
+        std::cout << std::endl;
+    }
+
+    static constexpr Vec zero() noexcept
+    {
+        return Vec();
+    }
+
+    /**
+     * @brief 角度thetaの方向を表す二次元単位ベクトルを返す。
+     */
+    static Vec direction2(T theta) noexcept
+        requires(N == 3)
+    {
+        return Vec(std::cos(theta), std::sin(theta), 0);
+    }
+
+    /**
+     * @brief 角度theta, phiの方向を表す三次元単位ベクトルを返す。
+     */
+    static Vec direction3(T theta, T phi) noexcept
+        requires(N == 3)
+    {
+        return Vec(std::cos(theta) * std::sin(phi), std::sin(theta) * std::sin(phi), std::cos(phi));
+    }
+
+    /**
+     * @brief 方向のみを表すランダムな正規化されたベクトル(z=0で固定)を返す。
+     */
+    static Vec randomDirection2() noexcept
+        requires(N == 3)
+    {
+        static std::mt19937 rand_gen(0);                     //!< 乱数生成器(生成器はとりあえずメルセンヌ・ツイスタ)
+        std::uniform_real_distribution<T> angle_ratio(0, 1); //!< 方向の割合
+        const T angle = 2.0 * M_PI * angle_ratio(rand_gen);
+
+        return direction2(angle);
+    }
+
+    /**
+     * @brief 方向のみを表すランダムな正規化されたベクトルを返す。
+     */
+    static Vec randomDirection3() noexcept
+        requires(N == 3)
+    {
+        static std::mt19937 rand_gen(0);                     //!< 乱数生成器(生成器はとりあえずメルセンヌ・ツイスタ)
+        std::uniform_real_distribution<T> angle_ratio(0, 1); //!< 方向の割合
+        const T theta = 2.0 * M_PI * angle_ratio(rand_gen);
+        const T phi   = 2.0 * M_PI * angle_ratio(rand_gen);
+
+        return direction3(theta, phi);
+    }
+};
+
+/**
+ * @brief 4要素分の境界にそろえた3次元のベクトル。配列にしたときに1要素を1回のSIMDのロード(doubleならAVXの256bit)で読める。
+ * @details 4番目の要素は使わない(0のまま)。Vec<T, 3>として計算し、結果はコンストラクタで戻す。
+ */
+template <typename T>
+struct alignas(4 * sizeof(T)) PaddedVec3 : public Vec<T, 3> {
+    T padding = 0;
+
+    constexpr PaddedVec3() noexcept = default;
+    constexpr PaddedVec3(const Vec<T, 3>& v) noexcept
+      : Vec<T, 3>(v)
+    {
+    }
+};
+
+/**
+ * @brief 配列に対するまとめた演算。要素ごとの演算をループにするだけなので、コンパイラがSIMD命令にしやすい。
+ * @details 第1引数はstd::spanで渡す(std::vectorならstd::span(v))。2番目以降の配列はspanに変換できれば何でもよい。
+ */
+namespace VecBatch {
+    /**
+     * @brief out[i] += in[i] * scale
+     */
+    template <typename V>
+    constexpr void addScaled(std::span<V> out, std::span<const std::type_identity_t<V>> in, typename V::value_type scale) noexcept
+    {
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] += in[i] * scale;
+        }
+    }
+
+    /**
+     * @brief out[i] = |points[i] - center|^2
+     */
+    template <typename V>
+    constexpr void distancesSquared(std::span<const V> points, const Vec<typename V::value_type, V::DIMENSION>& center,
+                                    std::span<typename V::value_type> out) noexcept
+    {
+        for (size_t i = 0; i < points.size(); i++) {
+            out[i] = (points[i] - center).lengthSquared();
+        }
+    }
+
+    /**
+     * @brief 要素ごとの最小値と最大値(外接箱)。空なら(0, 0)
+     */
+    template <typename V>
+    constexpr std::pair<V, V> boundingBox(std::span<const V> points) noexcept
+    {
+        if (points.empty()) {
+            return { V(), V() };
+        }
+
+        V lower = points[0], upper = points[0];
+        for (const V& p : points) {
+            for (int32_t d = 0; d < V::DIMENSION; d++) {
+                lower[d] = p[d] < lower[d] ? p[d] : lower[d];
+                upper[d] = p[d] > upper[d] ? p[d] : upper[d];
+            }
+        }
+        return { lower, upper };
+    }
+} // namespace VecBatch